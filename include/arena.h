@@ -0,0 +1,77 @@
+/**
+ * @file arena.h
+ * @brief Header file for the bump allocator of command lines
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions de l'arène d'allocation d'une ligne de commande : les chaînes d'une ligne (mots produits par l'analyseur lexical...)
+ *    sont allouées par simple incrément d'un pointeur dans un bloc fourni par le propriétaire (*command_line_t.command_line*),
+ *    puis libérées toutes ensemble par *arena_reset()*.
+ *    Si le bloc initial est plein, des blocs supplémentaires sont alloués sur le tas ; le compteur *arena_heap_allocations()* permet de vérifier
+ *    que le cas courant n'en alloue aucun.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+struct arena_chunk; // Bloc alloué sur le tas (voir arena.c)
+
+/** @brief Arène d'allocation.
+ * @struct arena_t
+ */
+typedef struct
+{
+    char *base;                 ///< Bloc initial, fourni par le propriétaire de l'arène
+    size_t base_size;           ///< Taille du bloc initial
+    char *ptr;                  ///< Premier octet libre du bloc courant
+    char *end;                  ///< Fin du bloc courant
+    struct arena_chunk *chunks; ///< Blocs alloués sur le tas, du plus récent au plus ancien
+} arena_t;
+
+/** @brief Fonction d'initialisation d'une arène.
+ * @param a Arène à initialiser.
+ * @param base Bloc initial (utilisé en premier, jamais libéré par l'arène).
+ * @param size Taille du bloc initial.
+ */
+void arena_init(arena_t *a, char *base, size_t size);
+
+/** @brief Fonction de libération de toutes les allocations d'une arène.
+ * @param a Arène initialisée.
+ * @details O(1) quand seul le bloc initial a servi ; sinon les blocs alloués sur le tas sont libérés.
+ *    A appeler aussi avant de libérer le propriétaire de l'arène.
+ */
+void arena_reset(arena_t *a);
+
+/** @brief Fonction d'allocation dans une arène.
+ * @param a Arène.
+ * @param size Taille demandée.
+ * @return void* Zone alignée pour un pointeur, NULL en cas d'erreur d'allocation.
+ */
+void *arena_alloc(arena_t *a, size_t size);
+
+/** @brief Fonction de copie d'une chaîne dans une arène.
+ * @param a Arène.
+ * @param s Début de la chaîne.
+ * @param len Longueur de la chaîne (un '\0' est ajouté).
+ * @return char* Copie, NULL en cas d'erreur d'allocation.
+ */
+char *arena_strndup(arena_t *a, const char *s, size_t len);
+
+/** @brief Fonction de réservation de place après l'objet en cours de construction.
+ * @param a Arène.
+ * @param object Début de l'objet en cours de construction (il se termine en *a->ptr*), ou pointeur sur NULL s'il n'y en a pas.
+ * @param more Nombre d'octets à rendre disponibles après *a->ptr*.
+ * @return int 0 en cas de succès, -1 en cas d'erreur d'allocation.
+ * @details Si le bloc courant est trop petit, l'objet en cours est recopié au début d'un nouveau bloc et *object* est mis à jour.
+ *    L'appelant écrit ensuite directement en *a->ptr*, qu'il avance.
+ */
+int arena_extend(arena_t *a, char **object, size_t more);
+
+/** @brief Fonction d'accès au nombre de blocs alloués sur le tas par toutes les arènes depuis le démarrage.
+ * @return size_t Nombre d'appels à *malloc()* effectués par les arènes.
+ */
+size_t arena_heap_allocations(void);
+
+#endif // ARENA_H
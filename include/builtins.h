@@ -12,16 +12,59 @@
 
 #include "processus.h"
 
+/// Taille de la table des commandes intégrées (puissance de 2, indexée par *builtin_slot()*)
+#define BUILTIN_TABLE_SIZE 32
+
+/** @brief Entrée de la table des commandes intégrées.
+ * @struct builtin_t
+ */
+typedef struct builtin
+{
+    const char *name;                 ///< Nom de la commande (NULL pour une case vide)
+    int (*handler)(processus_t *cmd); ///< Fonction d'exécution
+} builtin_t;
+
+/** @brief Fonction de hachage des noms de commandes intégrées.
+ * @param name Nom de la commande.
+ * @param len Longueur du nom (au moins 1).
+ * @return unsigned Case de la table (entre 0 et BUILTIN_TABLE_SIZE - 1).
+ * @details Hachage parfait pour les commandes intégrées : il ne dépend que du premier, du deuxième et du dernier caractère et de la longueur,
+ *    et les coefficients ont été choisis pour qu'aucune commande intégrée ne partage sa case avec une autre.
+ */
+unsigned builtin_slot(const char *name, size_t len);
+
+/** @brief Fonction de recherche d'une commande intégrée.
+ * @param name Nom de la commande.
+ * @return const builtin_t* Entrée de la table, NULL si la commande n'est pas intégrée.
+ * @details Une seule case est examinée (hachage parfait), suivie d'une unique comparaison de chaînes.
+ */
+const builtin_t *find_builtin(const char *name);
+
+/** @brief Fonction d'accès à la table des commandes intégrées.
+ * @return const builtin_t* Table de BUILTIN_TABLE_SIZE cases, indexée par *builtin_slot()* (les cases vides ont un nom NULL).
+ */
+const builtin_t *builtin_table(void);
+
+/** @brief Fonction de résolution d'une commande intégrée, mémorisée dans le processus.
+ * @param cmd Processus à résoudre.
+ * @return const builtin_t* Entrée de la table, NULL si la commande n'est pas intégrée.
+ * @details Le résultat est conservé dans *cmd->builtin* : les appels suivants (dont *exec_builtin()*) ne refont pas la recherche.
+ */
+const builtin_t *resolve_builtin(processus_t *cmd);
+
 /** @brief Fonction de vérification si une commande est une commande "built-in".
  * @param cmd Structure de commande à vérifier. (Le champ *path* est utilisé pour vérifier le nom de la commande.)
  * @return int 1 si la commande est intégrée, 0 sinon.
- * @details Les commandes intégrées sont a minima: cd, exit, export, unset, pwd.
+ * @details Les commandes intégrées sont a minima: cd, exit, export, unset, pwd. S'y ajoutent hash, type, echo, printf, test et [, les commandes de contrôle des jobs (jobs, wait, fg, bg, kill), set et exec.
+ *    La recherche passe par *find_builtin()* ; la commande résolue est utilisée si *cmd->builtin* est déjà renseigné.
  */
 int is_builtin(const processus_t* cmd);
 
 /** @brief Fonction d'exécution d'une commande intégrée.
  * @param cmd Pointeur vers la structure de commande à exécuter.
- * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (dont l'échec de l'écriture de la sortie).
+ * @details La fonction d'exécution est celle de *resolve_builtin()*. Au retour, la sortie tamponnée de la commande est écrite (voir *output_flush_all()*).
+ *    Toute commande autre que "test" et "[" invalide le cache des résultats de stat() (voir *builtin_stat_cache_clear()*).
  */
 int exec_builtin(processus_t* cmd);
 
@@ -39,22 +82,35 @@ int builtin_cd(processus_t* cmd);
  * @param cmd Pointeur vers la structure de commande à exécuter.
  * @return int 0 en cas de succès, -1 en cas d'erreur.
  * @details Termine le shell avec le code de sortie spécifié dans le premier argument de la commande.
- *  Si aucun argument n'est fourni, le shell se termine avec le code de sortie 0.
+ *  Si aucun argument n'est fourni, le shell se termine avec le code de retour de la dernière commande exécutée (0 au démarrage).
  *  En cas d'erreur (argument non numérique, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur
  */
 int builtin_exit(processus_t* cmd);
 
+/** @brief Fonction d'exécution de la commande "exec".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 0 en cas de succès, 1 si une redirection n'a pas pu être installée, 127 si la commande est introuvable, 126 si elle n'est pas exécutable
+ *  (shell interactif uniquement : sinon le shell se termine avec ce statut).
+ * @details Sans argument, installe les redirections de la commande dans le shell lui-même (voir *set_shell_fd()*) : "exec 3>>journal" ouvre
+ *  le fichier une seule fois pour toutes les lignes suivantes ("echo x >&3"), "exec >sortie" redirige la sortie du shell et de ses commandes,
+ *  "exec 3>&-" referme le descripteur. "exec commande arguments..." installe de même les redirections puis remplace le shell par la commande
+ *  (*execve()* sans fork, voir *replace_shell()*). En cas d'échec, un message est affiché sur *cmd->stderr* ; comme l'exige POSIX, un shell
+ *  non interactif (script, "-c") se termine alors au lieu de poursuivre avec les redirections déjà installées.
+ */
+int builtin_exec(processus_t* cmd);
+
 /** @brief Fonction d'exécution de la commande "export".
  * @param cmd Pointeur vers la structure de commande à exécuter.
  * @return int 0 en cas de succès, -1 en cas d'erreur.
- * @details Ajoute ou modifie une variable d'environnement dans l'environnement du shell. En cas d'erreur (format invalide, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur.
+ * @details Ajoute ou modifie une variable exportée dans la table des variables du shell (voir vars.h) : "export VAR=val" la définit,
+ *  "export VAR" exporte une variable locale déjà définie. Modifier PATH vide le cache des chemins de commandes. En cas d'erreur (format invalide, variable non définie, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur.
  */
 int builtin_export(processus_t* cmd);
 
 /** @brief Fonction d'exécution de la commande "unset".
  * @param cmd Pointeur vers la structure de commande à exécuter.
  * @return int 0 en cas de succès, -1 en cas d'erreur.
- * @details Supprime une variable d'environnement de l'environnement du shell. En cas d'erreur (variable inexistante, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur.
+ * @details Supprime une variable (locale ou exportée) de la table des variables du shell. Supprimer PATH vide le cache des chemins de commandes. En cas d'erreur (variable inexistante, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur.
  */
 int builtin_unset(processus_t* cmd);
 
@@ -65,4 +121,109 @@ int builtin_unset(processus_t* cmd);
  */
 int builtin_pwd(processus_t* cmd);
 
+/** @brief Fonction d'exécution de la commande "hash".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 0 en cas de succès, 1 si une commande est introuvable, -1 en cas d'erreur.
+ * @details Sans argument, affiche le contenu du cache des chemins de commandes (nombre d'utilisations et chemin) sur *cmd->stdout*.
+ *  "hash -r" vide le cache. "hash nom..." résout chaque nom via $PATH et le mémorise ; un nom introuvable provoque un message sur *cmd->stderr*.
+ */
+int builtin_hash(processus_t* cmd);
+
+/** @brief Fonction d'exécution de la commande "type".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 0 en cas de succès, 1 si une commande est introuvable.
+ * @details Indique pour chaque argument s'il s'agit d'une commande intégrée, d'une commande mémorisée dans le cache des chemins ("haché")
+ *  ou d'une commande trouvée dans $PATH (qui est alors mémorisée). Le résultat est affiché sur *cmd->stdout*.
+ */
+int builtin_type(processus_t* cmd);
+
+/** @brief Fonction d'exécution de la commande "jobs".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @details Affiche sur *cmd->stdout* les jobs d'arrière-plan ("[n]+ état commande"). "jobs -l" ajoute les PID, "jobs -p" n'affiche que les PID.
+ *  Les jobs terminés affichés sont retirés de la table.
+ */
+int builtin_jobs(processus_t* cmd);
+
+/** @brief Fonction d'exécution de la commande "wait".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int Code de retour du dernier job ou processus attendu, 127 s'il n'est pas un fils du shell, -1 en cas d'erreur.
+ * @details Sans argument, attend la fin de tous les jobs d'arrière-plan et retourne 0.
+ *  Sinon, attend chaque processus (PID) ou job (%n) désigné ; les jobs terminés sont retirés de la table.
+ */
+int builtin_wait(processus_t* cmd);
+
+/** @brief Fonction d'exécution de la commande "fg".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int Code de retour du job, 1 si le job n'existe pas.
+ * @details Passe le job désigné (par défaut le job courant) en avant-plan, le reprend s'il est stoppé (SIGCONT) et attend sa fin.
+ */
+int builtin_fg(processus_t* cmd);
+
+/** @brief Fonction d'exécution de la commande "bg".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 0 en cas de succès, 1 si le job n'existe pas.
+ * @details Reprend en arrière-plan (SIGCONT) le job stoppé désigné (par défaut le job courant).
+ */
+int builtin_bg(processus_t* cmd);
+
+/** @brief Fonction d'exécution de la commande "kill".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 0 en cas de succès, 1 si un envoi a échoué, -1 en cas d'erreur de syntaxe.
+ * @details "kill [-s SIG | -n NUM | -SIG] pid|%n..." envoie le signal (SIGTERM par défaut) aux processus ou aux jobs désignés.
+ *  "kill -l" liste les noms de signaux reconnus sur *cmd->stdout*.
+ */
+int builtin_kill(processus_t* cmd);
+
+/** @brief Fonction d'exécution de la commande "set".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @details "set -o" affiche les options du shell sur *cmd->stdout*. "set -o nom=valeur" modifie une option :
+ *  - maxjobs=N : nombre maximal de jobs d'arrière-plan exécutés simultanément (0 : illimité, nombre de processeurs par défaut) ;
+ *  - spawn=fork|posix_spawn|zygote : mécanisme de création des processus.
+ */
+int builtin_set(processus_t* cmd);
+
+/** @brief Fonction d'exécution de la commande "echo".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 0 en cas de succès, -1 en cas d'erreur d'écriture.
+ * @details Affiche les arguments séparés par des espaces, suivis d'un saut de ligne, sur *cmd->stdout*.
+ *  Options (éventuellement groupées, "-ne") : -n supprime le saut de ligne final, -e interprète les séquences d'échappement
+ *  ("\n", "\t", "\0NNN", "\c" arrête la sortie...), -E les désactive (par défaut). Un argument qui n'est pas une option est affiché tel quel.
+ */
+int builtin_echo(processus_t* cmd);
+
+/** @brief Fonction d'exécution de la commande "printf".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 0 en cas de succès, 1 si un argument ou le format est invalide (la sortie s'arrête à la conversion fautive), -1 sans format ou en cas d'erreur d'écriture.
+ * @details "printf format [argument...]" affiche les arguments selon *format* sur *cmd->stdout* (POSIX) :
+ *  - séquences d'échappement du format ("\n", "\t", "\\", "\NNN", "\xHH"...) ;
+ *  - conversions %d %i %o %u %x %X %c %s %e %E %f %F %g %G %a %A et %%, avec drapeaux (-+ #0), largeur et précision (nombres ou '*') ;
+ *  - %b : argument dont les séquences d'échappement sont interprétées ("\c" arrête toute la sortie) ;
+ *  - %q : argument protégé pour être relu par le shell.
+ *  Le format est réutilisé tant qu'il reste des arguments ; un argument manquant vaut 0 ou la chaîne vide.
+ *  Un argument numérique peut être en décimal, octal (0NNN), hexadécimal (0xHH) ou un caractère ('c).
+ */
+int builtin_printf(processus_t* cmd);
+
+/** @brief Fonction d'exécution des commandes "test" et "[".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 0 si l'expression est vraie, 1 si elle est fausse, 2 en cas d'erreur (syntaxe, entier invalide, "]" manquant).
+ * @details Opérateurs POSIX :
+ *  - fichiers : -b -c -d -e -f -g -h -L -k -p -r -s -S -t -u -w -x -G -O, f1 -nt f2, f1 -ot f2, f1 -ef f2 ;
+ *  - chaînes : -n, -z, =, ==, !=, <, > et une chaîne seule (vraie si non vide) ;
+ *  - entiers : -eq -ne -lt -le -gt -ge ;
+ *  - logiques : !, -a, -o et parenthèses.
+ *  Les résultats de stat() sont mis en cache jusqu'à la prochaine commande qui pourrait les rendre obsolètes (voir *builtin_stat_cache_clear()*) :
+ *  "[ -e f ] && [ -f f ] && [ -s f ]" ne fait qu'un appel système.
+ */
+int builtin_test(processus_t* cmd);
+
+/** @brief Fonction d'invalidation du cache des résultats de stat() utilisé par "test" et "[".
+ * @details Appelée au début de chaque ligne de commande, avant le lancement d'une commande externe, après toute commande intégrée autre que
+ *    "test" et "[", et à l'ouverture d'une redirection qui peut créer ou tronquer un fichier : le cache n'est partagé que par des tests
+ *    successifs qu'aucune autre commande n'a pu rendre obsolètes.
+ */
+void builtin_stat_cache_clear(void);
+
 #endif // BUILTINS_H
\ No newline at end of file
@@ -0,0 +1,84 @@
+/**
+ * @file expand.h
+ * @brief Header file for shell parameter expansion
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions des paramètres substitués dans les arguments des commandes ($NOM, ${NOM}) :
+ *    - variables du shell (voir vars.h) ;
+ *    - paramètres spéciaux : $? (code de retour de la dernière commande), $$ (PID du shell),
+ *      $! (PID de la dernière commande lancée en arrière-plan), $# (nombre de paramètres positionnels) ;
+ *    - paramètres positionnels : $0 (nom du shell ou du script), $1 à $9, ${10}..., $@ et $* (tous les paramètres séparés par des espaces).
+ *    Les valeurs sont lues dans l'état du shell tenu à jour par *launch_command_line()* : aucune allocation ni copie du nom,
+ *    les valeurs numériques sont écrites dans un tampon fourni par l'appelant.
+ *
+ *    La substitution est différée : l'analyseur lexical ne recopie que le nom des paramètres, entre des octets de contrôle (EXPAND_CTL_*),
+ *    et *expand_processus()* remplace ces marqueurs au lancement de chaque commande. Une commande d'une branche && ou || non exécutée
+ *    ne coûte donc aucune substitution, et "export X=1 && echo $X" voit la nouvelle valeur.
+ */
+
+#ifndef EXPAND_H
+#define EXPAND_H
+
+#include <stddef.h>
+
+#include "processus.h"
+
+/// Taille du tampon des valeurs numériques ($?, $$, $!, $#)
+#define EXPAND_NUMBER_SIZE 24
+
+/// Marqueurs des mots dont la substitution est différée (token TOKEN_WORD_EXPAND)
+#define EXPAND_CTL_VAR '\001'   ///< Début d'un paramètre hors guillemets (valeur découpée en mots) : NOM puis EXPAND_CTL_END
+#define EXPAND_CTL_QVAR '\002'  ///< Début d'un paramètre entre guillemets doubles (valeur non découpée) : NOM puis EXPAND_CTL_END
+#define EXPAND_CTL_END '\003'   ///< Fin du nom d'un paramètre
+#define EXPAND_CTL_QUOTE '\004' ///< Le mot contenait des guillemets : il existe même si sa substitution est vide ($X"")
+#define EXPAND_CTL_ESC '\005'   ///< Le caractère suivant est littéral (octet de la ligne égal à un marqueur)
+
+/// Caractère égal à l'un des marqueurs EXPAND_CTL_*
+#define EXPAND_IS_CTL(c) ((unsigned char)(c) >= 1 && (unsigned char)(c) <= 5)
+
+/** @brief Fonction de définition des paramètres positionnels.
+ * @param argc Nombre d'éléments de *argv*.
+ * @param argv $0 puis les paramètres $1, $2... (non copiés : le tableau doit rester valable, comme celui de *main()*).
+ * @return int 0 en cas de succès, -1 en cas d'erreur d'allocation (la valeur de $@ et $* est alors vide).
+ * @details Sans appel, $0 vaut "minishell" et il n'y a aucun paramètre positionnel.
+ */
+int expand_set_positional(int argc, char *argv[]);
+
+/** @brief Fonction de calcul de la longueur du nom d'un paramètre écrit sans accolades ($NOM, $?, $1...).
+ * @param name Début du nom (caractère qui suit le '$').
+ * @param max Nombre de caractères lisibles à partir de *name* (le nom s'arrête aussi au premier '\0').
+ * @return size_t Longueur du nom, 0 si le '$' n'est pas suivi d'un nom (il est alors littéral).
+ * @details Un paramètre spécial ou un chiffre forme un nom d'un caractère ("$12" est $1 suivi de "2", comme dans sh) ;
+ *    sinon le nom est la plus longue suite de lettres, chiffres et '_'.
+ */
+size_t expand_name_length(const char *name, size_t max);
+
+/** @brief Fonction de récupération de la valeur d'un paramètre.
+ * @param name Début du nom (pas nécessairement terminé par '\0').
+ * @param len Longueur du nom.
+ * @param buf Tampon où sont écrites les valeurs numériques.
+ * @return const char* Valeur du paramètre (dans *buf*, dans la table des variables ou dans les paramètres positionnels), NULL s'il n'est pas défini.
+ */
+const char *expand_parameter(const char *name, size_t len, char buf[EXPAND_NUMBER_SIZE]);
+
+/** @brief Fonction de substitution des paramètres dans les arguments d'un processus.
+ * @param cmdl Ligne de commande du processus (son arène reçoit les mots substitués et, si besoin, le nouveau tableau *argv*).
+ * @param proc Processus dont les arguments contiennent des marqueurs (*proc->expand*).
+ * @return int 0 en cas de succès, -1 en cas d'erreur d'allocation.
+ * @details Appelée au lancement du processus : les valeurs sont celles du moment, après l'exécution des commandes précédentes de la ligne.
+ *    Hors guillemets, une valeur est découpée en mots sur les espaces, tabulations et retours à la ligne (sauf dans une commande formée
+ *    uniquement d'affectations "NOM=valeur") ; un mot dont la substitution est vide disparaît, sauf s'il contenait des guillemets.
+ *    *argv* (et *path*) sont remplacés, *argc* est mis à jour et *proc->expand* remis à 0.
+ */
+int expand_processus(command_line_t *cmdl, processus_t *proc);
+
+/** @brief Fonction de substitution des paramètres dans un mot, sans découpage.
+ * @param a Arène qui reçoit le résultat.
+ * @param word Mot produit par l'analyseur lexical (avec ou sans marqueurs).
+ * @return char* Mot substitué (éventuellement vide), NULL en cas d'erreur d'allocation.
+ * @details Utilisée pour les mots qui ne forment jamais plusieurs arguments (fichier d'une redirection).
+ */
+char *expand_string(arena_t *a, const char *word);
+
+#endif // EXPAND_H
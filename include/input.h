@@ -0,0 +1,82 @@
+/**
+ * @file input.h
+ * @brief Header file for the command line reader
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions du lecteur de lignes de commande du shell : terminal, fichier de script, tube ou chaîne (-c).
+ *    Un fichier régulier est projeté en mémoire (mmap), les autres entrées sont lues par blocs.
+ *    Les lignes sont découpées sans copie : chaque ligne retournée pointe directement dans le tampon du lecteur.
+ */
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/// Taille des blocs lus sur une entrée non projetable (tube, terminal)
+#define INPUT_BLOCK_SIZE 65536
+
+/** @brief Lecteur de lignes de commande.
+ * @struct input_t
+ */
+typedef struct
+{
+    int fd;           ///< Descripteur lu (-1 pour une chaîne)
+    char *data;       ///< Contenu projeté, tampon de lecture ou chaîne
+    size_t size;      ///< Nombre d'octets valides dans *data*
+    size_t capacity;  ///< Taille du tampon de lecture (0 si *data* n'est pas alloué par le lecteur)
+    size_t pos;       ///< Position du début de la prochaine ligne dans *data*
+    size_t line_no;   ///< Numéro de la dernière ligne retournée
+    uint8_t mapped;   ///< *data* est une projection mmap
+    uint8_t eof;      ///< Fin de l'entrée atteinte
+    uint8_t owns_fd;  ///< Le descripteur a été ouvert par le lecteur
+} input_t;
+
+/** @brief Fonction d'ouverture d'un lecteur sur un descripteur.
+ * @param in Lecteur à initialiser.
+ * @param fd Descripteur à lire.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @details Un fichier régulier non vide est projeté en mémoire en une fois ; les autres descripteurs sont lus par blocs de INPUT_BLOCK_SIZE octets.
+ *    Le descripteur n'est pas fermé par *input_close()*.
+ */
+int input_open_fd(input_t *in, int fd);
+
+/** @brief Fonction d'ouverture d'un lecteur sur un fichier de script.
+ * @param in Lecteur à initialiser.
+ * @param path Chemin du fichier.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (errno renseigné).
+ */
+int input_open_file(input_t *in, const char *path);
+
+/** @brief Fonction d'ouverture d'un lecteur sur une chaîne (option -c).
+ * @param in Lecteur à initialiser.
+ * @param str Chaîne à lire, qui doit rester valide jusqu'à *input_close()*.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ */
+int input_open_string(input_t *in, const char *str);
+
+/** @brief Fonction de lecture de la ligne suivante.
+ * @param in Lecteur.
+ * @param line Pointeur renseigné avec le début de la ligne (dans le tampon du lecteur, sans '\n' ni '\0' final).
+ * @return ssize_t Longueur de la ligne, -1 à la fin de l'entrée ou en cas d'erreur de lecture.
+ * @details La ligne reste valide jusqu'au prochain appel. Le '\r' d'une fin de ligne "\r\n" est retiré.
+ */
+ssize_t input_next_line(input_t *in, const char **line);
+
+/** @brief Fonction de test de la fin de l'entrée.
+ * @param in Lecteur.
+ * @return int 1 si la fin de l'entrée est connue et qu'il ne reste que des blancs à lire (la dernière ligne a été retournée), 0 sinon.
+ * @details Aucune lecture n'est faite : sur une entrée lue par blocs, la fin n'est connue qu'une fois le dernier bloc lu.
+ */
+int input_at_end(const input_t *in);
+
+/** @brief Fonction de fermeture d'un lecteur.
+ * @param in Lecteur.
+ * @details Libère le tampon ou la projection, et ferme le descripteur s'il a été ouvert par *input_open_file()*.
+ */
+void input_close(input_t *in);
+
+#endif // INPUT_H
@@ -0,0 +1,232 @@
+/**
+ * @file jobs.h
+ * @brief Header file for the job table
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions de la table des jobs du shell : chaque processus fils lancé par le shell y est enregistré.
+ *    Les fils sont récupérés par le gestionnaire de SIGCHLD (via wait4()), qui enregistre leur statut, leur date de fin et les ressources consommées.
+ *    Les accès par PID (table de hachage) et par numéro de job (tableau) se font en temps constant.
+ */
+
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <signal.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/resource.h>
+
+/// Nombre de jobs d'arrière-plan terminés dont le statut est conservé pour "wait" en mode non interactif (voir *jobs_prune()*)
+#define JOBS_KEEP_DONE 1024
+
+/** @brief Etats d'un processus ou d'un job.
+ * @enum job_state_t
+ */
+typedef enum
+{
+    JOB_RUNNING, ///< En cours d'exécution
+    JOB_STOPPED, ///< Stoppé par un signal (SIGSTOP, SIGTSTP...)
+    JOB_DONE     ///< Terminé (statut disponible)
+} job_state_t;
+
+/** @brief Processus enregistré dans la table des jobs.
+ * @struct job_process_t
+ * @details Les champs *state*, *status*, *end_time* et *rusage* sont écrits par le gestionnaire de SIGCHLD.
+ */
+typedef struct
+{
+    pid_t pid;                      ///< PID du processus (0 : case libre)
+    int job_id;                     ///< Numéro du job auquel appartient le processus
+    int next;                       ///< Indice du processus suivant du même job, -1 pour le dernier
+    volatile sig_atomic_t state;    ///< Etat du processus (job_state_t)
+    int status;                     ///< Statut brut retourné par wait4()
+    struct timespec end_time;       ///< Date de fin du processus (CLOCK_MONOTONIC)
+    struct rusage rusage;           ///< Ressources consommées par le processus (wait4())
+} job_process_t;
+
+/** @brief Job : ensemble des processus d'une commande ou d'un pipeline.
+ * @struct job_t
+ */
+typedef struct
+{
+    int id;                         ///< Numéro du job (%n), 0 : case libre
+    int first;                      ///< Indice du premier processus du job, -1 si aucun
+    int last;                       ///< Indice du dernier processus du job, -1 si aucun
+    volatile sig_atomic_t nalive;   ///< Nombre de processus non terminés
+    volatile sig_atomic_t nstopped; ///< Nombre de processus stoppés
+    uint8_t is_background;          ///< Job en arrière-plan
+    char *command;                  ///< Texte de la commande (pour "jobs"), peut être NULL
+    sig_atomic_t done_next;         ///< Chaînage des jobs d'arrière-plan terminés et non signalés
+} job_t;
+
+/** @brief Fonction d'initialisation de la table des jobs.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @details Installe le gestionnaire de SIGCHLD. Les appels suivants n'ont aucun effet.
+ *    La fonction est appelée automatiquement par *jobs_new()*.
+ */
+int jobs_init(void);
+
+/** @brief Fonction d'installation d'une fonction de récupération supplémentaire.
+ * @param reaper Fonction "async-signal-safe" appelée par le gestionnaire de SIGCHLD, NULL pour aucune.
+ * @details Permet à un mécanisme de lancement dont les processus ne sont pas des fils du shell de transmettre leurs changements d'état
+ *    via *jobs_record()* : il lui suffit d'envoyer SIGCHLD au shell.
+ */
+void jobs_set_reaper(void (*reaper)(void));
+
+/** @brief Fonction d'enregistrement d'un changement d'état d'un processus suivi.
+ * @param pid PID du processus.
+ * @param status Statut brut (au format de wait4()).
+ * @param rusage Ressources consommées (prises en compte si le processus est terminé).
+ * @details Fonction "async-signal-safe", appelée par le gestionnaire de SIGCHLD pour les fils du shell et par les mécanismes de lancement
+ *    dont les processus ne sont pas des fils directs du shell (voir zygote.h). Hors gestionnaire, elle doit être appelée SIGCHLD bloqué.
+ *    Un PID absent de la table est ignoré. Le processus concerné est le processus non terminé qui porte ce PID, même si un processus
+ *    terminé le porte aussi : le nombre de jobs d'arrière-plan actifs (*jobs_wait_slot()*) baisse dès la récupération du fils.
+ */
+void jobs_record(pid_t pid, int status, const struct rusage *rusage);
+
+/** @brief Fonction de blocage de SIGCHLD.
+ * @param old Masque de signaux à sauvegarder (pour *jobs_unblock()*).
+ * @details Le lancement d'un processus et son enregistrement via *jobs_add_process()* doivent se faire SIGCHLD bloqué,
+ *    sinon le fils pourrait être récupéré avant d'être connu de la table.
+ */
+void jobs_block(sigset_t *old);
+
+/** @brief Fonction de restauration du masque de signaux sauvegardé par *jobs_block()*.
+ * @param old Masque de signaux à restaurer.
+ */
+void jobs_unblock(const sigset_t *old);
+
+/** @brief Fonction de création d'un job.
+ * @param is_background 1 si le job est lancé en arrière-plan.
+ * @param command Texte de la commande (copié), peut être NULL.
+ * @return int Numéro du job (> 0), -1 en cas d'erreur.
+ * @details Le numéro attribué est le plus grand numéro utilisé + 1, comme dans les shells usuels.
+ */
+int jobs_new(int is_background, const char *command);
+
+/** @brief Fonction d'ajout d'un processus à un job.
+ * @param id Numéro du job.
+ * @param pid PID du processus.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @details Doit être appelée avec SIGCHLD bloqué depuis la création du processus (voir *jobs_block()*).
+ *    Si le PID a été réutilisé par le système, le processus terminé qui le portait n'est plus accessible par *jobs_find_pid()*
+ *    (son statut reste disponible dans son job).
+ */
+int jobs_add_process(int id, pid_t pid);
+
+/** @brief Fonction de récupération d'un job par son numéro.
+ * @param id Numéro du job.
+ * @return job_t* Job, ou NULL s'il n'existe pas.
+ */
+job_t *jobs_get(int id);
+
+/** @brief Fonction de récupération d'un processus par son PID.
+ * @param pid PID du processus.
+ * @return job_process_t* Processus, ou NULL s'il n'est pas dans la table.
+ */
+job_process_t *jobs_find_pid(pid_t pid);
+
+/** @brief Fonction de récupération d'un processus par son indice.
+ * @param index Indice du processus (champs *first*, *last* et *next*).
+ * @return job_process_t* Processus, ou NULL si l'indice est invalide.
+ */
+job_process_t *jobs_process(int index);
+
+/** @brief Fonction de récupération du plus grand numéro de job utilisé.
+ * @return int Plus grand numéro de job, 0 si la table est vide.
+ * @details Permet de parcourir les jobs de 1 à *jobs_max_id()* via *jobs_get()*. C'est aussi le job "courant" (%+).
+ */
+int jobs_max_id(void);
+
+/** @brief Fonction de récupération du nombre de jobs d'arrière-plan non terminés.
+ * @return int Nombre de jobs d'arrière-plan en cours ou stoppés.
+ */
+int jobs_active_count(void);
+
+/** @brief Fonction d'attente d'une place pour un nouveau job d'arrière-plan.
+ * @param limit Nombre maximal de jobs d'arrière-plan en cours d'exécution (0 : illimité).
+ * @return int 0 quand moins de *limit* jobs d'arrière-plan s'exécutent.
+ * @details Le shell est suspendu (sigsuspend) jusqu'à la fin d'un job d'arrière-plan. Les jobs stoppés ne sont pas comptés :
+ *    ils ne se termineront pas d'eux-mêmes et bloqueraient le shell indéfiniment.
+ */
+int jobs_wait_slot(int limit);
+
+/** @brief Fonction d'attente d'un processus.
+ * @param pid PID du processus.
+ * @return int 0 si le processus est terminé ou stoppé, -1 s'il n'est pas dans la table.
+ * @details Le shell est suspendu (sigsuspend) jusqu'à ce que le gestionnaire de SIGCHLD change l'état du processus.
+ */
+int jobs_wait_pid(pid_t pid);
+
+/** @brief Fonction d'attente d'un job.
+ * @param id Numéro du job.
+ * @return int 0 si tous les processus du job sont terminés ou si l'un d'eux est stoppé, -1 si le job n'existe pas.
+ */
+int jobs_wait(int id);
+
+/** @brief Fonction de calcul du code de retour d'un job.
+ * @param id Numéro du job.
+ * @return int Code de retour du dernier processus du job (128 + signal s'il a été tué ou stoppé), -1 si le job n'existe pas.
+ */
+int jobs_status(int id);
+
+/** @brief Fonction de conversion d'un statut brut (wait4) en code de retour du shell.
+ * @param status Statut brut.
+ * @return int Code de sortie, ou 128 + numéro du signal.
+ */
+int jobs_exit_code(int status);
+
+/** @brief Fonction d'envoi d'un signal à tous les processus non terminés d'un job.
+ * @param id Numéro du job.
+ * @param sig Signal à envoyer.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @details Si *sig* est SIGCONT, les processus stoppés sont considérés comme repris.
+ */
+int jobs_signal(int id, int sig);
+
+/** @brief Fonction de suppression d'un job et de ses processus.
+ * @param id Numéro du job.
+ * @details Les processus non terminés ne sont plus suivis (ils ne deviennent pas des zombies : le gestionnaire de SIGCHLD les récupère toujours).
+ */
+void jobs_remove(int id);
+
+/** @brief Fonction de suppression de tous les jobs.
+ * @details Utilisée dans un fils du shell (commande intégrée d'un pipeline) : les jobs du shell ne sont pas ses fils,
+ *    il ne doit ni les attendre ni les reprendre.
+ */
+void jobs_clear(void);
+
+/** @brief Fonction de signalement des jobs d'arrière-plan terminés.
+ * @param fd Descripteur sur lequel afficher "[n] Fini commande", ou -1 pour ne rien afficher.
+ * @return int Nombre de jobs signalés.
+ * @details Les jobs signalés sont supprimés de la table. Seuls les jobs terminés depuis le dernier appel sont parcourus.
+ */
+int jobs_notify(int fd);
+
+/** @brief Fonction de suppression des jobs d'arrière-plan terminés les plus anciens, sans signalement.
+ * @param keep Nombre de jobs terminés conservés (les derniers terminés).
+ * @return int Nombre de jobs supprimés.
+ * @details Utilisée en mode non interactif, où *jobs_notify()* n'est pas appelée : les statuts restent disponibles pour "wait",
+ *    mais la table ne grossit pas indéfiniment. La liste n'est parcourue que lorsqu'elle dépasse 2 * *keep* jobs.
+ */
+int jobs_prune(int keep);
+
+/** @brief Fonction de passage d'un job en avant-plan ou en arrière-plan.
+ * @param id Numéro du job.
+ * @param is_background 1 pour l'arrière-plan, 0 pour l'avant-plan.
+ * @param command Texte de la commande à mémoriser si le job n'en a pas encore, peut être NULL.
+ * @return int 0 en cas de succès, -1 si le job n'existe pas.
+ */
+int jobs_set_background(int id, int is_background, const char *command);
+
+/** @brief Fonction de description de l'état d'un job ("En cours", "Stoppé", "Fini", "Sortie 3", ...).
+ * @param id Numéro du job.
+ * @param buf Tampon de destination.
+ * @param size Taille du tampon.
+ * @return const char* *buf*.
+ */
+const char *jobs_describe(int id, char *buf, size_t size);
+
+#endif // JOBS_H
@@ -0,0 +1,56 @@
+/**
+ * @file output.h
+ * @brief Header file for the buffered output of built-in commands
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions des tampons de sortie des commandes intégrées.
+ *    Chaque descripteur a son propre tampon ; les écritures sont regroupées et envoyées avec *writev()*
+ *    quand le tampon est plein, quand un autre descripteur est utilisé (l'ordre des messages entre sortie et erreur est conservé)
+ *    et au retour de la commande intégrée (voir *exec_builtin()*).
+ */
+
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stddef.h>
+
+/// Taille du tampon de chaque descripteur
+#define OUTPUT_BUFFER_SIZE 8192
+/// Nombre maximal de descripteurs ayant un tampon en même temps
+#define OUTPUT_MAX_FDS 4
+
+/** @brief Fonction d'écriture d'octets dans le tampon d'un descripteur.
+ * @param fd Descripteur de destination.
+ * @param data Octets à écrire.
+ * @param len Nombre d'octets.
+ * @details Si le tampon déborde, son contenu et *data* sont écrits ensemble par un seul *writev()*, sans copie de *data*.
+ */
+void output_write(int fd, const void *data, size_t len);
+
+/** @brief Fonction d'écriture d'un caractère dans le tampon d'un descripteur.
+ * @param fd Descripteur de destination.
+ * @param c Caractère.
+ */
+void output_putc(int fd, char c);
+
+/** @brief Fonction d'écriture formatée (comme *dprintf()*) dans le tampon d'un descripteur.
+ * @param fd Descripteur de destination.
+ * @param format Format de *printf()*.
+ * @return int Nombre d'octets produits, -1 en cas d'erreur de formatage.
+ */
+int output_printf(int fd, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+/** @brief Fonction d'écriture du tampon d'un descripteur.
+ * @param fd Descripteur.
+ * @return int 0 en cas de succès, -1 si une écriture a échoué.
+ */
+int output_flush(int fd);
+
+/** @brief Fonction d'écriture de tous les tampons.
+ * @return int 0 en cas de succès, -1 si une écriture a échoué depuis le dernier appel.
+ * @details Appelée au retour de chaque commande intégrée, avant que ses descripteurs ne soient fermés.
+ */
+int output_flush_all(void);
+
+#endif // OUTPUT_H
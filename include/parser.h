@@ -11,73 +11,61 @@
 #define PARSER_H
 
 #include "processus.h"
+#include "input.h"
 
-/** @brief Fonction de suppression des espaces inutiles au début et à la fin d'une chaîne de caractères.
- * @param str Chaîne de caractères à traiter.
- * @return int 0 en cas de succès, -1 en cas d'erreur.
+/** @brief Fonction d'analyse lexicale d'une ligne de commande.
+ * @param cmdl Pointeur vers la structure de ligne de commande à remplir (*tokens*, *token_types* et *arena*).
+ * @param line Début de la ligne de commande (pas nécessairement terminée par '\0').
+ * @param len Longueur de la ligne.
+ * @return int Nombre de tokens, -1 en cas d'erreur (guillemet non fermé, erreur d'allocation).
+ * @details Un seul parcours de la ligne, par un automate à trois états (hors guillemets, entre '...', entre "...") :
+ *    - les espaces séparent les mots ; les opérateurs ; | |& || && & < > >> <& >& &> &>> << <<- <<< sont reconnus sans espace autour ("a|b", "x>f") ;
+ *    - des chiffres en début de mot collés à '<' ou '>' forment un token TOKEN_IO_NUMBER ("2>f", "3<&0" ; "a2>f" redirige "a2"),
+ *      "!" n'est un opérateur que s'il forme un mot à lui seul ;
+ *    - les guillemets sont retirés : rien n'est interprété entre '...', seuls \$ \` \" \\ et $VAR le sont entre "..." ;
+ *      hors guillemets, '\' protège le caractère suivant ;
+ *    - $VAR, ${VAR} et les paramètres $? $$ $! $# $0..$9 $@ $* sont marqués (token TOKEN_WORD_EXPAND) puis substitués au lancement
+ *      de la commande par *expand_processus()* ; hors guillemets, la valeur est alors découpée en mots ;
+ *    - le délimiteur qui suit "<<" ou "<<-" est littéral ('$' compris) ; s'il contenait des guillemets ("<<'FIN'"), il se termine par
+ *      EXPAND_CTL_QUOTE : le contenu du document ne sera pas substitué.
+ *    Un mot entre guillemets n'est jamais un opérateur ("'|'" est un argument). Les mots et les tableaux *tokens* et *token_types* (doublés quand ils sont pleins) sont écrits dans *cmdl->arena*
+ *    (son bloc initial, *cmdl->command_line*, suffit aux lignes courantes).
+ *    Elle remplace l'ancienne chaîne de passes sur une copie de la ligne (trim, clean, separate_s, substenv, strcut), conservée dans bench_parser.
  */
-int trim(char* str);
-
-/** @brief Fonction de nettoyage d'une chaîne de caractères en supprimant les doublons d'espaces.
- * @param str Chaîne de caractères à nettoyer.
- * @return int 0 en cas de succès, -1 en cas d'erreur.
- */
-int clean(char* str);
-
-/** @brief Fonction d'ajout de caractères d'espacement autour de tous les caractères de la chaîne *s* présents dans *str*.
- * @param str Chaîne de caractères à traiter.
- * @param s Chaîne de caractères contenant les séparateurs.
- * @param max Taille maximale de la chaîne *str*.
- * @return int 0 en cas de succès, -1 en cas d'erreur (dépassement de taille).
- * @details Cette fonction ajoute un espace avant et après chaque occurrence d'un caractère de *s* dans *str*.
- *    Si l'ajout d'espaces dépasse la taille maximale *max*, la fonction retourne -1.
- */
-int separate_s(char* str, char* s, size_t max);
-
-/** @brief Fonction de remplacement de toutes les occurrences de la sous-chaîne *s* par la sous-chaîne *t* dans la chaîne *str*.
- * @param str Chaîne de caractères à traiter.
- * @param s Sous-chaîne à remplacer.
- * @param t Sous-chaîne de remplacement.
- * @param max Taille maximale de la chaîne *str*.
- * @return int 0 en cas de succès, -1 en cas d'erreur (dépassement de taille).
- * @details Cette fonction remplace toutes les occurrences de la sous-chaîne *s* par la sous-chaîne *t* dans la chaîne *str*.
- *    Si le remplacement dépasse la taille maximale *max*, la fonction retourne -1.
- */
-int replace(char* str, const char* s, const char* t, size_t max);
-
-/** @brief Fonction de substitution des variables d'environnement dans une chaîne de caractères.
- * @param str Chaîne de caractères à traiter.
- * @param max Taille maximale de la chaîne *str*.
- * @return int 0 en cas de succès, -1 en cas d'erreur (dépassement de taille).
- * @details Cette fonction remplace toutes les occurrences de variables d'environnement au format $VAR ou ${VAR} par leur valeur dans la chaîne *str*.
- *    Si une variable n'existe pas, elle est remplacée par une chaîne vide.
- *    Si le remplacement dépasse la taille maximale *max*, la fonction retourne -1.
- */
-int substenv(char* str, size_t max);
-
-/** @brief Fonction de découpage d'une chaîne de caractères en tokens selon un séparateur.
- * @param str Chaîne de caractères à découper. Attention, cette chaîne est modifiée par la fonction.
- * @param sep Caractère séparateur.
- * @param tokens Tableau de chaînes de caractères pour stocker les tokens extraits. Le tableau est terminé par un pointeur NULL.
- * @param max Taille maximale du tableau *tokens*.
- * @return int Nombre de tokens extraits, -1 en cas d'erreur (dépassement de taille).
- * @details Cette fonction découpe la chaîne *str* en tokens en utilisant le caractère *sep* comme séparateur.
- *    Les tokens extraits sont stockés dans le tableau *tokens*.
- *    Si le nombre de tokens dépasse la taille maximale *max*, la fonction retourne -1.
- */
-int strcut(char* str, char sep, char** tokens, size_t max);
+int lex_command_line(command_line_t* cmdl, const char* line, size_t len);
 
 /** @brief Fonction d'analyse d'une ligne de commande.
  * @param cmdl Pointeur vers la structure de ligne de commande à remplir.
  * @param line Chaîne de caractères contenant la ligne de commande à analyser.
- * @return int 0 en cas de succès, -1 en cas d'erreur (ligne trop longue, trop de commandes, etc.).
+ * @return int 0 en cas de succès, -1 en cas d'erreur (syntaxe, allocation, etc.).
  * @details Cette fonction analyse la ligne de commande *line* et remplit la structure *cmdl* avec les informations extraites.
- *    La ligne de commande est copiée dans *cmdl->command_line* dans la limite de MAX_CMD_LINE caractères.
- *    La ligne est ensuite nettoyée (trim, clean, separate_s, replace, substenv), puis découpée en tokens.
+ *    La ligne est découpée en tokens typés en un seul parcours par *lex_command_line()* (mots écrits dans *cmdl->arena*, pointés directement par *argv*).
  *    Les tokens sont ensuite utilisés pour remplir les structures processus_t et control_flow_t dans *cmdl*.
- *    Si la ligne dépasse la taille maximale ou si le nombre de commandes dépasse MAX_CMDS, la fonction retourne -1.
- *    Si une erreur est détectée, les descripteurs de fichiers ouverts sont fermés via close_fds(cmdl) avant de retourner -1.
+ *    Ni la longueur de la ligne, ni le nombre de commandes ou d'arguments ne sont limités (les tableaux de *cmdl* sont agrandis dans son arène).
+ *    Aucun fichier ni tube n'est ouvert : les redirections sont enregistrées par *add_redirection()* et ouvertes au lancement de leur commande,
+ *    les tubes d'un pipeline sont créés par *launch_command_line()*.
  */
 int parse_command_line(command_line_t* cmdl, const char* line);
 
+/** @brief Fonction d'analyse d'une ligne de commande de longueur connue.
+ * @param cmdl Pointeur vers la structure de ligne de commande à remplir.
+ * @param line Début de la ligne de commande (pas nécessairement terminée par '\0', par exemple une ligne du lecteur de input.h).
+ * @param len Longueur de la ligne.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (syntaxe, allocation, etc.).
+ * @details Identique à *parse_command_line()*, sans parcours préalable de la ligne pour en calculer la longueur.
+ */
+int parse_command_line_n(command_line_t* cmdl, const char* line, size_t len);
+
+/** @brief Fonction de lecture du contenu des documents en ligne d'une ligne de commande ("<<FIN", "<<-FIN").
+ * @param cmdl Ligne de commande analysée par *parse_command_line()* (*num_heredocs* documents en attente de leur contenu).
+ * @param in Lecteur de la ligne : le contenu est lu sur les lignes qui la suivent.
+ * @param prompt Invite affichée avant chaque ligne du contenu (mode interactif), NULL pour aucune.
+ * @return int 0 en cas de succès, -1 en cas d'erreur d'allocation.
+ * @details Les documents sont lus dans l'ordre de la ligne, chacun jusqu'à la ligne égale à son délimiteur (après le retrait des tabulations
+ *    de tête pour "<<-"), ou jusqu'à la fin de l'entrée (avec un avertissement). Le contenu est écrit dans l'arène de la ligne et remplace
+ *    le délimiteur dans la redirection. Si le délimiteur ne contenait pas de guillemets, $VAR y est marqué pour être substitué au lancement
+ *    (sans découpage en mots), "\$", "\\" et "\`" y sont des caractères littéraux et une ligne terminée par '\' se poursuit sur la suivante.
+ */
+int read_heredocs(command_line_t* cmdl, input_t* in, const char* prompt);
+
 #endif // PARSER_H
\ No newline at end of file
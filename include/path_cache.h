@@ -0,0 +1,65 @@
+/**
+ * @file path_cache.h
+ * @brief Header file for the command path cache
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions du cache "nom de commande -> chemin absolu" utilisé pour éviter de parcourir $PATH à chaque lancement.
+ */
+
+#ifndef PATH_CACHE_H
+#define PATH_CACHE_H
+
+#include <stddef.h>
+
+/** @brief Entrée du cache des chemins de commandes.
+ * @struct path_cache_entry_t
+ * @details Une entrée dont *path* vaut NULL mémorise un échec de recherche (commande introuvable dans $PATH).
+ */
+typedef struct
+{
+    char *name;         ///< Nom de la commande (clé)
+    char *path;         ///< Chemin absolu résolu, NULL si la commande est introuvable
+    unsigned long hits; ///< Nombre d'utilisations de l'entrée
+} path_cache_entry_t;
+
+/** @brief Fonction de résolution d'un nom de commande en chemin via le cache.
+ * @param name Nom de la commande (sans '/').
+ * @return const char* Chemin absolu de la commande, ou NULL si elle est introuvable dans $PATH.
+ * @details Au premier appel pour *name*, les répertoires de $PATH sont parcourus et le résultat (succès ou échec) est mémorisé.
+ *    Les appels suivants ne font aucun appel système. Le compteur *hits* de l'entrée est incrémenté.
+ */
+const char *path_cache_lookup(const char *name);
+
+/** @brief Fonction de consultation du cache sans résolution.
+ * @param name Nom de la commande.
+ * @return const path_cache_entry_t* Entrée du cache, ou NULL si *name* n'a jamais été résolu.
+ */
+const path_cache_entry_t *path_cache_find(const char *name);
+
+/** @brief Fonction de résolution forcée d'un nom de commande.
+ * @param name Nom de la commande.
+ * @return const char* Nouveau chemin absolu, ou NULL si la commande est introuvable.
+ * @details L'entrée existante est recalculée à partir de $PATH (utilisé par exemple quand l'exec d'un chemin mémorisé échoue avec ENOENT).
+ *    Le compteur *hits* est conservé.
+ */
+const char *path_cache_refresh(const char *name);
+
+/** @brief Fonction de vidage du cache.
+ * @details Appelée lorsque $PATH est modifié ou par "hash -r".
+ */
+void path_cache_clear(void);
+
+/** @brief Fonction de parcours des entrées du cache.
+ * @param fn Fonction appelée pour chaque entrée ; le parcours s'arrête si elle retourne une valeur non nulle.
+ * @param data Pointeur transmis tel quel à *fn*.
+ * @return int 0 si toutes les entrées ont été parcourues, la valeur retournée par *fn* sinon.
+ */
+int path_cache_foreach(int (*fn)(const path_cache_entry_t *entry, void *data), void *data);
+
+/** @brief Fonction de récupération du nombre d'entrées du cache.
+ * @return size_t Nombre d'entrées (échecs compris).
+ */
+size_t path_cache_size(void);
+
+#endif // PATH_CACHE_H
@@ -15,15 +15,14 @@
 #include <stdint.h>
 #include <time.h>
 #include <fcntl.h>
+#include <sys/resource.h>
 
-/// Nombre maximum d'arguments
-#define MAX_ARGS 128
-/// Nombre maximum de variables d'environnement
-#define MAX_ENV 128
-/// Nombre maximum de commandes sur une ligne
-#define MAX_CMDS 128
-/// Taille maximale d'une ligne de commande
-#define MAX_CMD_LINE 4096
+#include "arena.h"
+
+/// Nombre d'entrées de *argv* stockées dans le processus lui-même (NULL final compris) ; au-delà, *argv* est agrandi dans l'arène de la ligne
+#define PROCESSUS_INLINE_ARGS 8
+/// Taille du bloc initial de l'arène d'une ligne de commande ; au-delà, l'arène s'étend sur le tas (les lignes ne sont pas limitées en taille)
+#define COMMAND_LINE_BLOCK_SIZE 16384
 
 /** @brief Modes de contrôle de flux pour les processus.
  * @enum control_flow_mode_t
@@ -33,11 +32,89 @@ typedef enum
 {
     UNCONDITIONAL, ///< Exécution inconditionnelle
     ON_SUCCESS,    ///< Exécution en cas de succès
-    ON_FAILURE     ///< Exécution en cas d'échec
+    ON_FAILURE,    ///< Exécution en cas d'échec
+    PIPELINE       ///< Etape suivante d'un pipeline (exécution concurrente)
 } control_flow_mode_t;
 
+/** @brief Mécanismes de création des processus fils.
+ * @enum spawn_backend_t
+ * @details Cette énumération définit la manière dont *launch_processus()* crée les processus des commandes externes.
+ */
+typedef enum
+{
+    SPAWN_FORK,        ///< *fork()* puis *execv()* (mécanisme de repli)
+    SPAWN_POSIX_SPAWN, ///< *posix_spawn()* avec "file actions" (pas de copie des tables de pages du shell)
+    SPAWN_ZYGOTE       ///< Fils créés à l'avance par un zygote (voir zygote.h), pour les commandes de premier plan
+} spawn_backend_t;
+
+/** @brief Types des tokens d'une ligne de commande.
+ * @enum token_type_t
+ * @details Cette énumération définit les catégories reconnues par l'analyseur lexical (voir *lex_command_line()*).
+ */
+typedef enum
+{
+    TOKEN_END,        ///< Fin de la ligne
+    TOKEN_WORD,       ///< Mot (commande, argument ou fichier), guillemets retirés
+    TOKEN_SEMICOLON,  ///< ";"
+    TOKEN_PIPE,       ///< "|"
+    TOKEN_PIPE_ALL,   ///< "|&" (sortie et erreur standard vers le tube, comme "2>&1 |")
+    TOKEN_OR,         ///< "||"
+    TOKEN_AND,        ///< "&&"
+    TOKEN_BACKGROUND, ///< "&"
+    TOKEN_IN,         ///< "<"
+    TOKEN_OUT,        ///< ">"
+    TOKEN_APPEND,     ///< ">>"
+    TOKEN_DUP_IN,     ///< "<&" (suivi d'un numéro de descripteur ou de "-")
+    TOKEN_DUP_OUT,    ///< ">&" (suivi d'un numéro de descripteur, de "-" ou, sans numéro devant, d'un fichier comme "&>")
+    TOKEN_OUT_ALL,    ///< "&>" (sortie et erreur standard vers un fichier)
+    TOKEN_APPEND_ALL, ///< "&>>"
+    TOKEN_BANG,       ///< "!" isolé
+    TOKEN_WORD_EXPAND, ///< Mot contenant des paramètres ($NOM...), substitués au lancement de la commande (voir expand.h)
+    TOKEN_IO_NUMBER,  ///< Numéro du descripteur d'une redirection, collé à l'opérateur qui suit ("2" dans "2>f", "3" dans "3<&0")
+    TOKEN_HEREDOC,    ///< "<<" (suivi du délimiteur du document en ligne)
+    TOKEN_HEREDOC_STRIP, ///< "<<-" (tabulations en tête des lignes du document retirées)
+    TOKEN_HERESTRING  ///< "<<<" (suivi du mot envoyé sur l'entrée)
+} token_type_t;
+
 struct control_flow; // Déclaration anticipée pour l'utilisation dans processus_t
 struct command_line; // Déclaration anticipée pour l'utilisation dans control_flow_t
+struct builtin;      // Déclaration anticipée pour l'utilisation dans processus_t (voir builtins.h)
+
+/// Documents en ligne (*redirection_t::here*)
+#define HERE_NONE 0      ///< Redirection ordinaire
+#define HERE_DOC 1       ///< "<<FIN" : contenu lu sur les lignes suivantes, jusqu'à la ligne FIN
+#define HERE_DOC_STRIP 2 ///< "<<-FIN" : idem, tabulations en tête des lignes retirées
+#define HERE_STRING 3    ///< "<<<mot" : contenu formé du mot suivi de '\n'
+
+/**
+ * @brief Structure représentant une redirection d'un processus.
+ * @struct redirection_t
+ * @details Les redirections sont enregistrées par l'analyseur et appliquées dans l'ordre de la ligne au démarrage du processus
+ *    (voir *start_processus()*) : le fichier n'est ouvert que si la commande est effectivement lancée.
+ *    Trois formes : ouverture de *path* ("3>log"), duplication de *source* ("2>&1"), fermeture (*path* NULL et *source* -1, "2>&-").
+ *    Un document en ligne (*here*) est une ouverture dont *path* est le contenu lui-même : le descripteur est créé au démarrage,
+ *    sans fichier sur disque. Tant que son contenu n'a pas été lu (voir *read_heredocs()*), *path* est le délimiteur.
+ */
+typedef struct redirection
+{
+    int fd;                   ///< Descripteur redirigé (n'importe quel numéro : "3>log", "4<in")
+    int source;               ///< Descripteur dupliqué ("2>&1" : *fd* 2, *source* 1), -1 pour un fichier ou une fermeture
+    int flags;                ///< Drapeaux de *open()* (O_RDONLY, O_WRONLY | O_CREAT | O_TRUNC...)
+    uint8_t expand;           ///< *path* contient des paramètres à substituer (voir expand.h)
+    uint8_t here;             ///< Document en ligne (HERE_DOC, HERE_DOC_STRIP, HERE_STRING), HERE_NONE sinon
+    char *path;               ///< Chemin du fichier (mot de l'arène de la ligne) ou contenu d'un document en ligne, NULL pour une duplication
+    struct redirection *next; ///< Redirection suivante dans l'ordre de la ligne
+} redirection_t;
+
+/**
+ * @brief Descripteur d'un processus au-delà des IOs standards, résolu au démarrage ("3>log" : *fd* 3, *source* le fichier ouvert par le shell).
+ * @struct fd_mapping_t
+ */
+typedef struct
+{
+    int fd;     ///< Descripteur du processus (3 et plus)
+    int source; ///< Descripteur du shell copié sur *fd* dans le fils, -1 pour le fermer
+} fd_mapping_t;
 
 /**
  * @brief Structure représentant un processus.
@@ -47,24 +124,41 @@ struct command_line; // Déclaration anticipée pour l'utilisation dans control_
 typedef struct
 {
     pid_t pid;            ///< Process ID
-    char *argv[MAX_ARGS]; ///< Liste des arguments
-    char *envp[MAX_ENV];  ///< Variables d'environnement
+    char **argv;          ///< Liste des arguments (terminée par NULL) : *argv_inline*, ou tableau de l'arène de la ligne après *add_argument()*
+    char **envp;          ///< Variables d'environnement (terminée par NULL) : *vars_envp()* au démarrage d'une commande externe
     char *path;           ///< Chemin de l'exécutable
+    const struct builtin *builtin; ///< Commande intégrée résolue par *resolve_builtin()*, NULL si elle n'a pas été résolue ou si la commande est externe
 
-    int stdin_fd;               ///< Descripteur d'entrée standard
-    int stdout_fd;              ///< Descripteur de sortie standard
-    int stderr_fd;              ///< Descripteur d'erreur standard
+    int stdin_fd;               ///< Descripteur d'entrée standard (-1 : fermée par "<&-")
+    int stdout_fd;              ///< Descripteur de sortie standard (-1 : fermée par ">&-")
+    int stderr_fd;              ///< Descripteur d'erreur standard (-1 : fermée par "2>&-")
     int status;                 ///< Statut de sortie
+    int exec_errno;             ///< Valeur de errno en cas d'échec de l'exec, 0 sinon
+    int job_id;                 ///< Numéro du job du processus dans la table des jobs (voir jobs.h), 0 si aucun
     uint8_t is_background;      ///< Background flag
     uint8_t invert;             ///< Inversion du code de retour pour le contrôle de flux
-    struct timespec start_time; ///< Start time
-    struct timespec end_time;   ///< End time
+    uint8_t timed;              ///< Mesure des temps et des ressources demandée par le mot-clé "time" (porté par la première étape d'un pipeline)
+    uint8_t in_pipeline;        ///< Etape d'un pipeline de plusieurs commandes : une commande intégrée y est exécutée dans un fils
+    uint8_t expand;             ///< Des arguments contiennent des paramètres à substituer au démarrage (voir *expand_processus()*)
+    uint8_t tail_exec;          ///< Dernière commande du shell : une commande externe remplace le shell, sans fork (voir *launch_command_line()*)
+    redirection_t *redirections; ///< Redirections appliquées au démarrage, dans l'ordre de la ligne (liste de l'arène)
+    redirection_t *last_redirection; ///< Dernier élément de *redirections* (ajout en O(1))
+    fd_mapping_t *fd_mappings;  ///< Descripteurs au-delà de 2 installés dans le fils (tableau de l'arène, rempli au démarrage par les redirections)
+    unsigned int num_fd_mappings; ///< Nombre d'éléments de *fd_mappings*
+    struct timespec start_time; ///< Start time (CLOCK_MONOTONIC)
+    struct timespec end_time;   ///< End time (CLOCK_MONOTONIC)
+    struct rusage rusage;       ///< Ressources consommées par le fils (temps CPU, RSS max, défauts de page, commutations de contexte), nulles pour une commande intégrée
     struct control_flow *cf;    ///< Pointeur vers la structure de contrôle de flux associée
+    unsigned int argc;          ///< Nombre d'arguments ajoutés par *add_argument()*
+    unsigned int argv_capacity; ///< Nombre d'entrées de *argv* (NULL final compris)
+    char *argv_inline[PROCESSUS_INLINE_ARGS]; ///< Stockage initial de *argv* (pas d'allocation pour une commande courte)
 } processus_t;
 
 /** @brief Structure de contrôle de flux.
  * @struct control_flow_t
  * @details Cette structure permet de gérer le flux d'exécution des processus.
+ *    Les étapes d'un pipeline forment un groupe chaîné par *pipe_next* : le groupe est lancé d'un bloc et
+ *    ses successeurs (*unconditionnal_next*, *on_success_next*, *on_failure_next*) sont portés par sa dernière étape.
  */
 typedef struct control_flow
 {
@@ -72,6 +166,7 @@ typedef struct control_flow
     struct control_flow *unconditionnal_next; ///< Pointeur vers la prochaine structure de processus en cas d'exécution inconditionnelle
     struct control_flow *on_success_next;     ///< Pointeur vers la prochaine structure de processus en cas d'exécution réussie
     struct control_flow *on_failure_next;     ///< Pointeur vers la prochaine structure de processus en cas d'échec de l'exécution
+    struct control_flow *pipe_next;           ///< Pointeur vers l'étape suivante du pipeline (démarrée sans attendre la fin du processus courant)
     struct command_line *cmdl;                ///< Pointeur vers la structure de ligne de commande associée
 } control_flow_t;
 
@@ -80,17 +175,28 @@ typedef struct control_flow
  * @struct command_line_t
  * @details Cette structure contient la ligne de commande complète, un tableau de structures de processus, une structure de contrôle de flux, et un tableau des descripteurs de fichiers ouverts.
  * La structure permet à la fois d'allouer l'espace mémoire nécessaire pour les processus et de gérer le flux d'exécution entre eux.
+ * Les tableaux sont alloués dans l'arène de la ligne et doublés quand ils sont pleins : seule la taille de la mémoire limite la ligne
+ * (et, au lancement, ARG_MAX pour les arguments d'une commande externe). Le bloc initial suffit aux lignes courantes, qui ne font aucune allocation.
  * Le schéma suivant illustre la relation entre les structures:
  * \image html schema_struct.png
  */
 typedef struct command_line
 {
-    char command_line[MAX_CMD_LINE];          ///< Ligne de commande complète
-    char *tokens[MAX_CMD_LINE / 2 + 1];       ///< Tableau des tokens extraits de la ligne de commande
-    processus_t commands[MAX_CMDS];           ///< Tableau des structures de processus
-    control_flow_t flow[MAX_CMDS];            ///< Structure de contrôle de flux
-    unsigned int num_commands;                ///< Nombre de commandes
-    int opened_descriptors[MAX_CMDS * 3 + 1]; ///< Tableau des descripteurs de fichiers ouverts
+    char command_line[COMMAND_LINE_BLOCK_SIZE]; ///< Bloc initial de *arena* (mots, tokens, processus de la ligne de commande)
+    arena_t arena;                    ///< Arène de la ligne de commande (voir arena.h)
+    char **tokens;                    ///< Texte des tokens extraits de la ligne de commande (terminé par NULL)
+    uint8_t *token_types;             ///< Type de chaque token (token_type_t)
+    unsigned int num_tokens;          ///< Nombre de tokens
+    unsigned int tokens_capacity;     ///< Nombre d'entrées de *tokens* et *token_types*
+    processus_t *commands;            ///< Tableau des structures de processus
+    control_flow_t *flow;             ///< Structure de contrôle de flux (une entrée par processus)
+    unsigned int num_commands;        ///< Nombre de commandes
+    unsigned int commands_capacity;   ///< Nombre d'entrées de *commands* et *flow*
+    uint64_t *opened_descriptors;     ///< Ensemble des descripteurs ouverts par la ligne (bit *fd* % 64 du mot *fd* / 64)
+    unsigned int num_opened;          ///< Nombre de descripteurs ouverts
+    unsigned int opened_capacity;     ///< Nombre de mots de *opened_descriptors* (descripteurs 0 à 64 * capacité - 1)
+    unsigned int num_heredocs;        ///< Documents en ligne ("<<FIN") dont le contenu reste à lire sur les lignes suivantes (voir *read_heredocs()*)
+    uint8_t last_line;                ///< Dernière ligne d'un shell non interactif (script, -c) : renseigné par l'appelant après l'analyse
 } command_line_t;
 
 /**
@@ -99,31 +205,155 @@ typedef struct command_line
  * @return int 0 en cas de succès, -1 en cas d'erreur.
  * @details Cette fonction initialise les champs de la structure avec les valeurs suivantes:
  * - *pid*: 0
- * - *argv*: {NULL}
+ * - *argv*: *argv_inline*, {NULL}
  * - *envp*: {NULL}
  * - *path*: NULL
+ * - *builtin*: NULL
  * - *stdin_fd*: 0
  * - *stdout_fd*: 1
  * - *stderr_fd*: 2
  * - *status*: 0
+ * - *exec_errno*: 0
+ * - *job_id*: 0
  * - *is_background*: 0
  * - *invert*: 0
+ * - *timed*: 0
+ * - *in_pipeline*: 0
+ * - *tail_exec*: 0
  * - *start_time*: {0}
  * - *end_time*: {0}
+ * - *rusage*: {0}
  * - *cf*: NULL
+ * - *argc*: 0
+ * - *argv_capacity*: PROCESSUS_INLINE_ARGS
+ * - *redirections*, *fd_mappings*: NULL
  */
 int init_processus(processus_t *proc);
 
+/** @brief Fonction d'ajout d'un argument à un processus.
+ * @param cmdl Pointeur vers la structure de ligne de commande du processus (son arène reçoit *argv* quand *argv_inline* est plein).
+ * @param proc Pointeur vers le processus.
+ * @param arg Argument à ajouter (non copié).
+ * @return int 0 en cas de succès, -1 en cas d'erreur d'allocation.
+ * @details *argv* reste terminé par NULL ; sa capacité double à chaque agrandissement.
+ */
+int add_argument(command_line_t *cmdl, processus_t *proc, char *arg);
+
+/** @brief Fonction d'ajout d'une redirection à un processus.
+ * @param cmdl Pointeur vers la structure de ligne de commande du processus (son arène reçoit la redirection).
+ * @param proc Pointeur vers le processus.
+ * @param fd Descripteur redirigé (0, 1 ou 2).
+ * @param source Descripteur dupliqué sur *fd* ("n>&m"), -1 pour ouvrir *path*.
+ * @param path Fichier à ouvrir (non copié), NULL pour une duplication.
+ * @param flags Drapeaux de *open()*.
+ * @return redirection_t* Redirection ajoutée en fin de liste, NULL en cas d'erreur d'allocation.
+ * @details Rien n'est ouvert : le fichier est ouvert au démarrage du processus, après la substitution de son nom.
+ */
+redirection_t *add_redirection(command_line_t *cmdl, processus_t *proc, int fd, int source, char *path, int flags);
+
+/** @brief Fonction de sélection du mécanisme de création des processus.
+ * @param backend Mécanisme à utiliser (SPAWN_FORK, SPAWN_POSIX_SPAWN ou SPAWN_ZYGOTE).
+ * @return int 0 en cas de succès, -1 si *backend* est invalide ou si le zygote n'a pas pu être démarré.
+ * @details Le mécanisme par défaut est SPAWN_POSIX_SPAWN. Le choix s'applique à tous les lancements suivants.
+ *    Le zygote (voir zygote.h) est démarré à la sélection de SPAWN_ZYGOTE et arrêté quand un autre mécanisme est choisi.
+ */
+int set_spawn_backend(spawn_backend_t backend);
+
+/** @brief Fonction de récupération du mécanisme de création des processus courant.
+ * @return spawn_backend_t Mécanisme utilisé par *launch_processus()*.
+ */
+spawn_backend_t get_spawn_backend(void);
+
+/** @brief Fonction de conversion d'un nom de mécanisme ("fork", "posix_spawn", "zygote") en valeur spawn_backend_t.
+ * @param name Nom du mécanisme.
+ * @param backend Pointeur vers la valeur à remplir.
+ * @return int 0 en cas de succès, -1 si le nom est inconnu.
+ */
+int parse_spawn_backend(const char *name, spawn_backend_t *backend);
+
+/** @brief Fonction de récupération du code de retour de la dernière commande exécutée.
+ * @return int Code de retour (après inversion éventuelle par "!") de la dernière commande lancée par *launch_command_line()*.
+ */
+int get_last_status(void);
+
+/** @brief Fonction de récupération du PID de la dernière commande lancée en arrière-plan.
+ * @return pid_t PID du dernier processus lancé avec '&' (dernière étape pour un pipeline), 0 si aucun.
+ */
+pid_t get_last_background_pid(void);
+
+/** @brief Fonction de sélection du nombre maximal de jobs d'arrière-plan exécutés simultanément.
+ * @param n Nombre maximal de jobs (0 : illimité).
+ * @return int 0 en cas de succès, -1 si *n* est négatif.
+ * @details Quand la limite est atteinte, le lancement d'un nouveau job d'arrière-plan attend la fin de l'un des jobs en cours.
+ */
+int set_max_jobs(int n);
+
+/** @brief Fonction de récupération du nombre maximal de jobs d'arrière-plan exécutés simultanément.
+ * @return int Nombre maximal de jobs (0 : illimité). Par défaut, le nombre de processeurs en ligne.
+ */
+int get_max_jobs(void);
+
+/** @brief Fonction d'indication du mode du shell.
+ * @param on 1 si le shell lit ses commandes sur un terminal, 0 pour un script, "-c" ou une entrée redirigée.
+ * @details En mode non interactif, l'échec de "exec commande" termine le shell (POSIX).
+ */
+void set_interactive(int on);
+
+/** @brief Fonction de récupération du mode du shell.
+ * @return int 1 si le shell est interactif, 0 sinon.
+ */
+int is_interactive(void);
+
+/** @brief Fonction de remplacement du shell par un programme, sans fork.
+ * @param name Nom de la commande : cherché dans $PATH via le cache des chemins s'il ne contient pas de '/'
+ *    (résolu à nouveau si le chemin mémorisé n'existe plus).
+ * @param argv Arguments du programme.
+ * @param envp Environnement du programme.
+ * @return int Ne retourne qu'en cas d'échec : 127 si la commande est introuvable, 126 si elle n'est pas exécutable (errno renseigné).
+ * @details Les sorties tamponnées sont d'abord écrites, et le shell cesse d'être "subreaper" (mécanisme SPAWN_ZYGOTE) : les commandes
+ *    orphelines ne doivent pas être rattachées au programme qui le remplace. L'attribut est rétabli si l'exec échoue.
+ *    Utilisée par "exec commande" et pour la dernière commande d'un script ou de "-c" (voir *launch_command_line()*).
+ */
+int replace_shell(const char *name, char *const argv[], char *const envp[]);
+
+/** @brief Fonction de démarrage d'un processus sans attendre sa fin.
+ * @param proc Pointeur vers la structure de processus à démarrer.
+ * @return int 0 en cas de succès, un code d'erreur sinon.
+ * @details Une commande formée uniquement d'affectations "NOM=valeur" définit des variables du shell (voir vars.h), sans effet dans un pipeline.
+ *    Une commande dont tous les mots sont vides après substitution ("$VIDE > f") ne lance rien : ses redirections sont appliquées et
+ *    son statut vaut 0.
+ *    Une commande intégrée est exécutée immédiatement dans le shell et *status* est renseigné,
+ *    sauf dans un pipeline (*in_pipeline*) où elle est exécutée dans un fils, sans exec, comme dans un sous-shell.
+ *    Une commande externe est résolue via le cache des chemins (voir path_cache.h) puis créée via *posix_spawn()* ou *fork()* et *execve()*
+ *    (selon *get_spawn_backend()*), avec ses redirections (via *dup2()* ou les "file actions" de *posix_spawn*).
+ *    Son environnement (*envp*) est le tableau des variables exportées, *vars_envp()*, reconstruit seulement s'il a changé.
+ *    Si le chemin mémorisé n'existe plus (ENOENT), il est résolu à nouveau avant un second essai.
+ *    Un échec de l'exec est remonté au père (via le code de retour de *posix_spawn()* ou un tube CLOEXEC avec *fork()*) :
+ *    *exec_errno* est alors renseigné et *status* vaut 127 (commande introuvable) ou 126 (commande non exécutable).
+ *    Dans tous les cas, les descripteurs de redirection du processus sont fermés côté shell une fois le processus démarré.
+ *    Si *get_max_jobs()* jobs d'arrière-plan s'exécutent déjà, le démarrage d'un processus d'arrière-plan attend la fin de l'un d'eux.
+ *    Une commande externe marquée *tail_exec* remplace le shell par *execve()* : la fonction ne retourne pas.
+ */
+int start_processus(processus_t *proc);
+
+/** @brief Fonction d'attente de la fin d'un processus démarré par *start_processus()*.
+ * @param proc Pointeur vers la structure de processus à attendre.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @details La valeur de *status* est mise à jour avec le code de retour du fils (128 + numéro du signal s'il a été tué ou stoppé), *end_time* et *rusage* sont renseignés.
+ *    Le fils est récupéré par le gestionnaire de SIGCHLD de la table des jobs (voir jobs.h) : le shell attend via *sigsuspend()* que son état change.
+ *    Rien n'est fait pour une commande intégrée ou un exec échoué, déjà terminés au retour de *start_processus()*.
+ */
+int wait_processus(processus_t *proc);
+
 /** @brief Fonction de lancement d'un processus à partir d'une structure de processus.
  * @param proc Pointeur vers la structure de processus à lancer.
  * @return int 0 en cas de succès, un code d'erreur sinon.
- * @details Cette fonction utilise *fork()* et *execve()* pour lancer le processus décrit par la structure.
- *    Elle gère également les redirections des IOs standards (via *dup2()*).
+ * @details Cette fonction démarre le processus via *start_processus()* puis attend sa fin via *wait_processus()*.
  *    En cas de succès, le champ *pid* de la structure est mis à jour avec le PID du processus fils.
  *    Le flag *is_background* détermine si on attend la fin du processus ou non.
  *    La valeur de *status* est mise à jour à l'issue de l'exécution avec le code de retour du processus fils lorsque le flag *is_background* est désactivé.
  *    Les temps de démarrage et d'arrêt sont enregistrés dans *start_time* et *end_time* respectivement. *end_time* est mis à jour uniquement si *is_background* est désactivé.
- *    Les descripteurs de fichiers ouverts sont gérés dans *cf->cmdl->opened_descriptors* : le processus "fils" ferme tous les descripteurs listés dans ce tableau avant d'exécuter la commande.
+ *    Les descripteurs de fichiers ouverts sont gérés dans *cf->cmdl->opened_descriptors* : créés avec O_CLOEXEC, ils sont fermés par l'exec du processus "fils".
  */
 int launch_processus(processus_t *proc);
 
@@ -135,28 +365,33 @@ int launch_processus(processus_t *proc);
  * - *unconditionnal_next*: NULL
  * - *on_success_next*: NULL
  * - *on_failure_next*: NULL
+ * - *pipe_next*: NULL
  * - *cmdl*: NULL
  */
 int init_control_flow(control_flow_t *cf);
 
 /** @brief Fonction d'ajout d'un processus à la structure de contrôle de flux.
  * @param cmdl Pointeur vers la structure de ligne de commande dans laquelle le processus doit être ajouté.
- * @param mode Mode d'ajout (UNCONDITIONAL, ON_SUCCESS, ON_FAILURE).
- * @return processus_t* Pointeur vers le processus ajouté, ou NULL en cas d'erreur (tableau plein par exemple).
+ * @param mode Mode d'ajout (UNCONDITIONAL, ON_SUCCESS, ON_FAILURE, PIPELINE).
+ * @return processus_t* Pointeur vers le processus ajouté, ou NULL en cas d'erreur (allocation impossible).
  * @details Cette fonction ajoute le processus *proc* à la structure de contrôle de flux *cf* selon le mode spécifié:
  * Le dernier élément du tableau *commands* est retourné après avoir été initialisé dans le dernier élément du tableau *flow*.
  * Cette structure control_flow_t est mise à jour pour que le champ *proc* pointe vers le processus ajouté et la liste est mise à jour de la manière suivante :
  * - Si *mode* est UNCONDITIONAL, *proc* est ajouté à la liste des processus à exécuter inconditionnellement après le processus courant.
  * - Si *mode* est ON_SUCCESS, *proc* est ajouté à la liste des processus à exécuter uniquement si le processus courant s'est terminé avec succès (code de retour 0).
  * - Si *mode* est ON_FAILURE, *proc* est ajouté à la liste des processus à exécuter uniquement si le processus courant s'est terminé avec un échec (code de retour non nul).
+ * - Si *mode* est PIPELINE, *proc* est ajouté comme étape suivante du pipeline du processus courant.
+ *
+ * Quand *commands* est plein, sa capacité double : les processus et le contrôle de flux sont déplacés dans l'arène,
+ * les pointeurs vers les anciens tableaux (processus ou contrôle de flux déjà obtenus) ne sont alors plus valables.
  */
 processus_t *add_processus(command_line_t *cmdl, control_flow_mode_t mode);
 
 /** @brief Fonction de récupération du prochain processus à exécuter selon le contrôle de flux.
  * @param cmdl Pointeur vers la structure de ligne de commande.
- * @return processus_t* Pointeur vers le prochain processus à exécuter, ou NULL si le nombre maximum est atteint.
+ * @return processus_t* Pointeur vers le prochain processus à exécuter, ou NULL en cas d'erreur d'allocation.
  * @details Cette fonction retourne un pointeur vers la structure processus_t dans le tableau *commands* situé à l'indice *num_commands + 1*.
- *  Si le nombre maximum de commandes est atteint (MAX_CMDS), la fonction retourne NULL.
+ *  Le tableau est agrandi au besoin (voir *add_processus()*) : le pointeur retourné reste celui du prochain *add_processus()*.
  *  Cela permet notamment d'initialiser les descripteurs des IOs standards qui dépendent du processus en court de traitement (dans le cas des pipes par exemple).
  */
 processus_t *next_processus(command_line_t *cmdl);
@@ -164,39 +399,93 @@ processus_t *next_processus(command_line_t *cmdl);
 /** @brief Fonction d'ajout d'un descripteur de fichier à la structure de contrôle de flux.
  * @param cmdl Pointeur vers la structure de ligne de commande.
  * @param fd Descripteur de fichier à ajouter.
- * @return int 0 en cas de succès, -1 en cas d'erreur (tableau plein ou fd invalide).
- * @details Cette fonction ajoute le descripteur de fichier *fd* au tableau *opened_descriptors* de la structure *cf*.
- *    Si le tableau est plein ou si *fd* est invalide (négatif), la fonction retourne -1
+ * @return int 0 en cas de succès, -1 en cas d'erreur (allocation impossible ou fd invalide).
+ * @details Cette fonction ajoute le descripteur de fichier *fd* à l'ensemble *opened_descriptors* (un bit par descripteur, agrandi dans l'arène
+ *    si *fd* dépasse sa capacité) : l'ajout se fait en O(1), et ajouter un descripteur déjà présent ne change rien.
+ *    Le descripteur doit être créé avec O_CLOEXEC : il n'est alors transmis à aucune commande exécutée (seules ses copies 0, 1 et 2 le sont).
+ *    Si *fd* est invalide (négatif), la fonction retourne -1
  */
 int add_fd(command_line_t *cmdl, int fd);
 
 /** @brief Fonction de fermeture des descripteurs de fichiers listés dans la structure de contrôle de flux.
  * @param cmdl Pointeur vers la structure de ligne de commande.
  * @return int 0 en cas de succès, -1 en cas d'erreur.
- * @details Cette fonction ferme tous les descripteurs de fichiers listés dans le tableau *opened_descriptors* de la structure *cf*.
- *    Après fermeture, les entrées du tableau sont remises à -1.
+ * @details Cette fonction ferme tous les descripteurs de fichiers de l'ensemble *opened_descriptors* de la structure *cf*.
+ *    Après fermeture, l'ensemble est vidé (*num_opened* vaut 0).
  */
 int close_fds(command_line_t *cmdl);
 
+/** @brief Fonction de fermeture d'un descripteur listé dans la structure de ligne de commande.
+ * @param cmdl Pointeur vers la structure de ligne de commande.
+ * @param fd Descripteur à fermer et à retirer de *opened_descriptors*.
+ * @return int 0 si *fd* était listé (il est alors fermé), -1 sinon (rien n'est fermé).
+ * @details Un descripteur n'est ainsi jamais fermé deux fois, même si son numéro a été réutilisé entre-temps. Le retrait se fait en O(1).
+ */
+int remove_fd(command_line_t *cmdl, int fd);
+
+/** @brief Fonction de test de la présence d'un descripteur dans la structure de ligne de commande.
+ * @param cmdl Pointeur vers la structure de ligne de commande.
+ * @param fd Descripteur recherché.
+ * @return int 1 si *fd* est dans *opened_descriptors*, 0 sinon.
+ */
+int has_fd(const command_line_t *cmdl, int fd);
+
+/** @brief Fonction d'installation d'un descripteur dans le shell lui-même ("exec 3>>journal", "exec >sortie", "exec 3>&-").
+ * @param cmdl Ligne de commande en cours (un descripteur de la ligne qui porte le numéro *fd* est d'abord fermé), ou NULL.
+ * @param fd Descripteur du shell à remplacer.
+ * @param source Descripteur copié sur *fd*, -1 pour fermer *fd*.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (errno renseigné ; EBUSY si *fd* est un descripteur interne du shell).
+ * @details La copie, faite par *dup2()*, n'a pas O_CLOEXEC : elle est héritée par toutes les commandes lancées ensuite.
+ *    Les descripteurs au-delà de 2 ainsi installés sont suivis à part de *opened_descriptors* : *close_fds()* ne les ferme pas,
+ *    ils restent ouverts d'une ligne à l'autre jusqu'à "exec n>&-".
+ */
+int set_shell_fd(command_line_t *cmdl, int fd, int source);
+
+/** @brief Fonction de test d'un descripteur du shell utilisable par "n>&m".
+ * @param fd Descripteur testé.
+ * @return int 1 si *fd* est ouvert et appartient à l'utilisateur (installé par *set_shell_fd()* ou hérité sans O_CLOEXEC), 0 sinon.
+ * @details Les descripteurs internes du shell (script lu, zygote, descripteurs des lignes) ont O_CLOEXEC : ils ne sont pas visibles.
+ */
+int is_shell_fd(int fd);
+
+/** @brief Fonction de récupération du nombre de descripteurs au-delà de 2 installés par *set_shell_fd()*.
+ * @return unsigned int Nombre de descripteurs ouverts dans le shell par "exec n>...".
+ */
+unsigned int get_num_shell_fds(void);
+
 /** @brief Fonction d'initialisation d'une structure de ligne de commande.
- * @param cmdl Pointeur vers la structure de ligne de commande à initialiser.
+ * @param cmdl Pointeur vers la structure de ligne de commande à initialiser (contenu quelconque : aucun champ n'est lu).
  * @return int 0 en cas de succès, -1 en cas d'erreur.
- * @details Cette fonction initialise les champs de la structure avec les valeurs suivantes:
+ * @details A appeler une seule fois, avant la première ligne ; les lignes suivantes réutilisent la structure via *reset_command_line()*.
+ * Cette fonction initialise les champs de la structure avec les valeurs suivantes:
  * - *command_line*: "\0"
- * - *tokens*: {NULL}
- * - *commands*: tableau de processus initialisé via *init_processus()*
- * - *flow*: tableau de contrôle de flux initialisé via *init_control_flow()*
- * - *num_commands*: 0
- * - *opened_descriptors*: {-1}
+ * - *arena*: vide, de bloc initial *command_line* (voir *arena_init()*)
+ * - *tokens*, *token_types*, *commands*, *flow*, *opened_descriptors*: NULL (tableaux de l'arène, libérés avec elle)
+ * - *num_tokens*, *num_commands*, *num_opened*, *num_heredocs* et les capacités : 0
+ * - *last_line*: 0
+ *
+ * Les processus sont initialisés par *add_processus()*.
  */
 int init_command_line(command_line_t *cmdl);
 
+/** @brief Fonction de remise à zéro d'une structure de ligne de commande avant la ligne suivante.
+ * @param cmdl Pointeur vers la structure de ligne de commande, initialisée par *init_command_line()*.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @details Libère l'arène de la ligne précédente (O(1) si elle n'a pas débordé sur le tas, voir *arena_reset()*) et remet les champs
+ *    aux valeurs de *init_command_line()*. Le coût ne dépend donc pas de la taille de la ligne précédente.
+ */
+int reset_command_line(command_line_t *cmdl);
+
 /** @brief Fonction de lancement d'une ligne de commande.
  * @param cmdl Pointeur vers la structure de ligne de commande à lancer.
  * @return int 0 en cas de succès, un code d'erreur sinon.
  * @details Cette fonction lance les processus selon le flux défini dans la structure *cmdl*. Les lancements sont effectués via *launch_processus()* en
  *    respectant les conditions de contrôle de flux (inconditionnel, en cas de succès, en cas d'échec).
- *    Le tableau *opened_descriptors* est utilisé pour fermer les descripteurs ouverts au moment de l'initialisation des structures processus_t.
+ *    Les étapes d'un même pipeline sont toutes démarrées avant d'être attendues ensemble ; le statut du pipeline est celui de sa dernière étape.
+ *    Pour une commande ou un pipeline précédé du mot-clé "time", le temps écoulé et les ressources consommées sont affichés sur la sortie d'erreur.
+ *    L'ensemble *opened_descriptors* est utilisé pour fermer, à la fin de la ligne, les descripteurs ouverts au lancement de ses commandes.
+ *    Sur la dernière ligne du shell (*last_line*), une commande externe seule qui termine le flux, au premier plan, sans "time" ni "!",
+ *    alors qu'aucun job d'arrière-plan n'est actif, est exécutée à la place du shell (*tail_exec*) : son statut devient celui du shell.
  *    La fonction retourne 0 si tous les processus à lancer en fonction du contrôle de flux ont pu être lancés sans erreur.
  */
 int launch_command_line(command_line_t *cmdl);
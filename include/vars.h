@@ -0,0 +1,73 @@
+/**
+ * @file vars.h
+ * @brief Header file for the shell variable store
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions de la table des variables du shell, initialisée à partir de *environ* au premier accès.
+ *    Une variable est locale (visible par les substitutions $VAR du shell) ou exportée (transmise aussi aux commandes lancées).
+ *    Les commandes externes reçoivent le tableau *envp* de *vars_envp()*, reconstruit uniquement si les variables exportées
+ *    ont changé depuis le précédent appel (compteur de génération) : *environ* n'est plus ni lu ni modifié après l'initialisation.
+ */
+
+#ifndef VARS_H
+#define VARS_H
+
+#include <stddef.h>
+
+/** @brief Fonction de vérification d'un nom de variable ([A-Za-z_][A-Za-z0-9_]*).
+ * @param name Début du nom.
+ * @param len Longueur du nom.
+ * @return int 1 si le nom est valide, 0 sinon.
+ */
+int vars_valid_name(const char *name, size_t len);
+
+/** @brief Fonction de lecture d'une variable.
+ * @param name Nom de la variable.
+ * @return const char* Valeur de la variable (valable jusqu'à sa prochaine modification), NULL si elle n'est pas définie.
+ */
+const char *vars_get(const char *name);
+
+/** @brief Fonction de lecture d'une variable dont le nom n'est pas terminé par '\0'.
+ * @param name Début du nom (par exemple dans la ligne de commande, après '$').
+ * @param len Longueur du nom.
+ * @return const char* Valeur de la variable, NULL si elle n'est pas définie.
+ * @details Une recherche dans la table de hachage, sans copie du nom.
+ */
+const char *vars_getn(const char *name, size_t len);
+
+/** @brief Fonction de définition d'une variable.
+ * @param name Nom de la variable.
+ * @param value Valeur (copiée).
+ * @param exported 1 pour exporter la variable, 0 pour conserver son état (une nouvelle variable est locale).
+ * @return int 0 en cas de succès, -1 en cas d'erreur (nom invalide, allocation impossible).
+ * @details Modifier PATH vide le cache des chemins de commandes (voir path_cache.h).
+ */
+int vars_set(const char *name, const char *value, int exported);
+
+/** @brief Fonction d'export d'une variable déjà définie ("export NOM").
+ * @param name Nom de la variable.
+ * @return int 0 en cas de succès, -1 si la variable n'est pas définie.
+ */
+int vars_export(const char *name);
+
+/** @brief Fonction de suppression d'une variable.
+ * @param name Nom de la variable.
+ * @return int 0 en cas de succès (variable supprimée ou inexistante), -1 si le nom est invalide.
+ * @details Supprimer PATH vide le cache des chemins de commandes.
+ */
+int vars_unset(const char *name);
+
+/** @brief Fonction de récupération de l'environnement des commandes lancées.
+ * @return char** Tableau contigu "NOM=valeur" des variables exportées, terminé par NULL.
+ * @details Le tableau n'est reconstruit que si une variable exportée a changé depuis l'appel précédent ; il reste valable jusqu'au prochain appel.
+ *    En cas d'erreur d'allocation, *environ* est retourné.
+ */
+char **vars_envp(void);
+
+/** @brief Fonction d'accès au compteur de génération des variables exportées.
+ * @return unsigned long Valeur incrémentée à chaque modification d'une variable exportée.
+ */
+unsigned long vars_generation(void);
+
+#endif // VARS_H
@@ -0,0 +1,53 @@
+/**
+ * @file zygote.h
+ * @brief Header file for the zygote launcher
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions du "zygote" : un processus auxiliaire, créé tôt et donc léger, qui garde en réserve des fils déjà créés.
+ *    Pour lancer une commande, le shell envoie au zygote (socket Unix SOCK_SEQPACKET) le chemin, argv, l'environnement, le répertoire courant
+ *    et les descripteurs des IOs standards (SCM_RIGHTS). Le zygote transmet la requête à un fils en réserve, qui exécute immédiatement la commande :
+ *    la création du processus n'est plus sur le chemin critique du lancement.
+ *    Les commandes lancées ainsi sont des fils du zygote : il les récupère et transmet leur statut et leurs ressources au shell,
+ *    qu'il réveille avec SIGCHLD (voir *jobs_set_reaper()* et *jobs_record()*).
+ */
+
+#ifndef ZYGOTE_H
+#define ZYGOTE_H
+
+#include <sys/types.h>
+
+/// Nombre de fils gardés en réserve par le zygote
+#define ZYGOTE_POOL_SIZE 4
+/// Taille maximale d'une requête (chemin, argv, environnement et répertoire courant)
+#define ZYGOTE_MAX_REQUEST (128 * 1024)
+
+/** @brief Fonction de démarrage du zygote.
+ * @param pool_size Nombre de fils gardés en réserve (au moins 1).
+ * @return int 0 en cas de succès (ou si le zygote est déjà démarré), -1 en cas d'erreur.
+ */
+int zygote_start(int pool_size);
+
+/** @brief Fonction d'arrêt du zygote.
+ * @details Les fils en réserve sont terminés ; les commandes en cours continuent de s'exécuter.
+ */
+void zygote_stop(void);
+
+/** @brief Fonction de vérification du fonctionnement du zygote.
+ * @return int 1 si le zygote est démarré, 0 sinon.
+ */
+int zygote_running(void);
+
+/** @brief Fonction de lancement d'une commande par le zygote.
+ * @param path Chemin de l'exécutable.
+ * @param argv Arguments (terminés par NULL).
+ * @param envp Environnement de la commande (terminé par NULL, voir *vars_envp()*).
+ * @param fds Descripteurs à installer en entrée, sortie et erreur standard du processus.
+ * @param exec_errno Renseigné avec errno si l'exec a échoué, 0 sinon.
+ * @return pid_t PID du processus, 0 si l'exec a échoué, -1 si le zygote n'a pas pu traiter la requête (le zygote est alors arrêté).
+ * @details Doit être appelée SIGCHLD bloqué (voir *jobs_block()*), comme toute création de processus enregistré dans la table des jobs.
+ *    Le répertoire courant transmis est celui du shell.
+ */
+pid_t zygote_spawn(const char *path, char *const argv[], char *const envp[], const int fds[3], int *exec_errno);
+
+#endif // ZYGOTE_H
@@ -0,0 +1,137 @@
+/** @file arena.c
+ * @brief Implementation of the bump allocator of command lines
+ * @author Sofiane FETTAH
+ * @author Matthieu COMME
+ * @date 2025-26
+ * @details Implémentation de l'arène d'allocation d'une ligne de commande.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "arena.h"
+
+/** @brief Bloc alloué sur le tas quand le bloc initial est plein.
+ * @struct arena_chunk
+ */
+struct arena_chunk
+{
+    struct arena_chunk *next; ///< Bloc précédent
+    size_t size;              ///< Taille de *data*
+    char data[];              ///< Octets alloués
+};
+
+static size_t heap_allocations = 0; ///< Nombre de blocs alloués sur le tas
+
+/** @brief Fonction d'initialisation d'une arène.
+ * @param a Arène à initialiser.
+ * @param base Bloc initial (utilisé en premier, jamais libéré par l'arène).
+ * @param size Taille du bloc initial.
+ */
+void arena_init(arena_t *a, char *base, size_t size)
+{
+    a->base = base;
+    a->base_size = size;
+    a->ptr = base;
+    a->end = base + size;
+    a->chunks = NULL;
+}
+
+/** @brief Fonction de libération de toutes les allocations d'une arène.
+ * @param a Arène initialisée.
+ * @details O(1) quand seul le bloc initial a servi ; sinon les blocs alloués sur le tas sont libérés.
+ *    A appeler aussi avant de libérer le propriétaire de l'arène.
+ */
+void arena_reset(arena_t *a)
+{
+    while (a->chunks)
+    {
+        struct arena_chunk *next = a->chunks->next;
+        free(a->chunks);
+        a->chunks = next;
+    }
+    a->ptr = a->base;
+    a->end = a->base + a->base_size;
+}
+
+/** @brief Fonction de réservation de place après l'objet en cours de construction.
+ * @param a Arène.
+ * @param object Début de l'objet en cours de construction (il se termine en *a->ptr*), ou pointeur sur NULL s'il n'y en a pas.
+ * @param more Nombre d'octets à rendre disponibles après *a->ptr*.
+ * @return int 0 en cas de succès, -1 en cas d'erreur d'allocation.
+ * @details Si le bloc courant est trop petit, l'objet en cours est recopié au début d'un nouveau bloc et *object* est mis à jour.
+ *    L'appelant écrit ensuite directement en *a->ptr*, qu'il avance.
+ */
+int arena_extend(arena_t *a, char **object, size_t more)
+{
+    if ((size_t)(a->end - a->ptr) >= more)
+        return 0;
+
+    size_t used = (object && *object) ? (size_t)(a->ptr - *object) : 0;
+    // taille doublée à chaque nouveau bloc : peu d'allocations même pour une très longue substitution
+    size_t size = a->chunks ? 2 * a->chunks->size : 2 * a->base_size;
+    if (size < used + more)
+        size = used + more;
+    struct arena_chunk *chunk = malloc(sizeof *chunk + size);
+    if (!chunk)
+        return -1;
+    heap_allocations++;
+    chunk->size = size;
+    chunk->next = a->chunks;
+    a->chunks = chunk;
+
+    if (used > 0)
+    {
+        memcpy(chunk->data, *object, used);
+        *object = chunk->data;
+    }
+    a->ptr = chunk->data + used;
+    a->end = chunk->data + size;
+    return 0;
+}
+
+/** @brief Fonction d'allocation dans une arène.
+ * @param a Arène.
+ * @param size Taille demandée.
+ * @return void* Zone alignée pour un pointeur, NULL en cas d'erreur d'allocation.
+ */
+void *arena_alloc(arena_t *a, size_t size)
+{
+    size_t pad = (sizeof(void *) - (uintptr_t)a->ptr % sizeof(void *)) % sizeof(void *);
+    if ((size_t)(a->end - a->ptr) < pad + size)
+    {
+        // les blocs du tas commencent alignés
+        if (arena_extend(a, NULL, size) != 0)
+            return NULL;
+        pad = 0;
+    }
+    void *p = a->ptr + pad;
+    a->ptr += pad + size;
+    return p;
+}
+
+/** @brief Fonction de copie d'une chaîne dans une arène.
+ * @param a Arène.
+ * @param s Début de la chaîne.
+ * @param len Longueur de la chaîne (un '\0' est ajouté).
+ * @return char* Copie, NULL en cas d'erreur d'allocation.
+ */
+char *arena_strndup(arena_t *a, const char *s, size_t len)
+{
+    if (arena_extend(a, NULL, len + 1) != 0)
+        return NULL;
+    char *copy = a->ptr;
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    a->ptr += len + 1;
+    return copy;
+}
+
+/** @brief Fonction d'accès au nombre de blocs alloués sur le tas par toutes les arènes depuis le démarrage.
+ * @return size_t Nombre d'appels à *malloc()* effectués par les arènes.
+ */
+size_t arena_heap_allocations(void)
+{
+    return heap_allocations;
+}
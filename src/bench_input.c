@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include "../include/input.h"
+#include "../include/parser.h"
+#include "../include/processus.h"
+
+// make bench_input
+// ./bench_input [nombre de lignes]
+//
+// Mesure le débit (lignes par seconde) de lecture d'un gros script généré :
+// lecture seule (fgets d'origine, lecteur par blocs, lecteur mmap), lecture + analyse,
+// puis exécution complète par ./minishell (commandes intégrées uniquement, sans création de processus).
+
+static double now_s()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void report(const char *name, long lines, double elapsed)
+{
+    printf("%-40s %10.0f lignes/s  (%.3f s)\n", name, lines / elapsed, elapsed);
+}
+
+// Boucle de lecture de l'ancien main() : fgets dans un tampon de 4 Ko et trois strlen par ligne
+static long read_fgets(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char buf[4096];
+    long n = 0;
+    while (fgets(buf, sizeof buf, f))
+    {
+        if (strlen(buf) > 0 && buf[strlen(buf) - 1] == '\n')
+            buf[strlen(buf) - 1] = '\0';
+        n++;
+    }
+    fclose(f);
+    return n;
+}
+
+static long read_input(input_t *in)
+{
+    const char *line;
+    long n = 0;
+    while (input_next_line(in, &line) >= 0)
+        n++;
+    return n;
+}
+
+// Lecteur par blocs : le script est transmis par un tube
+static long read_pipe(const char *path)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+        exit(1);
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        close(fds[0]);
+        dup2(fds[1], STDOUT_FILENO);
+        execlp("cat", "cat", path, (char *)NULL);
+        _exit(127);
+    }
+    close(fds[1]);
+    input_t in;
+    input_open_fd(&in, fds[0]);
+    long n = read_input(&in);
+    input_close(&in);
+    close(fds[0]);
+    waitpid(pid, NULL, 0);
+    return n;
+}
+
+static long read_parse(const char *path)
+{
+    static command_line_t cmdl;
+    input_t in;
+    input_open_file(&in, path);
+    const char *line;
+    ssize_t len;
+    long n = 0;
+    init_command_line(&cmdl);
+    while ((len = input_next_line(&in, &line)) >= 0)
+    {
+        reset_command_line(&cmdl);
+        if (parse_command_line_n(&cmdl, line, len) != 0)
+            exit(1);
+        n++;
+    }
+    input_close(&in);
+    return n;
+}
+
+static double run_minishell(const char *path, int use_stdin)
+{
+    double start = now_s();
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        if (use_stdin)
+        {
+            int fd = open(path, O_RDONLY);
+            dup2(fd, STDIN_FILENO);
+            execl("./minishell", "minishell", (char *)NULL);
+        }
+        else
+            execl("./minishell", "minishell", path, (char *)NULL);
+        _exit(127);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        fprintf(stderr, "Erreur: ./minishell a échoué\n");
+        exit(1);
+    }
+    return now_s() - start;
+}
+
+int main(int argc, char *argv[])
+{
+    long lines = (argc > 1) ? atol(argv[1]) : 200000;
+
+    char path[] = "/tmp/bench_inputXXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+        return 1;
+    FILE *f = fdopen(fd, "w");
+    for (long i = 0; i < lines; i++)
+    {
+        if (i % 2 == 0)
+            fprintf(f, "cd .\n");
+        else
+            fprintf(f, "export BENCH_INPUT=valeur_%ld\n", i);
+    }
+    fclose(f);
+
+    printf("Script de %ld lignes\n", lines);
+
+    double t = now_s();
+    long n = read_fgets(path);
+    report("lecture fgets (ancien main)", n, now_s() - t);
+
+    t = now_s();
+    n = read_pipe(path);
+    report("lecture par blocs (tube)", n, now_s() - t);
+
+    input_t in;
+    t = now_s();
+    input_open_file(&in, path);
+    n = read_input(&in);
+    input_close(&in);
+    report("lecture mmap (fichier)", n, now_s() - t);
+
+    t = now_s();
+    n = read_parse(path);
+    report("lecture mmap + analyse", n, now_s() - t);
+
+    if (access("./minishell", X_OK) == 0)
+    {
+        report("./minishell script", lines, run_minishell(path, 0));
+        report("./minishell < script", lines, run_minishell(path, 1));
+    }
+
+    unlink(path);
+    return 0;
+}
@@ -0,0 +1,421 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include "../include/parser.h"
+#include "../include/processus.h"
+#include "../include/vars.h"
+
+// make bench_parser
+// ./bench_parser [nombre de lignes]
+//
+// Mesure le débit d'analyse (lignes par seconde) : découpage par l'ancienne chaîne de passes
+// (trim, clean, separate_s, substenv puis strcut), par l'analyseur lexical en un seul parcours,
+// puis analyse complète (parse_command_line_n) avec construction des processus.
+// Les lignes n'ouvrent ni fichier ni tube, et leurs opérateurs sont entourés d'espaces (seule forme comprise par l'ancienne chaîne).
+
+static const char *lines[] = {
+    "ls -l -a /tmp",
+    "   echo    \"bonjour   le monde\"  ;   echo $HOME ; pwd   ",
+    "export BENCH_PARSER=valeur && echo ${BENCH_PARSER} || echo 'échec : $BENCH_PARSER'",
+    "printf \"%s=%d\\n\" cle 1 autre 2 ; cd .. ; cd - ; true && false",
+    "time sleep 0 ; ! test -e /inexistant && echo absent ; echo \\$HOME fin",
+    "git commit -m \"message avec des mots\" --author 'Nom Prénom <nom@example.org>' --quiet",
+};
+#define NLINES (sizeof lines / sizeof lines[0])
+
+static double now_s()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void report(const char *name, long n, double elapsed)
+{
+    printf("%-56s %10.0f lignes/s  (%.3f s)\n", name, n / elapsed, elapsed);
+}
+
+/// Taille de l'ancien tampon de ligne (MAX_CMD_LINE)
+#define LEGACY_LINE 4096
+
+// Ancienne chaîne de passes, retirée de parser.c au profit de lex_command_line() : référence de la mesure
+
+// Suppression des espaces au début et à la fin de la ligne
+static int trim(char *str)
+{
+    if (!str) return -1;
+
+    // skip début (espaces, tabs, CR, LF)
+    char *start = str;
+    while (*start == ' ' || *start == '\t' || *start == '\r' || *start == '\n')
+        ++start;
+
+    if (start != str)
+        memmove(str, start, strlen(start) + 1);
+
+    // si chaîne vide après trim début
+    size_t len = strlen(str);
+    if (len == 0) return 0;
+
+    // trim fin (espaces, tabs, CR, LF)
+    char *end = str + len - 1;
+    while (end >= str && (*end == ' ' || *end == '\t' || *end == '\r' || *end == '\n')) {
+        *end = '\0';
+        --end;
+    }
+    return 0;
+}
+
+// Réduction des suites d'espaces hors guillemets à un seul espace
+static int clean(char *str)
+{
+    if (!str) return -1;
+    
+    char *r = str;  // lecture
+    char *w = str;  // écriture
+    int in_space = 0;
+    int in_quotes = 0;
+    char quote_char = 0;
+    
+    while (*r) {
+        // Gestion des guillemets
+        if ((*r == '"' || *r == '\'') && (r == str || *(r-1) != '\\')) {
+            if (!in_quotes) {
+                in_quotes = 1;
+                quote_char = *r;
+            } else if (*r == quote_char) {
+                in_quotes = 0;
+                quote_char = 0;
+            }
+            *w++ = *r++;
+            in_space = 0;
+            continue;
+        }
+        
+        // à l'intérieur, on copie tout
+        if (in_quotes) {
+            *w++ = *r++;
+            continue;
+        }
+        
+        // à l'extérieur, on clean
+        if (*r == ' ' || *r == '\t') {
+            if (!in_space) {
+                *w++ = ' ';
+                in_space = 1;
+            }
+            r++;
+        } else {
+            *w++ = *r++;
+            in_space = 0;
+        }
+    }
+    
+    *w = '\0';
+    return 0;
+}
+
+// Ajout d'un espace avant et après chaque caractère de *s* (opérateurs)
+static int separate_s(char *str, char *s, size_t max)
+{
+    if (str == NULL || s == NULL)
+        return -1;
+
+    int len = strlen(str);
+    int nb_s = 0;
+
+    // compte le nombre de separate à effectuer
+    for (int i = 0; i < len; i++)
+    {
+        if (strchr(s, str[i]) != NULL)
+            nb_s++;
+    }
+
+    if (nb_s == 0) // rien à faire
+        return 0;
+
+    size_t new_len = len + (nb_s * 2);
+
+    if (new_len + 1 > max) // dépassement de la taille maximale
+        return -1;
+
+    // remplissage de droite à gauche
+    int read_i = len - 1;
+    int write_i = new_len - 1;
+
+    str[new_len] = '\0';
+
+    while (read_i >= 0)
+    {
+        char current_char = str[read_i];
+
+        // si le char courant est un séparateur
+        if (strchr(s, current_char) != NULL)
+        {
+            str[write_i--] = ' ';
+            str[write_i--] = current_char;
+            str[write_i--] = ' ';
+        }
+        else
+            str[write_i--] = current_char;
+
+        read_i--;
+    }
+    return 0;
+}
+
+// Découpage en mots sur *sep*, avec retrait des guillemets et des '\' ; tokens terminé par NULL, au plus *max* cases
+static int strcut(char* str, char sep, char** tokens, size_t max) {
+    if (!str || !tokens || max == 0) return -1;
+
+    size_t n = 0;
+    char* p = str;
+
+    // Découpe "in-place" : chaque token pointe dans la chaîne d'origine.
+    // Bug rencontré : on terminait un token en écrivant '\0' sur le séparateur (espace/tab/\n)
+    // sans avancer le pointeur de lecture. Résultat : la chaîne semblait finie après le 1er token
+    // (ex: seule la commande "printf" était lue, et ses arguments disparaissaient).
+
+    while (*p) {
+        // Sauter les séparateurs (soit le caractère sep, soit les espaces)
+        while (*p == sep) p++;
+        if (!*p) break;
+
+        if (n >= max - 1) {
+            fprintf(stderr, "Erreur: trop de tokens (max=%zu)\n", max);
+            tokens[n] = NULL;  // Assurer la terminaison NULL même en erreur
+            return -1;
+        }
+
+        char* out = p;
+        tokens[n] = out;
+        n++;
+
+        int in_quotes = 0;
+        char quote_char = 0;
+
+        while (*p) {
+            if (!in_quotes && *p == sep) break;
+
+            if (*p == '\\' && p[1] != '\0' && quote_char != '\'') {
+                // Hors quotes: le backslash échappe toujours le caractère suivant.
+                if (!in_quotes) {
+                    p++;
+                    *out++ = *p++;
+                    continue;
+                }
+
+                // Dans doubles quotes: échappement seulement pour $ ` " \\ et newline.
+                if (quote_char == '"') {
+                    char next = p[1];
+                    if (next == '$' || next == '`' || next == '"' || next == '\\' || next == '\n') {
+                        p++;
+                        *out++ = *p++;
+                        continue;
+                    }
+                }
+            }
+
+            if (*p == '"' || *p == '\'') {
+                if (!in_quotes) {
+                    in_quotes = 1;
+                    quote_char = *p++;
+                    continue;
+                } else if (*p == quote_char) {
+                    in_quotes = 0;
+                    quote_char = 0;
+                    p++;
+                    continue;
+                }
+            }
+
+            *out++ = *p++;
+        }
+
+        if (in_quotes) {
+            fprintf(stderr, "Erreur: guillemet '%c' non fermé\n", quote_char);
+            return -1;
+        }
+
+        char stopped = *p;
+        *out = '\0';
+        if (stopped != '\0') {
+            p++;
+        }
+        while (*p == sep) p++;
+    }
+
+    tokens[n] = NULL;
+    return (int)n;
+}
+
+// Ancienne substitution des variables ($NOM, ${NOM}) : copie dans un tampon alloué à chaque appel, nom recopié, valeur lue par getenv()
+static int substenv(char *str, size_t max)
+{
+    if (str == NULL || max == 0)
+        return -1;
+
+    char *res = (char *)malloc(max);
+    if (res == NULL)
+        return -1;
+
+    unsigned int r = 0; // index de lecture dans str
+    unsigned int w = 0; // index d'écriture dans res
+    while (str[r] != '\0')
+    {
+        if (str[r] != '$')
+        {
+            if (w + 1 >= max)
+            {
+                free(res);
+                return -1;
+            }
+            res[w++] = str[r++];
+            continue;
+        }
+
+        int var_start = r + 1;
+        int var_end = var_start;
+        int is_bracket = 0;
+        if (str[var_start] == '{')
+        {
+            is_bracket = 1;
+            var_end = ++var_start;
+            while (str[var_end] != '\0' && str[var_end] != '}')
+                var_end++;
+            if (str[var_end] != '}') // "${" non fermé : '$' littéral
+            {
+                if (w + 1 >= max)
+                {
+                    free(res);
+                    return -1;
+                }
+                res[w++] = str[r++];
+                continue;
+            }
+        }
+        else
+        {
+            while (isalnum((unsigned char)str[var_end]) || str[var_end] == '_')
+                var_end++;
+        }
+
+        int var_len = var_end - var_start;
+        if (var_len == 0) // '$' suivi d'un caractère non valide
+        {
+            if (w + 1 >= max)
+            {
+                free(res);
+                return -1;
+            }
+            res[w++] = str[r++];
+            if (is_bracket && str[var_end] == '}')
+                r = var_end + 1;
+            continue;
+        }
+
+        char var_name[256];
+        memcpy(var_name, str + var_start, var_len);
+        var_name[var_len] = '\0';
+        char *env_val = getenv(var_name);
+        if (env_val != NULL)
+        {
+            int val_len = strlen(env_val);
+            if (w + val_len >= max)
+            {
+                free(res);
+                return -1;
+            }
+            strcpy(res + w, env_val);
+            w += val_len;
+        }
+        r = is_bracket ? var_end + 1 : var_end;
+    }
+
+    res[w] = '\0';
+    strcpy(str, res);
+    free(res);
+    return 0;
+}
+
+// Découpage de l'ancien parse_command_line_n : copie puis cinq parcours de la ligne
+static long legacy_tokens(long n, const size_t *lens)
+{
+    static char line[LEGACY_LINE];
+    static char *words[LEGACY_LINE / 2 + 1];
+    long tokens = 0;
+    for (long i = 0; i < n; i++)
+    {
+        size_t k = i % NLINES;
+        memcpy(line, lines[k], lens[k]);
+        line[lens[k]] = '\0';
+        if (trim(line) != 0 || clean(line) != 0 ||
+            separate_s(line, ";", LEGACY_LINE) != 0 || substenv(line, LEGACY_LINE) != 0)
+            exit(1);
+        int t = strcut(line, ' ', words, LEGACY_LINE / 2 + 1);
+        if (t < 0)
+            exit(1);
+        tokens += t;
+    }
+    return tokens;
+}
+
+static long lexer_tokens(command_line_t *cmdl, long n, const size_t *lens)
+{
+    long tokens = 0;
+    for (long i = 0; i < n; i++)
+    {
+        size_t k = i % NLINES;
+        reset_command_line(cmdl);
+        int t = lex_command_line(cmdl, lines[k], lens[k]);
+        if (t < 0)
+            exit(1);
+        tokens += t;
+    }
+    return tokens;
+}
+
+// Analyse complète, comme la boucle de main() (les chaînes sont dans l'arène de la ligne)
+static void full_parse(command_line_t *cmdl, long n, const size_t *lens)
+{
+    for (long i = 0; i < n; i++)
+    {
+        size_t k = i % NLINES;
+        reset_command_line(cmdl);
+        if (parse_command_line_n(cmdl, lines[k], lens[k]) != 0)
+            exit(1);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    long n = (argc > 1) ? atol(argv[1]) : 1000000;
+    static command_line_t cmdl;
+    init_command_line(&cmdl);
+    vars_set("BENCH_PARSER", "valeur", 1);
+
+    size_t lens[NLINES], bytes = 0;
+    for (size_t k = 0; k < NLINES; k++)
+    {
+        lens[k] = strlen(lines[k]);
+        bytes += lens[k];
+    }
+    printf("%ld lignes (%zu lignes différentes, %.0f octets en moyenne)\n", n, NLINES, (double)bytes / NLINES);
+
+    double t = now_s();
+    long tokens = legacy_tokens(n, lens);
+    report("découpage : trim, clean, separate_s, substenv, strcut", n, now_s() - t);
+    printf("%-56s %10ld\n", "  tokens", tokens);
+
+    t = now_s();
+    tokens = lexer_tokens(&cmdl, n, lens);
+    report("découpage : lex_command_line (un parcours)", n, now_s() - t);
+    printf("%-56s %10ld\n", "  tokens", tokens);
+
+    t = now_s();
+    full_parse(&cmdl, n, lens);
+    report("analyse complète : parse_command_line_n", n, now_s() - t);
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../include/processus.h"
+
+// make bench_spawn
+// ./bench_spawn [taille du tas en Mo] [nombre de lancements]
+//
+// Compare le coût de launch_processus() avec fork(), posix_spawn() et le zygote
+// lorsque le shell possède un gros tas (les tables de pages sont copiées par fork()).
+// Le zygote est démarré avant l'allocation du tas, comme au démarrage du shell : ses fils en réserve restent légers.
+// Affiche la moyenne et la latence de queue (p50, p99, p99.9) de chaque lancement.
+
+static double now_us()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const double *sorted, int n, double p)
+{
+    int i = (int)(p / 100.0 * n);
+    return sorted[i < n ? i : n - 1];
+}
+
+static void bench(const char *name, spawn_backend_t backend, int iterations, double *samples)
+{
+    processus_t proc;
+    if (set_spawn_backend(backend) != 0)
+    {
+        fprintf(stderr, "Erreur: mécanisme %s indisponible\n", name);
+        exit(1);
+    }
+
+    double total = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        init_processus(&proc);
+        proc.argv[0] = "true";
+        proc.argv[1] = NULL;
+        double start = now_us();
+        if (launch_processus(&proc) != 0 || proc.status != 0)
+        {
+            fprintf(stderr, "Erreur: lancement de 'true' échoué\n");
+            exit(1);
+        }
+        samples[i] = now_us() - start;
+        total += samples[i];
+    }
+    qsort(samples, iterations, sizeof(double), compare_double);
+    printf("%-12s: moyenne %8.1f us   p50 %8.1f us   p99 %8.1f us   p99.9 %8.1f us\n", name, total / iterations,
+           percentile(samples, iterations, 50), percentile(samples, iterations, 99), percentile(samples, iterations, 99.9));
+}
+
+int main(int argc, char *argv[])
+{
+    size_t heap_mb = argc > 1 ? strtoul(argv[1], NULL, 10) : 512;
+    int iterations = argc > 2 ? atoi(argv[2]) : 500;
+
+    // zygote démarré avant que le tas ne grossisse
+    if (set_spawn_backend(SPAWN_ZYGOTE) != 0)
+    {
+        fprintf(stderr, "Erreur: démarrage du zygote impossible\n");
+        return 1;
+    }
+
+    // Tas "réel" : les pages sont touchées pour être effectivement mappées
+    char *heap = malloc(heap_mb << 20);
+    double *samples = malloc(iterations * sizeof(double));
+    if (!heap || !samples)
+    {
+        perror("malloc");
+        return 1;
+    }
+    memset(heap, 1, heap_mb << 20);
+
+    printf("Tas: %zu Mo, %d lancements de 'true'\n", heap_mb, iterations);
+    // le zygote est mesuré en premier : choisir un autre mécanisme l'arrête
+    bench("zygote", SPAWN_ZYGOTE, iterations, samples);
+    bench("fork", SPAWN_FORK, iterations, samples);
+    bench("posix_spawn", SPAWN_POSIX_SPAWN, iterations, samples);
+
+    set_spawn_backend(SPAWN_POSIX_SPAWN);
+    free(samples);
+    free(heap);
+    return 0;
+}
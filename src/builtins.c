@@ -10,46 +10,128 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <unistd.h>
+#include <signal.h>
+#include <ctype.h>
+#include <errno.h>
+#include <strings.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/stat.h>
 
 #include "builtins.h"
 #include "processus.h"
+#include "path_cache.h"
+#include "jobs.h"
+#include "output.h"
+#include "vars.h"
+
+/** @brief Table des commandes intégrées, indexée par *builtin_slot()*.
+ * @details Les cases sont calculées hors ligne avec *builtin_slot()* ; *test_builtins* vérifie que chaque commande est dans sa case.
+ *    Ajouter une commande : calculer sa case, et si elle est déjà prise, choisir de nouveaux coefficients pour *builtin_slot()*.
+ */
+static const builtin_t builtins[BUILTIN_TABLE_SIZE] = {
+    [1] = {"exec", builtin_exec},
+    [2] = {"jobs", builtin_jobs},
+    [4] = {"type", builtin_type},
+    [9] = {"exit", builtin_exit},
+    [10] = {"set", builtin_set},
+    [11] = {"export", builtin_export},
+    [12] = {"test", builtin_test},
+    [13] = {"echo", builtin_echo},
+    [14] = {"printf", builtin_printf},
+    [15] = {"pwd", builtin_pwd},
+    [16] = {"hash", builtin_hash},
+    [18] = {"unset", builtin_unset},
+    [19] = {"kill", builtin_kill},
+    [20] = {"[", builtin_test},
+    [21] = {"cd", builtin_cd},
+    [24] = {"bg", builtin_bg},
+    [28] = {"fg", builtin_fg},
+    [31] = {"wait", builtin_wait},
+};
+
+/** @brief Fonction de hachage des noms de commandes intégrées.
+ * @param name Nom de la commande.
+ * @param len Longueur du nom (au moins 1).
+ * @return unsigned Case de la table (entre 0 et BUILTIN_TABLE_SIZE - 1).
+ * @details Hachage parfait pour les commandes intégrées : il ne dépend que du premier, du deuxième et du dernier caractère et de la longueur,
+ *    et les coefficients ont été choisis pour qu'aucune commande intégrée ne partage sa case avec une autre.
+ */
+unsigned builtin_slot(const char *name, size_t len)
+{
+    const unsigned char *c = (const unsigned char *)name;
+    unsigned second = (len > 1) ? c[1] : 0;
+    return (c[0] + (second << 2) + ((unsigned)c[len - 1] << 3) + (unsigned)len) & (BUILTIN_TABLE_SIZE - 1);
+}
+
+/** @brief Fonction de recherche d'une commande intégrée.
+ * @param name Nom de la commande.
+ * @return const builtin_t* Entrée de la table, NULL si la commande n'est pas intégrée.
+ * @details Une seule case est examinée (hachage parfait), suivie d'une unique comparaison de chaînes.
+ */
+const builtin_t *find_builtin(const char *name)
+{
+    if (!name || name[0] == '\0')
+        return NULL;
+    const builtin_t *entry = &builtins[builtin_slot(name, strlen(name))];
+    return (entry->name && strcmp(entry->name, name) == 0) ? entry : NULL;
+}
+
+/** @brief Fonction d'accès à la table des commandes intégrées.
+ * @return const builtin_t* Table de BUILTIN_TABLE_SIZE cases, indexée par *builtin_slot()* (les cases vides ont un nom NULL).
+ */
+const builtin_t *builtin_table(void)
+{
+    return builtins;
+}
+
+/** @brief Fonction de résolution d'une commande intégrée, mémorisée dans le processus.
+ * @param cmd Processus à résoudre.
+ * @return const builtin_t* Entrée de la table, NULL si la commande n'est pas intégrée.
+ * @details Le résultat est conservé dans *cmd->builtin* : les appels suivants (dont *exec_builtin()*) ne refont pas la recherche.
+ */
+const builtin_t *resolve_builtin(processus_t *cmd)
+{
+    if (!cmd || !cmd->argv[0])
+        return NULL;
+    if (!cmd->builtin)
+        cmd->builtin = find_builtin(cmd->argv[0]);
+    return cmd->builtin;
+}
 
 /** @brief Fonction de vérification si une commande est une commande "built-in".
  * @param cmd Nom de la commande à vérifier.
  * @return int 1 si la commande est intégrée, 0 sinon.
- * @details Les commandes intégrées sont a minima: cd, exit, export, unset, pwd.
+ * @details Les commandes intégrées sont a minima: cd, exit, export, unset, pwd. S'y ajoutent hash, type, echo, printf, test et [, les commandes de contrôle des jobs (jobs, wait, fg, bg, kill), set et exec.
+ *    La recherche passe par *find_builtin()* ; la commande résolue est utilisée si *cmd->builtin* est déjà renseigné.
  */
 int is_builtin(const processus_t *cmd)
 {
     if (!cmd || !cmd->argv[0])
         return 0;
-    const char *c = cmd->argv[0];
-    return (strcmp(c, "cd") == 0) ||
-           (strcmp(c, "exit") == 0) ||
-           (strcmp(c, "export") == 0) ||
-           (strcmp(c, "unset") == 0) ||
-           (strcmp(c, "pwd") == 0);
+    return cmd->builtin != NULL || find_builtin(cmd->argv[0]) != NULL;
 }
 
 /** @brief Fonction d'exécution d'une commande intégrée.
  * @param cmd Pointeur vers la structure de commande à exécuter.
- * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (dont l'échec de l'écriture de la sortie).
+ * @details La fonction d'exécution est celle de *resolve_builtin()*. Au retour, la sortie tamponnée de la commande est écrite (voir *output_flush_all()*).
+ *    Toute commande autre que "test" et "[" invalide le cache des résultats de stat() (voir *builtin_stat_cache_clear()*).
  */
 int exec_builtin(processus_t *cmd)
 {
-    if (!cmd || !cmd->argv[0])
+    const builtin_t *builtin = resolve_builtin(cmd);
+    if (!builtin)
         return -1;
-    if (strcmp(cmd->argv[0], "cd") == 0)
-        return builtin_cd(cmd);
-    if (strcmp(cmd->argv[0], "exit") == 0)
-        return builtin_exit(cmd);
-    if (strcmp(cmd->argv[0], "export") == 0)
-        return builtin_export(cmd);
-    if (strcmp(cmd->argv[0], "unset") == 0)
-        return builtin_unset(cmd);
-    if (strcmp(cmd->argv[0], "pwd") == 0)
-        return builtin_pwd(cmd);
-    return -1;
+    int rc = builtin->handler(cmd);
+    // sortie tamponnée écrite avant que les descripteurs de la commande ne soient fermés
+    if (output_flush_all() != 0 && rc == 0)
+        rc = -1;
+    if (builtin->handler != builtin_test)
+        builtin_stat_cache_clear();
+    return rc;
 }
 
 /** Fonctions spécifiques aux commandes intégrées. */
@@ -62,17 +144,19 @@ int exec_builtin(processus_t *cmd)
  */
 int builtin_cd(processus_t *cmd)
 {
-    const char *path = cmd->argv[1] ? cmd->argv[1] : getenv("HOME");
+    const char *path = cmd->argv[1] ? cmd->argv[1] : vars_get("HOME");
     if (!path)
     {
-        dprintf(cmd->stderr_fd, "cd: HOME non défini\n");
+        output_printf(cmd->stderr_fd, "cd: HOME non défini\n");
         return -1;
     }
     if (chdir(path) != 0)
     {
-        dprintf(cmd->stderr_fd, "cd: impossible d'accéder à %s\n", path);
+        output_printf(cmd->stderr_fd, "cd: impossible d'accéder à %s\n", path);
         return -1;
     }
+    // les chemins relatifs mémorisés par "test" désignent d'autres fichiers
+    builtin_stat_cache_clear();
     return 0;
 }
 
@@ -80,34 +164,94 @@ int builtin_cd(processus_t *cmd)
  * @param cmd Pointeur vers la structure de commande à exécuter.
  * @return int 0 en cas de succès, -1 en cas d'erreur.
  * @details Termine le shell avec le code de sortie spécifié dans le premier argument de la commande.
- *  Si aucun argument n'est fourni, le shell se termine avec le code de sortie 0.
+ *  Si aucun argument n'est fourni, le shell se termine avec le code de retour de la dernière commande exécutée (0 au démarrage).
  *  En cas d'erreur (argument non numérique, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur
  */
 int builtin_exit(processus_t *cmd)
 {
-    int code = 0;
+    int code = get_last_status();
     if (cmd->argv[1])
     {
         char *end = NULL;
         long v = strtol(cmd->argv[1], &end, 10);
         if (!end || *end != '\0')
         {
-            dprintf(cmd->stderr_fd, "exit: argument non numérique\n");
+            output_printf(cmd->stderr_fd, "exit: argument non numérique\n");
             return -1;
         }
         code = (int)(v & 0xFF);
     }
+    output_flush_all();
     exit(code);
 }
 
+/** @brief Fonction d'exécution de la commande "exec".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 0 en cas de succès, 1 si une redirection n'a pas pu être installée, 127 si la commande est introuvable, 126 si elle n'est pas exécutable
+ *  (shell interactif uniquement : sinon le shell se termine avec ce statut).
+ * @details Sans argument, installe les redirections de la commande dans le shell lui-même (voir *set_shell_fd()*) : "exec 3>>journal" ouvre
+ *  le fichier une seule fois pour toutes les lignes suivantes ("echo x >&3"), "exec >sortie" redirige la sortie du shell et de ses commandes,
+ *  "exec 3>&-" referme le descripteur. "exec commande arguments..." installe de même les redirections puis remplace le shell par la commande
+ *  (*execve()* sans fork, voir *replace_shell()*). En cas d'échec, un message est affiché sur *cmd->stderr* ; comme l'exige POSIX, un shell
+ *  non interactif (script, "-c") se termine alors au lieu de poursuivre avec les redirections déjà installées.
+ */
+int builtin_exec(processus_t *cmd)
+{
+    command_line_t *cmdl = cmd->cf ? cmd->cf->cmdl : NULL;
+
+    // ce qui a été écrit jusqu'ici part vers les anciennes destinations
+    output_flush_all();
+    fflush(NULL);
+
+    int std[3] = {cmd->stdin_fd, cmd->stdout_fd, cmd->stderr_fd};
+    for (int fd = 0; fd < 3; ++fd)
+    {
+        if (std[fd] != fd && set_shell_fd(cmdl, fd, std[fd]) != 0)
+        {
+            output_printf(cmd->stderr_fd, "exec: %d: %s\n", fd, strerror(errno));
+            return 1;
+        }
+    }
+    // les descripteurs du shell sont désormais ceux de la commande
+    cmd->stdin_fd = 0;
+    cmd->stdout_fd = 1;
+    cmd->stderr_fd = 2;
+    for (unsigned int i = 0; i < cmd->num_fd_mappings; ++i)
+    {
+        const fd_mapping_t *m = &cmd->fd_mappings[i];
+        if (set_shell_fd(cmdl, m->fd, m->source) != 0)
+        {
+            output_printf(cmd->stderr_fd, "exec: %d: %s\n", m->fd, strerror(errno));
+            return 1;
+        }
+    }
+    if (!cmd->argv[1])
+        return 0;
+
+    // remplacement du shell : aucun processus n'est créé
+    const char *name = cmd->argv[1];
+    int status = replace_shell(name, cmd->argv + 1, vars_envp());
+    if (status == 127 && !strchr(name, '/'))
+        output_printf(cmd->stderr_fd, "exec: %s : commande introuvable\n", name);
+    else
+        output_printf(cmd->stderr_fd, "exec: %s : %s\n", name, strerror(errno));
+    if (!is_interactive())
+    {
+        output_flush_all();
+        exit(status);
+    }
+    return status;
+}
+
 /** @brief Fonction d'exécution de la commande "export".
  * @param cmd Pointeur vers la structure de commande à exécuter.
  * @return int 0 en cas de succès, -1 en cas d'erreur.
- * @details Ajoute ou modifie une variable d'environnement dans l'environnement du shell. En cas d'erreur (format invalide, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur.
+ * @details Ajoute ou modifie une variable exportée dans la table des variables du shell (voir vars.h) : "export VAR=val" la définit,
+ *  "export VAR" exporte une variable locale déjà définie. Modifier PATH vide le cache des chemins de commandes. En cas d'erreur (format invalide, variable non définie, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur.
  */
 int builtin_export(processus_t *cmd)
 {
-    // format attendu: export VAR=val
+    // format attendu: export VAR=val ou export VAR
     if (!cmd->argv[1])
         return 0;
 
@@ -116,10 +260,21 @@ int builtin_export(processus_t *cmd)
         char *arg = cmd->argv[i];
         char *eq = strchr(arg, '=');
 
-        // pas de = ou = au début
-        if (!eq || eq == arg)
+        // export d'une variable locale existante
+        if (!eq)
         {
-            dprintf(cmd->stderr_fd, "export: format VAR=val requis\n");
+            if (vars_export(arg) != 0)
+            {
+                output_printf(cmd->stderr_fd, "export: %s : variable non définie (format VAR=val requis)\n", arg);
+                return -1;
+            }
+            continue;
+        }
+
+        // = au début
+        if (eq == arg)
+        {
+            output_printf(cmd->stderr_fd, "export: format VAR=val requis\n");
             return -1;
         }
 
@@ -129,7 +284,7 @@ int builtin_export(processus_t *cmd)
         char *var_name = malloc(var_len + 1);
         if (!var_name)
         {
-            dprintf(cmd->stderr_fd, "export: erreur malloc\n");
+            output_printf(cmd->stderr_fd, "export: erreur malloc\n");
             return -1;
         }
 
@@ -138,9 +293,10 @@ int builtin_export(processus_t *cmd)
 
         char *val = eq + 1;
 
-        if (setenv(var_name, val, 1) != 0)
+        // les chemins mémorisés dépendent de $PATH : vars_set vide le cache
+        if (vars_set(var_name, val, 1) != 0)
         {
-            dprintf(cmd->stderr_fd, "export: échec pour %s\n", var_name);
+            output_printf(cmd->stderr_fd, "export: échec pour %s\n", var_name);
             free(var_name);
             return -1;
         }
@@ -153,7 +309,7 @@ int builtin_export(processus_t *cmd)
 /** @brief Fonction d'exécution de la commande "unset".
  * @param cmd Pointeur vers la structure de commande à exécuter.
  * @return int 0 en cas de succès, -1 en cas d'erreur.
- * @details Supprime une variable d'environnement de l'environnement du shell. En cas d'erreur (variable inexistante, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur.
+ * @details Supprime une variable (locale ou exportée) de la table des variables du shell. Supprimer PATH vide le cache des chemins de commandes. En cas d'erreur (variable inexistante, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur.
  */
 int builtin_unset(processus_t *cmd)
 {
@@ -163,9 +319,9 @@ int builtin_unset(processus_t *cmd)
     int ret = 0;
     for (int i = 1; cmd->argv[i]; ++i)
     {
-        if (unsetenv(cmd->argv[i]) != 0)
+        if (vars_unset(cmd->argv[i]) != 0)
         {
-            dprintf(cmd->stderr_fd, "unset: identifiant invalide '%s'\n", cmd->argv[i]);
+            output_printf(cmd->stderr_fd, "unset: identifiant invalide '%s'\n", cmd->argv[i]);
             ret = -1;
         }
     }
@@ -183,9 +339,1238 @@ int builtin_pwd(processus_t *cmd)
     char buf[4096];
     if (!getcwd(buf, sizeof buf))
     {
-        dprintf(cmd->stderr_fd, "pwd: erreur getcwd\n");
+        output_printf(cmd->stderr_fd, "pwd: erreur getcwd\n");
         return -1;
     }
-    dprintf(cmd->stdout_fd, "%s\n", buf);
+    output_printf(cmd->stdout_fd, "%s\n", buf);
+    return 0;
+}
+/** @brief Affichage d'une entrée du cache des chemins pour "hash" (les échecs ne sont pas listés). */
+static int print_hash_entry(const path_cache_entry_t *entry, void *data)
+{
+    int fd = *(int *)data;
+    if (entry->path)
+        output_printf(fd, "%lu\t%s\n", entry->hits, entry->path);
+    return 0;
+}
+
+/** @brief Fonction d'exécution de la commande "hash".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 0 en cas de succès, 1 si une commande est introuvable, -1 en cas d'erreur.
+ * @details Sans argument, affiche le contenu du cache des chemins de commandes (nombre d'utilisations et chemin) sur *cmd->stdout*.
+ *  "hash -r" vide le cache. "hash nom..." résout chaque nom via $PATH et le mémorise ; un nom introuvable provoque un message sur *cmd->stderr*.
+ */
+int builtin_hash(processus_t *cmd)
+{
+    if (!cmd->argv[1])
+    {
+        if (path_cache_size() == 0)
+        {
+            output_printf(cmd->stdout_fd, "hash: table de hachage vide\n");
+            return 0;
+        }
+        output_printf(cmd->stdout_fd, "occurrences\tcommande\n");
+        return path_cache_foreach(print_hash_entry, &cmd->stdout_fd);
+    }
+
+    int i = 1;
+    if (strcmp(cmd->argv[1], "-r") == 0)
+    {
+        path_cache_clear();
+        i++;
+    }
+    else if (cmd->argv[1][0] == '-')
+    {
+        output_printf(cmd->stderr_fd, "hash: %s : option non valable\n", cmd->argv[1]);
+        return -1;
+    }
+
+    int ret = 0;
+    for (; cmd->argv[i]; ++i)
+    {
+        const char *name = cmd->argv[i];
+        if (strchr(name, '/'))
+            continue; // un chemin explicite n'est jamais mémorisé
+        if (!path_cache_refresh(name))
+        {
+            output_printf(cmd->stderr_fd, "hash: %s : non trouvé\n", name);
+            ret = 1;
+        }
+    }
+    return ret;
+}
+
+/** @brief Fonction d'exécution de la commande "type".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 0 en cas de succès, 1 si une commande est introuvable.
+ * @details Indique pour chaque argument s'il s'agit d'une commande intégrée, d'une commande mémorisée dans le cache des chemins ("haché")
+ *  ou d'une commande trouvée dans $PATH (qui est alors mémorisée). Le résultat est affiché sur *cmd->stdout*.
+ */
+int builtin_type(processus_t *cmd)
+{
+    int ret = 0;
+    processus_t probe;
+    init_processus(&probe);
+
+    for (int i = 1; cmd->argv[i]; ++i)
+    {
+        const char *name = cmd->argv[i];
+        probe.argv[0] = (char *)name;
+
+        if (is_builtin(&probe))
+        {
+            output_printf(cmd->stdout_fd, "%s est une primitive du shell\n", name);
+            continue;
+        }
+        if (strchr(name, '/'))
+        {
+            if (access(name, X_OK) == 0)
+                output_printf(cmd->stdout_fd, "%s est %s\n", name, name);
+            else
+            {
+                output_printf(cmd->stderr_fd, "type: %s : non trouvé\n", name);
+                ret = 1;
+            }
+            continue;
+        }
+
+        const path_cache_entry_t *entry = path_cache_find(name);
+        if (entry && entry->path)
+        {
+            output_printf(cmd->stdout_fd, "%s est haché (%s)\n", name, entry->path);
+            continue;
+        }
+        const char *path = entry ? path_cache_refresh(name) : path_cache_lookup(name);
+        if (path)
+            output_printf(cmd->stdout_fd, "%s est %s\n", name, path);
+        else
+        {
+            output_printf(cmd->stderr_fd, "type: %s : non trouvé\n", name);
+            ret = 1;
+        }
+    }
+    return ret;
+}
+
+/** @brief Conversion d'une désignation de job ("%n", "%%", "%+" ou un PID) en numéro de job.
+ * @param spec Désignation (NULL : job courant).
+ * @param pid PID désigné, renseigné si *spec* est un PID (0 sinon), peut être NULL.
+ * @return int Numéro du job, 0 s'il n'existe pas, -1 si la désignation est invalide.
+ */
+static int parse_job_spec(const char *spec, pid_t *pid)
+{
+    if (pid)
+        *pid = 0;
+    if (!spec || strcmp(spec, "%%") == 0 || strcmp(spec, "%+") == 0 || strcmp(spec, "%") == 0)
+        return jobs_max_id();
+
+    char *end;
+    if (spec[0] == '%')
+    {
+        long id = strtol(spec + 1, &end, 10);
+        if (*end != '\0' || end == spec + 1 || id <= 0)
+            return -1;
+        return jobs_get((int)id) ? (int)id : 0;
+    }
+
+    long n = strtol(spec, &end, 10);
+    if (*end != '\0' || end == spec || n <= 0)
+        return -1;
+    if (pid)
+        *pid = (pid_t)n;
+    job_process_t *p = jobs_find_pid((pid_t)n);
+    return p ? p->job_id : 0;
+}
+
+/** @brief Fonction d'exécution de la commande "jobs".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @details Affiche sur *cmd->stdout* les jobs d'arrière-plan ("[n]+ état commande"). "jobs -l" ajoute les PID, "jobs -p" n'affiche que les PID.
+ *  Les jobs terminés affichés sont retirés de la table.
+ */
+int builtin_jobs(processus_t *cmd)
+{
+    int long_format = 0, pids_only = 0;
+    for (int i = 1; cmd->argv[i]; ++i)
+    {
+        if (strcmp(cmd->argv[i], "-l") == 0)
+            long_format = 1;
+        else if (strcmp(cmd->argv[i], "-p") == 0)
+            pids_only = 1;
+        else
+        {
+            output_printf(cmd->stderr_fd, "jobs: %s : option non valable\n", cmd->argv[i]);
+            return -1;
+        }
+    }
+
+    char state[64];
+    int max = jobs_max_id();
+    for (int id = 1; id <= max; ++id)
+    {
+        job_t *job = jobs_get(id);
+        if (!job || !job->is_background)
+            continue;
+
+        if (pids_only)
+        {
+            for (job_process_t *p = jobs_process(job->first); p; p = jobs_process(p->next))
+                output_printf(cmd->stdout_fd, "%d\n", (int)p->pid);
+            continue;
+        }
+        output_printf(cmd->stdout_fd, "[%d]%c  ", id, id == max ? '+' : ' ');
+        if (long_format)
+        {
+            job_process_t *p = jobs_process(job->first);
+            output_printf(cmd->stdout_fd, "%d ", p ? (int)p->pid : 0);
+        }
+        output_printf(cmd->stdout_fd, "%-24s%s\n", jobs_describe(id, state, sizeof state), job->command ? job->command : "");
+        if (job->nalive == 0)
+            jobs_remove(id);
+    }
     return 0;
-}
\ No newline at end of file
+}
+
+/** @brief Fonction d'exécution de la commande "wait".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int Code de retour du dernier job ou processus attendu, 127 s'il n'est pas un fils du shell, -1 en cas d'erreur.
+ * @details Sans argument, attend la fin de tous les jobs d'arrière-plan et retourne 0.
+ *  Sinon, attend chaque processus (PID) ou job (%n) désigné ; les jobs terminés sont retirés de la table.
+ */
+int builtin_wait(processus_t *cmd)
+{
+    if (!cmd->argv[1])
+    {
+        int max = jobs_max_id();
+        for (int id = 1; id <= max; ++id)
+        {
+            job_t *job = jobs_get(id);
+            if (!job || !job->is_background)
+                continue;
+            jobs_wait(id);
+            if (job->nalive == 0)
+                jobs_remove(id);
+        }
+        return 0;
+    }
+
+    int ret = 0;
+    for (int i = 1; cmd->argv[i]; ++i)
+    {
+        pid_t pid;
+        int id = parse_job_spec(cmd->argv[i], &pid);
+        if (id < 0)
+        {
+            output_printf(cmd->stderr_fd, "wait: %s : désignation de job ou PID non valable\n", cmd->argv[i]);
+            ret = -1;
+            continue;
+        }
+        if (id == 0)
+        {
+            output_printf(cmd->stderr_fd, "wait: %s : n'est pas un fils de ce shell\n", cmd->argv[i]);
+            ret = 127;
+            continue;
+        }
+
+        if (pid > 0)
+        {
+            jobs_wait_pid(pid);
+            ret = jobs_exit_code(jobs_find_pid(pid)->status);
+        }
+        else
+        {
+            jobs_wait(id);
+            ret = jobs_status(id);
+        }
+        if (jobs_get(id)->nalive == 0)
+            jobs_remove(id);
+    }
+    return ret;
+}
+
+/** @brief Fonction d'exécution de la commande "fg".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int Code de retour du job, 1 si le job n'existe pas.
+ * @details Passe le job désigné (par défaut le job courant) en avant-plan, le reprend s'il est stoppé (SIGCONT) et attend sa fin.
+ */
+int builtin_fg(processus_t *cmd)
+{
+    int id = parse_job_spec(cmd->argv[1], NULL);
+    if (id <= 0)
+    {
+        output_printf(cmd->stderr_fd, "fg: %s : job inexistant\n", cmd->argv[1] ? cmd->argv[1] : "courant");
+        return 1;
+    }
+
+    job_t *job = jobs_get(id);
+    output_printf(cmd->stdout_fd, "%s\n", job->command ? job->command : "");
+    output_flush_all(); // affiché avant la sortie du job
+    jobs_set_background(id, 0, NULL);
+    if (job->nstopped > 0)
+        jobs_signal(id, SIGCONT);
+    jobs_wait(id);
+
+    int ret = jobs_status(id);
+    if (job->nalive == 0)
+        jobs_remove(id);
+    else
+    {
+        // de nouveau stoppé : retour en arrière-plan
+        jobs_set_background(id, 1, NULL);
+        output_printf(cmd->stderr_fd, "\n[%d]+  Stoppé                  %s\n", id, job->command ? job->command : "");
+    }
+    return ret;
+}
+
+/** @brief Fonction d'exécution de la commande "bg".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 0 en cas de succès, 1 si le job n'existe pas.
+ * @details Reprend en arrière-plan (SIGCONT) le job stoppé désigné (par défaut le job courant).
+ */
+int builtin_bg(processus_t *cmd)
+{
+    int id = parse_job_spec(cmd->argv[1], NULL);
+    if (id <= 0)
+    {
+        output_printf(cmd->stderr_fd, "bg: %s : job inexistant\n", cmd->argv[1] ? cmd->argv[1] : "courant");
+        return 1;
+    }
+
+    job_t *job = jobs_get(id);
+    if (job->nstopped == 0)
+    {
+        output_printf(cmd->stderr_fd, "bg: le job %d est déjà en arrière-plan\n", id);
+        return 0;
+    }
+    jobs_set_background(id, 1, NULL);
+    jobs_signal(id, SIGCONT);
+    output_printf(cmd->stdout_fd, "[%d]+ %s\n", id, job->command ? job->command : "");
+    return 0;
+}
+
+/** @brief Table des noms de signaux reconnus par "kill". */
+static const struct
+{
+    const char *name;
+    int sig;
+} signal_names[] = {
+    {"HUP", SIGHUP}, {"INT", SIGINT}, {"QUIT", SIGQUIT}, {"ILL", SIGILL}, {"TRAP", SIGTRAP},
+    {"ABRT", SIGABRT}, {"BUS", SIGBUS}, {"FPE", SIGFPE}, {"KILL", SIGKILL}, {"USR1", SIGUSR1},
+    {"SEGV", SIGSEGV}, {"USR2", SIGUSR2}, {"PIPE", SIGPIPE}, {"ALRM", SIGALRM}, {"TERM", SIGTERM},
+    {"CHLD", SIGCHLD}, {"CONT", SIGCONT}, {"STOP", SIGSTOP}, {"TSTP", SIGTSTP}, {"TTIN", SIGTTIN},
+    {"TTOU", SIGTTOU}, {"URG", SIGURG}, {"XCPU", SIGXCPU}, {"XFSZ", SIGXFSZ}, {"VTALRM", SIGVTALRM},
+    {"PROF", SIGPROF}, {"WINCH", SIGWINCH}, {"SYS", SIGSYS},
+};
+
+/** @brief Conversion d'un nom ("TERM", "SIGTERM") ou d'un numéro de signal.
+ * @return int Numéro du signal, -1 s'il est inconnu.
+ */
+static int parse_signal(const char *name)
+{
+    if (isdigit((unsigned char)name[0]))
+    {
+        char *end;
+        long sig = strtol(name, &end, 10);
+        return (*end == '\0' && sig >= 0 && sig < NSIG) ? (int)sig : -1;
+    }
+    if (strncasecmp(name, "SIG", 3) == 0)
+        name += 3;
+    for (size_t i = 0; i < sizeof signal_names / sizeof signal_names[0]; ++i)
+    {
+        if (strcasecmp(name, signal_names[i].name) == 0)
+            return signal_names[i].sig;
+    }
+    return -1;
+}
+
+/** @brief Fonction d'exécution de la commande "kill".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 0 en cas de succès, 1 si un envoi a échoué, -1 en cas d'erreur de syntaxe.
+ * @details "kill [-s SIG | -n NUM | -SIG] pid|%n..." envoie le signal (SIGTERM par défaut) aux processus ou aux jobs désignés.
+ *  "kill -l" liste les noms de signaux reconnus sur *cmd->stdout*.
+ */
+int builtin_kill(processus_t *cmd)
+{
+    int sig = SIGTERM;
+    int i = 1;
+
+    if (cmd->argv[1] && strcmp(cmd->argv[1], "-l") == 0)
+    {
+        for (size_t k = 0; k < sizeof signal_names / sizeof signal_names[0]; ++k)
+            output_printf(cmd->stdout_fd, "%2d) SIG%s\n", signal_names[k].sig, signal_names[k].name);
+        return 0;
+    }
+    if (cmd->argv[1] && (strcmp(cmd->argv[1], "-s") == 0 || strcmp(cmd->argv[1], "-n") == 0))
+    {
+        if (!cmd->argv[2] || (sig = parse_signal(cmd->argv[2])) < 0)
+        {
+            output_printf(cmd->stderr_fd, "kill: %s : signal non valable\n", cmd->argv[2] ? cmd->argv[2] : "");
+            return -1;
+        }
+        i = 3;
+    }
+    else if (cmd->argv[1] && cmd->argv[1][0] == '-' && cmd->argv[1][1] != '\0')
+    {
+        if ((sig = parse_signal(cmd->argv[1] + 1)) < 0)
+        {
+            output_printf(cmd->stderr_fd, "kill: %s : signal non valable\n", cmd->argv[1] + 1);
+            return -1;
+        }
+        i = 2;
+    }
+    if (!cmd->argv[i])
+    {
+        output_printf(cmd->stderr_fd, "kill: utilisation : kill [-s signal | -signal] pid | %%job ...\n");
+        return -1;
+    }
+
+    int ret = 0;
+    for (; cmd->argv[i]; ++i)
+    {
+        const char *target = cmd->argv[i];
+        if (target[0] == '%')
+        {
+            int id = parse_job_spec(target, NULL);
+            if (id <= 0 || jobs_signal(id, sig) != 0)
+            {
+                output_printf(cmd->stderr_fd, "kill: %s : job inexistant\n", target);
+                ret = 1;
+            }
+            continue;
+        }
+
+        char *end;
+        long pid = strtol(target, &end, 10);
+        if (*end != '\0' || end == target)
+        {
+            output_printf(cmd->stderr_fd, "kill: %s : les arguments doivent être des identifiants de processus ou de jobs\n", target);
+            ret = 1;
+        }
+        else if (kill((pid_t)pid, sig) != 0)
+        {
+            output_printf(cmd->stderr_fd, "kill: (%ld) - %s\n", pid, strerror(errno));
+            ret = 1;
+        }
+    }
+    return ret;
+}
+
+/** @brief Fonction d'exécution de la commande "set".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @details "set -o" affiche les options du shell sur *cmd->stdout*. "set -o nom=valeur" modifie une option :
+ *  - maxjobs=N : nombre maximal de jobs d'arrière-plan exécutés simultanément (0 : illimité, nombre de processeurs par défaut) ;
+ *  - spawn=fork|posix_spawn|zygote : mécanisme de création des processus.
+ */
+int builtin_set(processus_t *cmd)
+{
+    if (!cmd->argv[1] || strcmp(cmd->argv[1], "-o") != 0)
+    {
+        output_printf(cmd->stderr_fd, "set: utilisation : set -o [nom=valeur]\n");
+        return -1;
+    }
+    if (!cmd->argv[2])
+    {
+        output_printf(cmd->stdout_fd, "maxjobs\t%d\n", get_max_jobs());
+        static const char *backend_names[] = {"fork", "posix_spawn", "zygote"};
+        output_printf(cmd->stdout_fd, "spawn\t%s\n", backend_names[get_spawn_backend()]);
+        return 0;
+    }
+
+    for (int i = 2; cmd->argv[i]; ++i)
+    {
+        const char *option = cmd->argv[i];
+        const char *value = strchr(option, '=');
+        if (!value)
+        {
+            output_printf(cmd->stderr_fd, "set: %s : valeur manquante (nom=valeur)\n", option);
+            return -1;
+        }
+        value++;
+
+        if (strncmp(option, "maxjobs=", 8) == 0)
+        {
+            char *end;
+            long n = strtol(value, &end, 10);
+            if (*value == '\0' || *end != '\0' || n < 0 || n > INT_MAX || set_max_jobs((int)n) != 0)
+            {
+                output_printf(cmd->stderr_fd, "set: maxjobs : %s : nombre non valable\n", value);
+                return -1;
+            }
+        }
+        else if (strncmp(option, "spawn=", 6) == 0)
+        {
+            spawn_backend_t backend;
+            if (parse_spawn_backend(value, &backend) != 0)
+            {
+                output_printf(cmd->stderr_fd, "set: spawn : %s : mécanisme inconnu (fork, posix_spawn, zygote)\n", value);
+                return -1;
+            }
+            if (set_spawn_backend(backend) != 0)
+            {
+                output_printf(cmd->stderr_fd, "set: spawn : %s : démarrage impossible\n", value);
+                return -1;
+            }
+        }
+        else
+        {
+            output_printf(cmd->stderr_fd, "set: %.*s : option inconnue\n", (int)(value - 1 - option), option);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------- */
+/* echo et printf                                                                                                    */
+/* ---------------------------------------------------------------------------------------------------------------- */
+
+/** @brief Destination d'un rendu : le tampon de sortie d'un descripteur (voir output.h), ou une zone mémoire de taille suffisante.
+ * @struct render_t
+ */
+typedef struct
+{
+    int fd;      ///< Descripteur de destination (si *data* est NULL)
+    char *data;  ///< Zone mémoire de destination, ou NULL
+    size_t len;  ///< Octets rendus
+} render_t;
+
+/** @brief Ajout de *len* octets au rendu. */
+static void render_write(render_t *r, const char *data, size_t len)
+{
+    if (r->data)
+        memcpy(r->data + r->len, data, len);
+    else
+        output_write(r->fd, data, len);
+    r->len += len;
+}
+
+/** @brief Ajout d'un octet au rendu. */
+static void render_putc(render_t *r, char c)
+{
+    render_write(r, &c, 1);
+}
+
+/** @brief Ajout de *len* octets cadrés sur *width* colonnes et tronqués à *precision* octets (-1 : pas de troncature). */
+static void out_padded(int fd, const char *data, size_t len, int left, int width, int precision)
+{
+    static const char spaces[] = "                                ";
+    if (precision >= 0 && (size_t)precision < len)
+        len = precision;
+    size_t pad = (width > 0 && (size_t)width > len) ? width - len : 0;
+    for (size_t n; !left && pad > 0; pad -= n)
+        output_write(fd, spaces, n = pad < sizeof spaces - 1 ? pad : sizeof spaces - 1);
+    output_write(fd, data, len);
+    for (size_t n; left && pad > 0; pad -= n)
+        output_write(fd, spaces, n = pad < sizeof spaces - 1 ? pad : sizeof spaces - 1);
+}
+
+/** @brief Interprétation d'une séquence d'échappement ("\n", "\t", "\\", "\NNN"...).
+ * @param out Destination du rendu.
+ * @param s Pointeur sur le caractère qui suit le '\', avancé après la séquence.
+ * @param zero_octal Les valeurs octales s'écrivent "\0NNN" (echo -e et %b) plutôt que "\NNN" (format de printf).
+ * @return int 1 pour "\c" (fin de la sortie), 0 sinon.
+ */
+static int put_escape(render_t *out, const char **s, int zero_octal)
+{
+    const char *p = *s;
+    char c = *p++;
+    int value;
+    switch (c)
+    {
+    case 'a': render_putc(out, '\a'); break;
+    case 'b': render_putc(out, '\b'); break;
+    case 'c': *s = p; return 1;
+    case 'e': render_putc(out, '\033'); break;
+    case 'f': render_putc(out, '\f'); break;
+    case 'n': render_putc(out, '\n'); break;
+    case 'r': render_putc(out, '\r'); break;
+    case 't': render_putc(out, '\t'); break;
+    case 'v': render_putc(out, '\v'); break;
+    case '\\': render_putc(out, '\\'); break;
+    case 'x':
+        value = 0;
+        for (int i = 0; i < 2 && isxdigit((unsigned char)*p); ++i, ++p)
+            value = value * 16 + (isdigit((unsigned char)*p) ? *p - '0' : (tolower((unsigned char)*p) - 'a' + 10));
+        if (p == *s + 1)
+            render_write(out, "\\x", 2);
+        else
+            render_putc(out, (char)value);
+        break;
+    case '\0':
+        render_putc(out, '\\');
+        p--;
+        break;
+    default:
+        if (c >= '0' && c <= '7' && (!zero_octal || c == '0'))
+        {
+            // "\NNN" (format) ou "\0NNN" (echo -e, %b) : jusqu'à 3 chiffres octaux
+            value = zero_octal ? 0 : c - '0';
+            for (int i = zero_octal ? 0 : 1; i < 3 && *p >= '0' && *p <= '7'; ++i, ++p)
+                value = value * 8 + (*p - '0');
+            render_putc(out, (char)value);
+        }
+        else
+        {
+            render_putc(out, '\\');
+            render_putc(out, c);
+        }
+        break;
+    }
+    *s = p;
+    return 0;
+}
+
+/** @brief Ajout d'une chaîne en interprétant ses séquences d'échappement (echo -e, %b).
+ * @return int 1 si "\c" a été rencontré, 0 sinon.
+ */
+static int out_escaped(render_t *out, const char *s)
+{
+    while (*s)
+    {
+        const char *bs = strchr(s, '\\');
+        if (!bs)
+        {
+            render_write(out, s, strlen(s));
+            break;
+        }
+        render_write(out, s, bs - s);
+        s = bs + 1;
+        if (put_escape(out, &s, 1))
+            return 1;
+    }
+    return 0;
+}
+
+/** @brief Fonction d'exécution de la commande "echo".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 0 (une erreur d'écriture est signalée par *exec_builtin()*).
+ * @details Affiche les arguments séparés par des espaces, suivis d'un saut de ligne, sur *cmd->stdout*.
+ *  Options (éventuellement groupées, "-ne") : -n supprime le saut de ligne final, -e interprète les séquences d'échappement
+ *  ("\n", "\t", "\0NNN", "\c" arrête la sortie...), -E les désactive (par défaut). Un argument qui n'est pas une option est affiché tel quel.
+ */
+int builtin_echo(processus_t *cmd)
+{
+    render_t out = {.fd = cmd->stdout_fd};
+    int newline = 1, escapes = 0;
+    int i = 1;
+    for (; cmd->argv[i] && cmd->argv[i][0] == '-' && cmd->argv[i][1] != '\0'; ++i)
+    {
+        const char *opt = cmd->argv[i] + 1;
+        if (strspn(opt, "neE") != strlen(opt))
+            break;
+        for (; *opt; ++opt)
+        {
+            if (*opt == 'n')
+                newline = 0;
+            else
+                escapes = (*opt == 'e');
+        }
+    }
+
+    int stop = 0;
+    for (int first = i; cmd->argv[i] && !stop; ++i)
+    {
+        if (i > first)
+            render_putc(&out, ' ');
+        if (escapes)
+            stop = out_escaped(&out, cmd->argv[i]);
+        else
+            render_write(&out, cmd->argv[i], strlen(cmd->argv[i]));
+    }
+    if (newline && !stop)
+        render_putc(&out, '\n');
+    return 0;
+}
+
+/** @brief Ajout d'une chaîne protégée pour être relue par le shell (%q).
+ * @details Une chaîne sans caractère spécial est recopiée telle quelle ; sinon elle est entourée d'apostrophes
+ *  (une apostrophe devient '\'' ) ; la chaîne vide devient ''.
+ */
+static void out_quoted(render_t *out, const char *s)
+{
+    if (*s == '\0')
+    {
+        render_write(out, "''", 2);
+        return;
+    }
+    size_t safe = strspn(s, "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789_./,:+@%=-");
+    if (s[safe] == '\0')
+    {
+        render_write(out, s, safe);
+        return;
+    }
+    render_putc(out, '\'');
+    for (; *s; ++s)
+    {
+        if (*s == '\'')
+            render_write(out, "'\\''", 4);
+        else
+            render_putc(out, *s);
+    }
+    render_putc(out, '\'');
+}
+
+/** @brief Conversion d'un argument numérique de printf.
+ * @param arg Argument (NULL : argument manquant, vaut 0). "'c" ou "\"c" donne la valeur du caractère c.
+ * @param is_unsigned Conversion non signée.
+ * @param err Mis à 1 si l'argument n'est pas entièrement numérique (un message est affiché).
+ * @return long long Valeur (partielle en cas d'erreur).
+ */
+static long long printf_integer(processus_t *cmd, const char *arg, int is_unsigned, int *err)
+{
+    if (!arg || *arg == '\0')
+        return 0;
+    if (arg[0] == '\'' || arg[0] == '"')
+        return (unsigned char)arg[1];
+    char *end;
+    errno = 0;
+    long long v = is_unsigned && arg[0] != '-' ? (long long)strtoull(arg, &end, 0) : strtoll(arg, &end, 0);
+    if (end == arg || *end != '\0' || errno == ERANGE)
+    {
+        output_printf(cmd->stderr_fd, "printf: %s : nombre non valable\n", arg);
+        *err = 1;
+    }
+    return v;
+}
+
+/** @brief Conversion d'un argument réel de printf (voir *printf_integer()*). */
+static long double printf_float(processus_t *cmd, const char *arg, int *err)
+{
+    if (!arg || *arg == '\0')
+        return 0;
+    if (arg[0] == '\'' || arg[0] == '"')
+        return (unsigned char)arg[1];
+    char *end;
+    errno = 0;
+    long double v = strtold(arg, &end);
+    if (end == arg || *end != '\0' || errno == ERANGE)
+    {
+        output_printf(cmd->stderr_fd, "printf: %s : nombre non valable\n", arg);
+        *err = 1;
+    }
+    return v;
+}
+
+/** @brief Fonction d'exécution de la commande "printf".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 0 en cas de succès, 1 si un argument ou le format est invalide (la sortie s'arrête à la conversion fautive),
+ *  -1 sans format (une erreur d'écriture est signalée par *exec_builtin()*).
+ * @details "printf format [argument...]" affiche les arguments selon *format* sur *cmd->stdout* (POSIX) :
+ *  - séquences d'échappement du format ("\n", "\t", "\\", "\NNN", "\xHH"...) ;
+ *  - conversions %d %i %o %u %x %X %c %s %e %E %f %F %g %G %a %A et %%, avec drapeaux (-+ #0), largeur et précision (nombres ou '*') ;
+ *  - %b : argument dont les séquences d'échappement sont interprétées ("\c" arrête toute la sortie) ;
+ *  - %q : argument protégé pour être relu par le shell.
+ *  Le format est réutilisé tant qu'il reste des arguments ; un argument manquant vaut 0 ou la chaîne vide.
+ *  Un argument numérique peut être en décimal, octal (0NNN), hexadécimal (0xHH) ou un caractère ('c).
+ */
+int builtin_printf(processus_t *cmd)
+{
+    int first = 1;
+    if (cmd->argv[1] && strcmp(cmd->argv[1], "--") == 0)
+        first = 2;
+    const char *format = cmd->argv[first];
+    if (!format)
+    {
+        output_printf(cmd->stderr_fd, "printf: utilisation : printf format [arguments]\n");
+        return -1;
+    }
+
+    int fd = cmd->stdout_fd;
+    render_t out = {.fd = fd};
+    char *const *args = cmd->argv + first + 1;
+    int ret = 0, stop = 0;
+    do
+    {
+        char *const *pass_start = args;
+        for (const char *f = format; *f && !stop; ++f)
+        {
+            if (*f == '\\')
+            {
+                ++f;
+                stop = put_escape(&out, &f, 0);
+                --f;
+                continue;
+            }
+            if (*f != '%')
+            {
+                const char *next = strpbrk(f, "\\%");
+                size_t len = next ? (size_t)(next - f) : strlen(f);
+                output_write(fd, f, len);
+                f += len - 1;
+                continue;
+            }
+            if (f[1] == '%')
+            {
+                output_putc(fd, '%');
+                ++f;
+                continue;
+            }
+
+            // %[drapeaux][largeur][.précision][modificateur]conversion
+            const char *conv_start = f++;
+            char flags[8];
+            size_t nflags = 0;
+            while (*f && strchr("-+ #0", *f))
+            {
+                if (nflags < sizeof flags - 1)
+                    flags[nflags++] = *f;
+                ++f;
+            }
+            flags[nflags] = '\0';
+            int width = -1, precision = -1;
+            if (*f == '*')
+            {
+                width = (int)printf_integer(cmd, *args, 0, &ret);
+                if (*args)
+                    ++args;
+                ++f;
+            }
+            else if (isdigit((unsigned char)*f))
+                width = (int)strtol(f, (char **)&f, 10);
+            if (*f == '.')
+            {
+                ++f;
+                if (*f == '*')
+                {
+                    precision = (int)printf_integer(cmd, *args, 0, &ret);
+                    if (*args)
+                        ++args;
+                    ++f;
+                }
+                else
+                    precision = (int)strtol(f, (char **)&f, 10);
+            }
+            while (*f && strchr("hlLjzt", *f))
+                ++f;
+
+            char spec[32];
+            int left = strchr(flags, '-') != NULL;
+            if (width < 0 && width != -1)
+            {
+                left = 1; // largeur négative via '*' : cadrage à gauche
+                width = -width;
+            }
+            const char *arg = *args;
+            if (*f && strchr("diouxXcseEfFgGaAbq", *f) && arg)
+                ++args;
+
+            switch (*f)
+            {
+            case 'd':
+            case 'i':
+                snprintf(spec, sizeof spec, "%%%s%s*.*lld", flags, left ? "-" : "");
+                output_printf(fd, spec, width, precision, printf_integer(cmd, arg, 0, &ret));
+                break;
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+                snprintf(spec, sizeof spec, "%%%s%s*.*ll%c", flags, left ? "-" : "", *f);
+                output_printf(fd, spec, width, precision, (unsigned long long)printf_integer(cmd, arg, 1, &ret));
+                break;
+            case 'e':
+            case 'E':
+            case 'f':
+            case 'F':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                snprintf(spec, sizeof spec, "%%%s%s*.*L%c", flags, left ? "-" : "", *f);
+                output_printf(fd, spec, width, precision, printf_float(cmd, arg, &ret));
+                break;
+            case 'c':
+                out_padded(fd, arg ? arg : "", (arg && *arg) ? 1 : 0, left, width, -1);
+                break;
+            case 's':
+                if (!arg)
+                    arg = "";
+                out_padded(fd, arg, strlen(arg), left, width, precision);
+                break;
+            case 'b':
+            case 'q':
+            {
+                if (!arg)
+                    arg = "";
+                render_t tmp = {.fd = -1};
+                render_t *dest = &out;
+                if (width > 0 || precision >= 0)
+                {
+                    // rendu intermédiaire pour appliquer largeur et précision : %b ne rallonge pas l'argument, %q au plus 4 fois
+                    dest = &tmp;
+                    tmp.data = malloc(*f == 'b' ? strlen(arg) + 1 : 4 * strlen(arg) + 3);
+                    if (!tmp.data)
+                        return -1;
+                }
+                if (*f == 'b')
+                    stop = out_escaped(dest, arg);
+                else
+                    out_quoted(dest, arg);
+                if (dest == &tmp)
+                {
+                    out_padded(fd, tmp.data, tmp.len, left, width, precision);
+                    free(tmp.data);
+                }
+                break;
+            }
+            default:
+                output_printf(cmd->stderr_fd, "printf: %.*s : spécification de format non valable\n",
+                               (int)(f - conv_start + (*f ? 1 : 0)), conv_start);
+                return 1;
+            }
+        }
+        // le format est réutilisé tant qu'il consomme des arguments
+        if (args == pass_start)
+            break;
+    } while (*args && !stop);
+
+    return ret;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------- */
+/* test et [                                                                                                         */
+/* ---------------------------------------------------------------------------------------------------------------- */
+
+/// Nombre de cases du cache des résultats de stat() (puissance de 2)
+#define STAT_CACHE_SIZE 16
+/// Longueur maximale d'un chemin mémorisé dans le cache
+#define STAT_CACHE_PATH 256
+
+/** @brief Résultat mémorisé d'un appel à stat() ou lstat().
+ * @struct stat_cache_entry_t
+ */
+typedef struct
+{
+    uint64_t generation;          ///< Génération du cache à laquelle le résultat a été obtenu (0 : case vide)
+    int follow;                   ///< 1 pour stat(), 0 pour lstat()
+    int err;                      ///< errno de l'appel, 0 en cas de succès
+    struct stat st;               ///< Résultat de l'appel
+    char path[STAT_CACHE_PATH];   ///< Chemin
+} stat_cache_entry_t;
+
+static stat_cache_entry_t stat_cache[STAT_CACHE_SIZE]; ///< Cache direct des résultats de stat()
+static uint64_t stat_generation = 1;                   ///< Génération courante : les cases d'une autre génération sont périmées
+
+/** @brief Fonction d'invalidation du cache des résultats de stat() utilisé par "test" et "[".
+ * @details Appelée au début de chaque ligne de commande, avant le lancement d'une commande externe, après toute commande intégrée autre que
+ *    "test" et "[", et à l'ouverture d'une redirection qui peut créer ou tronquer un fichier : le cache n'est partagé que par des tests
+ *    successifs qu'aucune autre commande n'a pu rendre obsolètes.
+ */
+void builtin_stat_cache_clear(void)
+{
+    stat_generation++;
+}
+
+/** @brief stat() ou lstat() avec cache.
+ * @return int 0 en cas de succès, -1 sinon (errno renseigné).
+ */
+static int cached_stat(const char *path, struct stat *st, int follow)
+{
+    size_t len = strlen(path);
+    if (len >= STAT_CACHE_PATH)
+        return follow ? stat(path, st) : lstat(path, st);
+
+    // FNV-1a sur le chemin et le type d'appel
+    uint32_t h = 2166136261u ^ (uint32_t)follow;
+    for (size_t i = 0; i < len; ++i)
+        h = (h ^ (unsigned char)path[i]) * 16777619u;
+    stat_cache_entry_t *e = &stat_cache[h & (STAT_CACHE_SIZE - 1)];
+
+    if (e->generation != stat_generation || e->follow != follow || strcmp(e->path, path) != 0)
+    {
+        e->err = ((follow ? stat(path, &e->st) : lstat(path, &e->st)) == 0) ? 0 : errno;
+        e->generation = stat_generation;
+        e->follow = follow;
+        memcpy(e->path, path, len + 1);
+    }
+    if (e->err != 0)
+    {
+        errno = e->err;
+        return -1;
+    }
+    *st = e->st;
+    return 0;
+}
+
+/** @brief Etat de l'évaluation d'une expression de "test". */
+typedef struct
+{
+    processus_t *cmd; ///< Commande (pour les descripteurs et les messages)
+    char **args;      ///< Arguments de l'expression
+    int argc;         ///< Nombre d'arguments
+    int pos;          ///< Prochain argument à lire
+    int error;        ///< Erreur de syntaxe ou d'argument rencontrée
+} test_state_t;
+
+/** @brief Vérifie si *op* est un opérateur unaire de "test". */
+static int test_is_unary(const char *op)
+{
+    return op[0] == '-' && op[1] != '\0' && op[2] == '\0' && strchr("bcdefghkLnprsStuwxzGO", op[1]) != NULL;
+}
+
+/** @brief Vérifie si *op* est un opérateur binaire de "test". */
+static int test_is_binary(const char *op)
+{
+    static const char *ops[] = {"=", "==", "!=", "<", ">", "-eq", "-ne", "-lt", "-le", "-gt", "-ge", "-nt", "-ot", "-ef"};
+    for (size_t i = 0; i < sizeof ops / sizeof ops[0]; ++i)
+        if (strcmp(op, ops[i]) == 0)
+            return 1;
+    return 0;
+}
+
+/** @brief Conversion d'un opérande entier (espaces autour tolérés). */
+static long long test_integer(test_state_t *ts, const char *arg)
+{
+    char *end;
+    errno = 0;
+    long long v = strtoll(arg, &end, 10);
+    while (isspace((unsigned char)*end))
+        end++;
+    if (end == arg || *end != '\0' || errno == ERANGE)
+    {
+        output_printf(ts->cmd->stderr_fd, "test: %s : nombre entier attendu\n", arg);
+        ts->error = 1;
+    }
+    return v;
+}
+
+/** @brief Evaluation d'un opérateur unaire. */
+static int test_unary(test_state_t *ts, char op, const char *arg)
+{
+    struct stat st;
+    switch (op)
+    {
+    case 'n': return arg[0] != '\0';
+    case 'z': return arg[0] == '\0';
+    case 'r': return faccessat(AT_FDCWD, arg, R_OK, AT_EACCESS) == 0;
+    case 'w': return faccessat(AT_FDCWD, arg, W_OK, AT_EACCESS) == 0;
+    case 'x': return faccessat(AT_FDCWD, arg, X_OK, AT_EACCESS) == 0;
+    case 't':
+    {
+        long long fd = test_integer(ts, arg);
+        // les descripteurs standards sont ceux de la commande (redirections comprises)
+        int fds[3] = {ts->cmd->stdin_fd, ts->cmd->stdout_fd, ts->cmd->stderr_fd};
+        return !ts->error && fd >= 0 && fd <= INT_MAX && isatty(fd < 3 ? fds[fd] : (int)fd);
+    }
+    case 'h':
+    case 'L':
+        return cached_stat(arg, &st, 0) == 0 && S_ISLNK(st.st_mode);
+    }
+
+    if (cached_stat(arg, &st, 1) != 0)
+        return 0;
+    switch (op)
+    {
+    case 'b': return S_ISBLK(st.st_mode);
+    case 'c': return S_ISCHR(st.st_mode);
+    case 'd': return S_ISDIR(st.st_mode);
+    case 'e': return 1;
+    case 'f': return S_ISREG(st.st_mode);
+    case 'g': return (st.st_mode & S_ISGID) != 0;
+    case 'k': return (st.st_mode & S_ISVTX) != 0;
+    case 'p': return S_ISFIFO(st.st_mode);
+    case 's': return st.st_size > 0;
+    case 'S': return S_ISSOCK(st.st_mode);
+    case 'u': return (st.st_mode & S_ISUID) != 0;
+    case 'G': return st.st_gid == getegid();
+    case 'O': return st.st_uid == geteuid();
+    }
+    return 0;
+}
+
+/** @brief Comparaison des dates de modification (-nt, -ot). */
+static int test_newer(const char *a, const char *b)
+{
+    struct stat sa, sb;
+    if (cached_stat(a, &sa, 1) != 0)
+        return 0;
+    if (cached_stat(b, &sb, 1) != 0)
+        return 1;
+    return sa.st_mtim.tv_sec > sb.st_mtim.tv_sec ||
+           (sa.st_mtim.tv_sec == sb.st_mtim.tv_sec && sa.st_mtim.tv_nsec > sb.st_mtim.tv_nsec);
+}
+
+/** @brief Evaluation d'un opérateur binaire. */
+static int test_binary(test_state_t *ts, const char *a, const char *op, const char *b)
+{
+    if (strcmp(op, "=") == 0 || strcmp(op, "==") == 0)
+        return strcmp(a, b) == 0;
+    if (strcmp(op, "!=") == 0)
+        return strcmp(a, b) != 0;
+    if (strcmp(op, "<") == 0)
+        return strcmp(a, b) < 0;
+    if (strcmp(op, ">") == 0)
+        return strcmp(a, b) > 0;
+    if (strcmp(op, "-nt") == 0)
+        return test_newer(a, b);
+    if (strcmp(op, "-ot") == 0)
+        return test_newer(b, a);
+    if (strcmp(op, "-ef") == 0)
+    {
+        struct stat sa, sb;
+        return cached_stat(a, &sa, 1) == 0 && cached_stat(b, &sb, 1) == 0 && sa.st_dev == sb.st_dev && sa.st_ino == sb.st_ino;
+    }
+
+    long long x = test_integer(ts, a), y = test_integer(ts, b);
+    if (strcmp(op, "-eq") == 0)
+        return x == y;
+    if (strcmp(op, "-ne") == 0)
+        return x != y;
+    if (strcmp(op, "-lt") == 0)
+        return x < y;
+    if (strcmp(op, "-le") == 0)
+        return x <= y;
+    if (strcmp(op, "-gt") == 0)
+        return x > y;
+    return x >= y; // -ge
+}
+
+static int test_or(test_state_t *ts);
+
+/** @brief Argument suivant de l'expression (NULL à la fin). */
+static const char *test_peek(test_state_t *ts, int offset)
+{
+    return (ts->pos + offset < ts->argc) ? ts->args[ts->pos + offset] : NULL;
+}
+
+/** @brief primaire := '(' ou ')' | '!' primaire | opérande opérateur_binaire opérande | opérateur_unaire opérande | opérande */
+static int test_primary(test_state_t *ts)
+{
+    const char *a = test_peek(ts, 0);
+    if (!a)
+    {
+        output_printf(ts->cmd->stderr_fd, "test: argument attendu\n");
+        ts->error = 1;
+        return 0;
+    }
+    // un opérateur binaire en deuxième position est prioritaire ("[ -f = -f ]", "[ ! = x ]")
+    const char *op = test_peek(ts, 1);
+    if (op && test_peek(ts, 2) && test_is_binary(op))
+    {
+        ts->pos += 3;
+        return test_binary(ts, a, op, ts->args[ts->pos - 1]);
+    }
+    if (strcmp(a, "!") == 0)
+    {
+        ts->pos++;
+        return !test_primary(ts);
+    }
+    if (strcmp(a, "(") == 0 && op)
+    {
+        ts->pos++;
+        int v = test_or(ts);
+        const char *close_paren = test_peek(ts, 0);
+        if (!close_paren || strcmp(close_paren, ")") != 0)
+        {
+            output_printf(ts->cmd->stderr_fd, "test: ')' attendu\n");
+            ts->error = 1;
+            return 0;
+        }
+        ts->pos++;
+        return v;
+    }
+    if (test_is_unary(a) && op)
+    {
+        ts->pos += 2;
+        return test_unary(ts, a[1], op);
+    }
+    ts->pos++;
+    return a[0] != '\0';
+}
+
+/** @brief et := primaire ('-a' primaire)* */
+static int test_and(test_state_t *ts)
+{
+    int v = test_primary(ts);
+    while (!ts->error && test_peek(ts, 0) && strcmp(test_peek(ts, 0), "-a") == 0)
+    {
+        ts->pos++;
+        int rhs = test_primary(ts);
+        v = v && rhs;
+    }
+    return v;
+}
+
+/** @brief ou := et ('-o' et)* */
+static int test_or(test_state_t *ts)
+{
+    int v = test_and(ts);
+    while (!ts->error && test_peek(ts, 0) && strcmp(test_peek(ts, 0), "-o") == 0)
+    {
+        ts->pos++;
+        int rhs = test_and(ts);
+        v = v || rhs;
+    }
+    return v;
+}
+
+/** @brief Evaluation d'une expression de "test" selon les règles POSIX (par nombre d'arguments jusqu'à 4, puis grammaire complète).
+ * @return int 0 si l'expression est vraie, 1 si elle est fausse, 2 en cas d'erreur.
+ */
+static int test_eval(processus_t *cmd, char **args, int argc)
+{
+    test_state_t ts = {.cmd = cmd, .args = args, .argc = argc};
+    int negate = 0;
+
+    // règles POSIX : un "!" en tête de 2 à 4 arguments nie l'expression restante, "( x )" vaut x
+    while (ts.argc - ts.pos >= 2 && ts.argc - ts.pos <= 4 && strcmp(args[ts.pos], "!") == 0 &&
+           !(ts.argc - ts.pos == 3 && test_is_binary(args[ts.pos + 1])))
+    {
+        negate = !negate;
+        ts.pos++;
+    }
+    int n = ts.argc - ts.pos;
+    int v;
+    if (n == 0)
+        v = 0;
+    else if (n == 1)
+        v = args[ts.pos][0] != '\0';
+    else if (n == 2 && !test_is_unary(args[ts.pos]))
+    {
+        output_printf(cmd->stderr_fd, "test: %s : opérateur unaire attendu\n", args[ts.pos]);
+        return 2;
+    }
+    else if (n == 3 && !test_is_binary(args[ts.pos + 1]) && strcmp(args[ts.pos], "(") == 0 && strcmp(args[ts.pos + 2], ")") == 0)
+        v = args[ts.pos + 1][0] != '\0';
+    else
+    {
+        v = test_or(&ts);
+        if (!ts.error && ts.pos < ts.argc)
+        {
+            output_printf(cmd->stderr_fd, "test: %s : argument inattendu\n", args[ts.pos]);
+            ts.error = 1;
+        }
+    }
+    if (ts.error)
+        return 2;
+    return (v != negate) ? 0 : 1;
+}
+
+/** @brief Fonction d'exécution des commandes "test" et "[".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 0 si l'expression est vraie, 1 si elle est fausse, 2 en cas d'erreur (syntaxe, entier invalide, "]" manquant).
+ * @details Opérateurs POSIX :
+ *  - fichiers : -b -c -d -e -f -g -h -L -k -p -r -s -S -t -u -w -x -G -O, f1 -nt f2, f1 -ot f2, f1 -ef f2 ;
+ *  - chaînes : -n, -z, =, ==, !=, <, > et une chaîne seule (vraie si non vide) ;
+ *  - entiers : -eq -ne -lt -le -gt -ge ;
+ *  - logiques : !, -a, -o et parenthèses.
+ *  Les résultats de stat() sont mis en cache jusqu'à la prochaine commande qui pourrait les rendre obsolètes (voir *builtin_stat_cache_clear()*) :
+ *  "[ -e f ] && [ -f f ] && [ -s f ]" ne fait qu'un appel système.
+ */
+int builtin_test(processus_t *cmd)
+{
+    int argc = 0;
+    while (cmd->argv[argc])
+        argc++;
+    if (strcmp(cmd->argv[0], "[") == 0)
+    {
+        if (strcmp(cmd->argv[argc - 1], "]") != 0)
+        {
+            output_printf(cmd->stderr_fd, "[: « ] » manquant\n");
+            return 2;
+        }
+        argc--;
+    }
+    return test_eval(cmd, cmd->argv + 1, argc - 1);
+}
@@ -0,0 +1,316 @@
+/** @file expand.c
+ * @brief Implementation of shell parameter expansion
+ * @author Sofiane FETTAH
+ * @author Matthieu COMME
+ * @date 2025-26
+ * @details Implémentation des paramètres spéciaux et positionnels du shell.
+ *    La valeur de $@ et $* est construite une seule fois, par *expand_set_positional()* ; les autres valeurs sont lues à chaque substitution.
+ *    Les mots marqués par l'analyseur lexical sont substitués au lancement, directement dans l'arène de la ligne de commande.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+
+#include "expand.h"
+#include "processus.h"
+#include "vars.h"
+
+static char *default_argv[] = {"minishell", NULL};
+
+static char **positional = default_argv; ///< $0, $1...
+static size_t positional_count = 1;      ///< Nombre d'éléments de *positional* ($# + 1)
+static char *all_parameters = NULL;      ///< $1 à $n séparés par des espaces ($@ et $*)
+static pid_t shell_pid = 0;              ///< PID du shell ($$), lu au premier accès
+
+/** @brief Fonction de définition des paramètres positionnels.
+ * @param argc Nombre d'éléments de *argv*.
+ * @param argv $0 puis les paramètres $1, $2... (non copiés : le tableau doit rester valable, comme celui de *main()*).
+ * @return int 0 en cas de succès, -1 en cas d'erreur d'allocation (la valeur de $@ et $* est alors vide).
+ * @details Sans appel, $0 vaut "minishell" et il n'y a aucun paramètre positionnel.
+ */
+int expand_set_positional(int argc, char *argv[])
+{
+    if (argc < 1 || !argv)
+    {
+        argc = 1;
+        argv = default_argv;
+    }
+    positional = argv;
+    positional_count = argc;
+
+    free(all_parameters);
+    all_parameters = NULL;
+    size_t size = 1;
+    for (int i = 1; i < argc; ++i)
+        size += strlen(argv[i]) + 1;
+    all_parameters = malloc(size);
+    if (!all_parameters)
+        return -1;
+    char *p = all_parameters;
+    for (int i = 1; i < argc; ++i)
+    {
+        size_t len = strlen(argv[i]);
+        if (i > 1)
+            *p++ = ' ';
+        memcpy(p, argv[i], len);
+        p += len;
+    }
+    *p = '\0';
+    return 0;
+}
+
+/** @brief Fonction de calcul de la longueur du nom d'un paramètre écrit sans accolades ($NOM, $?, $1...).
+ * @param name Début du nom (caractère qui suit le '$').
+ * @param max Nombre de caractères lisibles à partir de *name* (le nom s'arrête aussi au premier '\0').
+ * @return size_t Longueur du nom, 0 si le '$' n'est pas suivi d'un nom (il est alors littéral).
+ * @details Un paramètre spécial ou un chiffre forme un nom d'un caractère ("$12" est $1 suivi de "2", comme dans sh) ;
+ *    sinon le nom est la plus longue suite de lettres, chiffres et '_'.
+ */
+size_t expand_name_length(const char *name, size_t max)
+{
+    if (max == 0 || *name == '\0')
+        return 0;
+    if (strchr("?$!#@*", *name) || isdigit((unsigned char)*name))
+        return 1;
+    size_t len = 0;
+    while (len < max && (isalnum((unsigned char)name[len]) || name[len] == '_'))
+        len++;
+    return len;
+}
+
+/** @brief Fonction de récupération de la valeur d'un paramètre.
+ * @param name Début du nom (pas nécessairement terminé par '\0').
+ * @param len Longueur du nom.
+ * @param buf Tampon où sont écrites les valeurs numériques.
+ * @return const char* Valeur du paramètre (dans *buf*, dans la table des variables ou dans les paramètres positionnels), NULL s'il n'est pas défini.
+ */
+const char *expand_parameter(const char *name, size_t len, char buf[EXPAND_NUMBER_SIZE])
+{
+    if (!name || len == 0)
+        return NULL;
+
+    // paramètres spéciaux
+    if (len == 1)
+    {
+        switch (*name)
+        {
+        case '?':
+            snprintf(buf, EXPAND_NUMBER_SIZE, "%d", get_last_status());
+            return buf;
+        case '$':
+            if (shell_pid == 0)
+                shell_pid = getpid();
+            snprintf(buf, EXPAND_NUMBER_SIZE, "%ld", (long)shell_pid);
+            return buf;
+        case '!':
+            if (get_last_background_pid() <= 0)
+                return NULL;
+            snprintf(buf, EXPAND_NUMBER_SIZE, "%ld", (long)get_last_background_pid());
+            return buf;
+        case '#':
+            snprintf(buf, EXPAND_NUMBER_SIZE, "%zu", positional_count - 1);
+            return buf;
+        case '@':
+        case '*':
+            return all_parameters ? all_parameters : "";
+        }
+    }
+
+    // paramètres positionnels : $0 à $9, ${10}...
+    if (isdigit((unsigned char)*name))
+    {
+        size_t index = 0;
+        for (size_t i = 0; i < len; ++i)
+        {
+            if (!isdigit((unsigned char)name[i]))
+                return NULL;
+            index = index * 10 + (name[i] - '0');
+            if (index >= positional_count)
+                return NULL;
+        }
+        return positional[index];
+    }
+
+    // variables du shell
+    return vars_getn(name, len);
+}
+
+/** @brief Réservation de *more* octets après le mot en cours dans l'arène (le mot est déplacé si le bloc est plein). */
+static int field_reserve(arena_t *a, char **field, size_t more)
+{
+    if ((size_t)(a->end - a->ptr) >= more)
+        return 0;
+    return arena_extend(a, field, more);
+}
+
+/** @brief Ajout de *len* caractères au mot en cours (qui est commencé si besoin), en gardant un octet pour son '\0'. */
+static int field_append(arena_t *a, char **field, const char *s, size_t len)
+{
+    if (field_reserve(a, field, len + 1) != 0)
+        return -1;
+    if (!*field)
+        *field = a->ptr;
+    memcpy(a->ptr, s, len);
+    a->ptr += len;
+    return 0;
+}
+
+/** @brief Rôle d'un mot substitué : argument d'un processus ou mot isolé (*expand_string()*). */
+typedef struct
+{
+    command_line_t *cmdl; ///< Ligne de commande du processus (NULL pour un mot isolé)
+    processus_t *proc;    ///< Processus qui reçoit les arguments
+    char *result;         ///< Dernier mot produit (mot isolé)
+} fields_t;
+
+/** @brief Fin du mot en cours : ajouté aux arguments du processus, ou conservé comme résultat. */
+static int field_end(arena_t *a, char **field, fields_t *out)
+{
+    if (!*field)
+        return 0;
+    *a->ptr++ = '\0'; // la place est réservée par field_append()
+    char *text = *field;
+    *field = NULL;
+    if (!out->proc)
+    {
+        out->result = text;
+        return 0;
+    }
+    return add_argument(out->cmdl, out->proc, text);
+}
+
+/** @brief Substitution des marqueurs d'un mot de l'analyseur lexical.
+ * @param a Arène qui reçoit les mots.
+ * @param word Mot avec marqueurs EXPAND_CTL_*.
+ * @param split Découpage des valeurs hors guillemets en plusieurs mots.
+ * @param out Destination des mots produits (aucun, un ou plusieurs).
+ * @return int 0 en cas de succès, -1 en cas d'erreur d'allocation.
+ */
+static int expand_fields(arena_t *a, const char *word, int split, fields_t *out)
+{
+    char buf[EXPAND_NUMBER_SIZE];
+    char *field = NULL;
+    for (const char *p = word; *p; ++p)
+    {
+        if (*p == EXPAND_CTL_QUOTE)
+        {
+            // mot entre guillemets : il existe, même vide
+            if (field_append(a, &field, "", 0) != 0)
+                return -1;
+            continue;
+        }
+        if (*p != EXPAND_CTL_VAR && *p != EXPAND_CTL_QVAR)
+        {
+            if (*p == EXPAND_CTL_ESC && p[1])
+                p++;
+            if (field_append(a, &field, p, 1) != 0)
+                return -1;
+            continue;
+        }
+
+        // paramètre : NOM jusqu'à EXPAND_CTL_END
+        int quoted = (*p == EXPAND_CTL_QVAR);
+        const char *name = p + 1;
+        const char *name_end = strchr(name, EXPAND_CTL_END);
+        if (!name_end)
+            break;
+        const char *value = expand_parameter(name, name_end - name, buf);
+        p = name_end;
+        if (!value)
+            value = "";
+
+        if (quoted || !split)
+        {
+            if (field_append(a, &field, value, strlen(value)) != 0)
+                return -1;
+            continue;
+        }
+        // hors guillemets : les espaces de la valeur séparent des mots
+        for (const char *v = value; *v;)
+        {
+            size_t n = strcspn(v, " \t\n");
+            if (n > 0 && field_append(a, &field, v, n) != 0)
+                return -1;
+            v += n;
+            if (*v)
+            {
+                if (field_end(a, &field, out) != 0)
+                    return -1;
+                v++;
+            }
+        }
+    }
+    return field_end(a, &field, out);
+}
+
+/** @brief Reconnaissance d'un mot "NOM=..." (le nom précède tout marqueur). */
+static int is_assignment_word(const char *word)
+{
+    const char *eq = strchr(word, '=');
+    return eq && vars_valid_name(word, eq - word);
+}
+
+/** @brief Fonction de substitution des paramètres dans les arguments d'un processus.
+ * @param cmdl Ligne de commande du processus (son arène reçoit les mots substitués et, si besoin, le nouveau tableau *argv*).
+ * @param proc Processus dont les arguments contiennent des marqueurs (*proc->expand*).
+ * @return int 0 en cas de succès, -1 en cas d'erreur d'allocation.
+ * @details Appelée au lancement du processus : les valeurs sont celles du moment, après l'exécution des commandes précédentes de la ligne.
+ *    Hors guillemets, une valeur est découpée en mots sur les espaces, tabulations et retours à la ligne (sauf dans une commande formée
+ *    uniquement d'affectations "NOM=valeur") ; un mot dont la substitution est vide disparaît, sauf s'il contenait des guillemets.
+ *    *argv* (et *path*) sont remplacés, *argc* est mis à jour et *proc->expand* remis à 0.
+ */
+int expand_processus(command_line_t *cmdl, processus_t *proc)
+{
+    if (!cmdl || !proc)
+        return -1;
+    if (!proc->expand)
+        return 0;
+
+    // mots de l'analyseur : *argv_inline* est réécrit, ses mots sont d'abord mis de côté
+    char *inline_words[PROCESSUS_INLINE_ARGS];
+    char **words = proc->argv;
+    unsigned int count = proc->argc;
+    if (words == proc->argv_inline)
+    {
+        memcpy(inline_words, proc->argv_inline, sizeof inline_words);
+        words = inline_words;
+    }
+    int path_is_argv0 = (count > 0 && proc->path == words[0]);
+
+    int assignments = 1;
+    for (unsigned int i = 0; i < count; ++i)
+        assignments = assignments && is_assignment_word(words[i]);
+
+    proc->argv = proc->argv_inline;
+    proc->argv_capacity = PROCESSUS_INLINE_ARGS;
+    proc->argc = 0;
+    proc->argv[0] = NULL;
+    fields_t out = {.cmdl = cmdl, .proc = proc};
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (expand_fields(&cmdl->arena, words[i], !assignments, &out) != 0)
+            return -1;
+    }
+
+    if (path_is_argv0)
+        proc->path = proc->argv[0];
+    proc->expand = 0;
+    return 0;
+}
+
+/** @brief Fonction de substitution des paramètres dans un mot, sans découpage.
+ * @param a Arène qui reçoit le résultat.
+ * @param word Mot produit par l'analyseur lexical (avec ou sans marqueurs).
+ * @return char* Mot substitué (éventuellement vide), NULL en cas d'erreur d'allocation.
+ * @details Utilisée pour les mots qui ne forment jamais plusieurs arguments (fichier d'une redirection).
+ */
+char *expand_string(arena_t *a, const char *word)
+{
+    fields_t out = {.result = NULL};
+    if (!a || !word || expand_fields(a, word, 0, &out) != 0)
+        return NULL;
+    return out.result ? out.result : arena_strndup(a, "", 0);
+}
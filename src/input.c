@@ -0,0 +1,221 @@
+/** @file input.c
+ * @brief Implementation of the command line reader
+ * @author Sofiane FETTAH
+ * @author Matthieu COMME
+ * @date 2025-26
+ * @details Implémentation du lecteur de lignes de commande.
+ *    Les lignes sont repérées avec memchr() dans la projection ou dans le tampon, sans copie ni strlen().
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "input.h"
+
+/** @brief Fonction d'ouverture d'un lecteur sur un descripteur.
+ * @param in Lecteur à initialiser.
+ * @param fd Descripteur à lire.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @details Un fichier régulier non vide est projeté en mémoire en une fois ; les autres descripteurs sont lus par blocs de INPUT_BLOCK_SIZE octets.
+ *    Le descripteur n'est pas fermé par *input_close()*.
+ */
+int input_open_fd(input_t *in, int fd)
+{
+    if (!in || fd < 0)
+        return -1;
+    memset(in, 0, sizeof(*in));
+    in->fd = fd;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+    {
+        // lecture depuis la position courante (cas d'un script déjà entamé sur l'entrée standard)
+        off_t offset = lseek(fd, 0, SEEK_CUR);
+        if (offset < 0)
+            offset = 0;
+        void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED)
+        {
+            madvise(map, st.st_size, MADV_SEQUENTIAL);
+            in->data = map;
+            in->size = st.st_size;
+            in->pos = (offset < st.st_size) ? (size_t)offset : in->size;
+            in->mapped = 1;
+            in->eof = 1;
+            return 0;
+        }
+    }
+
+    // tube, terminal ou fichier non projetable : lecture par blocs
+    in->data = malloc(INPUT_BLOCK_SIZE);
+    if (!in->data)
+        return -1;
+    in->capacity = INPUT_BLOCK_SIZE;
+    return 0;
+}
+
+/** @brief Fonction d'ouverture d'un lecteur sur un fichier de script.
+ * @param in Lecteur à initialiser.
+ * @param path Chemin du fichier.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (errno renseigné).
+ */
+int input_open_file(input_t *in, const char *path)
+{
+    if (!in || !path)
+        return -1;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+    if (input_open_fd(in, fd) != 0)
+    {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+    // une projection reste valide après la fermeture du descripteur
+    if (in->mapped)
+    {
+        close(fd);
+        in->fd = -1;
+    }
+    else
+    {
+        // le script est lu par blocs sur un descripteur au-delà de 9 : "exec 3<fichier" ne peut pas le remplacer
+        int high = fcntl(fd, F_DUPFD_CLOEXEC, 10);
+        if (high >= 0)
+        {
+            close(fd);
+            in->fd = high;
+        }
+        in->owns_fd = 1;
+    }
+    return 0;
+}
+
+/** @brief Fonction d'ouverture d'un lecteur sur une chaîne (option -c).
+ * @param in Lecteur à initialiser.
+ * @param str Chaîne à lire, qui doit rester valide jusqu'à *input_close()*.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ */
+int input_open_string(input_t *in, const char *str)
+{
+    if (!in || !str)
+        return -1;
+    memset(in, 0, sizeof(*in));
+    in->fd = -1;
+    in->data = (char *)str;
+    in->size = strlen(str);
+    in->eof = 1;
+    return 0;
+}
+
+/** @brief Lecture d'un bloc supplémentaire dans le tampon (la ligne partielle est d'abord ramenée en tête).
+ * @return ssize_t Nombre d'octets lus, 0 à la fin de l'entrée, -1 en cas d'erreur.
+ */
+static ssize_t fill(input_t *in)
+{
+    if (in->pos > 0)
+    {
+        memmove(in->data, in->data + in->pos, in->size - in->pos);
+        in->size -= in->pos;
+        in->pos = 0;
+    }
+    if (in->size == in->capacity)
+    {
+        // ligne plus longue que le tampon
+        char *grown = realloc(in->data, in->capacity * 2);
+        if (!grown)
+            return -1;
+        in->data = grown;
+        in->capacity *= 2;
+    }
+
+    ssize_t n;
+    do
+        n = read(in->fd, in->data + in->size, in->capacity - in->size);
+    while (n < 0 && errno == EINTR);
+    if (n <= 0)
+    {
+        in->eof = 1;
+        return n;
+    }
+    in->size += n;
+    return n;
+}
+
+/** @brief Fonction de lecture de la ligne suivante.
+ * @param in Lecteur.
+ * @param line Pointeur renseigné avec le début de la ligne (dans le tampon du lecteur, sans '\n' ni '\0' final).
+ * @return ssize_t Longueur de la ligne, -1 à la fin de l'entrée ou en cas d'erreur de lecture.
+ * @details La ligne reste valide jusqu'au prochain appel. Le '\r' d'une fin de ligne "\r\n" est retiré.
+ */
+ssize_t input_next_line(input_t *in, const char **line)
+{
+    if (!in || !line || !in->data)
+        return -1;
+
+    size_t scanned = 0; // octets de la ligne partielle déjà parcourus sans trouver de '\n'
+    while (1)
+    {
+        char *start = in->data + in->pos;
+        size_t avail = in->size - in->pos;
+        char *nl = memchr(start + scanned, '\n', avail - scanned);
+        if (nl || (in->eof && avail > 0))
+        {
+            size_t len = nl ? (size_t)(nl - start) : avail;
+            in->pos += nl ? len + 1 : len;
+            if (len > 0 && start[len - 1] == '\r')
+                len--;
+            in->line_no++;
+            *line = start;
+            return (ssize_t)len;
+        }
+        if (in->eof)
+            return -1;
+        scanned = avail;
+        if (fill(in) < 0)
+            return -1;
+    }
+}
+
+/** @brief Fonction de test de la fin de l'entrée.
+ * @param in Lecteur.
+ * @return int 1 si la fin de l'entrée est connue et qu'il ne reste que des blancs à lire (la dernière ligne a été retournée), 0 sinon.
+ * @details Aucune lecture n'est faite : sur une entrée lue par blocs, la fin n'est connue qu'une fois le dernier bloc lu.
+ */
+int input_at_end(const input_t *in)
+{
+    if (!in || !in->eof)
+        return 0;
+    for (size_t i = in->pos; i < in->size; ++i)
+    {
+        char c = in->data[i];
+        if (c != ' ' && c != '\t' && c != '\r' && c != '\n')
+            return 0;
+    }
+    return 1;
+}
+
+/** @brief Fonction de fermeture d'un lecteur.
+ * @param in Lecteur.
+ * @details Libère le tampon ou la projection, et ferme le descripteur s'il a été ouvert par *input_open_file()*.
+ */
+void input_close(input_t *in)
+{
+    if (!in)
+        return;
+    if (in->mapped)
+        munmap(in->data, in->size);
+    else if (in->capacity > 0)
+        free(in->data);
+    if (in->owns_fd && in->fd >= 0)
+        close(in->fd);
+    memset(in, 0, sizeof(*in));
+    in->fd = -1;
+}
@@ -0,0 +1,738 @@
+/** @file jobs.c
+ * @brief Implementation of the job table
+ * @author Sofiane FETTAH
+ * @author Matthieu COMME
+ * @date 2025-26
+ * @details Implémentation de la table des jobs et du gestionnaire de SIGCHLD.
+ *    Les jobs sont rangés dans un tableau indexé par leur numéro, les processus dans un tableau avec liste des cases libres,
+ *    et une table de hachage à adressage ouvert associe un PID à l'indice de son processus.
+ *    Le gestionnaire de SIGCHLD ne fait que des lectures dans ces structures (et l'écriture des champs d'état) :
+ *    toute modification de leur forme (ajout, suppression, agrandissement) se fait SIGCHLD bloqué.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "jobs.h"
+
+/// Marqueur d'une case supprimée dans la table de hachage des PID
+#define PID_SLOT_DELETED (-1)
+
+static job_t *jobs = NULL;                 ///< Jobs indexés par numéro (la case 0 n'est pas utilisée)
+static int jobs_capacity = 0;              ///< Nombre de cases de *jobs*
+static int max_id = 0;                     ///< Plus grand numéro de job utilisé
+
+static job_process_t *procs = NULL;        ///< Processus suivis
+static int procs_capacity = 0;             ///< Nombre de cases de *procs*
+static int procs_used = 0;                 ///< Nombre de cases de *procs* déjà utilisées au moins une fois
+static int procs_free = -1;                ///< Tête de la liste des cases libres de *procs* (chaînées par *next*)
+static int procs_live = 0;                 ///< Nombre de processus suivis
+
+static int *pid_slots = NULL;              ///< Table de hachage PID -> indice + 1 (0 : vide, PID_SLOT_DELETED : supprimée)
+static int pid_capacity = 0;               ///< Nombre de cases de *pid_slots* (puissance de 2)
+static int pid_filled = 0;                 ///< Cases non vides de *pid_slots* (supprimées comprises)
+
+static volatile sig_atomic_t done_head = 0; ///< Premier job d'arrière-plan terminé non signalé (0 : aucun)
+static volatile sig_atomic_t done_count = 0; ///< Nombre de jobs de la liste *done_head*
+static volatile sig_atomic_t active = 0;    ///< Nombre de jobs d'arrière-plan non terminés
+static volatile sig_atomic_t stopped = 0;   ///< Nombre de jobs d'arrière-plan non terminés ayant au moins un processus stoppé
+static int initialized = 0;                 ///< Gestionnaire de SIGCHLD installé
+static void (*extra_reaper)(void) = NULL;   ///< Fonction appelée par le gestionnaire de SIGCHLD après wait4 (voir *jobs_set_reaper()*)
+
+/** @brief Case de départ du sondage pour *pid*. */
+static int pid_hash(pid_t pid, int capacity)
+{
+    return (int)(((uint32_t)pid * 2654435761u) & (uint32_t)(capacity - 1));
+}
+
+/** @brief Fonction de récupération d'un processus par son PID.
+ * @param pid PID du processus.
+ * @return job_process_t* Processus, ou NULL s'il n'est pas dans la table.
+ * @details Fonction utilisable depuis le gestionnaire de SIGCHLD (lecture seule).
+ */
+job_process_t *jobs_find_pid(pid_t pid)
+{
+    if (pid_capacity == 0 || pid <= 0)
+        return NULL;
+    for (int i = pid_hash(pid, pid_capacity);; i = (i + 1) & (pid_capacity - 1))
+    {
+        int slot = pid_slots[i];
+        if (slot == 0)
+            return NULL;
+        if (slot > 0 && procs[slot - 1].pid == pid)
+            return &procs[slot - 1];
+    }
+}
+
+/** @brief Processus non terminé de PID *pid*, NULL si aucun (lecture seule, utilisable depuis le gestionnaire de SIGCHLD).
+ * @details Un processus terminé qui porte encore ce PID (réattribué depuis par le système) est ignoré : le changement d'état
+ *    est celui du processus en cours, qui doit être décompté des jobs actifs dès sa récupération.
+ */
+static job_process_t *find_live_pid(pid_t pid)
+{
+    if (pid_capacity == 0 || pid <= 0)
+        return NULL;
+    for (int i = pid_hash(pid, pid_capacity);; i = (i + 1) & (pid_capacity - 1))
+    {
+        int slot = pid_slots[i];
+        if (slot == 0)
+            return NULL;
+        if (slot > 0 && procs[slot - 1].pid == pid && procs[slot - 1].state != JOB_DONE)
+            return &procs[slot - 1];
+    }
+}
+
+/** @brief Mise à jour du nombre de processus stoppés d'un job (et du nombre de jobs d'arrière-plan stoppés). */
+static void add_stopped(job_t *job, int delta)
+{
+    int before = job->nstopped;
+    job->nstopped += delta;
+    if (job->is_background && (before == 0) != (job->nstopped == 0))
+        stopped += (before == 0) ? 1 : -1;
+}
+
+/** @brief Fonction d'enregistrement d'un changement d'état d'un processus suivi.
+ * @param pid PID du processus.
+ * @param status Statut brut (au format de wait4()).
+ * @param rusage Ressources consommées (prises en compte si le processus est terminé).
+ * @details Fonction "async-signal-safe", appelée par le gestionnaire de SIGCHLD pour les fils du shell et par les mécanismes de lancement
+ *    dont les processus ne sont pas des fils directs du shell (voir zygote.h). Hors gestionnaire, elle doit être appelée SIGCHLD bloqué.
+ *    Un PID absent de la table est ignoré. Le processus concerné est le processus non terminé qui porte ce PID, même si un processus
+ *    terminé le porte aussi : le nombre de jobs d'arrière-plan actifs (*jobs_wait_slot()*) baisse dès la récupération du fils.
+ */
+void jobs_record(pid_t pid, int status, const struct rusage *rusage)
+{
+    job_process_t *p = find_live_pid(pid);
+    if (!p)
+        return; // fils non suivi ou déjà terminé : il est simplement récupéré
+    job_t *job = &jobs[p->job_id];
+
+    if (WIFSTOPPED(status))
+    {
+        if (p->state == JOB_RUNNING)
+        {
+            p->state = JOB_STOPPED;
+            add_stopped(job, 1);
+        }
+        p->status = status;
+        return;
+    }
+    if (WIFCONTINUED(status))
+    {
+        if (p->state == JOB_STOPPED)
+        {
+            p->state = JOB_RUNNING;
+            add_stopped(job, -1);
+        }
+        return;
+    }
+
+    if (p->state == JOB_STOPPED)
+        add_stopped(job, -1);
+    p->status = status;
+    p->rusage = *rusage;
+    clock_gettime(CLOCK_MONOTONIC, &p->end_time);
+    p->state = JOB_DONE;
+
+    if (--job->nalive == 0 && job->is_background)
+    {
+        active--;
+        job->done_next = done_head;
+        done_head = job->id;
+        done_count++;
+    }
+}
+
+/** @brief Gestionnaire de SIGCHLD : récupère tous les fils ayant changé d'état.
+ * @details N'utilise que des appels système "async-signal-safe" (wait4, clock_gettime).
+ */
+static void sigchld_handler(int sig)
+{
+    (void)sig;
+    int saved_errno = errno;
+    int status;
+    struct rusage rusage;
+    pid_t pid;
+    while ((pid = wait4(-1, &status, WNOHANG | WUNTRACED | WCONTINUED, &rusage)) > 0)
+        jobs_record(pid, status, &rusage);
+    if (extra_reaper)
+        extra_reaper();
+    errno = saved_errno;
+}
+
+/** @brief Fonction d'initialisation de la table des jobs.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @details Installe le gestionnaire de SIGCHLD. Les appels suivants n'ont aucun effet.
+ *    La fonction est appelée automatiquement par *jobs_new()*.
+ */
+int jobs_init(void)
+{
+    if (initialized)
+        return 0;
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = sigchld_handler;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    if (sigaction(SIGCHLD, &sa, NULL) != 0)
+    {
+        perror("sigaction");
+        return -1;
+    }
+    initialized = 1;
+    return 0;
+}
+
+/** @brief Fonction d'installation d'une fonction de récupération supplémentaire.
+ * @param reaper Fonction "async-signal-safe" appelée par le gestionnaire de SIGCHLD, NULL pour aucune.
+ * @details Permet à un mécanisme de lancement dont les processus ne sont pas des fils du shell de transmettre leurs changements d'état
+ *    via *jobs_record()* : il lui suffit d'envoyer SIGCHLD au shell.
+ */
+void jobs_set_reaper(void (*reaper)(void))
+{
+    sigset_t old;
+    jobs_block(&old);
+    extra_reaper = reaper;
+    jobs_unblock(&old);
+}
+
+/** @brief Fonction de blocage de SIGCHLD.
+ * @param old Masque de signaux à sauvegarder (pour *jobs_unblock()*).
+ * @details Le lancement d'un processus et son enregistrement via *jobs_add_process()* doivent se faire SIGCHLD bloqué,
+ *    sinon le fils pourrait être récupéré avant d'être connu de la table.
+ */
+void jobs_block(sigset_t *old)
+{
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &set, old);
+}
+
+/** @brief Fonction de restauration du masque de signaux sauvegardé par *jobs_block()*.
+ * @param old Masque de signaux à restaurer.
+ */
+void jobs_unblock(const sigset_t *old)
+{
+    sigprocmask(SIG_SETMASK, old, NULL);
+}
+
+/** @brief Attente d'un SIGCHLD (à appeler SIGCHLD bloqué, avec le masque sauvegardé par *jobs_block()*). */
+static void wait_sigchld(const sigset_t *old)
+{
+    sigset_t mask = *old;
+    sigdelset(&mask, SIGCHLD);
+    sigsuspend(&mask);
+}
+
+/** @brief Agrandissement de la table de hachage des PID (les cases supprimées sont éliminées). */
+static int pid_rehash(int capacity)
+{
+    int *slots = calloc(capacity, sizeof(*slots));
+    if (!slots)
+        return -1;
+    for (int i = 0; i < pid_capacity; ++i)
+    {
+        int slot = pid_slots[i];
+        if (slot <= 0)
+            continue;
+        int j = pid_hash(procs[slot - 1].pid, capacity);
+        while (slots[j] != 0)
+            j = (j + 1) & (capacity - 1);
+        slots[j] = slot;
+    }
+    free(pid_slots);
+    pid_slots = slots;
+    pid_capacity = capacity;
+    pid_filled = 0;
+    for (int i = 0; i < capacity; ++i)
+        pid_filled += (slots[i] != 0);
+    return 0;
+}
+
+/** @brief Retrait du processus d'indice *index* de la table de hachage des PID (sans effet s'il n'y est plus). */
+static void pid_unlink(int index)
+{
+    for (int s = pid_hash(procs[index].pid, pid_capacity); pid_slots[s] != 0; s = (s + 1) & (pid_capacity - 1))
+    {
+        if (pid_slots[s] == index + 1)
+        {
+            pid_slots[s] = PID_SLOT_DELETED;
+            return;
+        }
+    }
+}
+
+/** @brief Fonction de création d'un job.
+ * @param is_background 1 si le job est lancé en arrière-plan.
+ * @param command Texte de la commande (copié), peut être NULL.
+ * @return int Numéro du job (> 0), -1 en cas d'erreur.
+ * @details Le numéro attribué est le plus grand numéro utilisé + 1, comme dans les shells usuels.
+ */
+int jobs_new(int is_background, const char *command)
+{
+    if (jobs_init() != 0)
+        return -1;
+
+    sigset_t old;
+    jobs_block(&old);
+
+    int id = max_id + 1;
+    if (id >= jobs_capacity)
+    {
+        int capacity = jobs_capacity ? jobs_capacity * 2 : 16;
+        job_t *grown = realloc(jobs, capacity * sizeof(*grown));
+        if (!grown)
+        {
+            jobs_unblock(&old);
+            return -1;
+        }
+        memset(grown + jobs_capacity, 0, (capacity - jobs_capacity) * sizeof(*grown));
+        jobs = grown;
+        jobs_capacity = capacity;
+    }
+
+    job_t *job = &jobs[id];
+    memset(job, 0, sizeof(*job));
+    job->id = id;
+    job->first = -1;
+    job->last = -1;
+    job->is_background = is_background ? 1 : 0;
+    job->command = command ? strdup(command) : NULL;
+    max_id = id;
+
+    jobs_unblock(&old);
+    return id;
+}
+
+/** @brief Fonction d'ajout d'un processus à un job.
+ * @param id Numéro du job.
+ * @param pid PID du processus.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @details Doit être appelée avec SIGCHLD bloqué depuis la création du processus (voir *jobs_block()*).
+ *    Si le PID a été réutilisé par le système, le processus terminé qui le portait n'est plus accessible par *jobs_find_pid()*
+ *    (son statut reste disponible dans son job).
+ */
+int jobs_add_process(int id, pid_t pid)
+{
+    job_t *job = jobs_get(id);
+    if (!job || pid <= 0)
+        return -1;
+
+    sigset_t old;
+    jobs_block(&old);
+
+    // PID réutilisé : le nouveau processus doit être trouvé à la place de l'ancien
+    job_process_t *reused = jobs_find_pid(pid);
+    if (reused && reused->state == JOB_DONE)
+        pid_unlink(reused - procs);
+
+    // table de hachage chargée au plus à moitié (cases supprimées comprises)
+    if ((pid_filled + 1) * 2 > pid_capacity)
+    {
+        int capacity = pid_capacity ? pid_capacity : 64;
+        while ((procs_live + 1) * 4 > capacity) // au plus 1/4 de cases occupées après reconstruction
+            capacity *= 2;
+        if (pid_rehash(capacity) != 0)
+        {
+            jobs_unblock(&old);
+            return -1;
+        }
+    }
+
+    int index = procs_free;
+    if (index >= 0)
+        procs_free = procs[index].next;
+    else
+    {
+        if (procs_used == procs_capacity)
+        {
+            int capacity = procs_capacity ? procs_capacity * 2 : 16;
+            job_process_t *grown = realloc(procs, capacity * sizeof(*grown));
+            if (!grown)
+            {
+                jobs_unblock(&old);
+                return -1;
+            }
+            procs = grown;
+            procs_capacity = capacity;
+        }
+        index = procs_used++;
+    }
+
+    job_process_t *p = &procs[index];
+    memset(p, 0, sizeof(*p));
+    p->pid = pid;
+    p->job_id = id;
+    p->next = -1;
+    p->state = JOB_RUNNING;
+    procs_live++;
+
+    if (job->last >= 0)
+        procs[job->last].next = index;
+    else
+        job->first = index;
+    job->last = index;
+    if (job->nalive++ == 0 && job->is_background)
+        active++;
+
+    int i = pid_hash(pid, pid_capacity);
+    while (pid_slots[i] > 0)
+        i = (i + 1) & (pid_capacity - 1);
+    if (pid_slots[i] == 0)
+        pid_filled++;
+    pid_slots[i] = index + 1;
+
+    jobs_unblock(&old);
+    return 0;
+}
+
+/** @brief Fonction de récupération d'un job par son numéro.
+ * @param id Numéro du job.
+ * @return job_t* Job, ou NULL s'il n'existe pas.
+ */
+job_t *jobs_get(int id)
+{
+    if (id <= 0 || id > max_id || jobs[id].id != id)
+        return NULL;
+    return &jobs[id];
+}
+
+/** @brief Fonction de récupération d'un processus par son indice.
+ * @param index Indice du processus (champs *first*, *last* et *next*).
+ * @return job_process_t* Processus, ou NULL si l'indice est invalide.
+ */
+job_process_t *jobs_process(int index)
+{
+    if (index < 0 || index >= procs_used || procs[index].pid == 0)
+        return NULL;
+    return &procs[index];
+}
+
+/** @brief Fonction de récupération du plus grand numéro de job utilisé.
+ * @return int Plus grand numéro de job, 0 si la table est vide.
+ * @details Permet de parcourir les jobs de 1 à *jobs_max_id()* via *jobs_get()*. C'est aussi le job "courant" (%+).
+ */
+int jobs_max_id(void)
+{
+    return max_id;
+}
+
+/** @brief Fonction de récupération du nombre de jobs d'arrière-plan non terminés.
+ * @return int Nombre de jobs d'arrière-plan en cours ou stoppés.
+ */
+int jobs_active_count(void)
+{
+    return active;
+}
+
+/** @brief Fonction d'attente d'une place pour un nouveau job d'arrière-plan.
+ * @param limit Nombre maximal de jobs d'arrière-plan en cours d'exécution (0 : illimité).
+ * @return int 0 quand moins de *limit* jobs d'arrière-plan s'exécutent.
+ * @details Le shell est suspendu (sigsuspend) jusqu'à la fin d'un job d'arrière-plan. Les jobs stoppés ne sont pas comptés :
+ *    ils ne se termineront pas d'eux-mêmes et bloqueraient le shell indéfiniment.
+ */
+int jobs_wait_slot(int limit)
+{
+    if (limit <= 0)
+        return 0;
+    sigset_t old;
+    jobs_block(&old);
+    while (active - stopped >= limit)
+        wait_sigchld(&old);
+    jobs_unblock(&old);
+    return 0;
+}
+
+/** @brief Fonction d'attente d'un processus.
+ * @param pid PID du processus.
+ * @return int 0 si le processus est terminé ou stoppé, -1 s'il n'est pas dans la table.
+ * @details Le shell est suspendu (sigsuspend) jusqu'à ce que le gestionnaire de SIGCHLD change l'état du processus.
+ */
+int jobs_wait_pid(pid_t pid)
+{
+    sigset_t old;
+    jobs_block(&old);
+    job_process_t *p = jobs_find_pid(pid);
+    if (!p)
+    {
+        jobs_unblock(&old);
+        return -1;
+    }
+    while (p->state == JOB_RUNNING)
+        wait_sigchld(&old);
+    jobs_unblock(&old);
+    return 0;
+}
+
+/** @brief Fonction d'attente d'un job.
+ * @param id Numéro du job.
+ * @return int 0 si tous les processus du job sont terminés ou si l'un d'eux est stoppé, -1 si le job n'existe pas.
+ */
+int jobs_wait(int id)
+{
+    sigset_t old;
+    jobs_block(&old);
+    job_t *job = jobs_get(id);
+    if (!job)
+    {
+        jobs_unblock(&old);
+        return -1;
+    }
+    while (job->nalive > 0 && job->nstopped == 0)
+        wait_sigchld(&old);
+    jobs_unblock(&old);
+    return 0;
+}
+
+/** @brief Fonction de conversion d'un statut brut (wait4) en code de retour du shell.
+ * @param status Statut brut.
+ * @return int Code de sortie, ou 128 + numéro du signal.
+ */
+int jobs_exit_code(int status)
+{
+    if (WIFEXITED(status))
+        return WEXITSTATUS(status);
+    if (WIFSIGNALED(status))
+        return 128 + WTERMSIG(status);
+    if (WIFSTOPPED(status))
+        return 128 + WSTOPSIG(status);
+    return 1;
+}
+
+/** @brief Fonction de calcul du code de retour d'un job.
+ * @param id Numéro du job.
+ * @return int Code de retour du dernier processus du job (128 + signal s'il a été tué ou stoppé), -1 si le job n'existe pas.
+ */
+int jobs_status(int id)
+{
+    job_t *job = jobs_get(id);
+    if (!job || job->last < 0)
+        return -1;
+    return jobs_exit_code(procs[job->last].status);
+}
+
+/** @brief Fonction d'envoi d'un signal à tous les processus non terminés d'un job.
+ * @param id Numéro du job.
+ * @param sig Signal à envoyer.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @details Si *sig* est SIGCONT, les processus stoppés sont considérés comme repris.
+ */
+int jobs_signal(int id, int sig)
+{
+    job_t *job = jobs_get(id);
+    if (!job)
+        return -1;
+
+    sigset_t old;
+    jobs_block(&old);
+    int ret = 0;
+    for (int i = job->first; i >= 0; i = procs[i].next)
+    {
+        job_process_t *p = &procs[i];
+        if (p->state == JOB_DONE)
+            continue;
+        if (kill(p->pid, sig) != 0)
+            ret = -1;
+        else if (sig == SIGCONT && p->state == JOB_STOPPED)
+        {
+            // WCONTINUED le signalera aussi : record_status ignore alors le doublon
+            p->state = JOB_RUNNING;
+            add_stopped(job, -1);
+        }
+    }
+    jobs_unblock(&old);
+    return ret;
+}
+
+/** @brief Fonction de suppression d'un job et de ses processus.
+ * @param id Numéro du job.
+ * @details Les processus non terminés ne sont plus suivis (ils ne deviennent pas des zombies : le gestionnaire de SIGCHLD les récupère toujours).
+ */
+void jobs_remove(int id)
+{
+    job_t *job = jobs_get(id);
+    if (!job)
+        return;
+
+    sigset_t old;
+    jobs_block(&old);
+
+    for (int i = job->first; i >= 0;)
+    {
+        int next = procs[i].next;
+        pid_unlink(i);
+        procs[i].pid = 0;
+        procs[i].next = procs_free;
+        procs_free = i;
+        procs_live--;
+        i = next;
+    }
+
+    // retrait de la liste des jobs terminés non signalés
+    if (job->nalive == 0 && job->is_background)
+    {
+        for (volatile sig_atomic_t *link = &done_head; *link; link = &jobs[*link].done_next)
+        {
+            if (*link == id)
+            {
+                *link = job->done_next;
+                done_count--;
+                break;
+            }
+        }
+    }
+    else if (job->is_background)
+    {
+        active--;
+        if (job->nstopped > 0)
+            stopped--;
+    }
+
+    free(job->command);
+    memset(job, 0, sizeof(*job));
+    while (max_id > 0 && jobs[max_id].id == 0)
+        max_id--;
+
+    jobs_unblock(&old);
+}
+
+/** @brief Fonction de suppression de tous les jobs.
+ * @details Utilisée dans un fils du shell (commande intégrée d'un pipeline) : les jobs du shell ne sont pas ses fils,
+ *    il ne doit ni les attendre ni les reprendre.
+ */
+void jobs_clear(void)
+{
+    for (int id = max_id; id > 0; --id)
+        jobs_remove(id);
+}
+
+/** @brief Fonction de passage d'un job en avant-plan ou en arrière-plan.
+ * @param id Numéro du job.
+ * @param is_background 1 pour l'arrière-plan, 0 pour l'avant-plan.
+ * @param command Texte de la commande à mémoriser si le job n'en a pas encore, peut être NULL.
+ * @return int 0 en cas de succès, -1 si le job n'existe pas.
+ */
+int jobs_set_background(int id, int is_background, const char *command)
+{
+    job_t *job = jobs_get(id);
+    if (!job)
+        return -1;
+
+    sigset_t old;
+    jobs_block(&old);
+    is_background = is_background ? 1 : 0;
+    if (job->is_background != is_background && job->nalive > 0)
+    {
+        active += is_background ? 1 : -1;
+        if (job->nstopped > 0)
+            stopped += is_background ? 1 : -1;
+    }
+    job->is_background = is_background;
+    if (!job->command && command)
+        job->command = strdup(command);
+    jobs_unblock(&old);
+    return 0;
+}
+
+/** @brief Fonction de description de l'état d'un job ("En cours", "Stoppé", "Fini", "Sortie 3", ...).
+ * @param id Numéro du job.
+ * @param buf Tampon de destination.
+ * @param size Taille du tampon.
+ * @return const char* *buf*.
+ */
+const char *jobs_describe(int id, char *buf, size_t size)
+{
+    job_t *job = jobs_get(id);
+    if (!job)
+        snprintf(buf, size, "Inconnu");
+    else if (job->nstopped > 0)
+        snprintf(buf, size, "Stoppé");
+    else if (job->nalive > 0)
+        snprintf(buf, size, "En cours d'exécution");
+    else
+    {
+        int status = job->last >= 0 ? procs[job->last].status : 0;
+        if (WIFSIGNALED(status))
+            snprintf(buf, size, "Tué (signal %d)", WTERMSIG(status));
+        else if (WEXITSTATUS(status) != 0)
+            snprintf(buf, size, "Sortie %d", WEXITSTATUS(status));
+        else
+            snprintf(buf, size, "Fini");
+    }
+    return buf;
+}
+
+/** @brief Fonction de signalement des jobs d'arrière-plan terminés.
+ * @param fd Descripteur sur lequel afficher "[n] Fini commande", ou -1 pour ne rien afficher.
+ * @return int Nombre de jobs signalés.
+ * @details Les jobs signalés sont supprimés de la table. Seuls les jobs terminés depuis le dernier appel sont parcourus.
+ */
+int jobs_notify(int fd)
+{
+    sigset_t old;
+    jobs_block(&old);
+    int id = done_head;
+    done_head = 0;
+    done_count = 0;
+    jobs_unblock(&old);
+
+    int n = 0;
+    char state[64];
+    while (id != 0)
+    {
+        job_t *job = &jobs[id];
+        int next = job->done_next;
+        job->done_next = 0;
+        if (fd >= 0)
+            dprintf(fd, "[%d]%c  %-24s%s\n", id, id == max_id ? '+' : ' ', jobs_describe(id, state, sizeof state),
+                    job->command ? job->command : "");
+        jobs_remove(id);
+        n++;
+        id = next;
+    }
+    return n;
+}
+
+/** @brief Fonction de suppression des jobs d'arrière-plan terminés les plus anciens, sans signalement.
+ * @param keep Nombre de jobs terminés conservés (les derniers terminés).
+ * @return int Nombre de jobs supprimés.
+ * @details Utilisée en mode non interactif, où *jobs_notify()* n'est pas appelée : les statuts restent disponibles pour "wait",
+ *    mais la table ne grossit pas indéfiniment. La liste n'est parcourue que lorsqu'elle dépasse 2 * *keep* jobs.
+ */
+int jobs_prune(int keep)
+{
+    if (keep < 0)
+        keep = 0;
+    sigset_t old;
+    jobs_block(&old);
+    if (done_count <= 2 * keep)
+    {
+        jobs_unblock(&old);
+        return 0;
+    }
+    // les *keep* premiers de la liste (les plus récents) sont conservés, la suite en est détachée
+    volatile sig_atomic_t *link = &done_head;
+    for (int i = 0; i < keep && *link; ++i)
+        link = &jobs[*link].done_next;
+    int id = *link;
+    *link = 0;
+    done_count = keep;
+    jobs_unblock(&old);
+
+    int n = 0;
+    while (id != 0)
+    {
+        int next = jobs[id].done_next;
+        jobs[id].done_next = 0;
+        jobs_remove(id);
+        n++;
+        id = next;
+    }
+    return n;
+}
@@ -5,15 +5,21 @@
  * @date 2025-26
  * @details Ce fichier contient la fonction main de l'exécutable. Elle gère la boucle principale du shell,
  *   incluant l'affichage du prompt, la lecture de la ligne de commande, le parsing et l'exécution.
+ *   Le shell s'utilise de manière interactive, sur un fichier de script ("minishell script.sh") ou sur une chaîne ("minishell -c 'ligne'").
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <unistd.h>
 
 #include "parser.h"
 #include "processus.h"
 #include "builtins.h"
+#include "jobs.h"
+#include "input.h"
+#include "expand.h"
 
 /** @brief Affiche le prompt du shell.
  * @details Affiche le prompt "$ " et force l'affichage immédiat avec fflush.
@@ -26,60 +32,127 @@ void prompt()
 }
 
 /** @brief Fonction principale du shell.
- * @param argc Nombre d'arguments (non utilisé).
- * @param argv Tableau des arguments (non utilisé).
- * @return int Code de retour du programme. Ce code pourrait être le code de retour du dernier processus exécuté (optionnel).
+ * @param argc Nombre d'arguments.
+ * @param argv Tableau des arguments : "minishell", "minishell script" ou "minishell -c 'ligne de commande'".
+ * @return int Code de retour de la dernière commande exécutée, 2 en cas d'utilisation incorrecte, 127 si le script est introuvable.
  * @details Cette fonction gère la boucle principale du shell:
- * - Affiche le prompt
+ * - Signale les jobs d'arrière-plan terminés (mode interactif)
+ * - Affiche le prompt (mode interactif)
  * - Lit la ligne de commande
  * - Parse la ligne de commande
  * - Exécute les commandes
+ * Le shell est interactif lorsqu'il lit son entrée standard et que celle-ci est un terminal. Sinon (script, "-c", tube, fichier redirigé),
+ * aucun prompt n'est affiché et l'entrée est lue par blocs ou projetée en mémoire (voir input.h).
  * En cas d'erreur lors de l'exécution, un message est affiché sur stderr et la boucle continue.
  * Le shell se termine proprement en cas d'EOF (Ctrl+D) ou d'erreur fatale.
  */
 int main(int argc, char *argv[])
 {
-    (void)argc; // Pour éviter les warnings inutilisés
-    (void)argv; // Pour éviter les warnings inutilisés
     // Initialisation des structures nécessaires
     command_line_t cmdl;
+    input_t in;
+    int interactive = 0;
+
+    // Choix de l'entrée : chaîne (-c), fichier de script ou entrée standard
+    if (argc >= 2 && strcmp(argv[1], "-c") == 0)
+    {
+        if (argc < 3)
+        {
+            fprintf(stderr, "minishell: -c : l'option nécessite un argument\n");
+            return 2;
+        }
+        input_open_string(&in, argv[2]);
+        // "minishell -c 'ligne' nom a b" : $0 = nom, $1 = a, $2 = b
+        if (argc > 3)
+            expand_set_positional(argc - 3, argv + 3);
+    }
+    else if (argc >= 2)
+    {
+        if (input_open_file(&in, argv[1]) != 0)
+        {
+            fprintf(stderr, "minishell: %s: %s\n", argv[1], strerror(errno));
+            return 127;
+        }
+        // "minishell script a b" : $0 = script, $1 = a, $2 = b
+        expand_set_positional(argc - 1, argv + 1);
+    }
+    else
+    {
+        if (input_open_fd(&in, STDIN_FILENO) != 0)
+        {
+            perror("minishell");
+            return 2;
+        }
+        interactive = isatty(STDIN_FILENO);
+    }
+    set_interactive(interactive);
+
+    // Choix du mécanisme de lancement des commandes externes (fork, posix_spawn, zygote)
+    const char *backend_name = getenv("MINISHELL_SPAWN");
+    if (backend_name)
+    {
+        spawn_backend_t backend;
+        if (parse_spawn_backend(backend_name, &backend) != 0)
+            fprintf(stderr, "MINISHELL_SPAWN: mécanisme inconnu '%s' (fork, posix_spawn, zygote)\n", backend_name);
+        else if (set_spawn_backend(backend) != 0)
+            fprintf(stderr, "MINISHELL_SPAWN: démarrage de '%s' impossible\n", backend_name);
+    }
+
+    // Récupération des processus fils par le gestionnaire de SIGCHLD
+    jobs_init();
+    init_command_line(&cmdl);
 
     // Boucle principale du shell
     while (1)
     {
-        // Initialisation de la structure de ligne de commande
-        // On s'assure ici que tous les champs sont remis à zéro ou à leur valeur par défaut
-        init_command_line(&cmdl);
-        prompt();
-
-        // Lecture de la ligne de commande
-        if (fgets(cmdl.command_line, sizeof(cmdl.command_line), stdin) == NULL)
+        // Signalement des jobs d'arrière-plan terminés (en mode non interactif, les derniers restent disponibles pour "wait")
+        if (interactive)
         {
-            // EOF ou erreur de lecture (provoqué par exemple par Ctrl+D)
-            processus_t exit_cmd;
-            init_processus(&exit_cmd);
-            exit_cmd.argv[0] = "exit";
-            builtin_exit(&exit_cmd);
+            jobs_notify(STDERR_FILENO);
+            prompt();
         }
-        // Suppression du saut de ligne final conservé par fgets
-        if (strlen(cmdl.command_line) > 0 && cmdl.command_line[strlen(cmdl.command_line) - 1] == '\n')
+        else
+            jobs_prune(JOBS_KEEP_DONE);
+
+        // Lecture de la ligne de commande (sans copie : la ligne pointe dans le tampon du lecteur)
+        const char *line;
+        ssize_t len = input_next_line(&in, &line);
+        if (len < 0)
         {
-            cmdl.command_line[strlen(cmdl.command_line) - 1] = '\0';
+            // EOF ou erreur de lecture (provoqué par exemple par Ctrl+D)
+            break;
         }
 
         // La ligne de commande est vide, on passe à la suivante
-        if (strlen(cmdl.command_line) == 0)
+        if (len == 0)
         {
             continue;
         }
 
+        // Remise à zéro de la structure de ligne de commande
+        // On s'assure ici que tous les champs sont remis à zéro ou à leur valeur par défaut
+        reset_command_line(&cmdl);
+
         // Parsing de la ligne de commande
-        if (parse_command_line(&cmdl, cmdl.command_line) != 0)
+        if (parse_command_line_n(&cmdl, line, len) != 0)
         {
-            fprintf(stderr, "Erreur lors de l'analyse de la ligne de commandes.\n");
+            if (interactive)
+                fprintf(stderr, "Erreur lors de l'analyse de la ligne de commandes.\n");
+            else
+                fprintf(stderr, "minishell: ligne %zu : erreur lors de l'analyse de la ligne de commandes.\n", in.line_no);
             continue;
         }
 
+        // Contenu des documents en ligne ("<<FIN") : lu sur les lignes suivantes, avant de savoir si c'est la dernière
+        if (cmdl.num_heredocs > 0 && read_heredocs(&cmdl, &in, interactive ? "> " : NULL) != 0)
+        {
+            fprintf(stderr, "Erreur lors de la lecture des documents en ligne.\n");
+            continue;
+        }
+
+        // Dernière ligne d'un script ou de -c : sa dernière commande peut remplacer le shell (voir launch_command_line())
+        cmdl.last_line = !interactive && input_at_end(&in);
+
         // Traitement de la ligne de commande
         if (launch_command_line(&cmdl) != 0)
         {
@@ -88,5 +161,8 @@ int main(int argc, char *argv[])
         }
     }
 
-    return 0;
+    input_close(&in);
+    if (interactive)
+        printf("\n");
+    return get_last_status();
 }
@@ -0,0 +1,197 @@
+/** @file output.c
+ * @brief Implementation of the buffered output of built-in commands
+ * @author Sofiane FETTAH
+ * @author Matthieu COMME
+ * @date 2025-26
+ * @details Implémentation des tampons de sortie des commandes intégrées.
+ *    Un seul tampon contient des octets en attente à un instant donné : passer à un autre descripteur vide d'abord les autres tampons,
+ *    ce qui conserve l'ordre des messages quand la sortie et l'erreur désignent le même fichier (terminal, 2>&1).
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#include "output.h"
+
+/** @brief Tampon de sortie d'un descripteur.
+ * @struct output_buffer_t
+ */
+typedef struct
+{
+    int fd;                          ///< Descripteur (-1 : tampon libre)
+    size_t len;                      ///< Octets en attente
+    char data[OUTPUT_BUFFER_SIZE];   ///< Octets en attente
+} output_buffer_t;
+
+static output_buffer_t buffers[OUTPUT_MAX_FDS] = {{.fd = -1}, {.fd = -1}, {.fd = -1}, {.fd = -1}};
+static int output_error = 0; ///< Une écriture a échoué depuis le dernier *output_flush_all()*
+
+/** @brief Ecriture complète d'un vecteur d'octets (reprise après EINTR et après une écriture partielle).
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ */
+static int write_all(int fd, struct iovec *iov, int count)
+{
+    while (count > 0)
+    {
+        ssize_t n = writev(fd, iov, count);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        while (count > 0 && (size_t)n >= iov->iov_len)
+        {
+            n -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0)
+        {
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+    return 0;
+}
+
+/** @brief Ecriture du contenu d'un tampon, suivi de *extra* octets (un seul *writev()*). */
+static void flush_buffer(output_buffer_t *b, const void *extra, size_t extra_len)
+{
+    struct iovec iov[2] = {{b->data, b->len}};
+    int count = (b->len > 0) ? 1 : 0;
+    if (extra_len > 0)
+        iov[count++] = (struct iovec){(void *)extra, extra_len};
+    if (count > 0 && write_all(b->fd, iov, count) != 0)
+        output_error = 1;
+    b->len = 0;
+}
+
+/** @brief Tampon de *fd* : les tampons des autres descripteurs sont d'abord vidés (ordre des messages conservé). */
+static output_buffer_t *get_buffer(int fd)
+{
+    output_buffer_t *found = NULL, *free_slot = NULL;
+    for (int i = 0; i < OUTPUT_MAX_FDS; ++i)
+    {
+        output_buffer_t *b = &buffers[i];
+        if (b->fd == fd)
+            found = b;
+        else
+        {
+            if (b->len > 0)
+                flush_buffer(b, NULL, 0);
+            if (!free_slot)
+                free_slot = b;
+        }
+    }
+    if (found)
+        return found;
+    free_slot->fd = fd;
+    return free_slot;
+}
+
+/** @brief Fonction d'écriture d'octets dans le tampon d'un descripteur.
+ * @param fd Descripteur de destination.
+ * @param data Octets à écrire.
+ * @param len Nombre d'octets.
+ * @details Si le tampon déborde, son contenu et *data* sont écrits ensemble par un seul *writev()*, sans copie de *data*.
+ */
+void output_write(int fd, const void *data, size_t len)
+{
+    if (fd < 0 || len == 0)
+        return;
+    output_buffer_t *b = get_buffer(fd);
+    if (b->len + len <= OUTPUT_BUFFER_SIZE)
+    {
+        memcpy(b->data + b->len, data, len);
+        b->len += len;
+    }
+    else
+        flush_buffer(b, data, len);
+}
+
+/** @brief Fonction d'écriture d'un caractère dans le tampon d'un descripteur.
+ * @param fd Descripteur de destination.
+ * @param c Caractère.
+ */
+void output_putc(int fd, char c)
+{
+    output_write(fd, &c, 1);
+}
+
+/** @brief Fonction d'écriture formatée (comme *dprintf()*) dans le tampon d'un descripteur.
+ * @param fd Descripteur de destination.
+ * @param format Format de *printf()*.
+ * @return int Nombre d'octets produits, -1 en cas d'erreur de formatage.
+ */
+int output_printf(int fd, const char *format, ...)
+{
+    if (fd < 0)
+        return -1;
+    output_buffer_t *b = get_buffer(fd);
+    size_t room = OUTPUT_BUFFER_SIZE - b->len;
+
+    va_list ap;
+    va_start(ap, format);
+    int n = vsnprintf(b->data + b->len, room, format, ap);
+    va_end(ap);
+    if (n < 0)
+        return -1;
+    if ((size_t)n < room)
+    {
+        b->len += n;
+        return n;
+    }
+
+    // pas assez de place : le texte est formaté à part puis écrit avec le tampon
+    char *tmp = malloc((size_t)n + 1);
+    if (!tmp)
+    {
+        output_error = 1;
+        return -1;
+    }
+    va_start(ap, format);
+    vsnprintf(tmp, (size_t)n + 1, format, ap);
+    va_end(ap);
+    output_write(fd, tmp, n);
+    free(tmp);
+    return n;
+}
+
+/** @brief Fonction d'écriture du tampon d'un descripteur.
+ * @param fd Descripteur.
+ * @return int 0 en cas de succès, -1 si une écriture a échoué.
+ */
+int output_flush(int fd)
+{
+    int before = output_error;
+    output_error = 0;
+    for (int i = 0; i < OUTPUT_MAX_FDS; ++i)
+        if (buffers[i].fd == fd && buffers[i].len > 0)
+            flush_buffer(&buffers[i], NULL, 0);
+    int failed = output_error;
+    output_error = before || failed;
+    return failed ? -1 : 0;
+}
+
+/** @brief Fonction d'écriture de tous les tampons.
+ * @return int 0 en cas de succès, -1 si une écriture a échoué depuis le dernier appel.
+ * @details Appelée au retour de chaque commande intégrée, avant que ses descripteurs ne soient fermés.
+ */
+int output_flush_all(void)
+{
+    for (int i = 0; i < OUTPUT_MAX_FDS; ++i)
+    {
+        if (buffers[i].len > 0)
+            flush_buffer(&buffers[i], NULL, 0);
+        buffers[i].fd = -1; // le descripteur peut être fermé puis réutilisé pour un autre fichier
+    }
+    int failed = output_error;
+    output_error = 0;
+    return failed ? -1 : 0;
+}
@@ -7,783 +7,793 @@
  */
 
 #include <string.h>
-#include <ctype.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <limits.h>
 
 #include "parser.h"
 #include "processus.h"
-
-/** @brief Fonction de suppression des espaces inutiles au début et à la fin d'une chaîne de caractères.
- * @param str Chaîne de caractères à traiter.
- * @return int 0 en cas de succès, -1 en cas d'erreur.
+#include "expand.h"
+#include "input.h"
+
+/// Texte des opérateurs, indexé par token_type_t (les mots sont dans *cmdl->arena*)
+static const char *const token_text[] = {
+    [TOKEN_SEMICOLON] = ";",
+    [TOKEN_PIPE] = "|",
+    [TOKEN_PIPE_ALL] = "|&",
+    [TOKEN_OR] = "||",
+    [TOKEN_AND] = "&&",
+    [TOKEN_BACKGROUND] = "&",
+    [TOKEN_IN] = "<",
+    [TOKEN_OUT] = ">",
+    [TOKEN_APPEND] = ">>",
+    [TOKEN_DUP_IN] = "<&",
+    [TOKEN_DUP_OUT] = ">&",
+    [TOKEN_OUT_ALL] = "&>",
+    [TOKEN_APPEND_ALL] = "&>>",
+    [TOKEN_BANG] = "!",
+    [TOKEN_HEREDOC] = "<<",
+    [TOKEN_HEREDOC_STRIP] = "<<-",
+    [TOKEN_HERESTRING] = "<<<",
+};
+
+/** @brief Etat de l'analyseur lexical.
+ * @struct lexer_t
  */
-int trim(char *str)
+typedef struct
 {
-    if (!str) return -1;
-
-    // skip début (espaces, tabs, CR, LF)
-    char *start = str;
-    while (*start == ' ' || *start == '\t' || *start == '\r' || *start == '\n')
-        ++start;
-
-    if (start != str)
-        memmove(str, start, strlen(start) + 1);
-
-    // si chaîne vide après trim début
-    size_t len = strlen(str);
-    if (len == 0) return 0;
-
-    // trim fin (espaces, tabs, CR, LF)
-    char *end = str + len - 1;
-    while (end >= str && (*end == ' ' || *end == '\t' || *end == '\r' || *end == '\n')) {
-        *end = '\0';
-        --end;
+    command_line_t *cmdl; ///< Ligne de commande à remplir
+    arena_t *arena;       ///< Arène où les mots sont écrits (*cmdl->arena*)
+    const char *end;      ///< Fin de la ligne source
+    char *word;           ///< Début du mot en cours (il se termine en *arena->ptr*), NULL entre deux mots
+    uint8_t expand;       ///< Le mot en cours contient des marqueurs de substitution (voir expand.h)
+    uint8_t quoted;       ///< Le mot en cours contient des guillemets
+    uint8_t delimiter;    ///< Le prochain mot est le délimiteur d'un document en ligne : '$' y est littéral
+} lexer_t;
+
+/** @brief Agrandissement des tableaux *tokens* et *token_types* (capacité doublée, dans l'arène à la suite des mots).
+ * @return int 0 en cas de succès, -1 en cas d'erreur d'allocation.
+ * @details Appelée entre deux mots uniquement : aucun mot n'est en construction dans l'arène.
+ */
+static int lex_grow_tokens(lexer_t *lx)
+{
+    command_line_t *cmdl = lx->cmdl;
+    unsigned int capacity = cmdl->tokens_capacity ? 2 * cmdl->tokens_capacity : 32;
+    char **tokens = arena_alloc(lx->arena, capacity * sizeof *tokens);
+    uint8_t *types = arena_alloc(lx->arena, capacity);
+    if (!tokens || !types)
+    {
+        perror("arena_alloc");
+        return -1;
     }
+    if (cmdl->num_tokens > 0)
+    {
+        memcpy(tokens, cmdl->tokens, cmdl->num_tokens * sizeof *tokens);
+        memcpy(types, cmdl->token_types, cmdl->num_tokens);
+    }
+    cmdl->tokens = tokens;
+    cmdl->token_types = types;
+    cmdl->tokens_capacity = capacity;
     return 0;
 }
 
-/** @brief Fonction de nettoyage d'une chaîne de caractères en supprimant les doublons d'espaces.
- * @param str Chaîne de caractères à nettoyer.
- * @return int 0 en cas de succès, -1 en cas d'erreur.
- * @details Cette fonction supprime les doubles espaces, mais respecte les guillemets.
- *    (Sinon, les espaces à l'intérieur des quotes seraient modifiés et les arguments "quotés" seraient cassés.)
+/** @brief Ajout d'un token au tableau de la ligne de commande, en gardant une place pour le token TOKEN_END final.
+ * @return int 0 en cas de succès, -1 en cas d'erreur d'allocation.
  */
-int clean(char *str)
+static int lex_push(lexer_t *lx, token_type_t type, char *text)
 {
-    if (!str) return -1;
-    
-    char *r = str;  // lecture
-    char *w = str;  // écriture
-    int in_space = 0;
-    int in_quotes = 0;
-    char quote_char = 0;
-    
-    while (*r) {
-        // Gestion des guillemets
-        if ((*r == '"' || *r == '\'') && (r == str || *(r-1) != '\\')) {
-            if (!in_quotes) {
-                in_quotes = 1;
-                quote_char = *r;
-            } else if (*r == quote_char) {
-                in_quotes = 0;
-                quote_char = 0;
-            }
-            *w++ = *r++;
-            in_space = 0;
-            continue;
-        }
-        
-        // à l'intérieur, on copie tout
-        if (in_quotes) {
-            *w++ = *r++;
-            continue;
-        }
-        
-        // à l'extérieur, on clean
-        if (*r == ' ' || *r == '\t') {
-            if (!in_space) {
-                *w++ = ' ';
-                in_space = 1;
-            }
-            r++;
-        } else {
-            *w++ = *r++;
-            in_space = 0;
-        }
-    }
-    
-    *w = '\0';
+    command_line_t *cmdl = lx->cmdl;
+    if (cmdl->num_tokens + 2 > cmdl->tokens_capacity && lex_grow_tokens(lx) != 0)
+        return -1;
+    cmdl->tokens[cmdl->num_tokens] = text;
+    cmdl->token_types[cmdl->num_tokens] = type;
+    cmdl->num_tokens++;
     return 0;
 }
 
-/** @brief Fonction d'ajout de caractères d'espacement autour de tous les caractères de la chaîne *s* présents dans *str*.
- * @param str Chaîne de caractères à traiter.
- * @param s Chaîne de caractères contenant les séparateurs.
- * @param max Taille maximale de la chaîne *str*.
- * @return int 0 en cas de succès, -1 en cas d'erreur (dépassement de taille).
- * @details Cette fonction ajoute un espace avant et après chaque occurrence d'un caractère de *s* dans *str*.
- *    Si l'ajout d'espaces dépasse la taille maximale *max*, la fonction retourne -1.
+/** @brief Réservation de *more* octets après le mot en cours dans l'arène (le mot est déplacé si le bloc est plein).
+ * @return int 0 en cas de succès, -1 en cas d'erreur d'allocation.
  */
-int separate_s(char *str, char *s, size_t max)
+static int lex_reserve(lexer_t *lx, size_t more)
 {
-    if (str == NULL || s == NULL)
-        return -1;
-
-    int len = strlen(str);
-    int nb_s = 0;
-
-    // compte le nombre de separate à effectuer
-    for (int i = 0; i < len; i++)
+    if ((size_t)(lx->arena->end - lx->arena->ptr) >= more)
+        return 0;
+    if (arena_extend(lx->arena, &lx->word, more) != 0)
     {
-        if (strchr(s, str[i]) != NULL)
-            nb_s++;
+        perror("arena_extend");
+        return -1;
     }
+    return 0;
+}
 
-    if (nb_s == 0) // rien à faire
+/** @brief Début d'un mot (éventuellement vide, comme "") s'il n'y en a pas en cours.
+ * @return int 0 en cas de succès, -1 en cas d'erreur d'allocation.
+ */
+static int lex_start_word(lexer_t *lx)
+{
+    if (lx->word)
         return 0;
-
-    size_t new_len = len + (nb_s * 2);
-
-    if (new_len + 1 > max) // dépassement de la taille maximale
+    if (lex_reserve(lx, 1) != 0)
         return -1;
-
-    // remplissage de droite à gauche
-    int read_i = len - 1;
-    int write_i = new_len - 1;
-
-    str[new_len] = '\0';
-
-    while (read_i >= 0)
-    {
-        char current_char = str[read_i];
-
-        // si le char courant est un séparateur
-        if (strchr(s, current_char) != NULL)
-        {
-            str[write_i--] = ' ';
-            str[write_i--] = current_char;
-            str[write_i--] = ' ';
-        }
-        else
-            str[write_i--] = current_char;
-
-        read_i--;
-    }
+    lx->word = lx->arena->ptr;
     return 0;
 }
 
-/** @brief Fonction de remplacement de toutes les occurrences de la sous-chaîne *s* par la sous-chaîne *t* dans la chaîne *str*.
- * @param str Chaîne de caractères à traiter.
- * @param s Sous-chaîne à remplacer.
- * @param t Sous-chaîne de remplacement.
- * @param max Taille maximale de la chaîne *str*.
- * @return int 0 en cas de succès, -1 en cas d'erreur (dépassement de taille).
- * @details Cette fonction remplace toutes les occurrences de la sous-chaîne *s* par la sous-chaîne *t* dans la chaîne *str*.
- *    Si le remplacement dépasse la taille maximale *max*, la fonction retourne -1.
+/** @brief Ajout d'un caractère littéral au mot en cours (qui est commencé si besoin).
+ * @return int 0 en cas de succès, -1 en cas d'erreur d'allocation.
+ * @details Un octet reste toujours libre après le mot pour son '\0'. Un octet égal à un marqueur de expand.h est précédé de EXPAND_CTL_ESC.
  */
-int replace(char *str, const char *s, const char *t, size_t max)
+static int lex_putc(lexer_t *lx, char c)
 {
-    char *pos = strstr(str, s);
-    if (!pos)
-    {
-        // printf("%s n'est pas inclus dans %s\n", s, str);
+    int escape = EXPAND_IS_CTL(c);
+    if (lex_reserve(lx, 2 + escape) != 0)
         return -1;
-    }
-    char *src = pos + strlen(s);
-    char *dst = pos + strlen(t);
-    int nb = strlen(src) + 1;                              // taille de la partie à déplacer
-    size_t new_size = strlen(str) - strlen(s) + strlen(t); // taille finale théorique
-    if (new_size > max)
+    if (!lx->word)
+        lx->word = lx->arena->ptr;
+    if (escape)
     {
-        nb = nb - (new_size - max);
+        *lx->arena->ptr++ = EXPAND_CTL_ESC;
+        lx->expand = 1;
     }
+    *lx->arena->ptr++ = c;
+    return 0;
+}
 
-    // printf("pos: '%s', src: '%s', dest: '%s'\n", pos, src, dst);
-    int nb_cp = strlen(t);
-    if (pos + nb_cp + 1 > str + max)
+/** @brief Fin du mot en cours, ajouté comme token TOKEN_WORD, ou TOKEN_WORD_EXPAND s'il contient des marqueurs (sans effet entre deux mots). */
+static int lex_end_word(lexer_t *lx)
+{
+    if (!lx->word)
+        return 0;
+    // un délimiteur entre guillemets est marqué comme tel (le document ne sera pas substitué)
+    if ((lx->expand || lx->delimiter) && lx->quoted)
     {
-        int diff = (pos + nb_cp + 1 - (str + max));
-        if (diff < 0)
-            diff = 0;
-        nb_cp -= diff;
+        if (lex_reserve(lx, 2) != 0)
+            return -1;
+        *lx->arena->ptr++ = EXPAND_CTL_QUOTE;
     }
-    if (dst < str + max && src < str + max)
-        memmove(dst, src, nb);
-    // printf("Après memmove: '%s'\n", str);
-    memcpy(pos, t, nb_cp);
-    return 0;
+    *lx->arena->ptr++ = '\0'; // la place est réservée par lex_start_word() et lex_putc()
+    char *word = lx->word;
+    token_type_t type = lx->expand ? TOKEN_WORD_EXPAND : TOKEN_WORD;
+    lx->word = NULL;
+    lx->expand = lx->quoted = lx->delimiter = 0;
+    return lex_push(lx, type, word);
 }
 
-/** @brief Fonction de substitution des variables d'environnement dans une chaîne de caractères.
- * @param str Chaîne de caractères à traiter.
- * @param max Taille maximale de la chaîne *str*.
- * @return int 0 en cas de succès, -1 en cas d'erreur (dépassement de taille).
- * @details Cette fonction remplace toutes les occurrences de variables d'environnement au format $VAR ou ${VAR} par leur valeur dans la chaîne *str*.
- *    Si une variable n'existe pas, elle est remplacée par une chaîne vide.
- *    Si le remplacement dépasse la taille maximale *max*, la fonction retourne -1.
- */
-int substenv(char *str, size_t max)
+/** @brief Fin du mot en cours suivie d'un opérateur. */
+static int lex_operator(lexer_t *lx, token_type_t type)
 {
-    if (str == NULL || max == 0)
+    if (lex_end_word(lx) != 0)
         return -1;
+    return lex_push(lx, type, (char *)token_text[type]);
+}
 
-    // buffer temporaire pour éviter les écrasements pendant la construction
-    char *res = (char *)malloc(max);
-    if (res == NULL)
+/** @brief Numéro de descripteur [p, q[ d'une redirection, ajouté comme token TOKEN_IO_NUMBER (appelée entre deux mots). */
+static int lex_io_number(lexer_t *lx, const char *p, const char *q)
+{
+    size_t len = q - p;
+    if (lex_reserve(lx, len + 1) != 0)
         return -1;
+    char *number = lx->arena->ptr;
+    memcpy(number, p, len);
+    number[len] = '\0';
+    lx->arena->ptr += len + 1;
+    return lex_push(lx, TOKEN_IO_NUMBER, number);
+}
+
+/** @brief Marquage d'un paramètre $NOM ou ${NOM} dans le mot en cours, substitué au lancement de la commande.
+ * @param p Pointeur sur le '$'.
+ * @param quoted Le paramètre est entre guillemets doubles : sa valeur ne sera pas découpée en mots.
+ * @return const char* Position qui suit le paramètre, NULL en cas d'erreur.
+ * @details Un '$' qui n'est pas suivi d'un nom (ou d'un "${" non fermé) est conservé.
+ *    Seul le nom est recopié, entre EXPAND_CTL_VAR (ou EXPAND_CTL_QVAR) et EXPAND_CTL_END : la valeur est lue par *expand_processus()*.
+ */
+static const char *lex_variable(lexer_t *lx, const char *p, int quoted)
+{
+    const char *name = p + 1, *name_end;
+    int braces = 0;
+    if (name < lx->end && *name == '{')
+    {
+        name_end = memchr(name + 1, '}', lx->end - name - 1);
+        if (!name_end)
+            return lex_putc(lx, '$') == 0 ? p + 1 : NULL;
+        braces = 1;
+        name++;
+    }
+    else
+        name_end = name + expand_name_length(name, lx->end - name);
+    const char *next = braces ? name_end + 1 : name_end;
 
-    unsigned int r = 0; // index de lecture dans str
-    unsigned int w = 0; // index d'écriture dans res
+    size_t len = name_end - name;
+    if (len == 0)
+        return lex_putc(lx, '$') == 0 ? next : NULL;
 
-    while (str[r] != '\0')
+    // un nom qui contient un marqueur ne désigne aucun paramètre : substitué par une chaîne vide
+    for (size_t i = 0; i < len; ++i)
     {
-        if (str[r] == '$')
-        {
-            int var_start = r + 1;
-            int var_end = var_start;
-            int is_bracket = 0;
+        if (EXPAND_IS_CTL(name[i]))
+            return next;
+    }
 
-            // si ${VAR}
-            if (str[var_start] == '{')
-            {
-                is_bracket = 1;
-                var_start++;
-                var_end = var_start;
+    // marqueur, nom et fin du nom (suivis d'un octet libre pour le '\0')
+    if (lex_reserve(lx, len + 3) != 0)
+        return NULL;
+    if (!lx->word)
+        lx->word = lx->arena->ptr;
+    char *w = lx->arena->ptr;
+    *w++ = quoted ? EXPAND_CTL_QVAR : EXPAND_CTL_VAR;
+    memcpy(w, name, len);
+    w += len;
+    *w++ = EXPAND_CTL_END;
+    lx->arena->ptr = w;
+    lx->expand = 1;
+    return next;
+}
 
-                // cherche la fin de l'accolade
-                while (str[var_end] != '\0' && str[var_end] != '}')
-                    var_end++;
+/** @brief Fonction d'analyse lexicale d'une ligne de commande.
+ * @param cmdl Pointeur vers la structure de ligne de commande à remplir (*tokens*, *token_types* et *arena*).
+ * @param line Début de la ligne de commande (pas nécessairement terminée par '\0').
+ * @param len Longueur de la ligne.
+ * @return int Nombre de tokens, -1 en cas d'erreur (guillemet non fermé, erreur d'allocation).
+ * @details Un seul parcours de la ligne, par un automate à trois états (hors guillemets, entre '...', entre "...") :
+ *    - les espaces séparent les mots ; les opérateurs ; | |& || && & < > >> <& >& &> &>> << <<- <<< sont reconnus sans espace autour ("a|b", "x>f") ;
+ *    - des chiffres en début de mot collés à '<' ou '>' forment un token TOKEN_IO_NUMBER ("2>f", "3<&0" ; "a2>f" redirige "a2"),
+ *      "!" n'est un opérateur que s'il forme un mot à lui seul ;
+ *    - les guillemets sont retirés : rien n'est interprété entre '...', seuls \$ \` \" \\ et $VAR le sont entre "..." ;
+ *      hors guillemets, '\' protège le caractère suivant ;
+ *    - $VAR, ${VAR} et les paramètres $? $$ $! $# $0..$9 $@ $* sont marqués (token TOKEN_WORD_EXPAND) puis substitués au lancement
+ *      de la commande par *expand_processus()* ; hors guillemets, la valeur est alors découpée en mots ;
+ *    - le délimiteur qui suit "<<" ou "<<-" est littéral ('$' compris) ; s'il contenait des guillemets ("<<'FIN'"), il se termine par
+ *      EXPAND_CTL_QUOTE : le contenu du document ne sera pas substitué.
+ *    Un mot entre guillemets n'est jamais un opérateur ("'|'" est un argument). Les mots et les tableaux *tokens* et *token_types* (doublés quand ils sont pleins) sont écrits dans *cmdl->arena*
+ *    (son bloc initial, *cmdl->command_line*, suffit aux lignes courantes).
+ */
+int lex_command_line(command_line_t *cmdl, const char *line, size_t len)
+{
+    lexer_t lx = {.cmdl = cmdl, .arena = &cmdl->arena, .end = line + len};
+    const char *p = line;
+    cmdl->num_tokens = 0;
+    char quote = 0;
+    int r = 0;
 
-                if (str[var_end] != '}') // on annule si pas d'accolade fermante
-                {
-                    if (w + 1 >= max)
-                    {
-                        free(res);
-                        return -1;
-                    }
-                    res[w++] = str[r++];
-                    continue;
-                }
+    while (p < lx.end && r == 0)
+    {
+        char c = *p;
+        if (quote == '\'')
+        {
+            // entre apostrophes : tout est littéral
+            if (c == '\'')
+                quote = 0;
+            else
+                r = lex_putc(&lx, c);
+            p++;
+            continue;
+        }
+        if (quote == '"')
+        {
+            if (c == '"')
+            {
+                quote = 0;
+                p++;
             }
-            else // si $VAR
-            {    // on garde alphanumérique et underscore
-                while (isalnum(str[var_end]) || str[var_end] == '_')
-                    var_end++;
+            else if (c == '\\' && p + 1 < lx.end && strchr("$`\"\\\n", p[1]))
+            {
+                r = lex_putc(&lx, p[1]);
+                p += 2;
             }
-
-            int var_len = var_end - var_start;
-
-            // $ suivi d'un char non valide
-            if (var_len == 0)
+            else if (c == '$' && !lx.delimiter)
+                r = (p = lex_variable(&lx, p, 1)) ? 0 : -1;
+            else
             {
-                if (w + 1 >= max)
-                {
-                    free(res);
-                    return -1;
-                }
-                res[w++] = str[r++];
-                // si ${} vide
-                if (is_bracket && str[var_end] == '}')
-                    r = var_end + 1;
-
-                continue;
+                r = lex_putc(&lx, c);
+                p++;
             }
+            continue;
+        }
 
-            // récupère le nom de la variable
-            char var_name[256];
-            memcpy(var_name, str + var_start, var_len);
-            var_name[var_len] = '\0';
-
-            char *env_val = getenv(var_name);
-
-            // si la variable existe
-            if (env_val != NULL)
+        switch (c)
+        {
+        case ' ':
+        case '\t':
+        case '\r':
+        case '\n':
+            r = lex_end_word(&lx);
+            p++;
+            break;
+        case '\'':
+        case '"':
+            r = lex_start_word(&lx); // "" est un mot vide
+            lx.quoted = 1;
+            quote = c;
+            p++;
+            break;
+        case '\\':
+            lx.quoted |= lx.delimiter; // "<<\FIN" : délimiteur protégé, comme entre guillemets
+            r = lex_putc(&lx, p + 1 < lx.end ? p[1] : '\\');
+            p += (p + 1 < lx.end) ? 2 : 1;
+            break;
+        case '$':
+            if (lx.delimiter)
             {
-                int val_len = strlen(env_val);
-                if (w + val_len >= max)
-                {
-                    free(res);
-                    return -1;
-                }
-                strcpy(res + w, env_val);
-                w += val_len;
+                r = lex_putc(&lx, c);
+                p++;
+                break;
             }
-            // si la var existe pas, on fait rien
-
-            r = (is_bracket) ? var_end + 1 : var_end;
-        }
-        else // char normal
+            r = (p = lex_variable(&lx, p, 0)) ? 0 : -1;
+            break;
+        case ';':
+            r = lex_operator(&lx, TOKEN_SEMICOLON);
+            p++;
+            break;
+        case '|':
+            if (p + 1 < lx.end && (p[1] == '|' || p[1] == '&'))
+            {
+                r = lex_operator(&lx, p[1] == '|' ? TOKEN_OR : TOKEN_PIPE_ALL);
+                p += 2;
+            }
+            else
+            {
+                r = lex_operator(&lx, TOKEN_PIPE);
+                p++;
+            }
+            break;
+        case '&':
+            if (p + 1 < lx.end && p[1] == '&')
+            {
+                r = lex_operator(&lx, TOKEN_AND);
+                p += 2;
+            }
+            else if (p + 1 < lx.end && p[1] == '>')
+            {
+                int append = (p + 2 < lx.end && p[2] == '>');
+                r = lex_operator(&lx, append ? TOKEN_APPEND_ALL : TOKEN_OUT_ALL);
+                p += append ? 3 : 2;
+            }
+            else
+            {
+                r = lex_operator(&lx, TOKEN_BACKGROUND);
+                p++;
+            }
+            break;
+        case '<':
+        case '>':
+            // "<", "<&", "<<", "<<-", "<<<", ">", ">>", ">&"
+            if (c == '<' && p + 1 < lx.end && p[1] == '<')
+            {
+                int here = (p + 2 < lx.end && p[2] == '<') ? TOKEN_HERESTRING
+                           : (p + 2 < lx.end && p[2] == '-') ? TOKEN_HEREDOC_STRIP : TOKEN_HEREDOC;
+                r = lex_operator(&lx, here);
+                lx.delimiter = (here != TOKEN_HERESTRING);
+                p += (here == TOKEN_HEREDOC) ? 2 : 3;
+            }
+            else if (p + 1 < lx.end && p[1] == '&')
+            {
+                r = lex_operator(&lx, c == '<' ? TOKEN_DUP_IN : TOKEN_DUP_OUT);
+                p += 2;
+            }
+            else if (c == '>' && p + 1 < lx.end && p[1] == '>')
+            {
+                r = lex_operator(&lx, TOKEN_APPEND);
+                p += 2;
+            }
+            else
+            {
+                r = lex_operator(&lx, c == '<' ? TOKEN_IN : TOKEN_OUT);
+                p++;
+            }
+            break;
+        case '0':
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9':
         {
-            if (w + 1 >= max) // dépassement
+            // numéro de descripteur : chiffres en début de mot collés à '<' ou '>' ("2>f", "3<&0")
+            const char *q = p;
+            while (!lx.word && q < lx.end && *q >= '0' && *q <= '9')
+                q++;
+            if (!lx.word && q < lx.end && (*q == '<' || *q == '>'))
             {
-                free(res);
-                return -1;
+                r = lex_io_number(&lx, p, q);
+                p = q;
+                break;
+            }
+            r = lex_putc(&lx, c);
+            p++;
+            break;
+        }
+        case '!':
+            if (!lx.word && (p + 1 == lx.end || p[1] == ' ' || p[1] == '\t' || p[1] == '\r' || p[1] == '\n'))
+            {
+                r = lex_operator(&lx, TOKEN_BANG);
+                p++;
+                break;
             }
-            res[w++] = str[r++];
+            r = lex_putc(&lx, c);
+            p++;
+            break;
+        default:
+            r = lex_putc(&lx, c);
+            p++;
+            break;
         }
     }
-
-    res[w] = '\0';
-
-    strcpy(str, res);
-    free(res);
-    return 0;
+    if (r != 0)
+        return -1;
+    if (quote)
+    {
+        fprintf(stderr, "Erreur: guillemet '%c' non fermé\n", quote);
+        return -1;
+    }
+    if (lex_end_word(&lx) != 0)
+        return -1;
+    // token TOKEN_END final (lex_push a gardé sa place, sauf pour une ligne vide)
+    if (cmdl->tokens_capacity == 0 && lex_grow_tokens(&lx) != 0)
+        return -1;
+    cmdl->tokens[cmdl->num_tokens] = NULL;
+    cmdl->token_types[cmdl->num_tokens] = TOKEN_END;
+    return (int)cmdl->num_tokens;
 }
 
-/** @brief Fonction de découpage d'une chaîne de caractères en tokens selon un séparateur.
- * @param str Chaîne de caractères à découper. Attention, cette chaîne est modifiée par la fonction.
- * @param sep Caractère séparateur.
- * @param tokens Tableau de chaînes de caractères pour stocker les tokens extraits. Le tableau est terminé par un pointeur NULL.
- * @param max Taille maximale du tableau *tokens*, NULL compris.
- * @return int Nombre de tokens extraits, -1 en cas d'erreur (dépassement de taille).
- * @details Cette fonction découpe la chaîne *str* en tokens en utilisant le caractère *sep* comme séparateur.
- *    Les tokens extraits sont stockés dans le tableau *tokens*.
- *    Si le nombre de tokens dépasse la taille maximale *max*, la fonction retourne -1.
+/** @brief Numéro de descripteur écrit en chiffres ("2", "10").
+ * @return int Numéro, -1 si *s* n'est pas formé uniquement de chiffres ou dépasse INT_MAX.
  */
-int strcut(char* str, char sep, char** tokens, size_t max) {
-    if (!str || !tokens || max == 0) return -1;
-
-    size_t n = 0;
-    char* p = str;
-
-    // Découpe "in-place" : chaque token pointe dans la chaîne d'origine.
-    // Bug rencontré : on terminait un token en écrivant '\0' sur le séparateur (espace/tab/\n)
-    // sans avancer le pointeur de lecture. Résultat : la chaîne semblait finie après le 1er token
-    // (ex: seule la commande "printf" était lue, et ses arguments disparaissaient).
-
-    while (*p) {
-        // Sauter les séparateurs (soit le caractère sep, soit les espaces)
-        while (*p == sep) p++;
-        if (!*p) break;
-
-        if (n >= max - 1) {
-            fprintf(stderr, "Erreur: trop de tokens (max=%zu)\n", max);
-            tokens[n] = NULL;  // Assurer la terminaison NULL même en erreur
+static int fd_number(const char *s)
+{
+    if (!*s)
+        return -1;
+    long n = 0;
+    for (; *s; ++s)
+    {
+        if (*s < '0' || *s > '9')
             return -1;
-        }
-
-        char* out = p;
-        tokens[n] = out;
-        n++;
-
-        int in_quotes = 0;
-        char quote_char = 0;
-
-        while (*p) {
-            if (!in_quotes && *p == sep) break;
-
-            if (*p == '\\' && p[1] != '\0' && quote_char != '\'') {
-                // Hors quotes: le backslash échappe toujours le caractère suivant.
-                if (!in_quotes) {
-                    p++;
-                    *out++ = *p++;
-                    continue;
-                }
-
-                // Dans doubles quotes: échappement seulement pour $ ` " \\ et newline.
-                if (quote_char == '"') {
-                    char next = p[1];
-                    if (next == '$' || next == '`' || next == '"' || next == '\\' || next == '\n') {
-                        p++;
-                        *out++ = *p++;
-                        continue;
-                    }
-                }
-            }
-
-            if (*p == '"' || *p == '\'') {
-                if (!in_quotes) {
-                    in_quotes = 1;
-                    quote_char = *p++;
-                    continue;
-                } else if (*p == quote_char) {
-                    in_quotes = 0;
-                    quote_char = 0;
-                    p++;
-                    continue;
-                }
-            }
-
-            *out++ = *p++;
-        }
-
-        if (in_quotes) {
-            fprintf(stderr, "Erreur: guillemet '%c' non fermé\n", quote_char);
+        n = n * 10 + (*s - '0');
+        if (n > INT_MAX)
             return -1;
-        }
-
-        char stopped = *p;
-        *out = '\0';
-        if (stopped != '\0') {
-            p++;
-        }
-        while (*p == sep) p++;
     }
-
-    tokens[n] = NULL;
     return (int)n;
 }
 
 /** @brief Fonction d'analyse d'une ligne de commande.
  * @param cmdl Pointeur vers la structure de ligne de commande à remplir.
  * @param line Chaîne de caractères contenant la ligne de commande à analyser.
- * @return int 0 en cas de succès, -1 en cas d'erreur (ligne trop longue, trop de commandes, etc.).
+ * @return int 0 en cas de succès, -1 en cas d'erreur (syntaxe, allocation, etc.).
  * @details Cette fonction analyse la ligne de commande *line* et remplit la structure *cmdl* avec les informations extraites.
- *    La ligne de commande est copiée dans *cmdl->command_line* dans la limite de MAX_CMD_LINE caractères.
- *    La ligne est ensuite nettoyée (trim, clean, separate_s, replace, substenv), puis découpée en tokens.
+ *    La ligne est découpée en tokens typés en un seul parcours par *lex_command_line()* (mots écrits dans *cmdl->arena*, pointés directement par *argv*).
  *    Les tokens sont ensuite utilisés pour remplir les structures processus_t et control_flow_t dans *cmdl*.
- *    Si la ligne dépasse la taille maximale ou si le nombre de commandes dépasse MAX_CMDS, la fonction retourne -1.
- *    Si une erreur est détectée, les descripteurs de fichiers ouverts sont fermés via close_fds(cmdl) avant de retourner -1.
+ *    Ni la longueur de la ligne, ni le nombre de commandes ou d'arguments ne sont limités (les tableaux de *cmdl* sont agrandis dans son arène).
+ *    Aucun fichier ni tube n'est ouvert : les redirections sont enregistrées par *add_redirection()* et ouvertes au lancement de leur commande,
+ *    les tubes d'un pipeline sont créés par *launch_command_line()*.
  */
 int parse_command_line(command_line_t *cmdl, const char *line)
 {
-    // Copie de la ligne de commande dans la structure
-    strncpy(cmdl->command_line, line, MAX_CMD_LINE - 1);
-    cmdl->command_line[MAX_CMD_LINE - 1] = '\0';
-
-    // Suppression des espaces inutiles au début et à la fin
-    if (trim(cmdl->command_line) != 0)
-    {
-        return -1;
-    }
-    // Suppression des doublons d'espaces
-    if (clean(cmdl->command_line) != 0)
-    {
-        return -1;
-    }
-    // Ajout d'espaces autour des caractères ;
-    if (separate_s(cmdl->command_line, ";", MAX_CMD_LINE) != 0)
-    {
-        return -1;
-    }
+    return parse_command_line_n(cmdl, line, strlen(line));
+}
 
-    // Traitement des variables d'environnement
-    if (substenv(cmdl->command_line, MAX_CMD_LINE) != 0)
-    {
-        return -1;
-    }
-    
-    // Découpage de la ligne en tokens
-    int num_tokens = strcut(cmdl->command_line, ' ', cmdl->tokens, MAX_CMD_LINE / 2 + 1);
+/** @brief Fonction d'analyse d'une ligne de commande de longueur connue.
+ * @param cmdl Pointeur vers la structure de ligne de commande à remplir.
+ * @param line Début de la ligne de commande (pas nécessairement terminée par '\0', par exemple une ligne du lecteur de input.h).
+ * @param len Longueur de la ligne.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (syntaxe, allocation, etc.).
+ * @details Identique à *parse_command_line()*, sans parcours préalable de la ligne pour en calculer la longueur.
+ */
+int parse_command_line_n(command_line_t *cmdl, const char *line, size_t len)
+{
+    // Découpage de la ligne en tokens typés (un seul parcours)
+    int num_tokens = lex_command_line(cmdl, line, len);
     if (num_tokens < 0)
     {
         return -1;
     }
 
-    // Index des tokens
-    int token_index = 0;
-    // Index des arguments dans le processus courant
-    int argv_index = 0;
     // Premier processus de la ligne de commande
     processus_t *current_proc = add_processus(cmdl, UNCONDITIONAL);
+    if (!current_proc)
+    {
+        perror("add_processus");
+        return -1;
+    }
 
-    while (cmdl->tokens[token_index] != NULL)
+    int io_number = -1; // descripteur de la prochaine redirection ("2" dans "2>f"), -1 : celui par défaut de l'opérateur
+    for (int token_index = 0; token_index < num_tokens; token_index++)
     {
-        // TODO : vérifier que le nombre de processus ne dépasse pas MAX_CMDS et que le nombre d'arguments ne dépasse pas MAX_ARGS
         char *token = cmdl->tokens[token_index];
-        if (strcmp(token, ";") == 0)
+        token_type_t type = cmdl->token_types[token_index];
+        switch (type)
         {
-            // fin d'une commande.
-            // si le ';' est le dernier token, on peut arrêter le parsing
-            if (cmdl->tokens[token_index + 1] == NULL)
-            {
-                break;
-            }
-            // sinon, on passe au processus suivant
+        case TOKEN_SEMICOLON:
+        case TOKEN_BACKGROUND:
+            // "&" termine la commande courante (comme ";"), qui est lancée en arrière-plan
+            if (type == TOKEN_BACKGROUND)
+                current_proc->is_background = 1;
+            // si c'est le dernier token, on peut arrêter le parsing
+            if (token_index + 1 == num_tokens)
+                return 0;
+            // sinon, on démarre une nouvelle commande inconditionnelle
             current_proc = add_processus(cmdl, UNCONDITIONAL);
-            // On réinitialise l'index des arguments
-            argv_index = 0;
-            // On passe au token suivant
-            token_index++;
-            continue;
-        }
-        if (strcmp(token, "<") == 0)
-        {
-            // Redirection de l'entrée standard
-            // Le token suivant doit être le fichier
-            token_index++;
-            if (cmdl->tokens[token_index] == NULL)
-            {
-                fprintf(stderr, "Erreur de syntaxe: fichier attendu après '<'\n");
-                close_fds(cmdl);
-                return -1;
-            }
-            // Ouvrir le fichier en lecture
-            int fd = open(cmdl->tokens[token_index], O_RDONLY);
-            if (fd < 0)
+            break;
+
+        case TOKEN_AND:
+        case TOKEN_OR:
+            // "&&" : processus suivant exécuté en cas de succès, "||" en cas d'échec
+            current_proc = add_processus(cmdl, type == TOKEN_AND ? ON_SUCCESS : ON_FAILURE);
+            break;
+
+        case TOKEN_PIPE:
+        case TOKEN_PIPE_ALL:
+            // "|&" : l'erreur standard suit la sortie dans le tube, après les autres redirections de l'étape ("2>&1 |")
+            if (type == TOKEN_PIPE_ALL && !add_redirection(cmdl, current_proc, 2, 1, NULL, 0))
             {
-                perror("open");
-                close_fds(cmdl);
+                perror("add_redirection");
                 return -1;
             }
-            current_proc->stdin_fd = fd;
-            // Ajouter le descripteur à la liste des descripteurs ouverts
-            if (add_fd(cmdl, fd) != 0)
+            // Étape suivante du pipeline : elle sera démarrée sans attendre la fin du processus courant (tube créé au lancement)
+            current_proc = add_processus(cmdl, PIPELINE);
+            break;
+
+        case TOKEN_IO_NUMBER:
+            // numéro du descripteur de la redirection qui suit (l'analyseur lexical garantit l'opérateur)
+            io_number = fd_number(token);
+            if (io_number < 0)
             {
-                close(fd);
-                close_fds(cmdl);
+                fprintf(stderr, "Erreur de syntaxe: descripteur '%s' trop grand\n", token);
                 return -1;
             }
-            // On passe au token suivant
-            token_index++;
-            continue;
-        }
-        // Traitement des autres opérateurs du shell (>, >>, 2>, |, &&, ||, ...)
-        if (strcmp(token, ">") == 0)
+            break;
+
+        case TOKEN_IN:
+        case TOKEN_OUT:
+        case TOKEN_APPEND:
+        case TOKEN_DUP_IN:
+        case TOKEN_DUP_OUT:
+        case TOKEN_OUT_ALL:
+        case TOKEN_APPEND_ALL:
         {
-            // Ouvrir le fichier en écriture (O_WRONLY | O_CREAT | O_TRUNC)
-            // Ajouter le descripteur à la liste des descripteurs ouverts
-            // Affecter le descripteur au stdout_fd du processus courant
-            token_index++;
-            if (!cmdl->tokens[token_index])
-            {
-                fprintf(stderr, "Erreur de syntaxe: fichier attendu après '>'\n");
-                close_fds(cmdl);
-                return -1;
-            }
-            int fd = open(cmdl->tokens[token_index], O_WRONLY | O_CREAT | O_TRUNC, 0644);
-            if (fd < 0)
+            // Le token suivant doit être le fichier (ou le descripteur dupliqué)
+            token_type_t word_type = cmdl->token_types[token_index + 1];
+            if (word_type != TOKEN_WORD && word_type != TOKEN_WORD_EXPAND)
             {
-                perror("open");
-                close_fds(cmdl);
+                fprintf(stderr, "Erreur de syntaxe: fichier attendu après '%s'\n", token);
                 return -1;
             }
-            current_proc->stdout_fd = fd;
-            if (add_fd(cmdl, fd) != 0)
-            {
-                close(fd);
-                close_fds(cmdl);
-                return -1;
-            }
-            token_index++;
-            continue;
-        }
-        if (strcmp(token, ">>") == 0)
-        {
-            // Ouvrir le fichier en écriture (O_WRONLY | O_CREAT | O_APPEND)
-            // Ajouter le descripteur à la liste des descripteurs ouverts
-            // Affecter le descripteur au stdout_fd du processus courant
-            token_index++;
-            if (!cmdl->tokens[token_index])
+            char *word = cmdl->tokens[++token_index];
+            int fd = (io_number >= 0) ? io_number : (type == TOKEN_IN || type == TOKEN_DUP_IN) ? 0 : 1;
+            int both = (type == TOKEN_OUT_ALL || type == TOKEN_APPEND_ALL);
+            redirection_t *r = NULL;
+
+            if (type == TOKEN_DUP_IN || type == TOKEN_DUP_OUT)
             {
-                fprintf(stderr, "Erreur de syntaxe: fichier attendu après '>>'\n");
-                close_fds(cmdl);
-                return -1;
+                // "n>&m" : copie de m, "n>&-" : fermeture ; ">&fichier" (sans n) équivaut à "&>fichier"
+                int source = (word_type == TOKEN_WORD) ? fd_number(word) : -1;
+                int close_fd = (word_type == TOKEN_WORD && strcmp(word, "-") == 0);
+                if (source < 0 && !close_fd && (type == TOKEN_DUP_IN || io_number >= 0))
+                {
+                    fprintf(stderr, "Erreur de syntaxe: descripteur attendu après '%s'\n", token);
+                    return -1;
+                }
+                if (source >= 0 || close_fd)
+                    r = add_redirection(cmdl, current_proc, fd, source, NULL, 0);
+                else
+                    both = 1;
             }
-            int fd = open(cmdl->tokens[token_index], O_WRONLY | O_CREAT | O_APPEND, 0644);
-            if (fd < 0)
+            if (!r)
             {
-                perror("open");
-                close_fds(cmdl);
-                return -1;
+                int flags = (type == TOKEN_IN) ? O_RDONLY
+                            : (type == TOKEN_APPEND || type == TOKEN_APPEND_ALL) ? O_WRONLY | O_CREAT | O_APPEND
+                                                                                : O_WRONLY | O_CREAT | O_TRUNC;
+                // le fichier est ouvert au lancement de la commande, après la substitution de son nom
+                r = add_redirection(cmdl, current_proc, fd, -1, word, flags);
+                if (r)
+                    r->expand = (word_type == TOKEN_WORD_EXPAND);
+                // "&>" : l'erreur standard suit la sortie
+                if (r && both && !add_redirection(cmdl, current_proc, 2, 1, NULL, 0))
+                    r = NULL;
             }
-            current_proc->stdout_fd = fd;
-            if (add_fd(cmdl, fd) != 0)
+            if (!r)
             {
-                close(fd);
-                close_fds(cmdl);
+                perror("add_redirection");
                 return -1;
             }
-            token_index++;
-            continue;
+            io_number = -1;
+            break;
         }
 
-        if (strcmp(token, "2>") == 0)
+        case TOKEN_HEREDOC:
+        case TOKEN_HEREDOC_STRIP:
+        case TOKEN_HERESTRING:
         {
-            // Reprendre le même traitement que pour ">", mais pour stderr_fd
-            token_index++;
-            if (!cmdl->tokens[token_index])
+            // Le token suivant est le délimiteur du document (ou le mot envoyé par "<<<")
+            token_type_t word_type = cmdl->token_types[token_index + 1];
+            if (word_type != TOKEN_WORD && word_type != TOKEN_WORD_EXPAND)
             {
-                fprintf(stderr, "Erreur de syntaxe: fichier attendu après '2>'\n");
-                close_fds(cmdl);
+                fprintf(stderr, "Erreur de syntaxe: mot attendu après '%s'\n", token);
                 return -1;
             }
-            int fd = open(cmdl->tokens[token_index], O_WRONLY | O_CREAT | O_TRUNC, 0644);
-            if (fd < 0)
+            char *word = cmdl->tokens[++token_index];
+            size_t len = strlen(word);
+            redirection_t *r = add_redirection(cmdl, current_proc, (io_number >= 0) ? io_number : 0, -1, word, O_RDONLY);
+            if (r && type == TOKEN_HERESTRING)
             {
-                perror("open");
-                close_fds(cmdl);
-                return -1;
+                // contenu : le mot suivi d'un retour à la ligne, substitué au lancement
+                r->here = HERE_STRING;
+                r->expand = (word_type == TOKEN_WORD_EXPAND);
+                r->path = arena_alloc(&cmdl->arena, len + 2);
+                if (r->path)
+                {
+                    memcpy(r->path, word, len);
+                    memcpy(r->path + len, "\n", 2);
+                }
+                else
+                    r = NULL;
+            }
+            else if (r)
+            {
+                // contenu lu plus tard sur les lignes suivantes (voir read_heredocs()), substitué si le délimiteur n'a pas de guillemets
+                r->here = (type == TOKEN_HEREDOC_STRIP) ? HERE_DOC_STRIP : HERE_DOC;
+                r->expand = !(len > 0 && word[len - 1] == EXPAND_CTL_QUOTE);
+                if (!r->expand)
+                    word[len - 1] = '\0';
+                cmdl->num_heredocs++;
             }
-            current_proc->stderr_fd = fd;
-            if (add_fd(cmdl, fd) != 0)
+            if (!r)
             {
-                close(fd);
-                close_fds(cmdl);
+                perror("add_redirection");
                 return -1;
             }
-            token_index++;
-            continue;
+            io_number = -1;
+            break;
         }
 
-        if (strcmp(token, "2>>") == 0)
-        {
-            // Reprendre le même traitement que pour ">>", mais pour stderr_fd
-            token_index++;
-            if (!cmdl->tokens[token_index])
+        case TOKEN_BANG:
+            if (current_proc->argc == 0)
             {
-                fprintf(stderr, "Erreur de syntaxe: fichier attendu après '2>>'\n");
-                close_fds(cmdl);
-                return -1;
+                // "!" en tête de commande (mot réservé) : mettre le flag invert du processus courant à 1
+                // (ailleurs, c'est un argument ordinaire, comme dans "[ ! -f x ]")
+                current_proc->invert = 1;
+                break;
             }
-            int fd = open(cmdl->tokens[token_index], O_WRONLY | O_CREAT | O_APPEND, 0644);
-            if (fd < 0)
+            /* fall through */
+        default:
+            if (type == TOKEN_WORD && current_proc->argc == 0 && strcmp(token, "time") == 0)
             {
-                perror("open");
-                close_fds(cmdl);
-                return -1;
+                // Mot-clé "time" en tête de commande : mesure de la commande ou de tout le pipeline qu'elle commence
+                current_proc->timed = 1;
+                break;
             }
-            current_proc->stderr_fd = fd;
-            if (add_fd(cmdl, fd) != 0)
+
+            // Le token n'est pas un opérateur, c'est une commande ou un argument.
+            // Les arguments (et le chemin de la commande) pointent directement sur les mots de l'arène : aucune copie
+            if (current_proc->argc == 0)
+                current_proc->path = token;
+            if (type == TOKEN_WORD_EXPAND)
+                current_proc->expand = 1; // substitution au lancement (voir expand.h)
+            if (add_argument(cmdl, current_proc, token) != 0)
             {
-                close(fd);
-                close_fds(cmdl);
+                perror("add_argument");
                 return -1;
             }
-            token_index++;
-            continue;
+            break;
         }
 
-        if (strcmp(token, ">&2") == 0)
+        if (!current_proc)
         {
-            // Rediriger stdout vers ce que stderr utilise actuellement
-            current_proc->stdout_fd = current_proc->stderr_fd;
-            token_index++;
-            continue;
-        }
-
-        if (strcmp(token, "2>&1") == 0)
-        {
-            // Rediriger stderr vers ce que stdout utilise actuellement
-            current_proc->stderr_fd = current_proc->stdout_fd;
-            token_index++;
-            continue;
+            perror("add_processus");
+            return -1;
         }
+    }
+    // On a traité tous les tokens.
+    // À ce moment, la structure cmdl contient toutes les informations nécessaires
+    // pour exécuter la ligne de commande avec le controle de flux associé.
+    return 0;
+}
 
-        // Pour la gestion du pipe, vous pourrez utiliser next_processus(cmdl) pour initialiser les descripteurs
-        // des IOs standards de la structure processus_t courante et de la suivante.
-        // next_processus(cmdl) retourne un pointeur vers le processus qui sera renvoyé par add_processus(cmdl, mode)
-        // lors du prochain appel.
-
-        if (strcmp(token, "|") == 0)
+/** @brief Lecture du contenu d'un document en ligne, jusqu'à son délimiteur (voir *read_heredocs()*).
+ * @return int 0 en cas de succès, -1 en cas d'erreur d'allocation.
+ */
+static int read_heredoc(command_line_t *cmdl, input_t *in, const char *prompt, redirection_t *r)
+{
+    const char *delimiter = r->path;
+    size_t delimiter_len = strlen(delimiter);
+    int expand = r->expand;
+    // le contenu est construit comme un mot de l'analyseur lexical : $VAR marqué, octets de contrôle protégés
+    lexer_t lx = {.cmdl = cmdl, .arena = &cmdl->arena};
+    int found = 0;
+
+    const char *line;
+    ssize_t len;
+    while (1)
+    {
+        if (prompt)
         {
-            int fds[2];
-            if (pipe(fds) < 0)
-            {
-                perror("pipe");
-                close_fds(cmdl);
-                return -1;
-            }
-
-            // stdout du processus courant → écriture du pipe
-            current_proc->stdout_fd = fds[1];
-
-            // enregistrer les deux fd pour que les fils les ferment
-            if (add_fd(cmdl, fds[0]) != 0 || add_fd(cmdl, fds[1]) != 0)
-            {
-                close(fds[0]);
-                close(fds[1]);
-                close_fds(cmdl);
-                return -1;
-            }
-
-            // Créer le processus suivant, enchaîné inconditionnellement
-            current_proc = add_processus(cmdl, UNCONDITIONAL);
-            if (!current_proc)
-            {
-                close_fds(cmdl);
-                return -1;
-            }
-
-            // stdin du nouveau processus → lecture du pipe
-            current_proc->stdin_fd = fds[0];
-
-            // On recommence une nouvelle commande : reset des arguments
-            argv_index = 0;
-            token_index++;
-            continue;
+            fputs(prompt, stdout);
+            fflush(stdout);
         }
-
-        if (strcmp(token, "&&") == 0)
+        if ((len = input_next_line(in, &line)) < 0)
+            break;
+        const char *p = line;
+        lx.end = line + len;
+        if (r->here == HERE_DOC_STRIP)
         {
-            // Si on rencontre "&&", créer un processus suivant en mode ON_SUCCESS
-            current_proc = add_processus(cmdl, ON_SUCCESS);
-            token_index++;
-            argv_index = 0; // Réinitialiser l'index des arguments
-            continue;
+            while (p < lx.end && *p == '\t')
+                p++;
         }
-
-        if (strcmp(token, "||") == 0)
+        if ((size_t)(lx.end - p) == delimiter_len && memcmp(p, delimiter, delimiter_len) == 0)
         {
-            // Si on rencontre "||", créer un processus suivant en mode ON_FAILURE
-            current_proc = add_processus(cmdl, ON_FAILURE); // Crée un nouveau processus pour `||`
-            token_index++;
-            argv_index = 0; // Réinitialiser l'index des arguments
-            continue;
+            found = 1;
+            break;
         }
 
-        if (strcmp(token, "&") == 0)
+        int joined = 0; // ligne terminée par '\' : poursuivie sur la suivante
+        int rc = 0;
+        while (p < lx.end && rc == 0)
         {
-            // Mettre le flag is_background du processus courant à 1
-            current_proc->is_background = 1;
-
-            // "&" termine la commande courante (comme ";").
-            // Bug rencontré: sans créer un nouveau processus, les tokens suivants (ex: "echo")
-            // étaient ajoutés dans argv du même processus, donc passés à "sleep".
-            token_index++;
-
-            // Si '&' est en fin de ligne, rien d'autre à parser.
-            if (cmdl->tokens[token_index] == NULL)
+            if (expand && *p == '$')
+                rc = (p = lex_variable(&lx, p, 1)) ? 0 : -1;
+            else if (expand && *p == '\\' && p + 1 == lx.end)
             {
-                break;
+                joined = 1;
+                p++;
             }
-
-            // Sinon, on démarre une nouvelle commande inconditionnelle.
-            current_proc = add_processus(cmdl, UNCONDITIONAL);
-            if (!current_proc)
+            else if (expand && *p == '\\' && strchr("$`\\", p[1]))
             {
-                close_fds(cmdl);
-                return -1;
+                rc = lex_putc(&lx, p[1]);
+                p += 2;
             }
-            argv_index = 0;
-            continue;
-        }
-
-        if (strcmp(token, "!") == 0)
-        {
-            // Mettre le flag invert du processus courant à 1
-            current_proc->invert = 1;
-            token_index++;
-            continue;
+            else
+                rc = lex_putc(&lx, *p++);
         }
-
-        // Le token n'est pas un opérateur, c'est une commande ou un argument
-        if (argv_index >= MAX_ARGS - 1)
-        {
-            fprintf(stderr, "Erreur: trop d'arguments pour une commande (max %d)\n", MAX_ARGS - 1);
-            close_fds(cmdl);
+        if (rc != 0 || (!joined && lex_putc(&lx, '\n') != 0))
             return -1;
-        }
+    }
+    if (!found)
+        fprintf(stderr, "minishell: document en ligne terminé par la fin de l'entrée (\"%s\" attendu)\n", delimiter);
 
-        // Copier le token dans argv
-        char *arg = strdup(token);
-        if (!arg)
-        {
-            perror("strdup failed");
-            return -1;
-        }
+    // '\0' final : sa place est réservée par lex_putc() et lex_variable()
+    if (lx.word)
+    {
+        *lx.arena->ptr++ = '\0';
+        r->path = lx.word;
+    }
+    else if (!(r->path = arena_strndup(&cmdl->arena, "", 0)))
+        return -1;
+    r->expand = lx.expand;
+    return 0;
+}
 
-        // Si c'est la commande (premier argument)
-        // Dans la boucle de traitement des tokens
-        if (argv_index == 0)
+/** @brief Fonction de lecture du contenu des documents en ligne d'une ligne de commande ("<<FIN", "<<-FIN").
+ * @param cmdl Ligne de commande analysée par *parse_command_line()* (*num_heredocs* documents en attente de leur contenu).
+ * @param in Lecteur de la ligne : le contenu est lu sur les lignes qui la suivent.
+ * @param prompt Invite affichée avant chaque ligne du contenu (mode interactif), NULL pour aucune.
+ * @return int 0 en cas de succès, -1 en cas d'erreur d'allocation.
+ * @details Les documents sont lus dans l'ordre de la ligne, chacun jusqu'à la ligne égale à son délimiteur (après le retrait des tabulations
+ *    de tête pour "<<-"), ou jusqu'à la fin de l'entrée (avec un avertissement). Le contenu est écrit dans l'arène de la ligne et remplace
+ *    le délimiteur dans la redirection. Si le délimiteur ne contenait pas de guillemets, $VAR y est marqué pour être substitué au lancement
+ *    (sans découpage en mots), "\\$", "\\\\" et "\\`" y sont des caractères littéraux et une ligne terminée par '\\' se poursuit sur la suivante.
+ */
+int read_heredocs(command_line_t *cmdl, input_t *in, const char *prompt)
+{
+    if (!cmdl || !in)
+        return -1;
+    for (unsigned int i = 0; i < cmdl->num_commands && cmdl->num_heredocs > 0; ++i)
+    {
+        for (redirection_t *r = cmdl->commands[i].redirections; r; r = r->next)
         {
-            // Pour la commande, on prend le token tel quel
-            current_proc->path = strdup(token);
-            if (!current_proc->path)
+            if (r->here != HERE_DOC && r->here != HERE_DOC_STRIP)
+                continue;
+            if (read_heredoc(cmdl, in, prompt, r) != 0)
             {
-                perror("strdup failed");
+                perror("read_heredocs");
                 return -1;
             }
+            cmdl->num_heredocs--;
         }
-
-        // Pour tous les arguments, y compris la commande
-        current_proc->argv[argv_index] = strdup(token);
-        if (!current_proc->argv[argv_index])
-        {
-            perror("strdup failed");
-            return -1;
-        }
-        argv_index++;
-        current_proc->argv[argv_index] = NULL; // Toujours terminer par NULL  // Toujours terminer par NULL
-
-        // Passer au token suivant
-        token_index++;
     }
-    // On a traité tous les tokens.
-    // À ce moment, la structure cmdl contient toutes les informations nécessaires
-    // pour exécuter la ligne de commande avec le controle de flux associé.
     return 0;
 }
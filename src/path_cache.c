@@ -0,0 +1,212 @@
+/** @file path_cache.c
+ * @brief Implementation of the command path cache
+ * @author Sofiane FETTAH
+ * @author Matthieu COMME
+ * @date 2025-26
+ * @details Implémentation du cache "nom de commande -> chemin absolu".
+ *    La table est à adressage ouvert (sondage linéaire) et sa capacité est une puissance de 2.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/stat.h>
+
+#include "path_cache.h"
+#include "vars.h"
+
+/// Capacité initiale de la table (puissance de 2)
+#define PATH_CACHE_INITIAL_CAPACITY 64
+/// Valeur de $PATH utilisée si la variable n'est pas définie
+#define PATH_CACHE_DEFAULT_PATH "/usr/local/bin:/usr/bin:/bin"
+
+static path_cache_entry_t *table = NULL; ///< Table des entrées (name == NULL : case libre)
+static size_t capacity = 0;              ///< Nombre de cases de la table
+static size_t count = 0;                 ///< Nombre de cases occupées
+
+/** @brief Fonction de hachage FNV-1a d'une chaîne. */
+static uint64_t hash_name(const char *name)
+{
+    uint64_t h = 14695981039346656037ULL;
+    for (const unsigned char *p = (const unsigned char *)name; *p; ++p)
+    {
+        h ^= *p;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/** @brief Recherche de la case de *name* (occupée par *name* ou libre si absent). */
+static path_cache_entry_t *find_slot(path_cache_entry_t *t, size_t cap, const char *name)
+{
+    size_t i = hash_name(name) & (cap - 1);
+    while (t[i].name && strcmp(t[i].name, name) != 0)
+        i = (i + 1) & (cap - 1);
+    return &t[i];
+}
+
+/** @brief Agrandissement de la table (facteur de charge maximal 1/2). */
+static int grow(void)
+{
+    size_t new_cap = capacity ? capacity * 2 : PATH_CACHE_INITIAL_CAPACITY;
+    path_cache_entry_t *t = calloc(new_cap, sizeof(*t));
+    if (!t)
+        return -1;
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        if (table[i].name)
+            *find_slot(t, new_cap, table[i].name) = table[i];
+    }
+    free(table);
+    table = t;
+    capacity = new_cap;
+    return 0;
+}
+
+/** @brief Parcours de $PATH à la recherche d'un fichier régulier exécutable nommé *name*.
+ * @return char* Chemin alloué dynamiquement, NULL si introuvable.
+ */
+static char *resolve(const char *name)
+{
+    const char *dirs = vars_get("PATH");
+    if (!dirs)
+        dirs = PATH_CACHE_DEFAULT_PATH;
+
+    size_t name_len = strlen(name);
+    char candidate[PATH_MAX];
+
+    const char *dir = dirs;
+    while (1)
+    {
+        const char *end = strchr(dir, ':');
+        size_t dir_len = end ? (size_t)(end - dir) : strlen(dir);
+
+        // un élément vide de $PATH désigne le répertoire courant
+        if (dir_len == 0)
+        {
+            dir = ".";
+            dir_len = 1;
+        }
+        if (dir_len + 1 + name_len + 1 <= sizeof candidate)
+        {
+            memcpy(candidate, dir, dir_len);
+            candidate[dir_len] = '/';
+            memcpy(candidate + dir_len + 1, name, name_len + 1);
+
+            struct stat st;
+            if (access(candidate, X_OK) == 0 && stat(candidate, &st) == 0 && S_ISREG(st.st_mode))
+                return strdup(candidate);
+        }
+        if (!end)
+            break;
+        dir = end + 1;
+    }
+    return NULL;
+}
+
+/** @brief Fonction de consultation du cache sans résolution.
+ * @param name Nom de la commande.
+ * @return const path_cache_entry_t* Entrée du cache, ou NULL si *name* n'a jamais été résolu.
+ */
+const path_cache_entry_t *path_cache_find(const char *name)
+{
+    if (!name || capacity == 0)
+        return NULL;
+    path_cache_entry_t *e = find_slot(table, capacity, name);
+    return e->name ? e : NULL;
+}
+
+/** @brief Fonction de résolution d'un nom de commande en chemin via le cache.
+ * @param name Nom de la commande (sans '/').
+ * @return const char* Chemin absolu de la commande, ou NULL si elle est introuvable dans $PATH.
+ * @details Au premier appel pour *name*, les répertoires de $PATH sont parcourus et le résultat (succès ou échec) est mémorisé.
+ *    Les appels suivants ne font aucun appel système. Le compteur *hits* de l'entrée est incrémenté.
+ */
+const char *path_cache_lookup(const char *name)
+{
+    if (!name)
+        return NULL;
+    if ((count + 1) * 2 > capacity && grow() != 0)
+    {
+        // pas de mémoire pour agrandir la table : résolution sans mémorisation
+        static char *uncached = NULL;
+        free(uncached);
+        uncached = resolve(name);
+        return uncached;
+    }
+
+    path_cache_entry_t *e = find_slot(table, capacity, name);
+    if (!e->name)
+    {
+        e->name = strdup(name);
+        if (!e->name)
+            return NULL;
+        e->path = resolve(name);
+        e->hits = 0;
+        count++;
+    }
+    e->hits++;
+    return e->path;
+}
+
+/** @brief Fonction de résolution forcée d'un nom de commande.
+ * @param name Nom de la commande.
+ * @return const char* Nouveau chemin absolu, ou NULL si la commande est introuvable.
+ * @details L'entrée existante est recalculée à partir de $PATH (utilisé par exemple quand l'exec d'un chemin mémorisé échoue avec ENOENT).
+ *    Le compteur *hits* est conservé.
+ */
+const char *path_cache_refresh(const char *name)
+{
+    path_cache_entry_t *e = (path_cache_entry_t *)path_cache_find(name);
+    if (!e)
+        return path_cache_lookup(name);
+    free(e->path);
+    e->path = resolve(name);
+    return e->path;
+}
+
+/** @brief Fonction de vidage du cache.
+ * @details Appelée lorsque $PATH est modifié ou par "hash -r".
+ */
+void path_cache_clear(void)
+{
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        free(table[i].name);
+        free(table[i].path);
+    }
+    if (capacity)
+        memset(table, 0, capacity * sizeof(*table));
+    count = 0;
+}
+
+/** @brief Fonction de parcours des entrées du cache.
+ * @param fn Fonction appelée pour chaque entrée ; le parcours s'arrête si elle retourne une valeur non nulle.
+ * @param data Pointeur transmis tel quel à *fn*.
+ * @return int 0 si toutes les entrées ont été parcourues, la valeur retournée par *fn* sinon.
+ */
+int path_cache_foreach(int (*fn)(const path_cache_entry_t *entry, void *data), void *data)
+{
+    if (!fn)
+        return -1;
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        if (table[i].name)
+        {
+            int rc = fn(&table[i], data);
+            if (rc != 0)
+                return rc;
+        }
+    }
+    return 0;
+}
+
+/** @brief Fonction de récupération du nombre d'entrées du cache.
+ * @return size_t Nombre d'entrées (échecs compris).
+ */
+size_t path_cache_size(void)
+{
+    return count;
+}
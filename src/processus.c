@@ -5,21 +5,36 @@
  * @date 2025-26
  * @details Implémentation des fonctions de gestion des processus.
  */
-#ifndef MAX_OPENED
-#define MAX_OPENED MAX_CMDS * 3 + 1
-#endif
+#define _GNU_SOURCE // pipe2(), close_range(), memfd_create()
 
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+#include <spawn.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/prctl.h>
+#include <sys/mman.h>
 
 #include "processus.h"
 #include "builtins.h"
+#include "path_cache.h"
+#include "jobs.h"
+#include "zygote.h"
+#include "vars.h"
+#include "expand.h"
+#include "output.h"
+
+/// Taille du texte d'une commande mémorisé dans la table des jobs (tronqué au-delà)
+#define JOB_TEXT_SIZE 4096
+
+static char *empty_env[] = {NULL}; ///< *envp* par défaut des processus
 
 /**
  * @brief Fonction d'initialisation d'une structure de processus.
@@ -27,17 +42,28 @@
  * @return int 0 en cas de succès, -1 en cas d'erreur.
  * @details Cette fonction initialise les champs de la structure avec les valeurs suivantes:
  * - *pid*: 0
- * - *argv*: {NULL}
+ * - *argv*: *argv_inline*, {NULL}
  * - *envp*: {NULL}
  * - *path*: NULL
+ * - *builtin*: NULL
  * - *stdin_fd*: 0
  * - *stdout_fd*: 1
  * - *stderr_fd*: 2
  * - *status*: 0
+ * - *exec_errno*: 0
+ * - *job_id*: 0
  * - *is_background*: 0
+ * - *timed*: 0
+ * - *in_pipeline*: 0
+ * - *expand*: 0
+ * - *tail_exec*: 0
  * - *start_time*: {0}
  * - *end_time*: {0}
+ * - *rusage*: {0}
  * - *cf*: NULL
+ * - *argc*: 0
+ * - *argv_capacity*: PROCESSUS_INLINE_ARGS
+ * - *redirections*, *fd_mappings*: NULL
  */
 int init_processus(processus_t *proc)
 {
@@ -46,6 +72,9 @@ int init_processus(processus_t *proc)
 
     memset(proc, 0, sizeof(*proc));
 
+    proc->argv = proc->argv_inline;
+    proc->argv_capacity = PROCESSUS_INLINE_ARGS;
+    proc->envp = empty_env;
     proc->stdin_fd = 0;
     proc->stdout_fd = 1;
     proc->stderr_fd = 2;
@@ -53,144 +82,1066 @@ int init_processus(processus_t *proc)
     return 0;
 }
 
-/** @brief Fonction de lancement d'un processus à partir d'une structure de processus.
- * @param proc Pointeur vers la structure de processus à lancer.
- * @return int 0 en cas de succès, un code d'erreur sinon.
- * @details Cette fonction utilise *fork()* et *execve()* pour lancer le processus décrit par la structure.
- *    Elle gère également les redirections des IOs standards (via *dup2()*).
- *    En cas de succès, le champ *pid* de la structure est mis à jour avec le PID du processus fils.
- *    Le flag *is_background* détermine si on attend la fin du processus ou non.
- *    La valeur de *status* est mise à jour à l'issue de l'exécution avec le code de retour du processus fils lorsque le flag *is_background* est désactivé.
- *    Les temps de démarrage et d'arrêt sont enregistrés dans *start_time* et *end_time* respectivement. *end_time* est mis à jour uniquement si *is_background* est désactivé.
- *    Les descripteurs de fichiers ouverts sont gérés dans *cf->cmdl->opened_descriptors* : le processus "fils" ferme tous les descripteurs listés dans ce tableau avant d'exécuter la commande.
+/** @brief Fonction d'ajout d'un argument à un processus.
+ * @param cmdl Pointeur vers la structure de ligne de commande du processus (son arène reçoit *argv* quand *argv_inline* est plein).
+ * @param proc Pointeur vers le processus.
+ * @param arg Argument à ajouter (non copié).
+ * @return int 0 en cas de succès, -1 en cas d'erreur d'allocation.
+ * @details *argv* reste terminé par NULL ; sa capacité double à chaque agrandissement.
+ */
+int add_argument(command_line_t *cmdl, processus_t *proc, char *arg)
+{
+    if (!cmdl || !proc)
+        return -1;
+    if (proc->argc + 1 >= proc->argv_capacity)
+    {
+        unsigned int capacity = 2 * proc->argv_capacity;
+        char **argv = arena_alloc(&cmdl->arena, capacity * sizeof *argv);
+        if (!argv)
+            return -1;
+        memcpy(argv, proc->argv, proc->argc * sizeof *argv);
+        proc->argv = argv;
+        proc->argv_capacity = capacity;
+    }
+    proc->argv[proc->argc++] = arg;
+    proc->argv[proc->argc] = NULL;
+    return 0;
+}
+
+/** @brief Fonction d'ajout d'une redirection à un processus.
+ * @param cmdl Pointeur vers la structure de ligne de commande du processus (son arène reçoit la redirection).
+ * @param proc Pointeur vers le processus.
+ * @param fd Descripteur redirigé (0 et plus).
+ * @param source Descripteur dupliqué sur *fd* ("n>&m"), -1 pour ouvrir *path* ou, sans *path*, fermer *fd* ("n>&-").
+ * @param path Fichier à ouvrir (non copié), NULL pour une duplication ou une fermeture.
+ * @param flags Drapeaux de *open()*.
+ * @return redirection_t* Redirection ajoutée en fin de liste, NULL en cas d'erreur d'allocation.
+ * @details Rien n'est ouvert : le fichier est ouvert au démarrage du processus, après la substitution de son nom.
+ */
+redirection_t *add_redirection(command_line_t *cmdl, processus_t *proc, int fd, int source, char *path, int flags)
+{
+    if (!cmdl || !proc)
+        return NULL;
+    redirection_t *r = arena_alloc(&cmdl->arena, sizeof *r);
+    if (!r)
+        return NULL;
+    r->fd = fd;
+    r->source = source;
+    r->flags = flags;
+    r->expand = 0;
+    r->here = HERE_NONE;
+    r->path = path;
+    r->next = NULL;
+    if (proc->last_redirection)
+        proc->last_redirection->next = r;
+    else
+        proc->redirections = r;
+    proc->last_redirection = r;
+    return r;
+}
+
+/// Mécanisme de création des processus utilisé par launch_processus()
+static spawn_backend_t spawn_backend = SPAWN_POSIX_SPAWN;
+
+/** @brief Fonction de sélection du mécanisme de création des processus.
+ * @param backend Mécanisme à utiliser (SPAWN_FORK, SPAWN_POSIX_SPAWN ou SPAWN_ZYGOTE).
+ * @return int 0 en cas de succès, -1 si *backend* est invalide ou si le zygote n'a pas pu être démarré.
+ * @details Le mécanisme par défaut est SPAWN_POSIX_SPAWN. Le choix s'applique à tous les lancements suivants.
+ *    Le zygote (voir zygote.h) est démarré à la sélection de SPAWN_ZYGOTE et arrêté quand un autre mécanisme est choisi.
+ */
+int set_spawn_backend(spawn_backend_t backend)
+{
+    if (backend != SPAWN_FORK && backend != SPAWN_POSIX_SPAWN && backend != SPAWN_ZYGOTE)
+        return -1;
+    if (backend == SPAWN_ZYGOTE && zygote_start(ZYGOTE_POOL_SIZE) != 0)
+        return -1;
+    if (backend != SPAWN_ZYGOTE)
+        zygote_stop();
+    spawn_backend = backend;
+    return 0;
+}
+
+/** @brief Fonction de récupération du mécanisme de création des processus courant.
+ * @return spawn_backend_t Mécanisme utilisé par *launch_processus()*.
+ */
+spawn_backend_t get_spawn_backend(void)
+{
+    return spawn_backend;
+}
+
+/** @brief Fonction de conversion d'un nom de mécanisme ("fork", "posix_spawn", "zygote") en valeur spawn_backend_t.
+ * @param name Nom du mécanisme.
+ * @param backend Pointeur vers la valeur à remplir.
+ * @return int 0 en cas de succès, -1 si le nom est inconnu.
  */
+int parse_spawn_backend(const char *name, spawn_backend_t *backend)
+{
+    if (!name || !backend)
+        return -1;
+    if (strcmp(name, "fork") == 0)
+        *backend = SPAWN_FORK;
+    else if (strcmp(name, "posix_spawn") == 0 || strcmp(name, "spawn") == 0)
+        *backend = SPAWN_POSIX_SPAWN;
+    else if (strcmp(name, "zygote") == 0)
+        *backend = SPAWN_ZYGOTE;
+    else
+        return -1;
+    return 0;
+}
+
+/// Code de retour de la dernière commande exécutée au premier plan
+static int last_status = 0;
 
-void get_current_time_legacy(struct timespec *ts)
+/** @brief Fonction de récupération du code de retour de la dernière commande exécutée.
+ * @return int Code de retour (après inversion éventuelle par "!") de la dernière commande lancée par *launch_command_line()*.
+ */
+int get_last_status(void)
 {
-    struct timeval tv;
-    if (gettimeofday(&tv, NULL) == 0)
+    return last_status;
+}
+
+/// PID du dernier processus lancé en arrière-plan ($!)
+static pid_t last_background_pid = 0;
+
+/** @brief Fonction de récupération du PID de la dernière commande lancée en arrière-plan.
+ * @return pid_t PID du dernier processus lancé avec '&' (dernière étape pour un pipeline), 0 si aucun.
+ */
+pid_t get_last_background_pid(void)
+{
+    return last_background_pid;
+}
+
+/// Nombre maximal de jobs d'arrière-plan simultanés (0 : illimité, -1 : pas encore initialisé)
+static int max_jobs = -1;
+
+/** @brief Fonction de sélection du nombre maximal de jobs d'arrière-plan exécutés simultanément.
+ * @param n Nombre maximal de jobs (0 : illimité).
+ * @return int 0 en cas de succès, -1 si *n* est négatif.
+ * @details Quand la limite est atteinte, le lancement d'un nouveau job d'arrière-plan attend la fin de l'un des jobs en cours.
+ */
+int set_max_jobs(int n)
+{
+    if (n < 0)
+        return -1;
+    max_jobs = n;
+    return 0;
+}
+
+/** @brief Fonction de récupération du nombre maximal de jobs d'arrière-plan exécutés simultanément.
+ * @return int Nombre maximal de jobs (0 : illimité). Par défaut, le nombre de processeurs en ligne.
+ */
+int get_max_jobs(void)
+{
+    if (max_jobs < 0)
     {
-        ts->tv_sec = tv.tv_sec;
-        //  conversion micro -> nano 
-        ts->tv_nsec = tv.tv_usec * 1000;
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        max_jobs = (n > 0) ? (int)n : 1;
     }
+    return max_jobs;
 }
-int launch_processus(processus_t *proc)
+
+/// Shell interactif (voir *set_interactive()*)
+static int interactive = 0;
+
+/** @brief Fonction d'indication du mode du shell.
+ * @param on 1 si le shell lit ses commandes sur un terminal, 0 pour un script, "-c" ou une entrée redirigée.
+ * @details En mode non interactif, l'échec de "exec commande" termine le shell (POSIX).
+ */
+void set_interactive(int on)
+{
+    interactive = on ? 1 : 0;
+}
+
+/** @brief Fonction de récupération du mode du shell.
+ * @return int 1 si le shell est interactif, 0 sinon.
+ */
+int is_interactive(void)
+{
+    return interactive;
+}
+
+static uint64_t *shell_fds = NULL;       ///< Descripteurs de l'utilisateur au-delà de 2 : "exec n>...", ou hérités (un bit par descripteur)
+static unsigned int shell_fds_words = 0; ///< Nombre de mots de *shell_fds*
+static unsigned int num_shell_fds = 0;   ///< Nombre de bits à 1 dans *shell_fds*
+
+/** @brief Test de la présence de *fd* dans *shell_fds*. */
+static int shell_fd_listed(int fd)
+{
+    return fd >= 0 && (unsigned int)fd / 64 < shell_fds_words && ((shell_fds[fd / 64] >> (fd % 64)) & 1);
+}
+
+/** @brief Ajout (*listed* à 1) ou retrait de *fd* dans *shell_fds* ; un échec d'allocation laisse seulement le descripteur hors du suivi. */
+static void track_shell_fd(int fd, int listed)
 {
-    if (!proc || !proc->argv[0])
+    unsigned int word = (unsigned int)fd / 64;
+    if (listed && word >= shell_fds_words)
     {
-        fprintf(stderr, "Erreur: commande invalide\n");
-        return -1;
+        uint64_t *bits = realloc(shell_fds, (word + 1) * sizeof *bits);
+        if (!bits)
+            return;
+        memset(bits + shell_fds_words, 0, (word + 1 - shell_fds_words) * sizeof *bits);
+        shell_fds = bits;
+        shell_fds_words = word + 1;
     }
+    if (listed == shell_fd_listed(fd))
+        return;
+    shell_fds[word] ^= UINT64_C(1) << (fd % 64);
+    num_shell_fds += listed ? 1 : -1;
+}
 
-    // temps de début
-    get_current_time_legacy(&proc->start_time);
+/** @brief Lecture de l'horloge monotone (insensible aux réglages de l'heure système, résolution à la nanoseconde). */
+static void get_current_time(struct timespec *ts)
+{
+    clock_gettime(CLOCK_MONOTONIC, ts);
+}
 
-    // BUILTINS
-    if (is_builtin(proc))
+/** @brief Installation des descripteurs du processus dans le fils, avant l'exec : IOs standards puis *fd_mappings*.
+ * @details Les copies par *dup2()* n'ont pas O_CLOEXEC : elles seules survivent à l'exec (l'ordre est sans importance, voir *protect_sources()*).
+ */
+static void install_fds(const processus_t *proc)
+{
+    int std[3] = {proc->stdin_fd, proc->stdout_fd, proc->stderr_fd};
+    for (int fd = 0; fd < 3; ++fd)
     {
-        int rc = exec_builtin(proc);
-        proc->status = rc; 
+        if (std[fd] < 0)
+            close(fd);
+        else if (std[fd] != fd)
+            dup2(std[fd], fd);
+    }
+    for (unsigned int i = 0; i < proc->num_fd_mappings; ++i)
+    {
+        const fd_mapping_t *m = &proc->fd_mappings[i];
+        if (m->source < 0)
+            close(m->fd);
+        else if (m->source != m->fd)
+            dup2(m->source, m->fd);
+    }
+}
 
-        // temps de fin
-        get_current_time_legacy(&proc->end_time);
-        return 0;
+/** @brief Création du processus fils via fork() et execve().
+ * @param proc Processus à lancer.
+ * @param path Chemin de l'exécutable.
+ * @param mask Masque de signaux à restaurer dans le fils (SIGCHLD est bloqué dans le shell pendant le lancement).
+ * @return pid_t PID du fils, 0 si l'exec a échoué (*exec_errno* renseigné, fils déjà récupéré), -1 si le fork a échoué.
+ * @details Un tube CLOEXEC permet au fils de transmettre errno au père si l'exec échoue :
+ *    le tube est fermé automatiquement par un exec réussi, le père lit donc 0 octet dans ce cas.
+ */
+static pid_t spawn_fork(processus_t *proc, const char *path, const sigset_t *mask)
+{
+    int errpipe[2];
+    if (pipe2(errpipe, O_CLOEXEC) < 0)
+    {
+        perror("pipe2");
+        return -1;
     }
 
-    // COMMANDES EXTERNES 
     pid_t pid = fork();
     if (pid < 0)
     {
         perror("fork failed");
-        proc->status = 1;
+        close(errpipe[0]);
+        close(errpipe[1]);
         return -1;
     }
 
     if (pid == 0) // fils
-    {     
+    {
+        close(errpipe[0]);
+        sigprocmask(SIG_SETMASK, mask, NULL);
+
         // appliquer les redirections
-        if (proc->stdin_fd != 0)
-            dup2(proc->stdin_fd, STDIN_FILENO);
-        if (proc->stdout_fd != 1)
-            dup2(proc->stdout_fd, STDOUT_FILENO);
-        if (proc->stderr_fd != 2)
-            dup2(proc->stderr_fd, STDERR_FILENO);
-
-        // fermer les descripteurs ouverts
-        if (proc->cf && proc->cf->cmdl)
-        {
-            int max_fds = MAX_CMDS * 3 + 1;
-            for (int i = 0; i < max_fds; ++i)
-            {
-                int fd = proc->cf->cmdl->opened_descriptors[i];
-                if (fd >= 3)
-                {
-                    close(fd);
-                }
-            }
-        }
+        install_fds(proc);
+
+        // les descripteurs de la ligne (O_CLOEXEC) sont fermés par l'exec, leurs copies 0, 1 et 2 restent ouvertes
+        execve(path, proc->argv, proc->envp);
 
-        const char *path = proc->path ? proc->path : proc->argv[0];
+        // si on arrive ici c'est une erreur : on la transmet au père
+        int err = errno;
+        ssize_t unused = write(errpipe[1], &err, sizeof err);
+        (void)unused;
+        _exit(127);
+    }
 
-        execvp(path, proc->argv);
+    // père : lecture bloquante jusqu'à l'exec (EOF) ou l'échec (errno)
+    close(errpipe[1]);
+    int err = 0;
+    ssize_t n;
+    do
+        n = read(errpipe[0], &err, sizeof err);
+    while (n < 0 && errno == EINTR);
+    close(errpipe[0]);
 
-        // si on arrive ici c'est une erreur
-        perror("execvp failed");
-        _exit(127); // 127 est le standard pour "command not found"
+    if (n == (ssize_t)sizeof err)
+    {
+        // le fils n'a jamais exécuté la commande : on le récupère tout de suite
+        int status;
+        waitpid(pid, &status, 0);
+        proc->exec_errno = err;
+        return 0;
     }
+    return pid;
+}
 
-    // père
-    proc->pid = pid;
+/** @brief Création du processus fils via posix_spawn().
+ * @param proc Processus à lancer.
+ * @param path Chemin de l'exécutable.
+ * @param mask Masque de signaux du fils (POSIX_SPAWN_SETSIGMASK).
+ * @return pid_t PID du fils, 0 si l'exec a échoué (*exec_errno* renseigné), -1 en cas d'erreur de mise en place.
+ * @details Les redirections sont décrites par des "file actions" (une par descripteur redirigé ou fermé) ;
+ *    les descripteurs de *opened_descriptors*, créés avec O_CLOEXEC, sont fermés par l'exec sans action supplémentaire.
+ *    La glibc crée le fils avec CLONE_VM|CLONE_VFORK : le coût ne dépend pas de la taille du tas du shell,
+ *    et un échec de l'exec est directement retourné par *posix_spawn()*.
+ */
+static pid_t spawn_posix(processus_t *proc, const char *path, const sigset_t *mask)
+{
+    posix_spawn_file_actions_t actions;
+    if (posix_spawn_file_actions_init(&actions) != 0)
+        return -1;
 
-    // fermeture des descripteurs côté père (ceux utilisés pour la redirection)
-    if (proc->stdin_fd > 2)
-        close(proc->stdin_fd);
-    if (proc->stdout_fd > 2)
-        close(proc->stdout_fd);
-    if (proc->stderr_fd > 2)
-        close(proc->stderr_fd);
-
-    // reset des valeurs par défaut pour éviter les accidents
+    // mêmes copies que *install_fds()*
+    int rc = 0;
+    int std[3] = {proc->stdin_fd, proc->stdout_fd, proc->stderr_fd};
+    for (int fd = 0; fd < 3; ++fd)
+    {
+        if (std[fd] < 0)
+            rc |= posix_spawn_file_actions_addclose(&actions, fd);
+        else if (std[fd] != fd)
+            rc |= posix_spawn_file_actions_adddup2(&actions, std[fd], fd);
+    }
+    for (unsigned int i = 0; i < proc->num_fd_mappings; ++i)
+    {
+        const fd_mapping_t *m = &proc->fd_mappings[i];
+        if (m->source < 0)
+            rc |= posix_spawn_file_actions_addclose(&actions, m->fd);
+        else if (m->source != m->fd)
+            rc |= posix_spawn_file_actions_adddup2(&actions, m->source, m->fd);
+    }
+
+    if (rc != 0)
+    {
+        posix_spawn_file_actions_destroy(&actions);
+        return -1;
+    }
+
+    posix_spawnattr_t attr;
+    if (posix_spawnattr_init(&attr) != 0)
+    {
+        posix_spawn_file_actions_destroy(&actions);
+        return -1;
+    }
+    posix_spawnattr_setsigmask(&attr, mask);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK);
+
+    pid_t pid = 0;
+    rc = posix_spawn(&pid, path, &actions, &attr, proc->argv, proc->envp);
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+
+    if (rc != 0)
+    {
+        proc->exec_errno = rc;
+        return 0;
+    }
+    return pid;
+}
+
+/** @brief Création du processus via le zygote.
+ * @param proc Processus à lancer.
+ * @param path Chemin de l'exécutable.
+ * @return pid_t PID du processus, 0 si l'exec a échoué (*exec_errno* renseigné), -1 si le zygote n'a pas pu le lancer.
+ * @details Le processus est créé par un fils en réserve du zygote, qui reçoit les descripteurs des IOs standards :
+ *    les autres descripteurs du shell (*opened_descriptors*) ne lui sont jamais transmis. Une commande qui ferme une IO standard
+ *    ou redirige d'autres descripteurs (*fd_mappings*) n'est donc pas confiée au zygote, pas plus qu'une commande lancée
+ *    alors que le shell a ouvert des descripteurs par "exec n>..." (voir *set_shell_fd()*) : elle doit en hériter.
+ */
+static pid_t spawn_zygote(processus_t *proc, const char *path)
+{
+    int fds[3] = {proc->stdin_fd, proc->stdout_fd, proc->stderr_fd};
+    return zygote_spawn(path, proc->argv, proc->envp, fds, &proc->exec_errno);
+}
+
+/** @brief Création du processus fils avec le mécanisme courant.
+ * @param proc Processus à lancer.
+ * @param path Chemin de l'exécutable.
+ * @param mask Masque de signaux du fils.
+ * @return pid_t PID du fils, 0 si l'exec a échoué (*exec_errno* renseigné), -1 en cas d'erreur système.
+ * @details Le zygote ne sert qu'aux commandes de premier plan suivies par la table des jobs (la latence de démarrage y est perçue) ;
+ *    s'il ne peut pas lancer la commande, *posix_spawn()* prend le relais.
+ */
+static pid_t spawn(processus_t *proc, const char *path, const sigset_t *mask)
+{
+    if (spawn_backend == SPAWN_ZYGOTE && !proc->is_background && proc->job_id > 0 && zygote_running() &&
+        proc->num_fd_mappings == 0 && proc->stdin_fd >= 0 && proc->stdout_fd >= 0 && proc->stderr_fd >= 0 && get_num_shell_fds() == 0)
+    {
+        pid_t pid = spawn_zygote(proc, path);
+        if (pid >= 0)
+            return pid;
+    }
+    return (spawn_backend == SPAWN_FORK) ? spawn_fork(proc, path, mask) : spawn_posix(proc, path, mask);
+}
+
+/** @brief Exécution d'une commande intégrée dans un fils, sans exec (étape d'un pipeline).
+ * @param proc Processus à lancer (commande intégrée résolue dans *proc->builtin*).
+ * @param mask Masque de signaux à restaurer dans le fils.
+ * @return pid_t PID du fils, -1 si le fork a échoué.
+ * @details Le fils s'exécute en parallèle des autres étapes : une commande intégrée qui écrit plus que la capacité du tube ne bloque plus le shell.
+ *    Comme dans un sous-shell POSIX, ses effets sur l'état du shell (cd, export, exit...) restent confinés au fils,
+ *    et il ne voit aucun job : "wait", "fg" et "bg" n'y attendent ni ne reprennent les jobs du shell.
+ *    Le code de retour de la commande devient le code de sortie du fils.
+ */
+static pid_t spawn_builtin(processus_t *proc, const sigset_t *mask)
+{
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        perror("fork failed");
+        return -1;
+    }
+    if (pid > 0)
+        return pid;
+
+    // fils : mêmes redirections qu'avant un exec ; sans exec, O_CLOEXEC ne ferme rien : tout descripteur au-delà de 2 est fermé
+    // (un bout de tube gardé ouvert empêcherait la fin de fichier ou SIGPIPE dans les autres étapes)
+    // (une commande intégrée n'utilise que les IOs standards : *fd_mappings* n'est pas installé)
+    int std[3] = {proc->stdin_fd, proc->stdout_fd, proc->stderr_fd};
+    for (int fd = 0; fd < 3; ++fd)
+    {
+        if (std[fd] < 0)
+            close(fd);
+        else if (std[fd] != fd)
+            dup2(std[fd], fd);
+    }
+    if (close_range(3, ~0U, 0) != 0 && proc->cf && proc->cf->cmdl)
+    {
+        // noyau sans close_range() (avant Linux 5.9) : descripteurs de la ligne
+        command_line_t *cmdl = proc->cf->cmdl;
+        for (unsigned int w = 0; w < cmdl->opened_capacity; ++w)
+            for (uint64_t bits = cmdl->opened_descriptors[w]; bits; bits &= bits - 1)
+                if (w * 64 + __builtin_ctzll(bits) >= 3)
+                    close((int)(w * 64 + __builtin_ctzll(bits)));
+    }
     proc->stdin_fd = 0;
     proc->stdout_fd = 1;
     proc->stderr_fd = 2;
 
-    // si exec en arrière-plan
-    if (proc->is_background)
+    jobs_clear();
+    sigprocmask(SIG_SETMASK, mask, NULL);
+    // _exit() sans vider les tampons stdio hérités du shell (les commandes intégrées écrivent avec output.h, vidé par exec_builtin())
+    _exit(exec_builtin(proc) & 0xff);
+}
+
+/** @brief Construction du texte d'une commande à partir des arguments de ses processus (pour la table des jobs).
+ * @param proc Processus seul ou première étape d'un pipeline.
+ * @param buf Tampon de destination.
+ * @param size Taille du tampon.
+ * @return const char* *buf*.
+ * @details Les étapes d'un pipeline sont séparées par " | " ; le texte est tronqué si le tampon est trop petit.
+ */
+static const char *format_command(processus_t *proc, char *buf, size_t size)
+{
+    size_t len = 0;
+    buf[0] = '\0';
+    while (proc)
     {
-        proc->status = 0;
-        return 0;
+        for (int i = 0; proc->argv[i] && len < size; ++i)
+            len += snprintf(buf + len, size - len, "%s%s", i ? " " : "", proc->argv[i]);
+        proc = (proc->cf && proc->cf->pipe_next) ? proc->cf->pipe_next->proc : NULL;
+        if (proc && len < size)
+            len += snprintf(buf + len, size - len, " | ");
+    }
+    if (len < size)
+        snprintf(buf + len, size - len, " &");
+    return buf;
+}
+
+/** @brief Fermeture, côté shell, des descripteurs de redirection d'un processus lancé.
+ * @param proc Processus dont les descripteurs doivent être fermés.
+ * @details Les descripteurs sont remis à leur valeur par défaut pour éviter les accidents.
+ *    Un même descripteur partagé par deux IOs (cas de 2>&1) n'est fermé qu'une fois, et un descripteur de *opened_descriptors* en est retiré.
+ */
+static void close_processus_fds(processus_t *proc)
+{
+    command_line_t *cmdl = proc->cf ? proc->cf->cmdl : NULL;
+    int fds[3] = {proc->stdin_fd, proc->stdout_fd, proc->stderr_fd};
+    for (int i = 0; i < 3; ++i)
+    {
+        if (fds[i] <= 2 || (i > 0 && fds[i] == fds[0]) || (i > 1 && fds[i] == fds[1]))
+            continue;
+        // descripteur de la ligne : retiré de la liste pour ne pas être refermé par close_fds()
+        // (un descripteur ouvert par "exec n>..." est copié par "n>&m" et reste ouvert)
+        if (remove_fd(cmdl, fds[i]) != 0 && !shell_fd_listed(fds[i]))
+            close(fds[i]);
     }
+    // descripteurs au-delà de 2 : toujours ouverts par la ligne (ou du shell, laissés ouverts)
+    for (unsigned int i = 0; i < proc->num_fd_mappings; ++i)
+        remove_fd(cmdl, proc->fd_mappings[i].source);
+    proc->num_fd_mappings = 0;
 
-    // avant-plan
+    proc->stdin_fd = 0;
+    proc->stdout_fd = 1;
+    proc->stderr_fd = 2;
+}
+
+/** @brief Reconnaissance d'une commande formée uniquement d'affectations "NOM=valeur".
+ * @return int 1 si tous les arguments sont des affectations, 0 sinon.
+ */
+static int is_assignment(const processus_t *proc)
+{
+    for (int i = 0; proc->argv[i]; ++i)
+    {
+        const char *eq = strchr(proc->argv[i], '=');
+        if (!eq || !vars_valid_name(proc->argv[i], eq - proc->argv[i]))
+            return 0;
+    }
+    return 1;
+}
+
+/** @brief Affectation des variables "NOM=valeur" de *proc* (variables locales du shell, ou exportées si elles l'étaient déjà).
+ * @return int 0 en cas de succès, 1 si une affectation a échoué.
+ */
+static int assign_variables(processus_t *proc)
+{
     int status = 0;
-    if (waitpid(pid, &status, 0) < 0)
+    for (int i = 0; proc->argv[i]; ++i)
+    {
+        const char *eq = strchr(proc->argv[i], '=');
+        char *name = strndup(proc->argv[i], eq - proc->argv[i]);
+        if (!name || vars_set(name, eq + 1, 0) != 0)
+        {
+            dprintf(proc->stderr_fd, "minishell: %s: affectation impossible\n", proc->argv[i]);
+            status = 1;
+        }
+        free(name);
+    }
+    return status;
+}
+
+/** @brief Emplacement de la valeur d'un descripteur du processus : IO standard, ou élément de *fd_mappings* (ajouté si *create*).
+ * @return int* Emplacement, NULL si *fd* (au-delà de 2) n'est pas redirigé et que *create* vaut 0.
+ * @details *fd_mappings* a la place de toutes les redirections du processus (voir *open_redirections()*).
+ */
+static int *fd_slot(processus_t *proc, int fd, int create)
+{
+    if (fd <= 2)
+        return (fd == 0) ? &proc->stdin_fd : (fd == 1) ? &proc->stdout_fd : &proc->stderr_fd;
+    for (unsigned int i = 0; i < proc->num_fd_mappings; ++i)
+    {
+        if (proc->fd_mappings[i].fd == fd)
+            return &proc->fd_mappings[i].source;
+    }
+    if (!create)
+        return NULL;
+    fd_mapping_t *m = &proc->fd_mappings[proc->num_fd_mappings++];
+    m->fd = fd;
+    m->source = fd;
+    return &m->source;
+}
+
+/** @brief Le descripteur *fd* du fils reçoit une autre valeur que celle du shell (il sera remplacé ou fermé avant l'exec). */
+static int fd_replaced(processus_t *proc, int fd)
+{
+    int *slot = fd_slot(proc, fd, 0);
+    return slot && *slot != fd;
+}
+
+/** @brief Protection des sources écrasées par l'installation d'un autre descripteur ("2>&1 >f" : la sortie d'origine, 1, est remplacée par f).
+ * @return int 0 en cas de succès, -1 en cas d'erreur (message sur la sortie d'erreur du shell).
+ * @details Une telle source est copiée au-delà de tous les descripteurs du processus (avec O_CLOEXEC, dans *opened_descriptors*) :
+ *    les copies sur les descripteurs du fils (*dup2()* ou "file actions") peuvent alors se faire dans n'importe quel ordre.
+ *    Un descripteur de la ligne gardé sous son propre numéro ("3>&3") est aussi copié, l'original étant fermé par l'exec.
+ */
+static int protect_sources(processus_t *proc, command_line_t *cmdl)
+{
+    int top = 2;
+    for (unsigned int i = 0; i < proc->num_fd_mappings; ++i)
+        top = (proc->fd_mappings[i].fd > top) ? proc->fd_mappings[i].fd : top;
+
+    for (unsigned int i = 0; i < 3 + proc->num_fd_mappings; ++i)
+    {
+        int fd = (i < 3) ? (int)i : proc->fd_mappings[i - 3].fd;
+        int *source = fd_slot(proc, fd, 0);
+        if (*source < 0 || !(*source == fd ? fd > 2 && has_fd(cmdl, fd) : fd_replaced(proc, *source)))
+            continue;
+        int copy = fcntl(*source, F_DUPFD_CLOEXEC, top + 1);
+        if (copy < 0 || add_fd(cmdl, copy) != 0)
+        {
+            fprintf(stderr, "minishell: %d: %s\n", *source, strerror(copy < 0 ? errno : ENOMEM));
+            if (copy >= 0)
+                close(copy);
+            return -1;
+        }
+        *source = copy;
+    }
+    return 0;
+}
+
+/** @brief Création du descripteur d'un document en ligne, positionné au début de son contenu.
+ * @return int Descripteur (O_CLOEXEC), -1 en cas d'erreur (errno renseigné).
+ * @details Un contenu d'au plus PIPE_BUF octets est écrit dans un tube, dont la capacité garantit que l'écriture ne bloque pas ;
+ *    au-delà, il est écrit dans un fichier anonyme en mémoire (*memfd_create()*) : aucun fichier temporaire sur disque, et le shell,
+ *    qui écrit tout le contenu avant de lancer la commande, ne peut pas rester bloqué sur un tube plein.
+ */
+static int open_here_document(const char *text)
+{
+    size_t len = strlen(text);
+    if (len <= PIPE_BUF)
+    {
+        int fds[2];
+        if (pipe2(fds, O_CLOEXEC) != 0)
+            return -1;
+        if (len > 0 && write(fds[1], text, len) != (ssize_t)len)
+        {
+            int err = errno;
+            close(fds[0]);
+            close(fds[1]);
+            errno = err;
+            return -1;
+        }
+        close(fds[1]);
+        return fds[0];
+    }
+
+    int fd = memfd_create("minishell-heredoc", MFD_CLOEXEC);
+    if (fd < 0)
+        return -1;
+    for (size_t done = 0; done < len;)
+    {
+        ssize_t n = write(fd, text + done, len - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+        {
+            int err = errno;
+            close(fd);
+            errno = err;
+            return -1;
+        }
+        done += n;
+    }
+    if (lseek(fd, 0, SEEK_SET) != 0)
+    {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+    return fd;
+}
+
+/** @brief Ouverture des redirections d'un processus, dans l'ordre de la ligne.
+ * @return int 0 en cas de succès, -1 si un fichier n'a pas pu être ouvert ou si un descripteur dupliqué n'existe pas
+ *    (message sur la sortie d'erreur du shell).
+ * @details Les fichiers sont ouverts avec O_CLOEXEC et ajoutés à *opened_descriptors* : seules leurs copies sur les descripteurs de la commande
+ *    lui sont transmises. Les IOs standards sont dans *stdin_fd*, *stdout_fd* et *stderr_fd*, les autres descripteurs dans *fd_mappings*.
+ *    "n>&m" copie la valeur de m à ce point de la ligne (celle du shell si m n'a pas été redirigé) ; "n>&-" ferme n (valeur -1).
+ *    Un fichier remplacé par une redirection suivante du même descripteur ("> a > b") reste ouvert jusqu'à *close_fds()*.
+ *    Un document en ligne devient un tube ou un fichier en mémoire (voir *open_here_document()*), traité comme un fichier ouvert.
+ */
+static int open_redirections(processus_t *proc)
+{
+    command_line_t *cmdl = proc->cf ? proc->cf->cmdl : NULL;
+    if (!proc->redirections)
+        return 0;
+    if (!cmdl)
+        return -1;
+
+    // place de tous les descripteurs au-delà de 2 (une redirection en ajoute au plus un)
+    unsigned int count = 0;
+    for (redirection_t *r = proc->redirections; r; r = r->next)
+        count += (r->fd > 2);
+    proc->num_fd_mappings = 0;
+    proc->fd_mappings = count ? arena_alloc(&cmdl->arena, count * sizeof *proc->fd_mappings) : NULL;
+    if (count && !proc->fd_mappings)
+    {
+        perror("arena_alloc");
+        return -1;
+    }
+
+    for (redirection_t *r = proc->redirections; r; r = r->next)
+    {
+        int value = -1; // fermeture
+        if (r->here)
+        {
+            // document en ligne : contenu substitué maintenant, comme le nom d'un fichier
+            const char *text = r->path;
+            if (r->expand && !(text = expand_string(&cmdl->arena, r->path)))
+            {
+                perror("expand_string");
+                return -1;
+            }
+            value = open_here_document(text);
+            if (value < 0)
+            {
+                fprintf(stderr, "minishell: document en ligne : %s\n", strerror(errno));
+                return -1;
+            }
+            if (add_fd(cmdl, value) != 0)
+            {
+                close(value);
+                return -1;
+            }
+        }
+        else if (r->path)
+        {
+            const char *path = r->path;
+            if (r->expand && !(path = expand_string(&cmdl->arena, r->path)))
+            {
+                perror("expand_string");
+                return -1;
+            }
+            value = open(path, r->flags | O_CLOEXEC, 0644);
+            // le fichier a pu être créé ou tronqué : les résultats de stat() mémorisés par "test" sont périmés
+            if (r->flags & (O_CREAT | O_TRUNC | O_APPEND))
+                builtin_stat_cache_clear();
+            if (value < 0)
+            {
+                fprintf(stderr, "minishell: %s: %s\n", path, strerror(errno));
+                return -1;
+            }
+            if (add_fd(cmdl, value) != 0)
+            {
+                close(value);
+                return -1;
+            }
+        }
+        else if (r->source >= 0)
+        {
+            // valeur courante de la source : redirigée plus tôt sur la ligne, ou descripteur du shell
+            int *slot = fd_slot(proc, r->source, 0);
+            value = slot ? *slot : (is_shell_fd(r->source) ? r->source : -1);
+            if (value < 0)
+            {
+                fprintf(stderr, "minishell: %d: %s\n", r->source, strerror(EBADF));
+                return -1;
+            }
+            // descripteur hérité par le shell ("minishell script 3>journal") : suivi comme ceux de "exec", jamais fermé par la ligne
+            if (!slot && value > 2)
+                track_shell_fd(value, 1);
+        }
+        *fd_slot(proc, r->fd, 1) = value;
+    }
+    return protect_sources(proc, cmdl);
+}
+
+/** @brief Fonction de remplacement du shell par un programme, sans fork.
+ * @param name Nom de la commande : cherché dans $PATH via le cache des chemins s'il ne contient pas de '/'
+ *    (résolu à nouveau si le chemin mémorisé n'existe plus).
+ * @param argv Arguments du programme.
+ * @param envp Environnement du programme.
+ * @return int Ne retourne qu'en cas d'échec : 127 si la commande est introuvable, 126 si elle n'est pas exécutable (errno renseigné).
+ * @details Les sorties tamponnées sont d'abord écrites, et le shell cesse d'être "subreaper" (mécanisme SPAWN_ZYGOTE) : les commandes
+ *    orphelines ne doivent pas être rattachées au programme qui le remplace. L'attribut est rétabli si l'exec échoue.
+ *    Utilisée par "exec commande" et pour la dernière commande d'un script ou de "-c" (voir *launch_command_line()*).
+ */
+int replace_shell(const char *name, char *const argv[], char *const envp[])
+{
+    output_flush_all();
+    fflush(NULL);
+    if (spawn_backend == SPAWN_ZYGOTE)
+        prctl(PR_SET_CHILD_SUBREAPER, 0);
+
+    int cached = (strchr(name, '/') == NULL);
+    const char *path = cached ? path_cache_lookup(name) : name;
+    if (path)
+    {
+        execve(path, argv, envp);
+        if (errno == ENOENT && cached && (path = path_cache_refresh(name)))
+            execve(path, argv, envp);
+    }
+    else
+        errno = ENOENT;
+
+    int err = errno;
+    if (spawn_backend == SPAWN_ZYGOTE)
+        prctl(PR_SET_CHILD_SUBREAPER, 1);
+    errno = err;
+    return (err == ENOENT || err == ENOTDIR) ? 127 : 126;
+}
+
+/** @brief Remplacement du shell par une commande externe, sans fork (dernière commande d'un script ou de "-c").
+ * @param proc Processus à exécuter.
+ * @param name Nom de la commande.
+ * @details Les redirections sont installées dans le shell lui-même, comme dans un fils (voir *install_fds()*), puis *replace_shell()*
+ *    exécute la commande. Ne retourne jamais : si l'exec échoue, les descripteurs du shell sont déjà remplacés et il se termine avec
+ *    le statut 127 ou 126, celui qu'aurait donné la commande lancée dans un fils.
+ */
+static void exec_in_place(processus_t *proc, const char *name)
+{
+    install_fds(proc);
+    int status = replace_shell(name, proc->argv, proc->envp);
+    dprintf(STDERR_FILENO, "minishell: %s: %s\n", proc->argv[0], strerror(errno));
+    exit(status);
+}
+
+/** @brief Commande sans mot ni redirection dès l'analyse ("a ; ; b").
+ * @details A tester avant *expand_processus()* : des mots tous vides après substitution ("$VIDE") ne rendent pas la commande invalide.
+ */
+static int is_empty_command(const processus_t *proc)
+{
+    return !proc->argv[0] && !proc->redirections && !proc->expand;
+}
+
+/** @brief Fonction de démarrage d'un processus sans attendre sa fin.
+ * @param proc Pointeur vers la structure de processus à démarrer.
+ * @return int 0 en cas de succès, un code d'erreur sinon.
+ * @details Les paramètres marqués par l'analyseur ($NOM...) sont d'abord substitués par *expand_processus()*, puis les redirections
+ *    sont ouvertes dans l'ordre de la ligne (un fichier impossible à ouvrir donne le statut 1, sans lancer la commande).
+ *    Une commande dont tous les mots sont vides après substitution ("$VIDE > f") ne lance rien : ses redirections sont appliquées et
+ *    son statut vaut 0.
+ *    Une commande formée uniquement d'affectations "NOM=valeur" définit des variables du shell (voir vars.h), sans effet dans un pipeline.
+ *    Une commande intégrée est exécutée immédiatement dans le shell et *status* est renseigné,
+ *    sauf dans un pipeline (*in_pipeline*) où elle est exécutée dans un fils, sans exec, comme dans un sous-shell.
+ *    Une commande externe est résolue via le cache des chemins (voir path_cache.h) puis créée via *posix_spawn()* ou *fork()* et *execve()*
+ *    (selon *get_spawn_backend()*), avec ses redirections (via *dup2()* ou les "file actions" de *posix_spawn*).
+ *    Son environnement (*envp*) est le tableau des variables exportées, *vars_envp()*, reconstruit seulement s'il a changé.
+ *    Si le chemin mémorisé n'existe plus (ENOENT), il est résolu à nouveau avant un second essai.
+ *    Un échec de l'exec est remonté au père (via le code de retour de *posix_spawn()* ou un tube CLOEXEC avec *fork()*) :
+ *    *exec_errno* est alors renseigné et *status* vaut 127 (commande introuvable) ou 126 (commande non exécutable).
+ *    Dans tous les cas, les descripteurs de redirection du processus sont fermés côté shell une fois le processus démarré.
+ *    Si *get_max_jobs()* jobs d'arrière-plan s'exécutent déjà, le démarrage d'un processus d'arrière-plan attend la fin de l'un d'eux.
+ *    Une commande externe marquée *tail_exec* remplace le shell par *execve()* : la fonction ne retourne pas.
+ */
+int start_processus(processus_t *proc)
+{
+    // commande vide à l'analyse ; celle d'une étape de pipeline est signalée par *launch_pipeline()*, avant sa substitution
+    if (!proc || (!proc->in_pipeline && is_empty_command(proc)))
+    {
+        fprintf(stderr, "Erreur: commande invalide\n");
+        return -1;
+    }
+    // paramètres substitués au dernier moment : valeurs laissées par les commandes précédentes de la ligne
+    // (des mots tous vides, "$VIDE", ne laissent aucun argument : la commande ne fait rien, comme "> f" seul)
+    if (proc->expand && proc->cf && expand_processus(proc->cf->cmdl, proc) != 0)
     {
-        perror("waitpid");
+        perror("expand_processus");
         proc->status = 1;
         return -1;
     }
 
-    // analyse du statut de retour
-    if (WIFEXITED(status))
+    // temps de début
+    get_current_time(&proc->start_time);
+
+    // REDIRECTIONS : fichiers ouverts seulement pour une commande effectivement lancée ("> f" seul crée ou vide f)
+    int redirected = open_redirections(proc);
+    if (redirected != 0 || !proc->argv[0])
     {
-        proc->status = WEXITSTATUS(status);
+        proc->status = (redirected != 0) ? 1 : 0;
+        get_current_time(&proc->end_time);
+        close_processus_fds(proc);
+        return 0;
     }
-    else if (WIFSIGNALED(status))
+
+    // AFFECTATIONS "NOM=valeur"
+    if (is_assignment(proc))
     {
-        proc->status = 128 + WTERMSIG(status);
+        proc->status = proc->in_pipeline ? 0 : assign_variables(proc);
+        get_current_time(&proc->end_time);
+        close_processus_fds(proc);
+        return 0;
     }
+
+    // BUILTINS (résolution en une case de la table, mémorisée dans le processus)
+    // Dans un pipeline, la commande intégrée est exécutée dans un fils (voir *spawn_builtin()*)
+    const builtin_t *builtin = resolve_builtin(proc);
+    if (builtin && !proc->in_pipeline)
+    {
+        int rc = exec_builtin(proc);
+        proc->status = rc; 
+
+        // temps de fin
+        get_current_time(&proc->end_time);
+
+        // le lecteur d'un éventuel tube doit voir la fin de fichier
+        close_processus_fds(proc);
+        return 0;
+    }
+
+    // COMMANDES EXTERNES (et commandes intégrées d'un pipeline)
+    proc->exec_errno = 0;
+    proc->envp = vars_envp();
+
+    // résolution du chemin : un nom sans '/' est cherché dans $PATH via le cache
+    const char *name = proc->path ? proc->path : proc->argv[0];
+    const char *path = name;
+    int cached = !builtin && (strchr(name, '/') == NULL);
+    if (cached)
+        path = path_cache_lookup(name);
+
+    // la commande peut modifier les fichiers : les résultats de stat() mémorisés par "test" sont périmés
+    if (!builtin)
+        builtin_stat_cache_clear();
+
+    // dernière commande du shell (voir *launch_command_line()*) : exécutée à sa place, aucun processus n'est créé
+    if (proc->tail_exec && !builtin && path)
+        exec_in_place(proc, name);
+
+    // job du processus (déjà créé pour les étapes d'un pipeline)
+    int own_job = (proc->job_id == 0);
+    if (own_job)
+    {
+        if (proc->is_background)
+            jobs_wait_slot(get_max_jobs()); // limite de jobs d'arrière-plan atteinte : attente d'une place
+        char text[JOB_TEXT_SIZE];
+        proc->job_id = jobs_new(proc->is_background, proc->is_background ? format_command(proc, text, sizeof text) : NULL);
+        if (proc->job_id < 0)
+            proc->job_id = 0;
+    }
+
+    // SIGCHLD est bloqué jusqu'à l'enregistrement du fils : il ne peut pas être récupéré avant d'être connu de la table
+    sigset_t old_mask;
+    jobs_block(&old_mask);
+
+    pid_t pid = 0;
+    if (builtin)
+        pid = spawn_builtin(proc, &old_mask);
+    else if (!path)
+        proc->exec_errno = ENOENT; // introuvable : inutile de créer un processus
     else
+    {
+        pid = spawn(proc, path, &old_mask);
+        if (pid == 0 && cached && proc->exec_errno == ENOENT)
+        {
+            // le chemin mémorisé n'existe plus : nouvelle résolution puis nouvel essai
+            path = path_cache_refresh(name);
+            if (path)
+            {
+                proc->exec_errno = 0;
+                pid = spawn(proc, path, &old_mask);
+            }
+        }
+    }
+    if (pid > 0 && proc->job_id > 0)
+        jobs_add_process(proc->job_id, pid);
+    jobs_unblock(&old_mask);
+
+    if (pid <= 0 && own_job && proc->job_id > 0)
+    {
+        jobs_remove(proc->job_id);
+        proc->job_id = 0;
+    }
+    if (pid < 0)
     {
         proc->status = 1;
+        return -1;
+    }
+
+    // père
+    proc->pid = pid;
+    if (proc->is_background)
+        last_background_pid = pid;
+
+    if (proc->exec_errno != 0)
+        dprintf(proc->stderr_fd, "minishell: %s: %s\n", proc->argv[0], strerror(proc->exec_errno));
+
+    // fermeture des descripteurs côté père (ceux utilisés pour la redirection)
+    close_processus_fds(proc);
+
+    // échec de l'exec : 127 si la commande est introuvable, 126 sinon (convention POSIX)
+    if (proc->exec_errno != 0)
+    {
+        proc->status = (proc->exec_errno == ENOENT || proc->exec_errno == ENOTDIR) ? 127 : 126;
+        get_current_time(&proc->end_time);
+        return 0;
+    }
+
+    proc->status = 0;
+    return 0;
+}
+
+/** @brief Récupération, dans la table des jobs, du statut d'un processus attendu.
+ * @param proc Processus terminé ou stoppé.
+ */
+static void collect_processus(processus_t *proc)
+{
+    job_process_t *jp = jobs_find_pid(proc->pid);
+    if (!jp)
+        return;
+    proc->status = jobs_exit_code(jp->status);
+    if (jp->state == JOB_DONE)
+    {
+        proc->end_time = jp->end_time;
+        proc->rusage = jp->rusage;
+    }
+}
+
+/** @brief Mise à jour d'un job d'avant-plan après son attente.
+ * @param id Numéro du job.
+ * @param first Processus seul ou première étape du job.
+ * @details Un job d'avant-plan terminé est supprimé de la table. Un job stoppé (Ctrl+Z, SIGSTOP) passe en arrière-plan
+ *    pour pouvoir être repris avec "fg" ou "bg".
+ */
+static void settle_job(int id, processus_t *first)
+{
+    job_t *job = jobs_get(id);
+    if (!job || job->is_background)
+        return;
+    if (job->nalive == 0)
+        jobs_remove(id);
+    else if (job->nstopped > 0)
+    {
+        char text[JOB_TEXT_SIZE];
+        jobs_set_background(id, 1, format_command(first, text, sizeof text));
+        dprintf(STDERR_FILENO, "\n[%d]+  Stoppé                  %s\n", id, job->command ? job->command : "");
     }
+}
+
+/** @brief Fonction d'attente de la fin d'un processus démarré par *start_processus()*.
+ * @param proc Pointeur vers la structure de processus à attendre.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @details La valeur de *status* est mise à jour avec le code de retour du fils (128 + numéro du signal s'il a été tué ou stoppé) et *end_time* est renseigné.
+ *    Le fils est récupéré par le gestionnaire de SIGCHLD de la table des jobs (voir jobs.h) : le shell attend via *sigsuspend()* que son état change.
+ *    Rien n'est fait pour une commande intégrée ou un exec échoué, déjà terminés au retour de *start_processus()*.
+ */
+int wait_processus(processus_t *proc)
+{
+    if (!proc)
+        return -1;
+    if (proc->pid <= 0 || proc->exec_errno != 0)
+        return 0;
 
-    // temps de fin si pas background
-    get_current_time_legacy(&proc->end_time);
+    if (jobs_wait_pid(proc->pid) != 0)
+    {
+        // processus absent de la table des jobs (table pleine) : attente directe
+        int status = 0;
+        if (wait4(proc->pid, &status, 0, &proc->rusage) < 0)
+        {
+            perror("wait4");
+            proc->status = 1;
+            return -1;
+        }
+        proc->status = jobs_exit_code(status);
+        get_current_time(&proc->end_time);
+        return 0;
+    }
 
+    collect_processus(proc);
+    settle_job(proc->job_id, proc);
     return 0;
 }
 
+/** @brief Fonction de lancement d'un processus à partir d'une structure de processus.
+ * @param proc Pointeur vers la structure de processus à lancer.
+ * @return int 0 en cas de succès, un code d'erreur sinon.
+ * @details Cette fonction démarre le processus via *start_processus()* puis attend sa fin via *wait_processus()*.
+ *    En cas de succès, le champ *pid* de la structure est mis à jour avec le PID du processus fils.
+ *    Le flag *is_background* détermine si on attend la fin du processus ou non.
+ *    La valeur de *status* est mise à jour à l'issue de l'exécution avec le code de retour du processus fils lorsque le flag *is_background* est désactivé.
+ *    Les temps de démarrage et d'arrêt sont enregistrés dans *start_time* et *end_time* respectivement. *end_time* est mis à jour uniquement si *is_background* est désactivé.
+ *    Les descripteurs de fichiers ouverts sont gérés dans *cf->cmdl->opened_descriptors* : créés avec O_CLOEXEC, ils sont fermés par l'exec du processus "fils".
+ */
+int launch_processus(processus_t *proc)
+{
+    if (start_processus(proc) != 0)
+        return -1;
+
+    // si exec en arrière-plan
+    if (proc->is_background)
+        return 0;
+
+    // avant-plan
+    return wait_processus(proc);
+}
+
 /** @brief Fonction d'initialisation d'une structure de contrôle de flux.
  * @param cf Pointeur vers la structure de contrôle de flux à initialiser.
  * @return int 0 en cas de succès, -1 en cas d'erreur.
@@ -199,6 +1150,7 @@ int launch_processus(processus_t *proc)
  * - *unconditionnal_next*: NULL
  * - *on_success_next*: NULL
  * - *on_failure_next*: NULL
+ * - *pipe_next*: NULL
  * - *cmdl*: NULL
  */
 int init_control_flow(control_flow_t *cf)
@@ -211,21 +1163,64 @@ int init_control_flow(control_flow_t *cf)
     return 0;
 }
 
+/** @brief Agrandissement des tableaux *commands* et *flow* d'une ligne de commande.
+ * @param cmdl Pointeur vers la structure de ligne de commande.
+ * @return int 0 s'il reste une entrée libre, -1 en cas d'erreur d'allocation.
+ * @details Les tableaux sont recopiés dans l'arène avec une capacité doublée ; les pointeurs qui relient processus, contrôle de flux
+ *    et *argv_inline* sont reportés sur les nouvelles copies (les anciennes restent dans l'arène jusqu'à sa remise à zéro).
+ */
+static int reserve_commands(command_line_t *cmdl)
+{
+    if (cmdl->num_commands < cmdl->commands_capacity)
+        return 0;
+
+    unsigned int capacity = cmdl->commands_capacity ? 2 * cmdl->commands_capacity : 4;
+    processus_t *commands = arena_alloc(&cmdl->arena, capacity * sizeof *commands);
+    control_flow_t *flow = arena_alloc(&cmdl->arena, capacity * sizeof *flow);
+    if (!commands || !flow)
+        return -1;
+
+    control_flow_t *old = cmdl->flow;
+#define MOVED(next) ((next) ? flow + ((next) - old) : NULL)
+    for (unsigned int i = 0; i < cmdl->num_commands; ++i)
+    {
+        commands[i] = cmdl->commands[i];
+        if (cmdl->commands[i].argv == cmdl->commands[i].argv_inline)
+            commands[i].argv = commands[i].argv_inline;
+        commands[i].cf = &flow[i];
+        flow[i] = old[i];
+        flow[i].proc = &commands[i];
+        flow[i].unconditionnal_next = MOVED(old[i].unconditionnal_next);
+        flow[i].on_success_next = MOVED(old[i].on_success_next);
+        flow[i].on_failure_next = MOVED(old[i].on_failure_next);
+        flow[i].pipe_next = MOVED(old[i].pipe_next);
+    }
+#undef MOVED
+    cmdl->commands = commands;
+    cmdl->flow = flow;
+    cmdl->commands_capacity = capacity;
+    return 0;
+}
+
 /** @brief Fonction d'ajout d'un processus à la structure de contrôle de flux.
  * @param cmdl Pointeur vers la structure de ligne de commande dans laquelle le processus doit être ajouté.
- * @param mode Mode d'ajout (UNCONDITIONAL, ON_SUCCESS, ON_FAILURE).
- * @return processus_t* Pointeur vers le processus ajouté, ou NULL en cas d'erreur (tableau plein par exemple).
+ * @param mode Mode d'ajout (UNCONDITIONAL, ON_SUCCESS, ON_FAILURE, PIPELINE).
+ * @return processus_t* Pointeur vers le processus ajouté, ou NULL en cas d'erreur (allocation impossible).
  * @details Cette fonction ajoute le processus *proc* à la structure de contrôle de flux *cf* selon le mode spécifié:
  * Le dernier élément du tableau *commands* est retourné après avoir été initialisé dans le dernier élément du tableau *flow*.
  * Cette structure control_flow_t est mise à jour pour que le champ *proc* pointe vers le processus ajouté et la liste est mise à jour de la manière suivante :
  * - Si *mode* est UNCONDITIONAL, *proc* est ajouté à la liste des processus à exécuter inconditionnellement après le processus courant.
  * - Si *mode* est ON_SUCCESS, *proc* est ajouté à la liste des processus à exécuter uniquement si le processus courant s'est terminé avec succès (code de retour 0).
  * - Si *mode* est ON_FAILURE, *proc* est ajouté à la liste des processus à exécuter uniquement si le processus courant s'est terminé avec un échec (code de retour non nul).
+ * - Si *mode* est PIPELINE, *proc* est ajouté comme étape suivante du pipeline du processus courant.
+ *
+ * Quand *commands* est plein, sa capacité double : les processus et le contrôle de flux sont déplacés dans l'arène,
+ * les pointeurs vers les anciens tableaux (processus ou contrôle de flux déjà obtenus) ne sont alors plus valables.
  */
 
 processus_t *add_processus(command_line_t *cmdl, control_flow_mode_t mode)
 {
-    if (cmdl == NULL || cmdl->num_commands >= MAX_CMDS)
+    if (cmdl == NULL || reserve_commands(cmdl) != 0)
         return NULL;
 
     processus_t *proc = &cmdl->commands[cmdl->num_commands];
@@ -249,6 +1244,8 @@ processus_t *add_processus(command_line_t *cmdl, control_flow_mode_t mode)
             prev_cf->on_success_next = cf;
         else if (mode == ON_FAILURE)
             prev_cf->on_failure_next = cf;
+        else if (mode == PIPELINE)
+            prev_cf->pipe_next = cf;
     }
     cmdl->num_commands++;
     return proc;
@@ -256,9 +1253,9 @@ processus_t *add_processus(command_line_t *cmdl, control_flow_mode_t mode)
 
 /** @brief Fonction de récupération du prochain processus à exécuter selon le contrôle de flux.
  * @param cmdl Pointeur vers la structure de ligne de commande.
- * @return processus_t* Pointeur vers le prochain processus à exécuter, ou NULL si le nombre maximum est atteint.
+ * @return processus_t* Pointeur vers le prochain processus à exécuter, ou NULL en cas d'erreur d'allocation.
  * @details Cette fonction retourne un pointeur vers la structure processus_t dans le tableau *commands* situé à l'indice *num_commands + 1*.
- *  Si le nombre maximum de commandes est atteint (MAX_CMDS), la fonction retourne NULL.
+ *  Le tableau est agrandi au besoin (voir *add_processus()*) : le pointeur retourné reste celui du prochain *add_processus()*.
  *  Cela permet notamment d'initialiser les descripteurs des IOs standards qui dépendent du processus en court de traitement (dans le cas des pipes par exemple).
  */
 processus_t *next_processus(command_line_t *cmdl)
@@ -266,7 +1263,7 @@ processus_t *next_processus(command_line_t *cmdl)
 
     if (!cmdl)
         return NULL;
-    if (cmdl->num_commands >= MAX_CMDS)
+    if (reserve_commands(cmdl) != 0)
         return NULL;
     return &cmdl->commands[cmdl->num_commands];
 }
@@ -274,30 +1271,45 @@ processus_t *next_processus(command_line_t *cmdl)
 /** @brief Fonction d'ajout d'un descripteur de fichier à la structure de contrôle de flux.
  * @param cmdl Pointeur vers la structure de ligne de commande.
  * @param fd Descripteur de fichier à ajouter.
- * @return int 0 en cas de succès, -1 en cas d'erreur (tableau plein ou fd invalide).
- * @details Cette fonction ajoute le descripteur de fichier *fd* au tableau *opened_descriptors* de la structure *cf*.
- *    Si le tableau est plein ou si *fd* est invalide (négatif), la fonction retourne -1
+ * @return int 0 en cas de succès, -1 en cas d'erreur (allocation impossible ou fd invalide).
+ * @details Cette fonction ajoute le descripteur de fichier *fd* à l'ensemble *opened_descriptors* (un bit par descripteur, agrandi dans l'arène
+ *    si *fd* dépasse sa capacité) : l'ajout se fait en O(1), et ajouter un descripteur déjà présent ne change rien.
+ *    Le descripteur doit être créé avec O_CLOEXEC : il n'est alors transmis à aucune commande exécutée (seules ses copies 0, 1 et 2 le sont).
+ *    Si *fd* est invalide (négatif), la fonction retourne -1
  */
 int add_fd(command_line_t *cmdl, int fd)
 {
     if (!cmdl || fd < 0)
         return -1;
-    for (int i = 0; i < MAX_OPENED; ++i)
+    unsigned int word = (unsigned int)fd / 64;
+    if (word >= cmdl->opened_capacity)
     {
-        if (cmdl->opened_descriptors[i] == -1)
-        {
-            cmdl->opened_descriptors[i] = fd;
-            return 0;
-        }
+        unsigned int capacity = cmdl->opened_capacity ? 2 * cmdl->opened_capacity : 1;
+        if (capacity <= word)
+            capacity = word + 1;
+        uint64_t *bits = arena_alloc(&cmdl->arena, capacity * sizeof *bits);
+        if (!bits)
+            return -1;
+        if (cmdl->opened_capacity > 0)
+            memcpy(bits, cmdl->opened_descriptors, cmdl->opened_capacity * sizeof *bits);
+        memset(bits + cmdl->opened_capacity, 0, (capacity - cmdl->opened_capacity) * sizeof *bits);
+        cmdl->opened_descriptors = bits;
+        cmdl->opened_capacity = capacity;
+    }
+    uint64_t bit = UINT64_C(1) << (fd % 64);
+    if (!(cmdl->opened_descriptors[word] & bit))
+    {
+        cmdl->opened_descriptors[word] |= bit;
+        cmdl->num_opened++;
     }
-    return -1;
+    return 0;
 }
 
 /** @brief Fonction de fermeture des descripteurs de fichiers listés dans la structure de contrôle de flux.
  * @param cmdl Pointeur vers la structure de ligne de commande.
  * @return int 0 en cas de succès, -1 en cas d'erreur.
- * @details Cette fonction ferme tous les descripteurs de fichiers listés dans le tableau *opened_descriptors* de la structure *cf*.
- *    Après fermeture, les entrées du tableau sont remises à -1.
+ * @details Cette fonction ferme tous les descripteurs de fichiers de l'ensemble *opened_descriptors* de la structure *cf*.
+ *    Après fermeture, l'ensemble est vidé (*num_opened* vaut 0).
  */
 int close_fds(command_line_t *cmdl)
 {
@@ -306,52 +1318,319 @@ int close_fds(command_line_t *cmdl)
 
     // ret == -1 si y a au moins une erreur de close
     int ret = 0;
-    for (int i = 0; i < MAX_OPENED; ++i)
+    for (unsigned int w = 0; w < cmdl->opened_capacity && cmdl->num_opened > 0; ++w)
     {
-        if (cmdl->opened_descriptors[i] >= 0)
+        // un mot par 64 descripteurs : seuls les bits à 1 sont parcourus
+        for (uint64_t bits = cmdl->opened_descriptors[w]; bits; bits &= bits - 1)
         {
-            if (close(cmdl->opened_descriptors[i]) == -1)
+            if (close((int)(w * 64 + __builtin_ctzll(bits))) == -1)
                 ret = -1;
-            cmdl->opened_descriptors[i] = -1;
+            cmdl->num_opened--;
         }
+        cmdl->opened_descriptors[w] = 0;
     }
+    cmdl->num_opened = 0;
     return ret;
 }
 
+/** @brief Fonction de fermeture d'un descripteur listé dans la structure de ligne de commande.
+ * @param cmdl Pointeur vers la structure de ligne de commande.
+ * @param fd Descripteur à fermer et à retirer de *opened_descriptors*.
+ * @return int 0 si *fd* était listé (il est alors fermé), -1 sinon (rien n'est fermé).
+ * @details Un descripteur n'est ainsi jamais fermé deux fois, même si son numéro a été réutilisé entre-temps. Le retrait se fait en O(1).
+ */
+int remove_fd(command_line_t *cmdl, int fd)
+{
+    if (!has_fd(cmdl, fd))
+        return -1;
+    cmdl->opened_descriptors[fd / 64] &= ~(UINT64_C(1) << (fd % 64));
+    cmdl->num_opened--;
+    close(fd);
+    return 0;
+}
+
+/** @brief Fonction de test de la présence d'un descripteur dans la structure de ligne de commande.
+ * @param cmdl Pointeur vers la structure de ligne de commande.
+ * @param fd Descripteur recherché.
+ * @return int 1 si *fd* est dans *opened_descriptors*, 0 sinon.
+ */
+int has_fd(const command_line_t *cmdl, int fd)
+{
+    if (!cmdl || fd < 0 || (unsigned int)fd / 64 >= cmdl->opened_capacity)
+        return 0;
+    return (cmdl->opened_descriptors[fd / 64] >> (fd % 64)) & 1;
+}
+
+/** @brief Fonction d'installation d'un descripteur dans le shell lui-même ("exec 3>>journal", "exec >sortie", "exec 3>&-").
+ * @param cmdl Ligne de commande en cours (un descripteur de la ligne qui porte le numéro *fd* est d'abord fermé), ou NULL.
+ * @param fd Descripteur du shell à remplacer.
+ * @param source Descripteur copié sur *fd*, -1 pour fermer *fd*.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (errno renseigné ; EBUSY si *fd* est un descripteur interne du shell).
+ * @details La copie, faite par *dup2()*, n'a pas O_CLOEXEC : elle est héritée par toutes les commandes lancées ensuite.
+ *    Les descripteurs au-delà de 2 ainsi installés sont suivis à part de *opened_descriptors* : *close_fds()* ne les ferme pas,
+ *    ils restent ouverts d'une ligne à l'autre jusqu'à "exec n>&-".
+ */
+int set_shell_fd(command_line_t *cmdl, int fd, int source)
+{
+    if (fd < 0)
+    {
+        errno = EBADF;
+        return -1;
+    }
+    if (source == fd)
+        return 0;
+
+    // le numéro est pris par la ligne (fichier dont la copie a été mise à l'abri par *protect_sources()*) : libéré
+    // sinon, un descripteur ouvert avec O_CLOEXEC qui n'est pas à l'utilisateur appartient au shell (script, zygote)
+    if (remove_fd(cmdl, fd) != 0 && fd > 2 && !shell_fd_listed(fd))
+    {
+        int flags = fcntl(fd, F_GETFD);
+        if (flags >= 0 && (flags & FD_CLOEXEC))
+        {
+            errno = EBUSY;
+            return -1;
+        }
+    }
+
+    if (source < 0)
+    {
+        if (close(fd) != 0 && errno != EBADF)
+            return -1;
+    }
+    else if (dup2(source, fd) < 0)
+        return -1;
+    if (fd > 2)
+        track_shell_fd(fd, source >= 0);
+    return 0;
+}
+
+/** @brief Fonction de test d'un descripteur du shell utilisable par "n>&m".
+ * @param fd Descripteur testé.
+ * @return int 1 si *fd* est ouvert et appartient à l'utilisateur (installé par *set_shell_fd()* ou hérité sans O_CLOEXEC), 0 sinon.
+ * @details Les descripteurs internes du shell (script lu, zygote, descripteurs des lignes) ont O_CLOEXEC : ils ne sont pas visibles.
+ */
+int is_shell_fd(int fd)
+{
+    if (shell_fd_listed(fd))
+        return 1;
+    int flags = fd < 0 ? -1 : fcntl(fd, F_GETFD);
+    return flags >= 0 && (fd <= 2 || !(flags & FD_CLOEXEC));
+}
+
+/** @brief Fonction de récupération du nombre de descripteurs au-delà de 2 installés par *set_shell_fd()*.
+ * @return unsigned int Nombre de descripteurs ouverts dans le shell par "exec n>...".
+ */
+unsigned int get_num_shell_fds(void)
+{
+    return num_shell_fds;
+}
+
+/** @brief Remise à zéro des champs d'une ligne de commande, hors arène.
+ * @param cmdl Pointeur vers la structure de ligne de commande.
+ */
+static void clear_command_line(command_line_t *cmdl)
+{
+    cmdl->command_line[0] = '\0';
+    cmdl->tokens = NULL;
+    cmdl->token_types = NULL;
+    cmdl->num_tokens = cmdl->tokens_capacity = 0;
+    cmdl->commands = NULL;
+    cmdl->flow = NULL;
+    cmdl->num_commands = cmdl->commands_capacity = 0;
+    cmdl->opened_descriptors = NULL;
+    cmdl->num_opened = cmdl->opened_capacity = 0;
+    cmdl->num_heredocs = 0;
+    cmdl->last_line = 0;
+}
+
 /** @brief Fonction d'initialisation d'une structure de ligne de commande.
- * @param cmdl Pointeur vers la structure de ligne de commande à initialiser.
+ * @param cmdl Pointeur vers la structure de ligne de commande à initialiser (contenu quelconque : aucun champ n'est lu).
  * @return int 0 en cas de succès, -1 en cas d'erreur.
- * @details Cette fonction initialise les champs de la structure avec les valeurs suivantes:
+ * @details A appeler une seule fois, avant la première ligne ; les lignes suivantes réutilisent la structure via *reset_command_line()*.
+ * Cette fonction initialise les champs de la structure avec les valeurs suivantes:
  * - *command_line*: "\0"
- * - *tokens*: {NULL}
- * - *commands*: tableau de processus initialisés via *init_processus()*
- * - *flow*: tableau de contrôle de flux initialisé via *init_control_flow()*
- * - *num_commands*: 0
- * - *opened_descriptors*: {-1}
+ * - *arena*: vide, de bloc initial *command_line* (voir *arena_init()*)
+ * - *tokens*, *token_types*, *commands*, *flow*, *opened_descriptors*: NULL (tableaux de l'arène, libérés avec elle)
+ * - *num_tokens*, *num_commands*, *num_opened*, *num_heredocs* et les capacités : 0
+ * - *last_line*: 0
+ *
+ * Les processus sont initialisés par *add_processus()*.
  */
 int init_command_line(command_line_t *cmdl)
 {
     if (!cmdl)
         return -1;
-    memset(cmdl->command_line, 0, sizeof cmdl->command_line);
-    for (size_t i = 0; i < (MAX_CMD_LINE / 2 + 1); ++i)
-        cmdl->tokens[i] = NULL;
-    for (int i = 0; i < MAX_CMDS; ++i)
+    arena_init(&cmdl->arena, cmdl->command_line, sizeof cmdl->command_line);
+    clear_command_line(cmdl);
+    return 0;
+}
+
+/** @brief Fonction de remise à zéro d'une structure de ligne de commande avant la ligne suivante.
+ * @param cmdl Pointeur vers la structure de ligne de commande, initialisée par *init_command_line()*.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @details Libère l'arène de la ligne précédente (O(1) si elle n'a pas débordé sur le tas, voir *arena_reset()*) et remet les champs
+ *    aux valeurs de *init_command_line()*. Le coût ne dépend donc pas de la taille de la ligne précédente.
+ */
+int reset_command_line(command_line_t *cmdl)
+{
+    if (!cmdl)
+        return -1;
+    arena_reset(&cmdl->arena);
+    clear_command_line(cmdl);
+    return 0;
+}
+/** @brief Fonction de lancement d'un pipeline.
+ * @param first Pointeur vers la structure de contrôle de flux de la première étape du pipeline.
+ * @return control_flow_t* Pointeur vers la structure de contrôle de flux de la dernière étape.
+ * @details Toutes les étapes (chaînées par *pipe_next*) sont démarrées via *start_processus()* avant d'attendre la moindre d'entre elles :
+ *    elles s'exécutent donc en parallèle et un producteur ne bloque plus sur un tube plein faute de consommateur.
+ *    Les étapes forment un seul job de la table des jobs ; elles sont attendues ensemble, sauf si la dernière est en arrière-plan.
+ *    Un pipeline d'arrière-plan compte pour un seul job dans la limite *get_max_jobs()*.
+ *    Le statut du pipeline est celui de sa dernière étape.
+ *    Le tube entre deux étapes est créé juste avant le démarrage de la première des deux, et ses extrémités sont fermées côté shell
+ *    dès que l'étape qui les utilise est démarrée : le shell ne garde qu'un tube ouvert à la fois, quelle que soit la longueur du pipeline.
+ */
+static control_flow_t *launch_pipeline(control_flow_t *first)
+{
+    control_flow_t *last = first;
+    while (last->pipe_next)
+        last = last->pipe_next;
+
+    // étapes démarrées ensemble : substitution de toutes les étapes d'abord (le texte du job en dépend)
+    for (control_flow_t *stage = first; stage; stage = stage->pipe_next)
     {
-        init_processus(&cmdl->commands[i]);
-        init_control_flow(&cmdl->flow[i]);
+        if (is_empty_command(stage->proc))
+            fprintf(stderr, "Erreur: commande invalide\n");
+        expand_processus(first->cmdl, stage->proc);
     }
-    for (int i = 0; i < MAX_OPENED; ++i)
-        cmdl->opened_descriptors[i] = -1;
-    cmdl->num_commands = 0;
-    return 0;
+
+    // un seul job pour toutes les étapes
+    char text[JOB_TEXT_SIZE];
+    int is_background = last->proc->is_background;
+    if (is_background)
+        jobs_wait_slot(get_max_jobs());
+    int id = jobs_new(is_background, is_background ? format_command(first->proc, text, sizeof text) : NULL);
+
+    int read_end = -1; // lecture du tube de l'étape précédente
+    for (control_flow_t *stage = first; stage; stage = stage->pipe_next)
+    {
+        processus_t *proc = stage->proc;
+        proc->job_id = (id > 0) ? id : 0;
+        proc->in_pipeline = 1;
+
+        // entrée : tube de l'étape précédente ; sortie : nouveau tube vers l'étape suivante (les redirections de l'étape passent après)
+        int stage_in = read_end, stage_out = -1;
+        read_end = -1;
+        if (stage_in >= 0)
+            proc->stdin_fd = stage_in;
+        if (stage->pipe_next)
+        {
+            int fds[2];
+            if (pipe2(fds, O_CLOEXEC) < 0)
+                perror("pipe2");
+            else if (add_fd(first->cmdl, fds[0]) != 0 || add_fd(first->cmdl, fds[1]) != 0)
+            {
+                if (remove_fd(first->cmdl, fds[0]) != 0)
+                    close(fds[0]);
+                close(fds[1]);
+            }
+            else
+            {
+                proc->stdout_fd = stage_out = fds[1];
+                read_end = fds[0];
+            }
+        }
+
+        start_processus(proc);
+
+        // extrémités encore ouvertes si une redirection les a remplacées (fermées une seule fois grâce à remove_fd())
+        remove_fd(first->cmdl, stage_in);
+        remove_fd(first->cmdl, stage_out);
+    }
+
+    job_t *job = jobs_get(id);
+    if (job && job->first < 0)
+    {
+        // aucune étape n'a créé de processus
+        jobs_remove(id);
+        job = NULL;
+    }
+
+    if (!is_background)
+    {
+        if (job)
+        {
+            jobs_wait(id);
+            for (control_flow_t *stage = first; stage; stage = stage->pipe_next)
+            {
+                if (stage->proc->pid > 0 && stage->proc->exec_errno == 0)
+                    collect_processus(stage->proc);
+            }
+            settle_job(id, first->proc);
+        }
+        else
+        {
+            for (control_flow_t *stage = first; stage; stage = stage->pipe_next)
+                wait_processus(stage->proc);
+        }
+    }
+    return last;
+}
+
+/** @brief Conversion d'une durée timeval en secondes. */
+static double timeval_seconds(const struct timeval *tv)
+{
+    return tv->tv_sec + tv->tv_usec / 1e6;
 }
+
+/** @brief Affichage des mesures demandées par le mot-clé "time" pour une commande ou un pipeline.
+ * @param first Structure de contrôle de flux de la commande ou de la première étape du pipeline.
+ * @details Le temps réel va du démarrage de la première étape à la fin de la dernière étape terminée (horloge monotone).
+ *    Les temps CPU, les défauts de page et les commutations de contexte sont cumulés sur les étapes ; la RSS maximale est celle de la plus grosse étape.
+ */
+static void report_timing(control_flow_t *first)
+{
+    struct timespec start = first->proc->start_time;
+    struct timespec end = start;
+    struct rusage total;
+    memset(&total, 0, sizeof total);
+
+    for (control_flow_t *stage = first; stage; stage = stage->pipe_next)
+    {
+        const processus_t *p = stage->proc;
+        if (p->end_time.tv_sec > end.tv_sec || (p->end_time.tv_sec == end.tv_sec && p->end_time.tv_nsec > end.tv_nsec))
+            end = p->end_time;
+        timeradd(&total.ru_utime, &p->rusage.ru_utime, &total.ru_utime);
+        timeradd(&total.ru_stime, &p->rusage.ru_stime, &total.ru_stime);
+        if (p->rusage.ru_maxrss > total.ru_maxrss)
+            total.ru_maxrss = p->rusage.ru_maxrss;
+        total.ru_minflt += p->rusage.ru_minflt;
+        total.ru_majflt += p->rusage.ru_majflt;
+        total.ru_nvcsw += p->rusage.ru_nvcsw;
+        total.ru_nivcsw += p->rusage.ru_nivcsw;
+    }
+
+    double real = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    double user = timeval_seconds(&total.ru_utime);
+    double sys = timeval_seconds(&total.ru_stime);
+    dprintf(STDERR_FILENO, "\nréel\t\t%dm%.3fs\nutilisateur\t%dm%.3fs\nsystème\t\t%dm%.3fs\n",
+            (int)(real / 60), real - 60 * (int)(real / 60),
+            (int)(user / 60), user - 60 * (int)(user / 60),
+            (int)(sys / 60), sys - 60 * (int)(sys / 60));
+    dprintf(STDERR_FILENO, "rss max\t\t%ld Ko\ndéfauts de page\t%ld mineurs, %ld majeurs\ncommutations\t%ld volontaires, %ld forcées\n",
+            total.ru_maxrss, total.ru_minflt, total.ru_majflt, total.ru_nvcsw, total.ru_nivcsw);
+}
+
 /** @brief Fonction de lancement d'une ligne de commande.
  * @param cmdl Pointeur vers la structure de ligne de commande à lancer.
  * @return int 0 en cas de succès, un code d'erreur sinon.
  * @details Cette fonction lance les processus selon le flux défini dans la structure *cmdl*. Les lancements sont effectués via *launch_processus()* en
  *    respectant les conditions de contrôle de flux (inconditionnel, en cas de succès, en cas d'échec).
- *    Le tableau *opened_descriptors* est utilisé pour fermer les descripteurs ouverts au moment de l'initialisation des structures processus_t.
+ *    Les étapes d'un même pipeline sont toutes démarrées avant d'être attendues ensemble ; le statut du pipeline est celui de sa dernière étape.
+ *    Pour une commande ou un pipeline précédé du mot-clé "time", le temps écoulé et les ressources consommées sont affichés sur la sortie d'erreur.
+ *    L'ensemble *opened_descriptors* est utilisé pour fermer, à la fin de la ligne, les descripteurs ouverts au lancement de ses commandes.
+ *    Sur la dernière ligne du shell (*last_line*), une commande externe seule qui termine le flux, au premier plan, sans "time" ni "!",
+ *    alors qu'aucun job d'arrière-plan n'est actif, est exécutée à la place du shell (*tail_exec*) : son statut devient celui du shell.
  *    La fonction retourne 0 si tous les processus à lancer en fonction du contrôle de flux ont pu être lancés sans erreur.
  */
 
@@ -361,20 +1640,35 @@ int launch_command_line(command_line_t *cmdl)
         return -1;
 
     control_flow_t *cur = &cmdl->flow[0]; // Début du flux de commandes
+    builtin_stat_cache_clear(); // pas de résultat de "test" partagé entre deux lignes
 
     while (cur)
     {
         processus_t *p = cur->proc;
+        control_flow_t *first = cur;
+
+        // Lancer le processus courant (ou tout le pipeline qu'il commence)
+        // la dernière commande du shell, s'il ne reste rien à faire après elle, le remplace : "minishell -c 'prog'" ne coûte qu'un processus
+        if (cur->pipe_next)
+            cur = launch_pipeline(cur);
+        else
+        {
+            p->tail_exec = cmdl->last_line && !cur->unconditionnal_next && !cur->on_success_next && !cur->on_failure_next &&
+                           !p->is_background && !p->timed && !p->invert && jobs_active_count() == 0;
+            launch_processus(p);
+        }
+        int status = cur->proc->status; // Statut du processus (de la dernière étape pour un pipeline)
 
-        // Lancer le processus courant
-        launch_processus(p);    // Lance le processus
-        int status = p->status; // Récupère le statut du processus
+        // Mot-clé "time" : mesures affichées une fois la commande (ou tout le pipeline) terminée
+        if (p->timed && !cur->proc->is_background)
+            report_timing(first);
 
         // Inversion éventuelle (si le processus a échoué, inverser le statut)
         if (p->invert)
         {
             status = (status == 0) ? 1 : 0; // Inverse le statut (0 -> 1, 1 -> 0)
         }
+        last_status = status;
 
         // Choisir le prochain maillon en fonction du statut
         if (cur->unconditionnal_next)
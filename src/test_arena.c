@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include "../include/arena.h"
+
+// make test_arena
+// ./test_arena
+
+void test_arena_alloc()
+{
+    printf("Démarrage des tests unitaires pour arena_alloc et arena_strndup...\n");
+
+    char block[64];
+    arena_t a;
+    arena_init(&a, block, sizeof block);
+    size_t before = arena_heap_allocations();
+
+    char *s = arena_strndup(&a, "bonjour le monde", 7);
+    assert(s == block && strcmp(s, "bonjour") == 0);
+    void **v = arena_alloc(&a, 3 * sizeof(void *));
+    assert(v && (uintptr_t)v % sizeof(void *) == 0);
+    assert((char *)v >= block && (char *)(v + 3) <= block + sizeof block);
+    assert(arena_heap_allocations() == before);
+    printf("[PASS] Test 1 : Allocations dans le bloc initial\n");
+
+    // bloc initial plein : bloc sur le tas, les allocations précédentes restent valides
+    char *big = arena_alloc(&a, 1000);
+    assert(big && (big < block || big >= block + sizeof block));
+    memset(big, 'x', 1000);
+    assert(strcmp(s, "bonjour") == 0);
+    assert(arena_heap_allocations() == before + 1);
+    printf("[PASS] Test 2 : Débordement sur le tas\n");
+
+    arena_reset(&a);
+    assert(a.ptr == block && a.chunks == NULL);
+    assert(arena_strndup(&a, "x", 1) == block);
+    assert(arena_heap_allocations() == before + 1);
+    printf("[PASS] Test 3 : Remise à zéro\n");
+
+    printf("Tous les tests pour arena_alloc et arena_strndup ont réussi !\n\n");
+}
+
+void test_arena_extend()
+{
+    printf("Démarrage des tests unitaires pour arena_extend...\n");
+
+    char block[16];
+    arena_t a;
+    arena_init(&a, block, sizeof block);
+
+    // construction d'un objet octet par octet, déplacé quand le bloc est plein
+    char *first = arena_strndup(&a, "abc", 3);
+    char *word = NULL;
+    for (int i = 0; i < 100; i++)
+    {
+        assert(arena_extend(&a, &word, 2) == 0);
+        if (!word)
+            word = a.ptr;
+        *a.ptr++ = 'a' + i % 26;
+    }
+    *a.ptr++ = '\0';
+    assert(strlen(word) == 100 && word[0] == 'a' && word[99] == 'a' + 99 % 26);
+    assert(first == block && strcmp(first, "abc") == 0);
+    printf("[PASS] Test 4 : Objet en construction déplacé vers un nouveau bloc\n");
+
+    arena_reset(&a);
+    assert(a.ptr == block);
+    printf("[PASS] Test 5 : Blocs du tas libérés\n");
+
+    printf("Tous les tests pour arena_extend ont réussi !\n\n");
+}
+
+int main()
+{
+    test_arena_alloc();
+    test_arena_extend();
+    return 0;
+}
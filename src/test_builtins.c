@@ -5,6 +5,14 @@
 #include <limits.h>
 #include "../include/builtins.h"
 #include "../include/processus.h"
+#include "../include/path_cache.h"
+#include "../include/jobs.h"
+#include "../include/output.h"
+#include "../include/vars.h"
+#include "../include/parser.h"
+#include <signal.h>
+#include <fcntl.h>
+#include <sys/wait.h>
 #include <linux/limits.h>
 
 void test_is_builtin()
@@ -21,8 +29,8 @@ void test_is_builtin()
     assert(is_builtin(cmd) == 0);
     printf("[PASS] Test 2 : Commande vide (argv[0] NULL)\n");
 
-    char *valid_cmds[] = {"cd", "exit", "export", "unset", "pwd"};
-    int nb_valid = 5;
+    char *valid_cmds[] = {"cd", "exit", "export", "unset", "pwd", "hash", "type", "jobs", "wait", "fg", "bg", "kill", "set", "echo", "printf", "test", "[", "exec"};
+    int nb_valid = 18;
 
     for (int i = 0; i < nb_valid; i++)
     {
@@ -35,7 +43,7 @@ void test_is_builtin()
     }
     printf("[PASS] Test 3 : Commandes built-in reconnues\n");
 
-    char *invalid_cmds[] = {"ls", "grep", "echo", "cat", "./script.sh", "CD", "Exit"};
+    char *invalid_cmds[] = {"ls", "grep", "/bin/echo", "cat", "./script.sh", "CD", "Exit"};
     int nb_invalid = 7;
 
     for (int i = 0; i < nb_invalid; i++)
@@ -49,6 +57,35 @@ void test_is_builtin()
     }
     printf("[PASS] Test 4 : Commandes externes ignorées\n");
 
+    // Table : chaque commande est dans la case de son hachage, trouvée en une recherche
+    const builtin_t *table = builtin_table();
+    int nb_entries = 0;
+    for (int i = 0; i < BUILTIN_TABLE_SIZE; i++)
+    {
+        if (!table[i].name)
+            continue;
+        nb_entries++;
+        assert(builtin_slot(table[i].name, strlen(table[i].name)) == (unsigned)i);
+        assert(table[i].handler != NULL);
+        assert(find_builtin(table[i].name) == &table[i]);
+    }
+    assert(nb_entries == nb_valid);
+    assert(find_builtin("") == NULL && find_builtin(NULL) == NULL);
+    printf("[PASS] Test 5 : Table des commandes intégrées (hachage parfait)\n");
+
+    // Résolution mémorisée dans le processus
+    init_processus(cmd);
+    cmd->argv[0] = "pwd";
+    assert(cmd->builtin == NULL);
+    assert(resolve_builtin(cmd) == find_builtin("pwd"));
+    assert(cmd->builtin == find_builtin("pwd"));
+    cmd->argv[0] = "ls";
+    assert(resolve_builtin(cmd) == find_builtin("pwd")); // pas de nouvelle recherche
+    init_processus(cmd);
+    cmd->argv[0] = "ls";
+    assert(resolve_builtin(cmd) == NULL && cmd->builtin == NULL);
+    printf("[PASS] Test 6 : Résolution mémorisée dans le processus\n");
+
     free(cmd);
 
     printf("Tous les tests pour is_builtin ont réussi !\n\n");
@@ -68,7 +105,7 @@ void test_builtin_cd()
         perror("getcwd init");
         exit(1);
     }
-    strcpy(old_home, getenv("HOME"));
+    strcpy(old_home, vars_get("HOME"));
 
     processus_t *cmd = malloc(sizeof(processus_t));
     if (!cmd)
@@ -97,7 +134,7 @@ void test_builtin_cd()
     assert(strcmp(current_cwd, "/tmp") == 0);
     printf("[PASS] Test 2 : cd vers dossier invalide\n");
 
-    setenv("HOME", initial_cwd, 1);
+    vars_set("HOME", initial_cwd, 1);
     cmd->argv[1] = NULL;
 
     assert(builtin_cd(cmd) == 0);
@@ -106,18 +143,19 @@ void test_builtin_cd()
     assert(strcmp(current_cwd, initial_cwd) == 0);
     printf("[PASS] Test 3 : cd HOME (retour départ)\n");
 
-    unsetenv("HOME");
+    vars_unset("HOME");
     cmd->argv[1] = NULL;
 
     assert(builtin_cd(cmd) == -1);
     printf("[PASS] Test 4 : cd sans HOME défini\n");
 
+    output_flush_all(); // sortie tamponnée des commandes intégrées (écrite par exec_builtin() dans le shell)
     if (cmd->stderr_fd >= 0)
         close(cmd->stderr_fd);
     free(cmd);
 
     // restauration de l'environnement
-    setenv("HOME", old_home, 1);
+    vars_set("HOME", old_home, 1);
     chdir(initial_cwd);
 
     printf("Tous les tests pour builtin_cd ont réussi !\n\n");
@@ -141,22 +179,22 @@ void test_builtin_export()
     printf("après var");
 
     assert(builtin_export(cmd) == 0);
-    assert(strcmp(getenv("TEST_EXPORT"), "coucou") == 0);
+    assert(strcmp(vars_get("TEST_EXPORT"), "coucou") == 0);
     printf("[PASS] Test 1 : export VAR=val\n");
 
     cmd->argv[1] = "TEST_EXPORT=nouveau";
     assert(builtin_export(cmd) == 0);
-    assert(strcmp(getenv("TEST_EXPORT"), "nouveau") == 0);
+    assert(strcmp(vars_get("TEST_EXPORT"), "nouveau") == 0);
     printf("[PASS] Test 2 : Mise à jour variable\n");
 
     cmd->argv[1] = "TEST_EMPTY=";
     assert(builtin_export(cmd) == 0);
-    assert(strcmp(getenv("TEST_EMPTY"), "") == 0);
+    assert(strcmp(vars_get("TEST_EMPTY"), "") == 0);
     printf("[PASS] Test 3 : Valeur vide supportée\n");
 
     cmd->argv[1] = "INVALID_FORMAT";
     assert(builtin_export(cmd) == -1);
-    assert(getenv("INVALID_FORMAT") == NULL);
+    assert(vars_get("INVALID_FORMAT") == NULL);
     printf("[PASS] Test 4 : Rejet format sans '='\n");
 
     cmd->argv[1] = "=VALEUR";
@@ -168,15 +206,28 @@ void test_builtin_export()
     cmd->argv[3] = NULL;
 
     assert(builtin_export(cmd) == 0);
-    assert(strcmp(getenv("VAR1"), "un") == 0);
-    assert(strcmp(getenv("VAR2"), "deux") == 0);
+    assert(strcmp(vars_get("VAR1"), "un") == 0);
+    assert(strcmp(vars_get("VAR2"), "deux") == 0);
     printf("[PASS] Test 6 : Arguments multiples\n");
 
-    unsetenv("TEST_EXPORT");
-    unsetenv("TEST_EMPTY");
-    unsetenv("VAR1");
-    unsetenv("VAR2");
-
+    // export d'une variable locale existante
+    vars_set("TEST_LOCALE", "locale", 0);
+    cmd->argv[1] = "TEST_LOCALE";
+    cmd->argv[2] = NULL;
+    assert(builtin_export(cmd) == 0);
+    int found = 0;
+    for (char **e = vars_envp(); *e; ++e)
+        found |= strcmp(*e, "TEST_LOCALE=locale") == 0;
+    assert(found);
+    printf("[PASS] Test 7 : Export d'une variable locale\n");
+
+    vars_unset("TEST_EXPORT");
+    vars_unset("TEST_EMPTY");
+    vars_unset("VAR1");
+    vars_unset("VAR2");
+    vars_unset("TEST_LOCALE");
+
+    output_flush_all();
     if (cmd->stderr_fd >= 0)
         close(cmd->stderr_fd);
     free(cmd);
@@ -194,39 +245,40 @@ void test_builtin_unset()
 
     cmd->stderr_fd = open("/dev/null", O_WRONLY);
 
-    setenv("VAR_TO_DELETE", "exists", 1);
+    vars_set("VAR_TO_DELETE", "exists", 1);
     cmd->argv[0] = "unset";
     cmd->argv[1] = "VAR_TO_DELETE";
     cmd->argv[2] = NULL;
 
     assert(builtin_unset(cmd) == 0);
-    assert(getenv("VAR_TO_DELETE") == NULL);
+    assert(vars_get("VAR_TO_DELETE") == NULL);
     printf("[PASS] Test 1 : Suppression simple\n");
 
-    setenv("VAR1", "A", 1);
-    setenv("VAR2", "B", 1);
+    vars_set("VAR1", "A", 1);
+    vars_set("VAR2", "B", 1);
     cmd->argv[1] = "VAR1";
     cmd->argv[2] = "VAR2";
     cmd->argv[3] = NULL;
 
     assert(builtin_unset(cmd) == 0);
-    assert(getenv("VAR1") == NULL);
-    assert(getenv("VAR2") == NULL);
+    assert(vars_get("VAR1") == NULL);
+    assert(vars_get("VAR2") == NULL);
     printf("[PASS] Test 2 : Suppression multiple\n");
 
-    unsetenv("NON_EXISTENT");
+    vars_unset("NON_EXISTENT");
     cmd->argv[1] = "NON_EXISTENT";
     cmd->argv[2] = NULL;
 
     assert(builtin_unset(cmd) == 0);
     printf("[PASS] Test 3 : Variable inexistante (Succès attendu)\n");
 
-    // unsetenv échoue si la chaîne contient un '='
+    // un nom contenant '=' n'est pas un identifiant valable
     cmd->argv[1] = "VAR=VAL";
 
     assert(builtin_unset(cmd) == -1);
     printf("[PASS] Test 4 : Identifiant invalide (Erreur attendue)\n");
 
+    output_flush_all();
     if (cmd->stderr_fd >= 0)
         close(cmd->stderr_fd);
     free(cmd);
@@ -258,6 +310,7 @@ void test_builtin_pwd()
 
     int ret = builtin_pwd(cmd);
 
+    output_flush_all();
     close(pipe_fd[1]);
 
     assert(ret == 0);
@@ -282,19 +335,535 @@ void test_builtin_pwd()
     printf("[PASS] Test 1 : pwd affiche le bon chemin\n");
 
     // Nettoyage
+    output_flush_all();
     if (cmd->stderr_fd >= 0)
         close(cmd->stderr_fd);
     free(cmd);
     printf("Tous les tests pour builtin_pwd ont réussi !\n");
 }
 
+// Lecture de tout ce qui a été écrit dans un tube (extrémité d'écriture déjà fermée)
+static void read_all(int fd, char *buf, size_t size)
+{
+    size_t len = 0;
+    ssize_t n;
+    while (len < size - 1 && (n = read(fd, buf + len, size - 1 - len)) > 0)
+        len += n;
+    buf[len] = '\0';
+}
+
+void test_builtin_hash_type()
+{
+    printf("Démarrage des tests unitaires pour builtin_hash et builtin_type...\n");
+
+    processus_t *cmd = malloc(sizeof(processus_t));
+    if (!cmd)
+        exit(1);
+    char output[4096];
+    int pipe_fd[2];
+
+    vars_set("PATH", "/usr/bin:/bin", 1);
+
+    // hash -r puis hash sh : sh est mémorisé
+    init_processus(cmd);
+    cmd->argv[0] = "hash";
+    cmd->argv[1] = "-r";
+    cmd->argv[2] = "sh";
+    cmd->argv[3] = NULL;
+    assert(builtin_hash(cmd) == 0);
+    printf("[PASS] Test 1 : hash -r nom\n");
+
+    // type sh : haché
+    pipe(pipe_fd);
+    init_processus(cmd);
+    cmd->argv[0] = "type";
+    cmd->argv[1] = "sh";
+    cmd->argv[2] = "cd";
+    cmd->argv[3] = NULL;
+    cmd->stdout_fd = pipe_fd[1];
+    assert(builtin_type(cmd) == 0);
+    output_flush_all();
+    close(pipe_fd[1]);
+    read_all(pipe_fd[0], output, sizeof(output));
+    close(pipe_fd[0]);
+    assert(strstr(output, "sh est haché (/") != NULL);
+    assert(strstr(output, "cd est une primitive du shell") != NULL);
+    printf("[PASS] Test 2 : type (haché, primitive)\n");
+
+    // type d'une commande introuvable
+    init_processus(cmd);
+    cmd->argv[0] = "type";
+    cmd->argv[1] = "commande_qui_n_existe_pas_12345";
+    cmd->argv[2] = NULL;
+    cmd->stderr_fd = open("/dev/null", O_WRONLY);
+    assert(builtin_type(cmd) == 1);
+    output_flush_all();
+    close(cmd->stderr_fd);
+    printf("[PASS] Test 3 : type d'une commande introuvable\n");
+
+    // hash sans argument : liste avec compteur
+    pipe(pipe_fd);
+    init_processus(cmd);
+    cmd->argv[0] = "hash";
+    cmd->argv[1] = NULL;
+    cmd->stdout_fd = pipe_fd[1];
+    assert(builtin_hash(cmd) == 0);
+    output_flush_all();
+    close(pipe_fd[1]);
+    read_all(pipe_fd[0], output, sizeof(output));
+    close(pipe_fd[0]);
+    assert(strstr(output, "occurrences") != NULL);
+    assert(strstr(output, "/sh\n") != NULL);
+    printf("[PASS] Test 4 : hash liste les commandes mémorisées\n");
+
+    // export PATH=... vide le cache
+    init_processus(cmd);
+    cmd->argv[0] = "export";
+    cmd->argv[1] = "PATH=/bin:/usr/bin";
+    cmd->argv[2] = NULL;
+    assert(builtin_export(cmd) == 0);
+    assert(path_cache_size() == 0);
+    printf("[PASS] Test 5 : export PATH invalide le cache\n");
+
+    free(cmd);
+    printf("Tous les tests pour builtin_hash et builtin_type ont réussi !\n\n");
+}
+
+void test_builtin_jobs_wait_kill()
+{
+    printf("Démarrage des tests unitaires pour builtin_jobs, builtin_wait et builtin_kill...\n");
+
+    processus_t *bg = malloc(sizeof(processus_t));
+    processus_t *cmd = malloc(sizeof(processus_t));
+    if (!bg || !cmd)
+        exit(1);
+    char output[4096];
+    int pipe_fd[2];
+
+    vars_set("PATH", "/usr/bin:/bin", 1);
+
+    // sleep 30 & : job 1 en arrière-plan
+    init_processus(bg);
+    bg->argv[0] = "sleep";
+    bg->argv[1] = "30";
+    bg->is_background = 1;
+    assert(launch_processus(bg) == 0);
+    assert(bg->pid > 0 && bg->job_id > 0);
+    int id = bg->job_id;
+
+    init_processus(cmd);
+    cmd->argv[0] = "jobs";
+    assert(pipe(pipe_fd) == 0);
+    cmd->stdout_fd = pipe_fd[1];
+    assert(builtin_jobs(cmd) == 0);
+    output_flush_all();
+    close(pipe_fd[1]);
+    read_all(pipe_fd[0], output, sizeof(output));
+    close(pipe_fd[0]);
+    assert(strstr(output, "sleep 30 &") != NULL);
+    assert(strstr(output, "En cours") != NULL);
+    printf("[PASS] Test 1 : jobs liste le job d'arrière-plan\n");
+
+    // kill %n puis wait %n : 128 + SIGTERM
+    char spec[16];
+    snprintf(spec, sizeof spec, "%%%d", id);
+    init_processus(cmd);
+    cmd->argv[0] = "kill";
+    cmd->argv[1] = spec;
+    assert(builtin_kill(cmd) == 0);
+    cmd->argv[0] = "wait";
+    assert(builtin_wait(cmd) == 128 + SIGTERM);
+    assert(jobs_get(id) == NULL); // job retiré de la table après wait
+    printf("[PASS] Test 2 : kill %%n puis wait %%n\n");
+
+    // kill -s KILL pid, wait pid
+    init_processus(bg);
+    bg->argv[0] = "sleep";
+    bg->argv[1] = "30";
+    bg->is_background = 1;
+    assert(launch_processus(bg) == 0);
+    char pid_str[16];
+    snprintf(pid_str, sizeof pid_str, "%d", (int)bg->pid);
+    init_processus(cmd);
+    cmd->argv[0] = "kill";
+    cmd->argv[1] = "-s";
+    cmd->argv[2] = "KILL";
+    cmd->argv[3] = pid_str;
+    assert(builtin_kill(cmd) == 0);
+    init_processus(cmd);
+    cmd->argv[0] = "wait";
+    cmd->argv[1] = pid_str;
+    assert(builtin_wait(cmd) == 128 + SIGKILL);
+    printf("[PASS] Test 3 : kill -s KILL pid puis wait pid\n");
+
+    // wait sans argument : attend tous les jobs
+    for (int i = 0; i < 3; i++)
+    {
+        init_processus(bg);
+        bg->argv[0] = "true";
+        bg->is_background = 1;
+        assert(launch_processus(bg) == 0);
+    }
+    init_processus(cmd);
+    cmd->argv[0] = "wait";
+    assert(builtin_wait(cmd) == 0);
+    assert(jobs_active_count() == 0);
+    printf("[PASS] Test 4 : wait sans argument\n");
+
+    // désignations invalides
+    init_processus(cmd);
+    cmd->argv[0] = "wait";
+    cmd->argv[1] = "999999";
+    assert(pipe(pipe_fd) == 0);
+    cmd->stderr_fd = pipe_fd[1];
+    assert(builtin_wait(cmd) == 127);
+    cmd->argv[0] = "kill";
+    cmd->argv[1] = "-PASUNSIGNAL";
+    cmd->argv[2] = "1";
+    assert(builtin_kill(cmd) == -1);
+    cmd->argv[0] = "fg";
+    cmd->argv[1] = "%42";
+    cmd->argv[2] = NULL;
+    assert(builtin_fg(cmd) == 1);
+    output_flush_all();
+    close(pipe_fd[1]);
+    close(pipe_fd[0]);
+    printf("[PASS] Test 5 : PID, signal et job inexistants\n");
+
+    free(bg);
+    free(cmd);
+    printf("Tous les tests pour builtin_jobs, builtin_wait et builtin_kill ont réussi !\n\n");
+}
+
+void test_builtin_set()
+{
+    printf("Démarrage des tests unitaires pour builtin_set...\n");
+
+    processus_t *cmd = malloc(sizeof(processus_t));
+    if (!cmd)
+        exit(1);
+    char output[4096];
+    int pipe_fd[2];
+
+    init_processus(cmd);
+    cmd->argv[0] = "set";
+    cmd->argv[1] = "-o";
+    cmd->argv[2] = "maxjobs=3";
+    assert(builtin_set(cmd) == 0);
+    assert(get_max_jobs() == 3);
+    cmd->argv[2] = "spawn=fork";
+    assert(builtin_set(cmd) == 0);
+    assert(get_spawn_backend() == SPAWN_FORK);
+    printf("[PASS] Test 1 : set -o nom=valeur\n");
+
+    cmd->argv[2] = NULL;
+    assert(pipe(pipe_fd) == 0);
+    cmd->stdout_fd = pipe_fd[1];
+    assert(builtin_set(cmd) == 0);
+    output_flush_all();
+    close(pipe_fd[1]);
+    read_all(pipe_fd[0], output, sizeof(output));
+    close(pipe_fd[0]);
+    assert(strstr(output, "maxjobs\t3\n") != NULL);
+    assert(strstr(output, "spawn\tfork\n") != NULL);
+    printf("[PASS] Test 2 : set -o liste les options\n");
+
+    init_processus(cmd);
+    cmd->argv[0] = "set";
+    cmd->argv[1] = "-o";
+    assert(pipe(pipe_fd) == 0);
+    cmd->stderr_fd = pipe_fd[1];
+    char *invalid[] = {"maxjobs=-1", "maxjobs=abc", "maxjobs=", "spawn=vfork", "inconnue=1", "maxjobs"};
+    for (int i = 0; i < 6; i++)
+    {
+        cmd->argv[2] = invalid[i];
+        assert(builtin_set(cmd) == -1);
+    }
+    assert(get_max_jobs() == 3);
+    output_flush_all();
+    close(pipe_fd[1]);
+    close(pipe_fd[0]);
+    printf("[PASS] Test 3 : Valeurs invalides refusées\n");
+
+    set_spawn_backend(SPAWN_POSIX_SPAWN);
+    free(cmd);
+    printf("Tous les tests pour builtin_set ont réussi !\n");
+}
+
+// Exécute une commande intégrée (argv terminé par NULL) et récupère sa sortie standard
+static int run_builtin(int (*builtin)(processus_t *), char **argv, char *output, size_t size)
+{
+    processus_t *cmd = malloc(sizeof(processus_t));
+    if (!cmd)
+        exit(1);
+    init_processus(cmd);
+    cmd->argv = argv;
+    int pipe_fd[2];
+    assert(pipe(pipe_fd) == 0);
+    cmd->stdout_fd = pipe_fd[1];
+    cmd->stderr_fd = open("/dev/null", O_WRONLY);
+    int rc = builtin(cmd);
+    output_flush_all();
+    close(pipe_fd[1]);
+    close(cmd->stderr_fd);
+    read_all(pipe_fd[0], output, size);
+    close(pipe_fd[0]);
+    free(cmd);
+    return rc;
+}
+
+void test_builtin_echo_printf()
+{
+    printf("Démarrage des tests unitaires pour builtin_echo et builtin_printf...\n");
+    char out[4096];
+
+    assert(run_builtin(builtin_echo, (char *[]){"echo", "a", "b", NULL}, out, sizeof out) == 0);
+    assert(strcmp(out, "a b\n") == 0);
+    assert(run_builtin(builtin_echo, (char *[]){"echo", NULL}, out, sizeof out) == 0);
+    assert(strcmp(out, "\n") == 0);
+    assert(run_builtin(builtin_echo, (char *[]){"echo", "-n", "x", NULL}, out, sizeof out) == 0);
+    assert(strcmp(out, "x") == 0);
+    assert(run_builtin(builtin_echo, (char *[]){"echo", "-ne", "a\\tb\\0101\\n", NULL}, out, sizeof out) == 0);
+    assert(strcmp(out, "a\tbA\n") == 0);
+    assert(run_builtin(builtin_echo, (char *[]){"echo", "-e", "a\\cb", "c", NULL}, out, sizeof out) == 0);
+    assert(strcmp(out, "a") == 0);
+    assert(run_builtin(builtin_echo, (char *[]){"echo", "-x", "a\\n", NULL}, out, sizeof out) == 0);
+    assert(strcmp(out, "-x a\\n\n") == 0);
+    printf("[PASS] Test 1 : echo (-n, -e, -E, \\c, option inconnue)\n");
+
+    assert(run_builtin(builtin_printf, (char *[]){"printf", "%s=%d\\n", "a", "1", "b", "2", "c", NULL}, out, sizeof out) == 0);
+    assert(strcmp(out, "a=1\nb=2\nc=0\n") == 0);
+    assert(run_builtin(builtin_printf, (char *[]){"printf", "sans conversion\\n", "ignoré", NULL}, out, sizeof out) == 0);
+    assert(strcmp(out, "sans conversion\n") == 0);
+    printf("[PASS] Test 2 : Réutilisation du format\n");
+
+    assert(run_builtin(builtin_printf, (char *[]){"printf", "[%5s|%-5s|%.2s|%*d|%-*d]", "ab", "cd", "efgh", "4", "7", "3", "8", NULL}, out, sizeof out) == 0);
+    assert(strcmp(out, "[   ab|cd   |ef|   7|8  ]") == 0);
+    assert(run_builtin(builtin_printf, (char *[]){"printf", "%x %X %o %#x %05d %+i %u %c", "255", "0xff", "010", "255", "42", "3", "7", "hello", NULL}, out, sizeof out) == 0);
+    assert(strcmp(out, "ff FF 10 0xff 00042 +3 7 h") == 0);
+    assert(run_builtin(builtin_printf, (char *[]){"printf", "%.3f %e %g %d", "3.14159", "1000", "0.5", "'A", NULL}, out, sizeof out) == 0);
+    assert(strcmp(out, "3.142 1.000000e+03 0.5 65") == 0);
+    assert(run_builtin(builtin_printf, (char *[]){"printf", "\\101\\x42%%\\t|", NULL}, out, sizeof out) == 0);
+    assert(strcmp(out, "AB%\t|") == 0);
+    printf("[PASS] Test 3 : Conversions, drapeaux, largeur, précision et échappements\n");
+
+    assert(run_builtin(builtin_printf, (char *[]){"printf", "%b|%q|%q|%q|%4q", "a\\nb", "it's", "", "x y", "ab", NULL}, out, sizeof out) == 0);
+    assert(strcmp(out, "a\nb|'it'\\''s'|''|'x y'|  ab") == 0);
+    assert(run_builtin(builtin_printf, (char *[]){"printf", "%b%s", "x\\cy", "z", NULL}, out, sizeof out) == 0);
+    assert(strcmp(out, "x") == 0);
+    printf("[PASS] Test 4 : %%b et %%q\n");
+
+    assert(run_builtin(builtin_printf, (char *[]){"printf", "%d|", "12abc", NULL}, out, sizeof out) == 1);
+    assert(strcmp(out, "12|") == 0);
+    assert(run_builtin(builtin_printf, (char *[]){"printf", "%y", NULL}, out, sizeof out) == 1);
+    assert(run_builtin(builtin_printf, (char *[]){"printf", "a%", NULL}, out, sizeof out) == 1); // code 1, comme les autres erreurs
+    assert(strcmp(out, "a") == 0);
+    assert(run_builtin(builtin_printf, (char *[]){"printf", NULL}, out, sizeof out) == -1);
+    printf("[PASS] Test 5 : Arguments et formats invalides\n");
+
+    // Sortie volumineuse : plusieurs remplissages du tampon (elle tient dans le tampon du tube)
+    static char big[20000], big_out[32768];
+    memset(big, 'x', sizeof big - 1);
+    assert(run_builtin(builtin_printf, (char *[]){"printf", "%s-%s\\n", big, "fin", NULL}, big_out, sizeof big_out) == 0);
+    assert(strlen(big_out) == sizeof big - 1 + 5 && strcmp(big_out + sizeof big - 1, "-fin\n") == 0);
+    printf("[PASS] Test 6 : Sortie plus grande que le tampon\n");
+
+    printf("Tous les tests pour builtin_echo et builtin_printf ont réussi !\n");
+}
+
+// Evalue "test" avec les arguments donnés (argv terminé par NULL)
+static int run_test(char **argv)
+{
+    char out[64];
+    return run_builtin(builtin_test, argv, out, sizeof out);
+}
+
+// Ligne de commande réutilisée par run_line(), initialisée une fois dans main()
+static command_line_t line_cmdl;
+
+// Analyse et exécution d'une ligne, comme la boucle de main()
+static void run_line(const char *line)
+{
+    reset_command_line(&line_cmdl);
+    assert(parse_command_line(&line_cmdl, line) == 0);
+    assert(launch_command_line(&line_cmdl) == 0);
+}
+
+void test_builtin_test()
+{
+    printf("Démarrage des tests unitaires pour builtin_test...\n");
+
+    char dir[] = "/tmp/test_builtin_testXXXXXX";
+    assert(mkdtemp(dir) != NULL);
+    char file[64], empty[64], link[64];
+    snprintf(file, sizeof file, "%s/fichier", dir);
+    snprintf(empty, sizeof empty, "%s/vide", dir);
+    snprintf(link, sizeof link, "%s/lien", dir);
+    int fd = open(file, O_WRONLY | O_CREAT, 0644);
+    assert(fd >= 0 && write(fd, "x", 1) == 1);
+    close(fd);
+    close(open(empty, O_WRONLY | O_CREAT, 0600));
+    assert(symlink(file, link) == 0);
+
+    assert(run_test((char *[]){"test", "-f", file, NULL}) == 0);
+    assert(run_test((char *[]){"test", "-d", dir, NULL}) == 0);
+    assert(run_test((char *[]){"test", "-d", file, NULL}) == 1);
+    assert(run_test((char *[]){"test", "-e", "/chemin/inexistant", NULL}) == 1);
+    assert(run_test((char *[]){"test", "-s", file, NULL}) == 0);
+    assert(run_test((char *[]){"test", "-s", empty, NULL}) == 1);
+    assert(run_test((char *[]){"test", "-h", link, NULL}) == 0);
+    assert(run_test((char *[]){"test", "-L", file, NULL}) == 1);
+    assert(run_test((char *[]){"test", "-r", file, NULL}) == 0);
+    assert(run_test((char *[]){"test", "-x", "/bin/sh", NULL}) == 0);
+    assert(run_test((char *[]){"test", "-p", file, NULL}) == 1);
+    assert(run_test((char *[]){"test", file, "-ef", link, NULL}) == 0);
+    assert(run_test((char *[]){"test", file, "-nt", "/chemin/inexistant", NULL}) == 0);
+    assert(run_test((char *[]){"test", file, "-ot", "/chemin/inexistant", NULL}) == 1);
+    printf("[PASS] Test 1 : Opérateurs sur les fichiers\n");
+
+    assert(run_test((char *[]){"test", NULL}) == 1);
+    assert(run_test((char *[]){"test", "", NULL}) == 1);
+    assert(run_test((char *[]){"test", "x", NULL}) == 0);
+    assert(run_test((char *[]){"test", "-n", "", NULL}) == 1);
+    assert(run_test((char *[]){"test", "-z", "", NULL}) == 0);
+    assert(run_test((char *[]){"test", "a", "=", "a", NULL}) == 0);
+    assert(run_test((char *[]){"test", "a", "!=", "a", NULL}) == 1);
+    assert(run_test((char *[]){"test", "a", "<", "b", NULL}) == 0);
+    assert(run_test((char *[]){"test", "-f", "=", "-f", NULL}) == 0);
+    assert(run_test((char *[]){"test", "3", "-lt", "10", NULL}) == 0);
+    assert(run_test((char *[]){"test", "-3", "-ge", " -3 ", NULL}) == 0);
+    assert(run_test((char *[]){"test", "3", "-eq", "x", NULL}) == 2);
+    printf("[PASS] Test 2 : Chaînes et entiers\n");
+
+    assert(run_test((char *[]){"test", "!", "x", NULL}) == 1);
+    assert(run_test((char *[]){"test", "!", "=", "x", NULL}) == 1);
+    assert(run_test((char *[]){"test", "!", "-e", "/chemin/inexistant", NULL}) == 0);
+    assert(run_test((char *[]){"test", "-e", "/chemin/inexistant", "-o", "1", "-eq", "1", NULL}) == 0);
+    assert(run_test((char *[]){"test", "-e", "/chemin/inexistant", "-a", "1", "-eq", "1", NULL}) == 1);
+    assert(run_test((char *[]){"test", "(", "a", "=", "b", ")", "-o", "!", "(", "x", ")", NULL}) == 1);
+    assert(run_test((char *[]){"test", "(", "a", NULL}) == 2);
+    assert(run_test((char *[]){"test", "a", "b", NULL}) == 2);
+    assert(run_test((char *[]){"[", "-d", dir, "]", NULL}) == 0);
+    assert(run_test((char *[]){"[", "-d", dir, NULL}) == 2);
+    assert(run_test((char *[]){"[", "]", NULL}) == 1);
+    printf("[PASS] Test 3 : Opérateurs logiques, parenthèses et [\n");
+
+    // Cache : le résultat de stat() est réutilisé jusqu'à l'invalidation
+    builtin_stat_cache_clear();
+    assert(run_test((char *[]){"test", "-f", file, NULL}) == 0);
+    unlink(link);
+    unlink(file);
+    assert(run_test((char *[]){"test", "-f", file, NULL}) == 0);
+    assert(run_test((char *[]){"test", "-s", file, NULL}) == 0);
+    builtin_stat_cache_clear();
+    assert(run_test((char *[]){"test", "-f", file, NULL}) == 1);
+    printf("[PASS] Test 4 : Résultats de stat() partagés jusqu'à l'invalidation\n");
+
+    // une redirection ou une commande intégrée peut créer le fichier entre deux tests de la même ligne
+    char line[256];
+    snprintf(line, sizeof line, "[ -e %s ] ; echo x > %s ; [ -e %s ]", file, file, file);
+    run_line(line);
+    assert(get_last_status() == 0);
+    unlink(file);
+    snprintf(line, sizeof line, "[ -e %s ] || echo x > %s ; [ -f %s ]", file, file, file);
+    run_line(line);
+    assert(get_last_status() == 0);
+    unlink(file);
+    printf("[PASS] Test 5 : Cache invalidé par une redirection\n");
+
+    unlink(empty);
+    rmdir(dir);
+    printf("Tous les tests pour builtin_test ont réussi !\n");
+}
+
+void test_builtin_exec()
+{
+    printf("Démarrage des tests unitaires pour builtin_exec...\n");
+
+    const char *path = "/tmp/test_builtins_exec.txt";
+    char output[64];
+    vars_set("PATH", "/usr/bin:/bin", 1);
+    unlink(path);
+
+    // fichier ouvert une seule fois, puis utilisé par les lignes suivantes (commandes intégrées et externes)
+    run_line("exec 7>>/tmp/test_builtins_exec.txt");
+    assert(get_last_status() == 0);
+    assert(get_num_shell_fds() == 1 && is_shell_fd(7));
+    run_line("echo un >&7");
+    run_line("sh -c 'echo deux >&7' ; printf trois >&7");
+    assert(is_shell_fd(7));
+    int fd = open(path, O_RDONLY);
+    assert(fd >= 0);
+    read_all(fd, output, sizeof(output));
+    close(fd);
+    assert(strcmp(output, "un\ndeux\ntrois") == 0);
+    printf("[PASS] Test 1 : exec 7>>fichier persiste d'une ligne à l'autre\n");
+
+    run_line("exec 7>&-");
+    assert(get_num_shell_fds() == 0 && fcntl(7, F_GETFD) < 0);
+    run_line("echo x >&7");
+    assert(get_last_status() == 1);
+    printf("[PASS] Test 2 : exec 7>&- referme le descripteur\n");
+
+    // le processus lui-même est remplacé (dans un fils, pour garder le programme de test)
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0)
+    {
+        run_line("exec sh -c 'exit 7'");
+        _exit(0);
+    }
+    int status = 0;
+    assert(waitpid(pid, &status, 0) == pid);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 7);
+    // shell interactif : l'échec de l'exec laisse le shell continuer
+    set_interactive(1);
+    run_line("exec commande_introuvable_minishell");
+    assert(get_last_status() == 127);
+    set_interactive(0);
+    printf("[PASS] Test 3 : exec commande remplace le shell sans fork\n");
+
+    // shell non interactif : l'échec de l'exec termine le shell, la suite de la ligne n'est pas exécutée
+    fflush(NULL);
+    pid = fork();
+    assert(pid >= 0);
+    if (pid == 0)
+    {
+        run_line("exec commande_introuvable_minishell 2>/dev/null ; exit 0");
+        _exit(0);
+    }
+    assert(waitpid(pid, &status, 0) == pid);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 127);
+    fflush(NULL);
+    pid = fork();
+    assert(pid >= 0);
+    if (pid == 0)
+    {
+        run_line("exec /tmp 2>/dev/null ; exit 0");
+        _exit(0);
+    }
+    assert(waitpid(pid, &status, 0) == pid);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 126);
+    printf("[PASS] Test 4 : exec introuvable termine un shell non interactif (127/126)\n");
+
+    unlink(path);
+    printf("Tous les tests pour builtin_exec ont réussi !\n\n");
+}
+
 int main()
 {
+    init_command_line(&line_cmdl);
     test_is_builtin();
     test_builtin_cd();
     test_builtin_export();
     test_builtin_unset();
     test_builtin_pwd();
+    test_builtin_hash_type();
+    test_builtin_jobs_wait_kill();
+    test_builtin_set();
+    test_builtin_echo_printf();
+    test_builtin_test();
+    test_builtin_exec();
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include "../include/expand.h"
+#include "../include/parser.h"
+#include "../include/processus.h"
+#include "../include/vars.h"
+
+// make test_expand
+// ./test_expand
+
+static command_line_t cmdl;
+
+// Analyse et exécution d'une ligne, comme la boucle de main()
+static void run(const char *line)
+{
+    reset_command_line(&cmdl);
+    assert(parse_command_line(&cmdl, line) == 0);
+    assert(launch_command_line(&cmdl) == 0);
+}
+
+// Arguments de la première commande d'une ligne, substitués comme à son lancement
+static char **words(const char *line, unsigned int expected)
+{
+    reset_command_line(&cmdl);
+    assert(parse_command_line(&cmdl, line) == 0);
+    assert(expand_processus(&cmdl, &cmdl.commands[0]) == 0);
+    assert(cmdl.commands[0].argc == expected);
+    return cmdl.commands[0].argv;
+}
+
+void test_expand_parameter()
+{
+    printf("Démarrage des tests unitaires pour expand_name_length et expand_parameter...\n");
+
+    char buf[EXPAND_NUMBER_SIZE];
+    assert(expand_name_length("HOME/bin", 8) == 4);
+    assert(expand_name_length("HOME", 2) == 2);
+    assert(expand_name_length("?x", 2) == 1);
+    assert(expand_name_length("12", 2) == 1);
+    assert(expand_name_length("-x", 2) == 0);
+    assert(expand_name_length("", 5) == 0);
+    printf("[PASS] Test 1 : Longueur des noms\n");
+
+    char pid[EXPAND_NUMBER_SIZE];
+    snprintf(pid, sizeof pid, "%ld", (long)getpid());
+    assert(strcmp(expand_parameter("$", 1, buf), pid) == 0);
+    assert(strcmp(expand_parameter("?", 1, buf), "0") == 0);
+    assert(expand_parameter("!", 1, buf) == NULL); // aucune commande d'arrière-plan
+    vars_set("EXPAND_VAR", "valeur", 0);
+    assert(strcmp(expand_parameter("EXPAND_VAR_SUITE", 10, buf), "valeur") == 0);
+    assert(expand_parameter("a b", 3, buf) == NULL);
+    printf("[PASS] Test 2 : Paramètres spéciaux et variables\n");
+
+    // sans expand_set_positional() : $0 = minishell, aucun paramètre
+    assert(strcmp(expand_parameter("0", 1, buf), "minishell") == 0);
+    assert(strcmp(expand_parameter("#", 1, buf), "0") == 0);
+    assert(strcmp(expand_parameter("@", 1, buf), "") == 0);
+    assert(expand_parameter("1", 1, buf) == NULL);
+
+    char *argv[] = {"script.sh", "un", "deux", "3", "4", "5", "6", "7", "8", "9", "dix", NULL};
+    assert(expand_set_positional(11, argv) == 0);
+    assert(strcmp(expand_parameter("0", 1, buf), "script.sh") == 0);
+    assert(strcmp(expand_parameter("2", 1, buf), "deux") == 0);
+    assert(strcmp(expand_parameter("10", 2, buf), "dix") == 0);
+    assert(expand_parameter("11", 2, buf) == NULL);
+    assert(expand_parameter("99999999999999999999999", 23, buf) == NULL);
+    assert(strcmp(expand_parameter("#", 1, buf), "10") == 0);
+    assert(strcmp(expand_parameter("*", 1, buf), "un deux 3 4 5 6 7 8 9 dix") == 0);
+    printf("[PASS] Test 3 : Paramètres positionnels\n");
+
+    printf("Tous les tests pour expand_parameter ont réussi !\n\n");
+}
+
+void test_expand_lexer()
+{
+    printf("Démarrage des tests unitaires pour expand_processus...\n");
+
+    char *argv[] = {"script.sh", "a b", "c", NULL};
+    assert(expand_set_positional(3, argv) == 0);
+
+    // $1 hors guillemets : découpé en mots ; "$12" est $1 suivi de "2"
+    char **t = words("echo $1 \"$1\" ${2}x $12 '$1' $#", 9);
+    assert(strcmp(t[0], "echo") == 0);
+    assert(strcmp(t[1], "a") == 0 && strcmp(t[2], "b") == 0);
+    assert(strcmp(t[3], "a b") == 0);
+    assert(strcmp(t[4], "cx") == 0);
+    assert(strcmp(t[5], "a") == 0 && strcmp(t[6], "b2") == 0);
+    assert(strcmp(t[7], "$1") == 0 && strcmp(t[8], "2") == 0);
+    printf("[PASS] Test 4 : Paramètres positionnels\n");
+
+    t = words("echo \"$@\" $0", 3);
+    assert(strcmp(t[1], "a b c") == 0 && strcmp(t[2], "script.sh") == 0);
+    printf("[PASS] Test 5 : $@ et $0\n");
+
+    run("false");
+    t = words("echo $? ${?}", 3);
+    assert(strcmp(t[1], "1") == 0 && strcmp(t[2], "1") == 0);
+    run("true");
+    t = words("echo $?", 2);
+    assert(strcmp(t[1], "0") == 0);
+    printf("[PASS] Test 6 : $? suit le code de retour de la dernière commande\n");
+
+    run("sleep 0 &");
+    assert(get_last_background_pid() > 0);
+    char pid[EXPAND_NUMBER_SIZE];
+    snprintf(pid, sizeof pid, "%ld", (long)get_last_background_pid());
+    t = words("echo $! $$", 3);
+    assert(strcmp(t[1], pid) == 0);
+    assert(atol(t[2]) == (long)getpid());
+    run("wait");
+    printf("[PASS] Test 7 : $! et $$\n");
+
+    printf("Tous les tests pour expand_processus ont réussi !\n\n");
+}
+
+void test_expand_deferred()
+{
+    printf("Démarrage des tests unitaires pour la substitution au lancement...\n");
+
+    // chaque commande voit l'état laissé par les précédentes de la même ligne
+    vars_unset("TEST_DIFF");
+    run("TEST_DIFF=1 && TEST_COPIE=$TEST_DIFF ; false ; TEST_STATUT=$?");
+    assert(strcmp(vars_get("TEST_COPIE"), "1") == 0);
+    assert(strcmp(vars_get("TEST_STATUT"), "1") == 0);
+    printf("[PASS] Test 8 : Valeurs lues au lancement de chaque commande\n");
+
+    // branche non exécutée : aucune substitution
+    run("true || TEST_COPIE=$TEST_DIFF$TEST_DIFF");
+    assert(cmdl.commands[1].expand == 1);
+    assert(strcmp(vars_get("TEST_COPIE"), "1") == 0);
+    printf("[PASS] Test 9 : Branche non exécutée\n");
+
+    // pas de découpage en mots dans une affectation
+    run("TEST_ESP=\"a  b\" ; TEST_COPIE=$TEST_ESP");
+    assert(strcmp(vars_get("TEST_COPIE"), "a  b") == 0);
+    char **t = words("echo x$TEST_ESP", 3);
+    assert(strcmp(t[1], "xa") == 0 && strcmp(t[2], "b") == 0);
+    printf("[PASS] Test 10 : Affectations et découpage\n");
+
+    // redirections ouvertes au lancement : nom substitué à ce moment, rien n'est créé pour une commande non exécutée
+    unlink("test_expand_redir.txt");
+    unlink("test_expand_jamais.txt");
+    run("TEST_FICHIER=test_expand_redir.txt ; echo ok > $TEST_FICHIER ; false && echo x > test_expand_jamais.txt");
+    assert(access("test_expand_redir.txt", F_OK) == 0);
+    assert(access("test_expand_jamais.txt", F_OK) != 0);
+    run("cat < test_expand_absent.txt || TEST_COPIE=echec");
+    assert(strcmp(vars_get("TEST_COPIE"), "echec") == 0);
+    unlink("test_expand_redir.txt");
+    printf("[PASS] Test 11 : Redirections ouvertes au lancement\n");
+
+    printf("Tous les tests pour la substitution au lancement ont réussi !\n\n");
+}
+
+void test_expand_words()
+{
+    printf("Démarrage des tests unitaires pour expand_processus (paramètres dans un mot)...\n");
+
+    char *argv[] = {"minishell", "premier", NULL};
+    assert(expand_set_positional(2, argv) == 0);
+    run("false");
+
+    char **t = words("echo code=$? arg=$1 nb=$#", 4);
+    assert(strcmp(t[1], "code=1") == 0 && strcmp(t[2], "arg=premier") == 0 && strcmp(t[3], "nb=1") == 0);
+    printf("[PASS] Test 12 : Paramètres spéciaux et positionnels\n");
+
+    t = words("echo '$1' \"$1\" \"'$1'\"", 4);
+    assert(strcmp(t[1], "$1") == 0 && strcmp(t[2], "premier") == 0 && strcmp(t[3], "'premier'") == 0);
+    printf("[PASS] Test 13 : Rien n'est substitué entre apostrophes\n");
+
+    // valeurs plus longues et plus courtes que leur nom, dans le même mot
+    vars_set("EXPAND_LONG", "0123456789", 0);
+    vars_unset("EXPAND_UNSET");
+    t = words("echo $1$EXPAND_UNSET$EXPAND_LONG$EXPAND_UNSET!", 2);
+    assert(strcmp(t[1], "premier0123456789!") == 0);
+    words("echo $EXPAND_UNSET$EXPAND_UNSET", 1); // substitution vide : le mot disparaît
+    reset_command_line(&cmdl);
+    char *s = expand_string(&cmdl.arena, "\001EXPAND_LONG\003-\0011\003");
+    assert(s && strcmp(s, "0123456789-premier") == 0);
+    printf("[PASS] Test 14 : Valeurs plus longues et plus courtes que leur nom\n");
+
+    // aucun mot après substitution : la commande ne fait rien mais applique ses affectations et redirections (statut 0, sans erreur)
+    unlink("test_expand_vide.txt");
+    fflush(stderr);
+    int saved_stderr = dup(STDERR_FILENO);
+    FILE *err = tmpfile();
+    assert(saved_stderr >= 0 && err);
+    dup2(fileno(err), STDERR_FILENO);
+    run("false ; $EXPAND_UNSET $EXPAND_UNSET && TEST_VIDE=suite");
+    assert(get_last_status() == 0 && strcmp(vars_get("TEST_VIDE"), "suite") == 0);
+    run("TEST_VIDE=affecte $EXPAND_UNSET ; $EXPAND_UNSET > test_expand_vide.txt ; echo x | $EXPAND_UNSET");
+    assert(get_last_status() == 0 && strcmp(vars_get("TEST_VIDE"), "affecte") == 0);
+    assert(access("test_expand_vide.txt", F_OK) == 0);
+    fflush(stderr);
+    dup2(saved_stderr, STDERR_FILENO);
+    close(saved_stderr);
+    assert(ftell(err) == 0 && lseek(fileno(err), 0, SEEK_END) == 0);
+    fclose(err);
+    unlink("test_expand_vide.txt");
+    printf("[PASS] Test 15 : Commande vide après substitution\n");
+
+    printf("Tous les tests pour les paramètres dans un mot ont réussi !\n\n");
+}
+
+int main()
+{
+    init_command_line(&cmdl);
+    test_expand_parameter();
+    test_expand_lexer();
+    test_expand_deferred();
+    test_expand_words();
+    return 0;
+}
@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include "../include/input.h"
+
+// make test_input
+// ./test_input
+
+// Vérifie que le lecteur retourne exactement les lignes attendues
+static void expect_lines(input_t *in, const char **expected, int n)
+{
+    const char *line;
+    size_t first = in->line_no;
+    for (int i = 0; i < n; i++)
+    {
+        ssize_t len = input_next_line(in, &line);
+        assert(len == (ssize_t)strlen(expected[i]));
+        assert(memcmp(line, expected[i], len) == 0);
+        assert(in->line_no == first + i + 1);
+    }
+    assert(input_next_line(in, &line) == -1);
+    assert(input_next_line(in, &line) == -1);
+}
+
+static char *write_temp(const char *content, size_t len)
+{
+    static char path[64];
+    strcpy(path, "/tmp/test_inputXXXXXX");
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    assert(write(fd, content, len) == (ssize_t)len);
+    close(fd);
+    return path;
+}
+
+void test_input_string()
+{
+    printf("Démarrage des tests unitaires pour input_open_string...\n");
+
+    input_t in;
+    const char *expected[] = {"echo a", "", "ls -l", "dernière"};
+    assert(input_open_string(&in, "echo a\n\nls -l\r\ndernière") == 0);
+    assert(!input_at_end(&in));
+    expect_lines(&in, expected, 4);
+    assert(input_at_end(&in));
+    input_close(&in);
+    printf("[PASS] Test 1 : Découpage d'une chaîne (-c)\n");
+
+    assert(input_open_string(&in, "") == 0);
+    expect_lines(&in, NULL, 0);
+    input_close(&in);
+    printf("[PASS] Test 2 : Chaîne vide\n");
+
+    // lignes blanches finales : la première ligne est déjà la dernière
+    const char *line;
+    assert(input_open_string(&in, "echo a\n \t\n\n") == 0);
+    assert(input_next_line(&in, &line) == 6);
+    assert(input_at_end(&in));
+    input_close(&in);
+    printf("[PASS] Test 3 : Fin de l'entrée\n");
+
+    printf("Tous les tests pour input_open_string ont réussi !\n\n");
+}
+
+void test_input_file()
+{
+    printf("Démarrage des tests unitaires pour input_open_file...\n");
+
+    const char content[] = "cd /tmp\npwd\n\nexit 3\n";
+    char *path = write_temp(content, sizeof content - 1);
+
+    input_t in;
+    assert(input_open_file(&in, path) == 0);
+    assert(in.mapped == 1);
+    const char *expected[] = {"cd /tmp", "pwd", "", "exit 3"};
+    const char *line;
+    assert(input_next_line(&in, &line) == 7);
+    assert(line == in.data); // aucune copie : la ligne pointe dans la projection
+    expect_lines(&in, expected + 1, 3);
+    input_close(&in);
+    printf("[PASS] Test 1 : Fichier projeté en mémoire\n");
+
+    // fichier vide : pas de projection possible, lecture classique
+    path = write_temp("", 0);
+    assert(input_open_file(&in, path) == 0);
+    assert(in.mapped == 0);
+    expect_lines(&in, NULL, 0);
+    input_close(&in);
+    unlink(path);
+    printf("[PASS] Test 2 : Fichier vide\n");
+
+    assert(input_open_file(&in, "/chemin/qui/n/existe/pas") == -1);
+    printf("[PASS] Test 3 : Fichier inexistant\n");
+
+    printf("Tous les tests pour input_open_file ont réussi !\n\n");
+}
+
+void test_input_pipe()
+{
+    printf("Démarrage des tests unitaires pour la lecture par blocs...\n");
+
+    // Beaucoup de lignes, dont une plus longue que le tampon, écrites par petits morceaux dans un tube
+    int n = 20000;
+    size_t long_len = INPUT_BLOCK_SIZE * 2 + 17;
+    int fds[2];
+    assert(pipe(fds) == 0);
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0)
+    {
+        close(fds[0]);
+        char buf[64];
+        for (int i = 0; i < n; i++)
+        {
+            int len = snprintf(buf, sizeof buf, "ligne %d\n", i);
+            if (write(fds[1], buf, len) != len)
+                _exit(1);
+            if (i == n / 2)
+            {
+                char *big = malloc(long_len + 1);
+                memset(big, 'x', long_len);
+                big[long_len] = '\n';
+                for (size_t off = 0; off < long_len + 1;)
+                    off += write(fds[1], big + off, long_len + 1 - off);
+            }
+        }
+        if (write(fds[1], "sans fin de ligne", 17) != 17)
+            _exit(1);
+        _exit(0);
+    }
+    close(fds[1]);
+
+    input_t in;
+    assert(input_open_fd(&in, fds[0]) == 0);
+    assert(in.mapped == 0);
+    const char *line;
+    char expected[64];
+    for (int i = 0; i < n; i++)
+    {
+        ssize_t len = input_next_line(&in, &line);
+        snprintf(expected, sizeof expected, "ligne %d", i);
+        assert(len == (ssize_t)strlen(expected) && memcmp(line, expected, len) == 0);
+        if (i == n / 2)
+        {
+            len = input_next_line(&in, &line);
+            assert(len == (ssize_t)long_len);
+            assert(line[0] == 'x' && line[long_len - 1] == 'x');
+        }
+    }
+    assert(input_next_line(&in, &line) == 17 && memcmp(line, "sans fin de ligne", 17) == 0);
+    assert(input_next_line(&in, &line) == -1);
+    input_close(&in);
+    close(fds[0]);
+    waitpid(pid, NULL, 0);
+    printf("[PASS] Test 1 : %d lignes lues par blocs, ligne plus longue que le tampon\n", n + 2);
+
+    printf("Tous les tests pour la lecture par blocs ont réussi !\n");
+}
+
+int main()
+{
+    test_input_string();
+    test_input_file();
+    test_input_pipe();
+
+    return 0;
+}
@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include "../include/jobs.h"
+
+// make test_jobs
+// ./test_jobs
+
+// Création d'un fils qui se termine avec le code *code* (ou se stoppe si code < 0), enregistré dans le job *id*
+static pid_t start_child(int id, int code)
+{
+    sigset_t old;
+    jobs_block(&old);
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0)
+    {
+        sigprocmask(SIG_SETMASK, &old, NULL);
+        if (code < 0)
+            raise(SIGSTOP);
+        _exit(code < 0 ? 0 : code);
+    }
+    assert(jobs_add_process(id, pid) == 0);
+    jobs_unblock(&old);
+    return pid;
+}
+
+void test_jobs_wait()
+{
+    printf("Démarrage des tests unitaires pour jobs_wait...\n");
+
+    assert(jobs_init() == 0);
+    int id = jobs_new(0, NULL);
+    assert(id > 0);
+    pid_t pid = start_child(id, 3);
+
+    assert(jobs_wait_pid(pid) == 0);
+    job_process_t *p = jobs_find_pid(pid);
+    assert(p != NULL && p->state == JOB_DONE);
+    assert(jobs_exit_code(p->status) == 3);
+    assert(p->end_time.tv_sec > 0);
+    assert(jobs_status(id) == 3);
+    assert(jobs_get(id)->nalive == 0);
+    printf("[PASS] Test 1 : Statut et date de fin enregistrés par le gestionnaire de SIGCHLD\n");
+
+    // le fils a été récupéré : plus de zombie
+    assert(waitpid(pid, NULL, WNOHANG) < 0 && errno == ECHILD);
+    printf("[PASS] Test 2 : Aucun zombie\n");
+
+    jobs_remove(id);
+    assert(jobs_get(id) == NULL);
+    assert(jobs_find_pid(pid) == NULL);
+    assert(jobs_wait_pid(pid) == -1);
+    printf("[PASS] Test 3 : Suppression du job\n");
+
+    // pipeline : un job, plusieurs processus, statut du dernier
+    id = jobs_new(0, NULL);
+    start_child(id, 1);
+    start_child(id, 0);
+    start_child(id, 7);
+    assert(jobs_wait(id) == 0);
+    assert(jobs_get(id)->nalive == 0);
+    assert(jobs_status(id) == 7);
+    jobs_remove(id);
+    printf("[PASS] Test 4 : Job à plusieurs processus\n");
+
+    printf("Tous les tests pour jobs_wait ont réussi !\n\n");
+}
+
+void test_jobs_stop()
+{
+    printf("Démarrage des tests unitaires pour jobs_signal...\n");
+
+    int id = jobs_new(1, "stop &");
+    pid_t pid = start_child(id, -1);
+    assert(jobs_wait(id) == 0);
+    assert(jobs_get(id)->nstopped == 1);
+    assert(jobs_find_pid(pid)->state == JOB_STOPPED);
+    assert(jobs_status(id) == 128 + SIGSTOP);
+    printf("[PASS] Test 1 : Processus stoppé\n");
+
+    assert(jobs_signal(id, SIGCONT) == 0);
+    assert(jobs_get(id)->nstopped == 0);
+    assert(jobs_wait(id) == 0);
+    assert(jobs_status(id) == 0);
+    assert(jobs_active_count() == 0);
+    printf("[PASS] Test 2 : Reprise via SIGCONT\n");
+
+    // un job stoppé n'occupe pas de place : jobs_wait_slot ne doit pas bloquer indéfiniment
+    int stopped_id = jobs_new(1, NULL);
+    start_child(stopped_id, -1);
+    assert(jobs_wait(stopped_id) == 0);
+    assert(jobs_active_count() == 1);
+    assert(jobs_wait_slot(1) == 0);
+    jobs_signal(stopped_id, SIGCONT);
+    jobs_wait(stopped_id);
+    assert(jobs_active_count() == 0);
+    jobs_remove(stopped_id);
+    printf("[PASS] Test 3 : Les jobs stoppés ne comptent pas dans la limite\n");
+
+    char state[64];
+    assert(strcmp(jobs_describe(id, state, sizeof state), "Fini") == 0);
+    assert(jobs_notify(-1) == 1);
+    assert(jobs_get(id) == NULL);
+    assert(jobs_notify(-1) == 0);
+    printf("[PASS] Test 4 : Signalement des jobs terminés\n");
+
+    printf("Tous les tests pour jobs_signal ont réussi !\n\n");
+}
+
+void test_jobs_many()
+{
+    printf("Démarrage des tests unitaires pour la montée en charge de la table des jobs...\n");
+
+    // beaucoup de jobs d'arrière-plan : les tables doivent s'agrandir sans perdre de processus
+    int n = 2000;
+    pid_t *pids = malloc(n * sizeof(*pids));
+    assert(pids != NULL);
+    for (int i = 0; i < n; i++)
+    {
+        int id = jobs_new(1, NULL);
+        assert(id == i + 1);
+        pids[i] = start_child(id, i % 256);
+    }
+    assert(jobs_max_id() == n);
+
+    for (int i = 0; i < n; i++)
+    {
+        assert(jobs_wait_pid(pids[i]) == 0);
+        assert(jobs_exit_code(jobs_find_pid(pids[i])->status) == i % 256);
+    }
+    assert(jobs_active_count() == 0);
+    printf("[PASS] Test 1 : %d jobs d'arrière-plan récupérés\n", n);
+
+    // suppression d'un job au milieu : le numéro suivant reste max + 1
+    jobs_remove(10);
+    assert(jobs_get(10) == NULL);
+    assert(jobs_new(1, NULL) == n + 1);
+    jobs_remove(n + 1);
+    printf("[PASS] Test 2 : Numérotation des jobs\n");
+
+    assert(jobs_notify(-1) == n - 1);
+    assert(jobs_max_id() == 0);
+    assert(jobs_new(0, NULL) == 1);
+    jobs_remove(1);
+    printf("[PASS] Test 3 : Table vidée\n");
+
+    free(pids);
+    printf("Tous les tests pour la montée en charge de la table des jobs ont réussi !\n\n");
+}
+
+// Lancement fictif de *n* jobs d'arrière-plan terminés aussitôt, avec des PID attribués en boucle au-delà de *pid_max*
+static void run_reused_pids(int n, int pid_max, int prune)
+{
+    struct rusage rusage;
+    memset(&rusage, 0, sizeof rusage);
+    for (int i = 0; i < n; i++)
+    {
+        assert(jobs_wait_slot(1) == 0); // limite des jobs d'arrière-plan : bloquerait si une fin n'était pas décomptée
+        int id = jobs_new(1, NULL);
+        pid_t pid = 300 + i % (pid_max - 300);
+        sigset_t old;
+        jobs_block(&old);
+        assert(jobs_add_process(id, pid) == 0);
+        assert(jobs_active_count() == 1);
+        jobs_record(pid, W_EXITCODE(i % 256, 0), &rusage);
+        jobs_unblock(&old);
+        assert(jobs_active_count() == 0);
+        assert(jobs_status(id) == i % 256);
+        assert(jobs_exit_code(jobs_find_pid(pid)->status) == i % 256);
+        if (prune)
+            jobs_prune(JOBS_KEEP_DONE); // boucle principale en mode non interactif
+    }
+}
+
+void test_jobs_pid_reuse()
+{
+    printf("Démarrage des tests unitaires pour la réutilisation des PID...\n");
+
+    int pid_max = 32768;
+    FILE *f = fopen("/proc/sys/kernel/pid_max", "r");
+    if (f)
+    {
+        if (fscanf(f, "%d", &pid_max) != 1)
+            pid_max = 32768;
+        fclose(f);
+    }
+    if (pid_max > 100000)
+        pid_max = 100000;
+    int n = pid_max + 1000;
+
+    // sans suppression : un PID réutilisé désigne le nouveau processus, l'ancien garde son statut dans son job
+    run_reused_pids(n, pid_max, 0);
+    assert(jobs_max_id() == n);
+    assert(jobs_status(1) == 0 && jobs_status(pid_max) == (pid_max - 1) % 256);
+    assert(jobs_notify(-1) == n);
+    printf("[PASS] Test 1 : %d jobs, PID réutilisés après pid_max (%d)\n", n, pid_max);
+
+    // mode non interactif : seuls les derniers jobs terminés sont conservés pour "wait"
+    run_reused_pids(n, pid_max, 1);
+    int kept = jobs_notify(-1);
+    assert(kept >= JOBS_KEEP_DONE && kept <= 2 * JOBS_KEEP_DONE);
+    assert(jobs_max_id() == 0);
+    printf("[PASS] Test 2 : Jobs terminés supprimés en mode non interactif\n");
+
+    printf("Tous les tests pour la réutilisation des PID ont réussi !\n");
+}
+
+int main()
+{
+    test_jobs_wait();
+    test_jobs_stop();
+    test_jobs_many();
+    test_jobs_pid_reuse();
+
+    return 0;
+}
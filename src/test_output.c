@@ -0,0 +1,129 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include "../include/output.h"
+
+// make test_output
+// ./test_output
+
+// Lit tout ce qui est disponible dans le tube (non bloquant)
+static size_t read_available(int fd, char *buf, size_t size)
+{
+    size_t total = 0;
+    while (total < size)
+    {
+        ssize_t n = read(fd, buf + total, size - total);
+        if (n <= 0)
+            break;
+        total += n;
+    }
+    return total;
+}
+
+static void open_pipe(int p[2])
+{
+    assert(pipe(p) == 0);
+    assert(fcntl(p[0], F_SETFL, O_NONBLOCK) == 0);
+    assert(fcntl(p[1], F_SETPIPE_SZ, 1 << 20) >= 0);
+}
+
+void test_output_buffering()
+{
+    printf("Démarrage des tests unitaires pour output_write et output_printf...\n");
+
+    int p[2];
+    open_pipe(p);
+    char buf[64 * 1024];
+
+    output_write(p[1], "abc", 3);
+    output_putc(p[1], ' ');
+    assert(output_printf(p[1], "%d-%s\n", 42, "x") == 5);
+    assert(read(p[0], buf, sizeof buf) == -1 && errno == EAGAIN);
+    assert(output_flush_all() == 0);
+    size_t n = read_available(p[0], buf, sizeof buf);
+    assert(n == 9 && memcmp(buf, "abc 42-x\n", 9) == 0);
+    printf("[PASS] Test 1 : Ecritures regroupées jusqu'au vidage\n");
+
+    // deux descripteurs vers le même tube : l'ordre des écritures est conservé
+    int other = dup(p[1]);
+    output_write(p[1], "1", 1);
+    output_write(other, "2", 1);
+    output_write(p[1], "3", 1);
+    output_printf(other, "%s", "4");
+    assert(output_flush_all() == 0);
+    n = read_available(p[0], buf, sizeof buf);
+    assert(n == 4 && memcmp(buf, "1234", 4) == 0);
+    close(other);
+    printf("[PASS] Test 2 : Ordre conservé entre descripteurs\n");
+
+    // débordement du tampon : contenu en attente puis gros bloc, sans perte ni inversion
+    char *big = malloc(3 * OUTPUT_BUFFER_SIZE);
+    for (size_t i = 0; i < 3 * OUTPUT_BUFFER_SIZE; ++i)
+        big[i] = 'a' + i % 26;
+    output_write(p[1], big, 100);
+    output_write(p[1], big + 100, 3 * OUTPUT_BUFFER_SIZE - 100);
+    output_write(p[1], "!", 1);
+    assert(output_flush_all() == 0);
+    n = read_available(p[0], buf, sizeof buf);
+    assert(n == 3 * OUTPUT_BUFFER_SIZE + 1);
+    assert(memcmp(buf, big, 3 * OUTPUT_BUFFER_SIZE) == 0 && buf[n - 1] == '!');
+    printf("[PASS] Test 3 : Ecriture plus grande que le tampon\n");
+
+    // texte formaté plus grand que la place restante, puis que le tampon
+    output_write(p[1], big, OUTPUT_BUFFER_SIZE - 10);
+    assert(output_printf(p[1], "%020d", 7) == 20);
+    assert(output_printf(p[1], "%*s", 2 * OUTPUT_BUFFER_SIZE, "z") == 2 * OUTPUT_BUFFER_SIZE);
+    assert(output_flush_all() == 0);
+    n = read_available(p[0], buf, sizeof buf);
+    assert(n == OUTPUT_BUFFER_SIZE - 10 + 20 + 2 * OUTPUT_BUFFER_SIZE);
+    assert(memcmp(buf + OUTPUT_BUFFER_SIZE - 10, "00000000000000000007", 20) == 0);
+    assert(buf[n - 2] == ' ' && buf[n - 1] == 'z');
+    printf("[PASS] Test 4 : output_printf plus grand que le tampon\n");
+
+    free(big);
+    close(p[0]);
+    close(p[1]);
+    printf("Tous les tests pour output_write et output_printf ont réussi !\n\n");
+}
+
+void test_output_errors()
+{
+    printf("Démarrage des tests unitaires pour output_flush...\n");
+
+    int p[2];
+    open_pipe(p);
+    char buf[16];
+
+    // output_flush ne vide que le descripteur demandé
+    output_write(p[1], "ok", 2);
+    assert(output_flush(p[1]) == 0);
+    assert(read_available(p[0], buf, sizeof buf) == 2);
+    printf("[PASS] Test 5 : Vidage d'un descripteur\n");
+
+    // écriture dans un tube sans lecteur : l'erreur est signalée une fois par output_flush_all
+    signal(SIGPIPE, SIG_IGN);
+    close(p[0]);
+    output_write(p[1], "perdu", 5);
+    assert(output_flush_all() == -1);
+    assert(output_flush_all() == 0);
+    output_write(-1, "ignoré", 6);
+    assert(output_printf(-1, "%s", "ignoré") == -1);
+    assert(output_flush_all() == 0);
+    close(p[1]);
+    printf("[PASS] Test 6 : Erreurs d'écriture\n");
+
+    printf("Tous les tests pour output_flush ont réussi !\n\n");
+}
+
+int main()
+{
+    test_output_buffering();
+    test_output_errors();
+    return 0;
+}
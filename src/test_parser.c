@@ -1,340 +1,15 @@
 #include "../include/parser.h"
+#include "../include/vars.h"
+#include "../include/expand.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
-#define MAX 100
+#include <fcntl.h>
 
 // make test_parser
 // ./test_parser
 
-void print_test_result(char *func_name, int test_result)
-{
-	printf("- Fonction %s : %s\n", func_name, (test_result == 0) ? "SUCCES" : "ECHEC");
-}
-
-void print_expected_result(char *func_name, char *obtained, char *expected)
-{
-	printf("Après %s: '%s'\nRésultat attendu: '%s'\n\n", func_name, obtained, expected);
-}
-
-int test_trim()
-{
-	int result = 0;
-	char s1[] = "        toto 123    !                  ";
-	char s2[] = "titi1 2 3    ";
-	char s3[] = "               tutu123.";
-	char s4[] = "tata123";
-
-	char t1[] = "toto 123    !";
-	char t2[] = "titi1 2 3";
-	char t3[] = "tutu123.";
-	char t4[] = "tata123";
-
-	trim(s1);
-	trim(s2);
-	trim(s3);
-	trim(s4);
-
-	int r1 = strcmp(s1, t1);
-	int r2 = strcmp(s2, t2);
-	int r3 = strcmp(s3, t3);
-	int r4 = strcmp(s4, t4);
-
-	if (r1 || r2 || r3 || r4)
-	{
-		result = -1;
-
-		if (r1)
-			print_expected_result("trim", s1, t1);
-		if (r2)
-			print_expected_result("trim", s2, t2);
-		if (r3)
-			print_expected_result("trim", s3, t3);
-		if (r4)
-			print_expected_result("trim", s4, t4);
-	}
-
-	return result;
-}
-
-void test_separate_s()
-{
-	char buffer[256];
-	int ret;
-
-	printf("Démarrage des tests unitaires pour separate_s...\n");
-
-	strcpy(buffer, "hello,world");
-	ret = separate_s(buffer, ",", 256);
-	assert(ret == 0);
-	assert(strcmp(buffer, "hello , world") == 0);
-	printf("[PASS] Test 1 : Cas simple\n");
-
-	strcpy(buffer, "a+b=c");
-	ret = separate_s(buffer, "+=", 256);
-	assert(ret == 0);
-	assert(strcmp(buffer, "a + b = c") == 0);
-	printf("[PASS] Test 2 : Plusieurs séparateurs\n");
-
-	strcpy(buffer, "(bonjour)");
-	ret = separate_s(buffer, "()", 256);
-	assert(ret == 0);
-	assert(strcmp(buffer, " ( bonjour ) ") == 0);
-	printf("[PASS] Test 3 : Séparateurs au début/fin\n");
-
-	strcpy(buffer, "wow!!");
-	ret = separate_s(buffer, "!", 256);
-	assert(ret == 0);
-	assert(strcmp(buffer, "wow !  ! ") == 0);
-	printf("[PASS] Test 4 : Séparateurs contigus\n");
-
-	strcpy(buffer, "bonjour");
-	ret = separate_s(buffer, ",;!", 256);
-	assert(ret == 0);
-	assert(strcmp(buffer, "bonjour") == 0);
-	printf("[PASS] Test 5 : Aucun séparateur présent\n");
-
-	buffer[0] = '\0';
-	ret = separate_s(buffer, ",", 256);
-	assert(ret == 0);
-	assert(strlen(buffer) == 0);
-	printf("[PASS] Test 6 : Chaîne vide\n");
-
-	strcpy(buffer, "texte");
-	ret = separate_s(buffer, "", 256);
-	assert(ret == 0);
-	assert(strcmp(buffer, "texte") == 0);
-	printf("[PASS] Test 7 : Liste séparateurs vide\n");
-
-	strcpy(buffer, "a,b");
-	ret = separate_s(buffer, ",", 5);
-	assert(ret == -1);
-	assert(strcmp(buffer, "a,b") == 0);
-	printf("[PASS] Test 8 : Dépassement de taille (Overflow)\n");
-
-	strcpy(buffer, "a,b");
-	ret = separate_s(buffer, ",", 6);
-	assert(ret == 0);
-	assert(strcmp(buffer, "a , b") == 0);
-	printf("[PASS] Test 9 : Taille exacte\n");
-
-	ret = separate_s(NULL, ",", 256);
-	assert(ret == -1);
-	ret = separate_s(buffer, NULL, 256);
-	assert(ret == -1);
-	printf("[PASS] Test 10 : Pointeurs NULL\n");
-
-	printf("\nTous les tests ont réussi !\n");
-}
-
-int test_replace()
-{
-	int result = 0;
-
-	char s1[MAX] = "toto";
-	char s2[MAX] = "abcd";
-
-	char t1[] = "PRoto";
-	char t2[] = "abcxy";
-
-	int r1 = replace(s1, "t", "PR", MAX) || strcmp(s1, t1);
-	int r2 = replace(s2, "d", "xyzzz", 6) || strcmp(s2, t2);
-	int r3 = replace(s1, "blablabal", "", MAX);
-
-	if (r1 || r2 || r3 != -1)
-	{
-		result = -1;
-
-		if (r1)
-			print_expected_result("replace", s1, t1);
-		if (r2)
-			print_expected_result("replace", s2, t2);
-		if (r3)
-			print_expected_result("replace", s1, "ERREUR");
-	}
-
-	return result;
-}
-
-int test_clean()
-{
-	int result = 0;
-
-	char s1[] = "        to          t          o                   ";
-	char s2[] = "abcd";
-
-	char t1[] = " to t o ";
-	char t2[] = "abcd";
-
-	int r1 = clean(s1) || strcmp(s1, t1);
-
-	int r2 = clean(s2) || strcmp(s2, t2);
-
-	if (r1 || r2)
-	{
-		result = -1;
-
-		if (r1)
-			print_expected_result("clean", s1, t1);
-		if (r2)
-			print_expected_result("clean", s2, t2);
-	}
-
-	return result;
-}
-
-int test_strcut()
-{
-	char buffer[256];
-	char *tokens[10];
-	int ret;
-
-	printf("Démarrage des tests unitaires pour strcut...\n");
-
-	strcpy(buffer, "un,deux,trois");
-	ret = strcut(buffer, ',', tokens, 10);
-	assert(ret == 3);
-	assert(strcmp(tokens[0], "un") == 0);
-	assert(strcmp(tokens[1], "deux") == 0);
-	assert(strcmp(tokens[2], "trois") == 0);
-	assert(tokens[3] == NULL);
-	printf("[PASS] Test 1 : Cas nominal\n");
-
-	strcpy(buffer, "a,b,c,d,e");
-	ret = strcut(buffer, ',', tokens, 3); // max=3 ("a", "b", et NULL)
-	assert(ret == -1);
-	assert(tokens[2] == NULL);
-	printf("[PASS] Test 2 : Dépassement de taille (Overflow)\n");
-
-	strcpy(buffer, "a,b,c");
-	ret = strcut(buffer, ',', tokens, 4);
-	assert(ret == 3);
-	assert(strcmp(tokens[2], "c") == 0);
-	assert(tokens[3] == NULL);
-	printf("[PASS] Test 3 : Taille exacte\n");
-
-	strcpy(buffer, "");
-	ret = strcut(buffer, ',', tokens, 10);
-	assert(ret == 0);
-	assert(tokens[0] == NULL);
-	printf("[PASS] Test 4 : Chaîne vide\n");
-
-	strcpy(buffer, "unseultoken");
-	ret = strcut(buffer, ',', tokens, 10);
-	assert(ret == 1);
-	assert(strcmp(tokens[0], "unseultoken") == 0);
-	assert(tokens[1] == NULL);
-	printf("[PASS] Test 5 : Aucun séparateur\n");
-
-	strcpy(buffer, "a,,b,c,"); // Ignore les virgules en double et à la fin
-	ret = strcut(buffer, ',', tokens, 10);
-	assert(ret == 3);
-	assert(strcmp(tokens[0], "a") == 0);
-	assert(strcmp(tokens[1], "b") == 0);
-	assert(strcmp(tokens[2], "c") == 0);
-	assert(tokens[3] == NULL);
-	printf("[PASS] Test 6 : Séparateurs multiples (ignorés)\n");
-
-	strcpy(buffer, "a,b");
-	ret = strcut(buffer, ',', tokens, 1);
-	assert(ret == -1);
-	assert(tokens[0] == NULL);
-	printf("[PASS] Test 7 : Cas limite (max=1)\n");
-
-	strcpy(buffer, "a,b");
-	ret = strcut(buffer, ',', tokens, 0);
-	assert(ret == -1);
-	printf("[PASS] Test 8 : Cas limite (max=0)\n");
-
-	printf("\nTous les tests ont réussi !\n");
-}
-
-void test_substenv()
-{
-	char buffer[1024];
-	int ret;
-
-	printf("Démarrage des tests unitaires pour substenv...\n");
-
-	// Configuration de l'environnement pour les tests
-	setenv("TEST_VAR", "monde", 1);
-	setenv("LONG_VAR", "une_valeur_tres_longue_pour_tester_les_limites", 1);
-	setenv("EMPTY_VAR", "", 1);
-	unsetenv("NON_EXISTENT_VAR"); // On s'assure qu'elle n'existe pas
-
-	strcpy(buffer, "bonjour tout le monde");
-	ret = substenv(buffer, 1024);
-	assert(ret == 0);
-	assert(strcmp(buffer, "bonjour tout le monde") == 0);
-	printf("[PASS] Test 1 : Pas de substitution\n");
-
-	strcpy(buffer, "bonjour $TEST_VAR");
-	ret = substenv(buffer, 1024);
-	assert(ret == 0);
-	assert(strcmp(buffer, "bonjour monde") == 0);
-	printf("[PASS] Test 2 : Substitution simple\n");
-
-	strcpy(buffer, "bonjour ${TEST_VAR} !");
-	ret = substenv(buffer, 1024);
-	assert(ret == 0);
-	assert(strcmp(buffer, "bonjour monde !") == 0);
-	printf("[PASS] Test 3 : Substitution avec accolades\n");
-
-	strcpy(buffer, "bonjour $NON_EXISTENT_VAR!");
-	ret = substenv(buffer, 1024);
-	assert(ret == 0);
-	assert(strcmp(buffer, "bonjour !") == 0);
-	printf("[PASS] Test 4 : Variable inexistante\n");
-
-	setenv("A", "1", 1);
-	setenv("B", "2", 1);
-	strcpy(buffer, "test $A$B ${A}.${B}");
-	ret = substenv(buffer, 1024);
-	assert(ret == 0);
-	assert(strcmp(buffer, "test 12 1.2") == 0);
-	printf("[PASS] Test 5 : Variables multiples\n");
-
-	strcpy(buffer, "Prix: 10$ payables. ou ${incomplet");
-	ret = substenv(buffer, 1024);
-	assert(ret == 0);
-	assert(strcmp(buffer, "Prix: 10$ payables. ou ${incomplet") == 0);
-	printf("[PASS] Test 6 : Syntaxe invalide ($ littéral)\n");
-
-	strcpy(buffer, "Start $LONG_VAR end");
-	// La chaine finale devrait faire : 6 ("Start ") + 46 (valeur) + 4 (" end") = 56 chars.
-	ret = substenv(buffer, 50);
-	assert(ret == -1);
-	assert(strcmp(buffer, "Start $LONG_VAR end") == 0);
-	printf("[PASS] Test 7 : Dépassement de taille (Overflow)\n");
-
-	setenv("KEY", "VAL", 1);
-	strcpy(buffer, "$KEY");
-	ret = substenv(buffer, 4);
-	assert(ret == 0);
-	assert(strcmp(buffer, "VAL") == 0);
-
-	strcpy(buffer, "$KEY");
-	ret = substenv(buffer, 3);
-	assert(ret == -1);
-	printf("[PASS] Test 8 : Tests aux limites de taille exacte\n");
-
-	ret = substenv(NULL, 1024);
-	assert(ret == -1);
-	strcpy(buffer, "$TEST_VAR");
-	ret = substenv(buffer, 0);
-	assert(ret == -1);
-	printf("[PASS] Test 9 : Paramètres invalides (NULL ou size 0)\n");
-
-	strcpy(buffer, "Vide[$EMPTY_VAR]");
-	ret = substenv(buffer, 1024);
-	assert(ret == 0);
-	assert(strcmp(buffer, "Vide[]") == 0);
-	printf("[PASS] Test 10 : Variable vide\n");
-
-	printf("\nTous les tests ont réussi !\n");
-}
-
 // Fonction utilitaire pour nettoyer une structure command_line_t entre deux tests
 // (Note: Idéalement, il faudrait une fonction free_command_line dans ton projet)
 void reset_cmdl(command_line_t *cmdl)
@@ -342,9 +17,8 @@ void reset_cmdl(command_line_t *cmdl)
 	// Fermeture des FDs ouverts par le parsing précédent
 	close_fds(cmdl);
 
-	// Réinitialisation basique (attention, ça ne free pas les strdup des argv/path !)
-	// Dans un vrai projet, il faudrait boucler sur commands[] pour free path et argv.
-	init_command_line(cmdl);
+	// Réinitialisation (les argv/path pointent dans l'arène de la ligne, remise à zéro par reset_command_line)
+	reset_command_line(cmdl);
 }
 
 void test_parse_command_line()
@@ -370,7 +44,7 @@ void test_parse_command_line()
 	reset_cmdl(cmdl);
 
 	// --- TEST 2 : Séquence (;) ---
-	// Note: Ta fonction separate_s gère les espaces autour de ';', on teste sans espace
+	// L'analyseur lexical reconnaît ';' sans espace autour
 	const char *line2 = "echo un;echo deux";
 
 	assert(parse_command_line(cmdl, line2) == 0);
@@ -388,43 +62,45 @@ void test_parse_command_line()
 	reset_cmdl(cmdl);
 
 	// --- TEST 3 : Redirection sortie (>) ---
-	// On doit vérifier que le fichier est créé et que stdout_fd n'est plus 1
+	// La redirection est enregistrée : le fichier n'est ouvert qu'au lancement de la commande
 	const char *line3 = "ls > test_out.txt";
 
+	unlink("test_out.txt");
 	assert(parse_command_line(cmdl, line3) == 0);
-	assert(cmdl->commands[0].stdout_fd > 2); // Doit être un FD ouvert
-
-	// Vérification que le fichier existe bien
-	assert(access("test_out.txt", F_OK) == 0);
-	unlink("test_out.txt"); // Nettoyage
+	assert(cmdl->commands[0].stdout_fd == 1);
+	assert(access("test_out.txt", F_OK) != 0);
+	redirection_t *r = cmdl->commands[0].redirections;
+	assert(r && r->next == NULL);
+	assert(r->fd == 1 && r->source == -1 && strcmp(r->path, "test_out.txt") == 0);
+	assert(r->flags == (O_WRONLY | O_CREAT | O_TRUNC));
 
 	printf("[PASS] Test 3 : Redirection (>)\n");
 	reset_cmdl(cmdl);
 
 	// --- TEST 4 : Pipe (|) ---
-	// Note: Ton parser ne sépare pas '|' automatiquement avec separate_s.
-	// Il faut donc mettre des espaces dans le test pour l'instant : "ls | grep"
+	// (opérateurs sans espace autour : voir le test 10)
 	const char *line4 = "ls | grep c";
 
 	assert(parse_command_line(cmdl, line4) == 0);
 
-	// Vérification de la plomberie
-	// Cmd 0 (ls) doit avoir stdout != 1
-	assert(cmdl->commands[0].stdout_fd != 1);
-	assert(cmdl->commands[0].stdout_fd > 2);
+	// Aucun tube n'est créé par l'analyse (il l'est au lancement du pipeline)
+	assert(cmdl->commands[0].stdout_fd == 1);
+	assert(cmdl->commands[1].stdin_fd == 0);
+	assert(cmdl->num_opened == 0);
 
-	// Cmd 1 (grep) doit avoir stdin != 0
-	assert(cmdl->commands[1].stdin_fd != 0);
-	assert(cmdl->commands[1].stdin_fd > 2);
+	// Les deux étapes forment un groupe pipeline
+	assert(cmdl->flow[0].pipe_next == &cmdl->flow[1]);
+	assert(cmdl->flow[0].unconditionnal_next == NULL);
 
 	printf("[PASS] Test 4 : Pipe (|)\n");
 	reset_cmdl(cmdl);
 
 	// --- TEST 5 : Substitution de variables ($) ---
-	setenv("TEST_VAR", "mon_dossier", 1);
+	vars_set("TEST_VAR", "mon_dossier", 1);
 	const char *line5 = "cd $TEST_VAR";
 
 	assert(parse_command_line(cmdl, line5) == 0);
+	assert(expand_processus(cmdl, &cmdl->commands[0]) == 0);
 	assert(strcmp(cmdl->commands[0].argv[1], "mon_dossier") == 0);
 
 	printf("[PASS] Test 5 : Substitution ($)\n");
@@ -456,6 +132,230 @@ void test_parse_command_line()
 	assert(cmdl->commands[0].is_background == 1);
 
 	printf("[PASS] Test 7 : Background (&)\n");
+	reset_cmdl(cmdl);
+
+	// --- TEST 8 : Mot-clé time ---
+	const char *line8 = "time ls | wc -l ; echo time";
+
+	assert(parse_command_line(cmdl, line8) == 0);
+	assert(cmdl->commands[0].timed == 1);
+	assert(strcmp(cmdl->commands[0].argv[0], "ls") == 0);
+	assert(cmdl->commands[1].timed == 0);
+	assert(cmdl->commands[2].timed == 0);
+	assert(strcmp(cmdl->commands[2].argv[1], "time") == 0); // argument ordinaire hors tête de commande
+
+	printf("[PASS] Test 8 : Mot-clé time\n");
+	reset_cmdl(cmdl);
+
+	// --- TEST 9 : "!" mot réservé seulement en tête de commande ---
+	const char *line9 = "! [ ! -e x ]";
+
+	assert(parse_command_line(cmdl, line9) == 0);
+	assert(cmdl->commands[0].invert == 1);
+	assert(strcmp(cmdl->commands[0].argv[0], "[") == 0);
+	assert(strcmp(cmdl->commands[0].argv[1], "!") == 0);
+	assert(strcmp(cmdl->commands[0].argv[4], "]") == 0);
+
+	printf("[PASS] Test 9 : \"!\" en tête de commande ou en argument\n");
+	reset_cmdl(cmdl);
+
+	// --- TEST 10 : Opérateurs sans espaces ---
+	const char *line10 = "echo a|wc -c&&echo 'x | y'>/dev/null";
+
+	assert(parse_command_line(cmdl, line10) == 0);
+	assert(cmdl->num_commands == 3);
+	assert(strcmp(cmdl->commands[0].argv[1], "a") == 0 && cmdl->commands[0].argv[2] == NULL);
+	assert(cmdl->flow[0].pipe_next == &cmdl->flow[1]);
+	assert(strcmp(cmdl->commands[1].argv[1], "-c") == 0);
+	assert(strcmp(cmdl->commands[2].argv[1], "x | y") == 0);
+	assert(cmdl->commands[2].redirections && strcmp(cmdl->commands[2].redirections->path, "/dev/null") == 0);
+
+	printf("[PASS] Test 10 : Opérateurs sans espaces\n");
+	reset_cmdl(cmdl);
+
+	// --- TEST 11 : Commande simple sans allocation sur le tas ---
+	size_t allocations = arena_heap_allocations();
+	assert(parse_command_line(cmdl, "ls -l 'a b' $TEST_VAR") == 0);
+	assert(arena_heap_allocations() == allocations);
+	assert(cmdl->commands[0].path == cmdl->commands[0].argv[0]);
+	for (int i = 0; i < 4; i++)
+		assert(cmdl->commands[0].argv[i] >= cmdl->command_line && cmdl->commands[0].argv[i] < cmdl->command_line + sizeof cmdl->command_line);
+	assert(strcmp(cmdl->commands[0].argv[2], "a b") == 0);
+
+	printf("[PASS] Test 11 : Arguments dans l'arène, sans allocation\n");
+	reset_cmdl(cmdl);
+
+	// --- TEST 12 : Substitution plus longue que le bloc initial de l'arène ---
+	char *long_value = malloc(10000);
+	memset(long_value, 'v', 9999);
+	long_value[9999] = '\0';
+	vars_set("TEST_LONG", long_value, 1);
+	assert(parse_command_line(cmdl, "echo $TEST_LONG \"$TEST_LONG\" fin") == 0);
+	assert(expand_processus(cmdl, &cmdl->commands[0]) == 0);
+	assert(arena_heap_allocations() > allocations);
+	assert(strcmp(cmdl->commands[0].argv[1], long_value) == 0);
+	assert(strcmp(cmdl->commands[0].argv[2], long_value) == 0);
+	assert(strcmp(cmdl->commands[0].argv[3], "fin") == 0);
+	reset_cmdl(cmdl);
+	assert(cmdl->arena.chunks == NULL);
+	vars_unset("TEST_LONG");
+	free(long_value);
+
+	printf("[PASS] Test 12 : Débordement de l'arène sur le tas\n");
+
+	// --- TEST 13 : Ligne sans limite de taille, de commandes ni d'arguments ---
+	size_t big_size = 300 * 16;
+	char *big = malloc(big_size);
+	size_t len = 0;
+	for (int i = 0; i < 300; i++)
+		len += snprintf(big + len, big_size - len, "%s%d", i == 0 ? "echo " : i < 200 ? " " : " ; c", i);
+	assert(len > 1000);
+	assert(parse_command_line(cmdl, big) == 0);
+	assert(cmdl->num_commands == 101);
+	assert(cmdl->commands[0].argc == 201);
+	assert(strcmp(cmdl->commands[0].argv[200], "199") == 0 && cmdl->commands[0].argv[201] == NULL);
+	assert(strcmp(cmdl->commands[100].argv[0], "c299") == 0);
+	assert(cmdl->flow[99].unconditionnal_next == &cmdl->flow[100] && cmdl->flow[100].proc == &cmdl->commands[100]);
+	reset_cmdl(cmdl);
+
+	// ligne de plus de 4 Ko (l'ancienne limite) puis plus grande que le bloc initial de l'arène
+	for (size_t size = 5000; size <= 40000; size *= 8)
+	{
+		char *line = malloc(size + 1);
+		memcpy(line, "echo ", 5);
+		memset(line + 5, 'x', size - 5);
+		line[size] = '\0';
+		assert(parse_command_line(cmdl, line) == 0);
+		assert(strlen(cmdl->commands[0].argv[1]) == size - 5);
+		reset_cmdl(cmdl);
+		free(line);
+	}
+	free(big);
+
+	printf("[PASS] Test 13 : Grande ligne (201 arguments, 101 commandes, 40 Ko)\n");
+
+	// --- TEST 14 : Redirections de descripteurs quelconques ---
+	assert(parse_command_line(cmdl, "cmd 3>log 4<&0 2>&- &>f >&g |& wc") == 0);
+	r = cmdl->commands[0].redirections;
+	assert(r->fd == 3 && r->source == -1 && strcmp(r->path, "log") == 0);
+	r = r->next;
+	assert(r->fd == 4 && r->source == 0 && r->path == NULL);
+	r = r->next;
+	assert(r->fd == 2 && r->source == -1 && r->path == NULL); // fermeture
+	r = r->next;
+	assert(r->fd == 1 && strcmp(r->path, "f") == 0 && r->next->fd == 2 && r->next->source == 1);
+	r = r->next->next;
+	assert(r->fd == 1 && strcmp(r->path, "g") == 0 && r->next->fd == 2 && r->next->source == 1);
+	r = r->next->next;
+	assert(r->fd == 2 && r->source == 1 && r->next == NULL); // "|&"
+	assert(cmdl->flow[0].pipe_next == &cmdl->flow[1]);
+	reset_cmdl(cmdl);
+
+	int saved = dup(STDERR_FILENO);
+	int devnull = open("/dev/null", O_WRONLY);
+	dup2(devnull, STDERR_FILENO);
+	assert(parse_command_line(cmdl, "a 2>&x") == -1);
+	reset_cmdl(cmdl);
+	assert(parse_command_line(cmdl, "a <&f") == -1);
+	reset_cmdl(cmdl);
+	assert(parse_command_line(cmdl, "a 99999999999>f") == -1);
+	reset_cmdl(cmdl);
+	dup2(saved, STDERR_FILENO);
+	close(devnull);
+	close(saved);
+
+	// appliquées dans l'ordre : "2>&1 >f" garde l'erreur sur l'ancienne sortie standard
+	unlink("test_fd1.txt");
+	unlink("test_fd3.txt");
+	assert(parse_command_line(cmdl, "sh -c 'echo out; echo side >&3; echo err >&2' 3>test_fd3.txt 2>&1 >test_fd1.txt 2>&-") == 0);
+	assert(launch_command_line(cmdl) == 0);
+	char text[64] = {0};
+	int fd = open("test_fd1.txt", O_RDONLY);
+	assert(fd >= 0 && read(fd, text, sizeof text - 1) == 4 && strcmp(text, "out\n") == 0);
+	close(fd);
+	memset(text, 0, sizeof text);
+	fd = open("test_fd3.txt", O_RDONLY);
+	assert(fd >= 0 && read(fd, text, sizeof text - 1) == 5 && strcmp(text, "side\n") == 0);
+	close(fd);
+	unlink("test_fd1.txt");
+	unlink("test_fd3.txt");
+	reset_cmdl(cmdl);
+
+	printf("[PASS] Test 14 : Redirections de descripteurs quelconques\n");
+
+	// --- TEST 15 : Documents en ligne et chaînes en ligne ---
+	assert(parse_command_line(cmdl, "cat <<FIN | tr a-z A-Z >test_here1.txt ; cat <<-'FIN' 3<<<\"$HERE_VAR\" <<\\X >test_here2.txt") == 0);
+	assert(cmdl->num_heredocs == 3);
+	r = cmdl->commands[0].redirections;
+	assert(r->fd == 0 && r->here == HERE_DOC && r->expand == 1 && strcmp(r->path, "FIN") == 0);
+	r = cmdl->commands[2].redirections;
+	assert(r->here == HERE_DOC_STRIP && r->expand == 0 && strcmp(r->path, "FIN") == 0);
+	r = r->next;
+	assert(r->fd == 3 && r->here == HERE_STRING && r->expand == 1 && strcmp(r->path, "\002HERE_VAR\003\004\n") == 0);
+	assert(r->next->here == HERE_DOC && r->next->expand == 0 && strcmp(r->next->path, "X") == 0);
+
+	// contenu lu sur les lignes suivantes, dans l'ordre de la ligne ; substitué au lancement si le délimiteur n'a pas de guillemets
+	input_t in;
+	assert(input_open_string(&in, "a $HERE_VAR \\$b \\\nc\nFIN\n\t$HERE_VAR\n\tFIN\nx\nX\nsuite\n") == 0);
+	assert(read_heredocs(cmdl, &in, NULL) == 0 && cmdl->num_heredocs == 0);
+	const char *next_line;
+	assert(input_next_line(&in, &next_line) == 5 && strncmp(next_line, "suite", 5) == 0);
+	input_close(&in);
+	vars_set("HERE_VAR", "v  w", 0);
+	unlink("test_here1.txt");
+	unlink("test_here2.txt");
+	assert(launch_command_line(cmdl) == 0);
+	char here[64] = {0};
+	fd = open("test_here1.txt", O_RDONLY);
+	assert(fd >= 0 && read(fd, here, sizeof here - 1) == 12 && strcmp(here, "A V  W $B C\n") == 0);
+	close(fd);
+	memset(here, 0, sizeof here);
+	fd = open("test_here2.txt", O_RDONLY);
+	assert(fd >= 0 && read(fd, here, sizeof here - 1) == 2 && strcmp(here, "x\n") == 0);
+	close(fd);
+	reset_cmdl(cmdl);
+
+	// "<<-" retire les tabulations ; chaîne en ligne substituée sans découpage ; contenu plus grand qu'un tube (PIPE_BUF)
+	assert(parse_command_line(cmdl, "cat <<-FIN >test_here1.txt ; cat <<<$HERE_VAR >test_here2.txt ; cat <<FIN | wc -c >test_here3.txt") == 0);
+	char *doc = malloc(100000 + 64);
+	strcpy(doc, "\t$HERE_VAR\n\tFIN\n");
+	size_t doc_len = strlen(doc);
+	memset(doc + doc_len, 'x', 100000);
+	strcpy(doc + doc_len + 100000, "\nFIN\n");
+	assert(input_open_string(&in, doc) == 0);
+	assert(read_heredocs(cmdl, &in, NULL) == 0);
+	input_close(&in);
+	free(doc);
+	assert(launch_command_line(cmdl) == 0);
+	memset(here, 0, sizeof here);
+	fd = open("test_here1.txt", O_RDONLY);
+	assert(fd >= 0 && read(fd, here, sizeof here - 1) == 5 && strcmp(here, "v  w\n") == 0);
+	close(fd);
+	memset(here, 0, sizeof here);
+	fd = open("test_here2.txt", O_RDONLY);
+	assert(fd >= 0 && read(fd, here, sizeof here - 1) == 5 && strcmp(here, "v  w\n") == 0);
+	close(fd);
+	memset(here, 0, sizeof here);
+	fd = open("test_here3.txt", O_RDONLY);
+	assert(fd >= 0 && read(fd, here, sizeof here - 1) > 0 && atoi(here) == 100001);
+	close(fd);
+	unlink("test_here1.txt");
+	unlink("test_here2.txt");
+	unlink("test_here3.txt");
+	reset_cmdl(cmdl);
+
+	saved = dup(STDERR_FILENO);
+	devnull = open("/dev/null", O_WRONLY);
+	dup2(devnull, STDERR_FILENO);
+	assert(parse_command_line(cmdl, "cat <<") == -1);
+	reset_cmdl(cmdl);
+	assert(parse_command_line(cmdl, "cat <<< |") == -1);
+	reset_cmdl(cmdl);
+	dup2(saved, STDERR_FILENO);
+	close(devnull);
+	close(saved);
+
+	printf("[PASS] Test 15 : Documents en ligne et chaînes en ligne\n");
 
 	// Nettoyage final
 	reset_cmdl(cmdl);
@@ -464,14 +364,91 @@ void test_parse_command_line()
 	printf("Tous les tests pour parse_command_line ont réussi !\n");
 }
 
+// Vérifie les types et textes des tokens produits par lex_command_line
+static void expect_tokens(command_line_t *cmdl, const char *line, const token_type_t *types, const char **texts, int n)
+{
+	reset_command_line(cmdl);
+	assert(lex_command_line(cmdl, line, strlen(line)) == n);
+	for (int i = 0; i < n; i++)
+	{
+		assert(cmdl->token_types[i] == types[i]);
+		if (texts[i])
+			assert(strcmp(cmdl->tokens[i], texts[i]) == 0);
+	}
+	assert(cmdl->tokens[n] == NULL && cmdl->token_types[n] == TOKEN_END);
+}
+
+void test_lex_command_line()
+{
+	printf("Démarrage des tests unitaires pour lex_command_line...\n");
+
+	command_line_t *cmdl = malloc(sizeof(command_line_t));
+	if (!cmdl)
+		exit(1);
+	init_command_line(cmdl);
+
+	expect_tokens(cmdl, "a|b", (token_type_t[]){TOKEN_WORD, TOKEN_PIPE, TOKEN_WORD}, (const char *[]){"a", "|", "b"}, 3);
+	expect_tokens(cmdl, "x>f;y>>g<h", (token_type_t[]){TOKEN_WORD, TOKEN_OUT, TOKEN_WORD, TOKEN_SEMICOLON, TOKEN_WORD, TOKEN_APPEND, TOKEN_WORD, TOKEN_IN, TOKEN_WORD},
+				  (const char *[]){"x", NULL, "f", NULL, "y", NULL, "g", NULL, "h"}, 9);
+	expect_tokens(cmdl, "a&&b||c&d", (token_type_t[]){TOKEN_WORD, TOKEN_AND, TOKEN_WORD, TOKEN_OR, TOKEN_WORD, TOKEN_BACKGROUND, TOKEN_WORD},
+				  (const char *[]){"a", NULL, "b", NULL, "c", NULL, "d"}, 7);
+	printf("[PASS] Test 1 : Opérateurs reconnus sans espaces\n");
+
+	expect_tokens(cmdl, "cmd 2>e 2>>f 2>&1 >&2 a2>g", (token_type_t[]){TOKEN_WORD, TOKEN_IO_NUMBER, TOKEN_OUT, TOKEN_WORD, TOKEN_IO_NUMBER, TOKEN_APPEND, TOKEN_WORD, TOKEN_IO_NUMBER, TOKEN_DUP_OUT, TOKEN_WORD, TOKEN_DUP_OUT, TOKEN_WORD, TOKEN_WORD, TOKEN_OUT, TOKEN_WORD},
+				  (const char *[]){"cmd", "2", NULL, "e", "2", NULL, "f", "2", NULL, "1", NULL, "2", "a2", NULL, "g"}, 15);
+	expect_tokens(cmdl, "c 10<&0 3<&- &>f &>>g|&d 12x>h", (token_type_t[]){TOKEN_WORD, TOKEN_IO_NUMBER, TOKEN_DUP_IN, TOKEN_WORD, TOKEN_IO_NUMBER, TOKEN_DUP_IN, TOKEN_WORD, TOKEN_OUT_ALL, TOKEN_WORD, TOKEN_APPEND_ALL, TOKEN_WORD, TOKEN_PIPE_ALL, TOKEN_WORD, TOKEN_WORD, TOKEN_OUT, TOKEN_WORD},
+				  (const char *[]){"c", "10", NULL, "0", "3", NULL, "-", NULL, "f", NULL, "g", NULL, "d", "12x", NULL, "h"}, 16);
+	printf("[PASS] Test 2 : Redirections de descripteurs quelconques\n");
+
+	expect_tokens(cmdl, "  echo  'a | b' \"c;d\" e\\&f \"\" '!' ! x!", (token_type_t[]){TOKEN_WORD, TOKEN_WORD, TOKEN_WORD, TOKEN_WORD, TOKEN_WORD, TOKEN_WORD, TOKEN_BANG, TOKEN_WORD},
+				  (const char *[]){"echo", "a | b", "c;d", "e&f", "", "!", "!", "x!"}, 8);
+	expect_tokens(cmdl, "a\"b c\"'d'\" \\\" \\n\"", (token_type_t[]){TOKEN_WORD}, (const char *[]){"ab cd \" \\n"}, 1);
+	printf("[PASS] Test 3 : Guillemets et échappements\n");
+
+	// les paramètres sont seulement marqués : leur valeur est lue au lancement
+	expect_tokens(cmdl, "x$LEX_VAR \"$LEX_VAR\" '$LEX_VAR' ${LEX_VAR}y $ a$ \\$X \"a\"$? a\001b",
+				  (token_type_t[]){TOKEN_WORD_EXPAND, TOKEN_WORD_EXPAND, TOKEN_WORD, TOKEN_WORD_EXPAND, TOKEN_WORD, TOKEN_WORD, TOKEN_WORD, TOKEN_WORD_EXPAND, TOKEN_WORD_EXPAND},
+				  (const char *[]){"x\001LEX_VAR\003", "\002LEX_VAR\003\004", "$LEX_VAR", "\001LEX_VAR\003y", "$", "a$", "$X", "a\001?\003\004", "a\005\001b"}, 9);
+
+	vars_set("LEX_VAR", "un deux", 1);
+	vars_unset("LEX_VIDE");
+	reset_command_line(cmdl);
+	assert(parse_command_line(cmdl, "echo x$LEX_VAR \"$LEX_VAR\" '$LEX_VAR' ${LEX_VAR}y $LEX_VIDE \"$LEX_VIDE\" $LEX_VIDE\"\" $ a$ a\001b") == 0);
+	processus_t *proc = &cmdl->commands[0];
+	assert(proc->expand == 1 && expand_processus(cmdl, proc) == 0 && proc->expand == 0);
+	const char *expected[] = {"echo", "xun", "deux", "un deux", "$LEX_VAR", "un", "deuxy", "", "", "$", "a$", "a\001b"};
+	assert(proc->argc == 12 && proc->argv[12] == NULL && proc->path == proc->argv[0]);
+	for (int i = 0; i < 12; i++)
+		assert(strcmp(proc->argv[i], expected[i]) == 0);
+	printf("[PASS] Test 4 : Substitution des variables au lancement\n");
+
+	int saved_stderr = dup(STDERR_FILENO);
+	int null_fd = open("/dev/null", O_WRONLY);
+	dup2(null_fd, STDERR_FILENO);
+	assert(lex_command_line(cmdl, "echo 'abc", 9) == -1);
+	dup2(saved_stderr, STDERR_FILENO);
+	close(null_fd);
+	close(saved_stderr);
+	printf("[PASS] Test 5 : Erreurs (guillemet non fermé)\n");
+
+	// plus de tokens que l'ancienne limite (MAX_CMD_LINE / 2) : les tableaux sont agrandis
+	char *many = malloc(10000);
+	memset(many, ';', 10000);
+	reset_command_line(cmdl);
+	assert(lex_command_line(cmdl, many, 10000) == 10000);
+	assert(cmdl->token_types[9999] == TOKEN_SEMICOLON && cmdl->token_types[10000] == TOKEN_END);
+	free(many);
+	expect_tokens(cmdl, "", (token_type_t[]){TOKEN_END}, (const char *[]){NULL}, 0);
+	printf("[PASS] Test 6 : Nombre de tokens non limité\n");
+
+	reset_command_line(cmdl);
+	free(cmdl);
+	printf("Tous les tests pour lex_command_line ont réussi !\n");
+}
+
 int main()
 {
-	print_test_result("test_trim", test_trim());
-	print_test_result("test_replace", test_replace());
-	print_test_result("test_clean", test_clean());
-	test_strcut();
-	test_separate_s();
-	test_substenv();
+	test_lex_command_line();
 	test_parse_command_line();
 
 	return 0;
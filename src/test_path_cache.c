@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "../include/path_cache.h"
+#include "../include/vars.h"
+
+// make test_path_cache
+// ./test_path_cache
+
+static int count_entries(const path_cache_entry_t *entry, void *data)
+{
+    (void)entry;
+    (*(int *)data)++;
+    return 0;
+}
+
+void test_path_cache_lookup()
+{
+    printf("Démarrage des tests unitaires pour path_cache_lookup...\n");
+
+    vars_set("PATH", "/usr/bin:/bin", 1);
+    path_cache_clear();
+
+    const char *sh = path_cache_lookup("sh");
+    assert(sh != NULL);
+    assert(sh[0] == '/');
+    assert(strcmp(sh + strlen(sh) - 3, "/sh") == 0);
+    printf("[PASS] Test 1 : Résolution via $PATH\n");
+
+    assert(path_cache_lookup("sh") == sh); // même entrée, aucune nouvelle résolution
+    const path_cache_entry_t *e = path_cache_find("sh");
+    assert(e != NULL && e->hits == 2);
+    printf("[PASS] Test 2 : Succès mémorisé et compteur d'utilisations\n");
+
+    assert(path_cache_lookup("commande_qui_n_existe_pas_12345") == NULL);
+    e = path_cache_find("commande_qui_n_existe_pas_12345");
+    assert(e != NULL && e->path == NULL);
+    printf("[PASS] Test 3 : Echec mémorisé\n");
+
+    assert(path_cache_find("jamais_cherchee") == NULL);
+    assert(path_cache_lookup(NULL) == NULL);
+    printf("[PASS] Test 4 : Absents et NULL\n");
+
+    printf("Tous les tests pour path_cache_lookup ont réussi !\n\n");
+}
+
+void test_path_cache_refresh()
+{
+    printf("Démarrage des tests unitaires pour path_cache_refresh...\n");
+
+    // Un exécutable créé dans un répertoire de $PATH après un échec mémorisé
+    char dir[] = "/tmp/test_path_cacheXXXXXX";
+    assert(mkdtemp(dir) != NULL);
+    vars_set("PATH", dir, 1);
+    path_cache_clear();
+
+    assert(path_cache_lookup("outil") == NULL);
+
+    char tool[256];
+    snprintf(tool, sizeof(tool), "%s/outil", dir);
+    int fd = open(tool, O_WRONLY | O_CREAT, 0755);
+    assert(fd >= 0);
+    close(fd);
+
+    assert(path_cache_lookup("outil") == NULL); // l'échec reste mémorisé
+    const char *p = path_cache_refresh("outil");
+    assert(p != NULL && strcmp(p, tool) == 0);
+    assert(path_cache_find("outil")->hits == 2);
+    printf("[PASS] Test 1 : Nouvelle résolution d'un échec mémorisé\n");
+
+    unlink(tool);
+    assert(path_cache_refresh("outil") == NULL);
+    printf("[PASS] Test 2 : Nouvelle résolution d'un chemin disparu\n");
+
+    rmdir(dir);
+    printf("Tous les tests pour path_cache_refresh ont réussi !\n\n");
+}
+
+void test_path_cache_clear()
+{
+    printf("Démarrage des tests unitaires pour path_cache_clear...\n");
+
+    vars_set("PATH", "/usr/bin:/bin", 1);
+    path_cache_clear();
+    assert(path_cache_size() == 0);
+
+    // Beaucoup d'entrées : la table doit s'agrandir sans perdre d'entrée
+    char name[32];
+    for (int i = 0; i < 500; i++)
+    {
+        snprintf(name, sizeof(name), "absente_%d", i);
+        path_cache_lookup(name);
+    }
+    path_cache_lookup("sh");
+    assert(path_cache_size() == 501);
+
+    int n = 0;
+    path_cache_foreach(count_entries, &n);
+    assert(n == 501);
+    assert(path_cache_find("absente_0") != NULL);
+    assert(path_cache_find("absente_499") != NULL);
+    printf("[PASS] Test 1 : Agrandissement de la table\n");
+
+    path_cache_clear();
+    assert(path_cache_size() == 0);
+    assert(path_cache_find("sh") == NULL);
+    n = 0;
+    path_cache_foreach(count_entries, &n);
+    assert(n == 0);
+    printf("[PASS] Test 2 : Vidage\n");
+
+    printf("Tous les tests pour path_cache_clear ont réussi !\n");
+}
+
+int main()
+{
+    test_path_cache_lookup();
+    test_path_cache_refresh();
+    test_path_cache_clear();
+
+    return 0;
+}
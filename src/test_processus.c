@@ -4,6 +4,10 @@
 #include <assert.h>
 #include "../include/processus.h"
 #include <errno.h>
+#include <limits.h>
+#include <sys/wait.h>
+#include "../include/jobs.h"
+#include "../include/vars.h"
 
 void test_init_processus()
 {
@@ -46,6 +50,7 @@ void test_init_processus()
     assert(proc->end_time.tv_sec == 0);
 
     assert(proc->cf == NULL);
+    assert(proc->argv == proc->argv_inline && proc->argc == 0);
 
     printf("[PASS] Initialisation correcte des champs\n");
 
@@ -132,6 +137,237 @@ void test_launch_processus()
     printf("Tous les tests pour launch_processus ont réussi !\n");
 }
 
+void test_spawn_backend()
+{
+    printf("\nDémarrage des tests unitaires pour les mécanismes de lancement...\n");
+
+    spawn_backend_t backend;
+    assert(parse_spawn_backend("fork", &backend) == 0 && backend == SPAWN_FORK);
+    assert(parse_spawn_backend("posix_spawn", &backend) == 0 && backend == SPAWN_POSIX_SPAWN);
+    assert(parse_spawn_backend("zygote", &backend) == 0 && backend == SPAWN_ZYGOTE);
+    assert(parse_spawn_backend("vfork_magique", &backend) == -1);
+    assert(set_spawn_backend((spawn_backend_t)42) == -1);
+    printf("[PASS] Test 1 : Sélection du mécanisme\n");
+
+    processus_t *proc = malloc(sizeof(processus_t));
+    if (!proc)
+        exit(1);
+
+    spawn_backend_t backends[] = {SPAWN_FORK, SPAWN_POSIX_SPAWN, SPAWN_ZYGOTE};
+    for (int i = 0; i < 3; i++)
+    {
+        assert(set_spawn_backend(backends[i]) == 0);
+        assert(get_spawn_backend() == backends[i]);
+
+        // Un vrai "exit 127" ne doit pas être confondu avec un échec de l'exec
+        init_processus(proc);
+        proc->argv[0] = "sh";
+        proc->argv[1] = "-c";
+        proc->argv[2] = "exit 127";
+        proc->argv[3] = NULL;
+        assert(launch_processus(proc) == 0);
+        assert(proc->status == 127);
+        assert(proc->exec_errno == 0);
+
+        // Echec de l'exec : remonté via exec_errno
+        init_processus(proc);
+        proc->argv[0] = "commande_qui_n_existe_pas_12345";
+        proc->stderr_fd = open("/dev/null", O_WRONLY);
+        assert(launch_processus(proc) == 0);
+        assert(proc->status == 127);
+        assert(proc->exec_errno == ENOENT);
+
+        // Fichier non exécutable : 126
+        init_processus(proc);
+        proc->argv[0] = "/etc/passwd";
+        proc->stderr_fd = open("/dev/null", O_WRONLY);
+        assert(launch_processus(proc) == 0);
+        assert(proc->status == 126);
+        assert(proc->exec_errno == EACCES);
+    }
+    printf("[PASS] Test 2 : Echecs d'exec distingués (fork, posix_spawn et zygote)\n");
+
+    // Zygote : redirections transmises par SCM_RIGHTS, statut et ressources remontés au shell
+    assert(set_spawn_backend(SPAWN_ZYGOTE) == 0);
+    char path[] = "/tmp/test_zygoteXXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    for (int i = 0; i < 50; i++)
+    {
+        init_processus(proc);
+        proc->argv[0] = "sh";
+        proc->argv[1] = "-c";
+        proc->argv[2] = "pwd; exit 3";
+        proc->argv[3] = NULL;
+        proc->stdout_fd = dup(fd);
+        assert(launch_processus(proc) == 0);
+        assert(proc->status == 3);
+        assert(proc->exec_errno == 0);
+    }
+    char cwd[4096], line[4096];
+    assert(getcwd(cwd, sizeof cwd) != NULL);
+    ssize_t n = pread(fd, line, sizeof line - 1, 0);
+    assert(n > 0);
+    line[n] = '\0';
+    assert(strncmp(line, cwd, strlen(cwd)) == 0 && line[strlen(cwd)] == '\n');
+    close(fd);
+    unlink(path);
+
+    // Arrêt du zygote : retour au lancement classique
+    assert(set_spawn_backend(SPAWN_POSIX_SPAWN) == 0);
+    init_processus(proc);
+    proc->argv[0] = "true";
+    proc->argv[1] = NULL;
+    assert(launch_processus(proc) == 0 && proc->status == 0);
+    printf("[PASS] Test 3 : Zygote (redirections, répertoire courant, 50 lancements, arrêt)\n");
+
+    set_spawn_backend(SPAWN_POSIX_SPAWN);
+    free(proc);
+    printf("Tous les tests pour les mécanismes de lancement ont réussi !\n");
+}
+
+void test_rusage()
+{
+    printf("\nDémarrage des tests unitaires pour les mesures de temps et de ressources...\n");
+
+    processus_t *proc = malloc(sizeof(processus_t));
+    if (!proc)
+        exit(1);
+
+    // Horloge monotone : start_time et end_time encadrent l'exécution
+    struct timespec before, after;
+    clock_gettime(CLOCK_MONOTONIC, &before);
+    init_processus(proc);
+    proc->argv[0] = "sleep";
+    proc->argv[1] = "0.1";
+    assert(launch_processus(proc) == 0);
+    clock_gettime(CLOCK_MONOTONIC, &after);
+    double start = proc->start_time.tv_sec + proc->start_time.tv_nsec / 1e9;
+    double end = proc->end_time.tv_sec + proc->end_time.tv_nsec / 1e9;
+    assert(start >= before.tv_sec + before.tv_nsec / 1e9);
+    assert(end <= after.tv_sec + after.tv_nsec / 1e9);
+    assert(end - start >= 0.1);
+    printf("[PASS] Test 1 : Temps mesurés sur CLOCK_MONOTONIC (%.3f s)\n", end - start);
+
+    // Ressources consommées collectées par wait4 : un processus actif consomme du CPU et de la mémoire
+    init_processus(proc);
+    proc->argv[0] = "sh";
+    proc->argv[1] = "-c";
+    proc->argv[2] = "i=0; while [ $i -lt 30000 ]; do i=$((i+1)); done";
+    assert(launch_processus(proc) == 0);
+    assert(proc->status == 0);
+    double cpu = proc->rusage.ru_utime.tv_sec + proc->rusage.ru_utime.tv_usec / 1e6 +
+                 proc->rusage.ru_stime.tv_sec + proc->rusage.ru_stime.tv_usec / 1e6;
+    assert(cpu > 0);
+    assert(proc->rusage.ru_maxrss > 0);
+    assert(proc->rusage.ru_minflt > 0);
+    printf("[PASS] Test 2 : rusage collecté (%.3f s CPU, %ld Ko)\n", cpu, proc->rusage.ru_maxrss);
+
+    // Commande intégrée : pas de fils, ressources nulles
+    init_processus(proc);
+    proc->argv[0] = "pwd";
+    proc->stdout_fd = open("/dev/null", O_WRONLY);
+    assert(launch_processus(proc) == 0);
+    assert(proc->rusage.ru_maxrss == 0);
+    printf("[PASS] Test 3 : Ressources nulles pour une commande intégrée\n");
+
+    free(proc);
+    printf("Tous les tests pour les mesures de temps et de ressources ont réussi !\n");
+}
+
+void test_environment()
+{
+    printf("\nDémarrage des tests unitaires pour l'environnement des commandes...\n");
+
+    processus_t *proc = malloc(sizeof(processus_t));
+    if (!proc)
+        exit(1);
+
+    // "NOM=valeur" seul : variable locale du shell, sans processus fils
+    init_processus(proc);
+    proc->argv[0] = "TEST_AFFECT=42";
+    proc->argv[1] = "TEST_AFFECT2=";
+    assert(launch_processus(proc) == 0);
+    assert(proc->status == 0 && proc->pid == 0);
+    assert(strcmp(vars_get("TEST_AFFECT"), "42") == 0 && strcmp(vars_get("TEST_AFFECT2"), "") == 0);
+    printf("[PASS] Test 1 : Affectation de variables locales\n");
+
+    // le fils reçoit les variables exportées, pas les variables locales
+    assert(vars_set("TEST_EXPORTEE", "oui", 1) == 0);
+    init_processus(proc);
+    proc->argv[0] = "sh";
+    proc->argv[1] = "-c";
+    proc->argv[2] = "test \"$TEST_EXPORTEE\" = oui && test -z \"$TEST_AFFECT\"";
+    assert(launch_processus(proc) == 0);
+    assert(proc->status == 0);
+    assert(proc->envp == vars_envp());
+    printf("[PASS] Test 2 : Variables exportées transmises au fils\n");
+
+    assert(vars_export("TEST_AFFECT") == 0);
+    init_processus(proc);
+    proc->argv[0] = "sh";
+    proc->argv[1] = "-c";
+    proc->argv[2] = "test \"$TEST_AFFECT\" = 42";
+    assert(launch_processus(proc) == 0);
+    assert(proc->status == 0);
+    printf("[PASS] Test 3 : Variable locale exportée\n");
+
+    vars_unset("TEST_AFFECT");
+    vars_unset("TEST_AFFECT2");
+    vars_unset("TEST_EXPORTEE");
+    free(proc);
+    printf("Tous les tests pour l'environnement des commandes ont réussi !\n");
+}
+
+void test_max_jobs()
+{
+    printf("\nDémarrage des tests unitaires pour la limite de jobs d'arrière-plan...\n");
+
+    assert(get_max_jobs() >= 1); // nombre de processeurs par défaut
+    assert(set_max_jobs(-1) == -1);
+    assert(set_max_jobs(2) == 0 && get_max_jobs() == 2);
+    printf("[PASS] Test 1 : Sélection de la limite\n");
+
+    // 5 "sleep 0.2 &" avec une limite de 2 : jamais plus de 2 jobs simultanés, et le lancement attend
+    processus_t *proc = malloc(sizeof(processus_t));
+    if (!proc)
+        exit(1);
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < 5; i++)
+    {
+        init_processus(proc);
+        proc->argv[0] = "sleep";
+        proc->argv[1] = "0.2";
+        proc->is_background = 1;
+        assert(launch_processus(proc) == 0);
+        assert(jobs_active_count() <= 2);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double elapsed = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    assert(elapsed >= 0.35); // les 3e et 5e lancements ont attendu la fin d'une vague
+    printf("[PASS] Test 2 : Au plus 2 jobs simultanés (%.2f s)\n", elapsed);
+
+    // 0 : illimité
+    assert(set_max_jobs(0) == 0);
+    for (int i = 0; i < 4; i++)
+    {
+        init_processus(proc);
+        proc->argv[0] = "sleep";
+        proc->argv[1] = "0.2";
+        proc->is_background = 1;
+        assert(launch_processus(proc) == 0);
+    }
+    assert(jobs_active_count() >= 4);
+    printf("[PASS] Test 3 : Pas de limite\n");
+
+    while (jobs_active_count() > 0)
+        jobs_wait_slot(1);
+    jobs_notify(-1);
+    free(proc);
+    printf("Tous les tests pour la limite de jobs d'arrière-plan ont réussi !\n");
+}
+
 void test_init_control_flow()
 {
     printf("\nDémarrage du test unitaire pour init_control_flow...\n");
@@ -160,6 +396,7 @@ void test_init_control_flow()
     assert(cf->unconditionnal_next == NULL);
     assert(cf->on_success_next == NULL);
     assert(cf->on_failure_next == NULL);
+    assert(cf->pipe_next == NULL);
     assert(cf->cmdl == NULL);
 
     printf("[PASS] Nettoyage de la structure (bzero fonctionne)\n");
@@ -225,22 +462,54 @@ void test_add_processus()
 
     printf("[PASS] Test 4 : Chaînage ON_FAILURE\n");
 
-    // --- TEST 5 : Saturation du tableau (Overflow) ---
-    // On remplit jusqu'à MAX_CMDS
-    // On est déjà à 4 commandes. On boucle jusqu'à MAX_CMDS.
-    for (int i = 4; i < MAX_CMDS; i++)
+    // --- TEST 4b : Chaînage Pipeline (|) ---
+    processus_t *p5 = add_processus(cmdl, PIPELINE);
+
+    assert(p5 != NULL);
+    // Le précédent (p4, index 3) doit pointer vers p5 (index 4) via pipe_next uniquement
+    assert(cmdl->flow[3].pipe_next == &cmdl->flow[4]);
+    assert(cmdl->flow[3].unconditionnal_next == NULL);
+
+    printf("[PASS] Test 4b : Chaînage PIPELINE\n");
+
+    // --- TEST 5 : Agrandissement du tableau ---
+    // Les tableaux sont déplacés dans l'arène : les liens entre processus et contrôle de flux doivent suivre
+    char arg0[] = "cmd";
+    add_argument(cmdl, &cmdl->commands[0], arg0);
+    for (int i = 5; i < 1000; i++)
     {
-        assert(add_processus(cmdl, UNCONDITIONAL) != NULL);
+        assert(add_processus(cmdl, i % 2 ? PIPELINE : ON_SUCCESS) != NULL);
     }
 
-    assert(cmdl->num_commands == MAX_CMDS);
+    assert(cmdl->num_commands == 1000);
+    assert(cmdl->commands_capacity >= 1000);
+    for (unsigned int i = 0; i < cmdl->num_commands; i++)
+    {
+        assert(cmdl->flow[i].proc == &cmdl->commands[i]);
+        assert(cmdl->commands[i].cf == &cmdl->flow[i]);
+        assert(cmdl->commands[i].argv == cmdl->commands[i].argv_inline);
+    }
+    assert(cmdl->flow[0].unconditionnal_next == &cmdl->flow[1]);
+    assert(cmdl->flow[3].pipe_next == &cmdl->flow[4]);
+    assert(cmdl->flow[998].pipe_next == &cmdl->flow[999]);
+    assert(strcmp(cmdl->commands[0].argv[0], "cmd") == 0);
 
-    // Tentative d'ajout supplémentaire
-    assert(add_processus(cmdl, UNCONDITIONAL) == NULL);
-    assert(cmdl->num_commands == MAX_CMDS); // Ne doit pas avoir bougé
+    printf("[PASS] Test 5 : Agrandissement du tableau (1000 commandes)\n");
 
-    printf("[PASS] Test 5 : Gestion tableau plein (MAX_CMDS)\n");
+    // --- TEST 6 : Arguments au-delà du stockage initial ---
+    processus_t *p = &cmdl->commands[999];
+    char words[300][8];
+    for (int i = 0; i < 300; i++)
+    {
+        snprintf(words[i], sizeof words[i], "a%d", i);
+        assert(add_argument(cmdl, p, words[i]) == 0);
+    }
+    assert(p->argc == 300 && p->argv != p->argv_inline);
+    assert(strcmp(p->argv[0], "a0") == 0 && strcmp(p->argv[299], "a299") == 0 && p->argv[300] == NULL);
 
+    printf("[PASS] Test 6 : add_argument (300 arguments)\n");
+
+    arena_reset(&cmdl->arena);
     free(cmdl);
     printf("Tous les tests pour add_processus ont réussi !\n");
 }
@@ -271,13 +540,15 @@ void test_next_processus()
     assert(next == &cmdl->commands[1]); // Doit être l'index 1
     printf("[PASS] Test 2 : Après 1 ajout (Index 1)\n");
 
-    // --- TEST 3 : Tableau plein (MAX_CMDS) ---
-    // On remplit artificiellement le compteur jusqu'au max
-    cmdl->num_commands = MAX_CMDS;
+    // --- TEST 3 : Tableau plein ---
+    // On remplit artificiellement le compteur jusqu'à la capacité : le tableau est agrandi
+    cmdl->num_commands = cmdl->commands_capacity;
 
     next = next_processus(cmdl);
-    assert(next == NULL); // Doit renvoyer NULL car plus de place
-    printf("[PASS] Test 3 : Tableau plein (NULL)\n");
+    assert(next != NULL);
+    assert(next == &cmdl->commands[cmdl->num_commands]);
+    assert(cmdl->commands_capacity > cmdl->num_commands);
+    printf("[PASS] Test 3 : Tableau plein (agrandi)\n");
 
     // --- TEST 4 : Robustesse (NULL) ---
     assert(next_processus(NULL) == NULL);
@@ -295,18 +566,16 @@ void test_add_fd()
     if (!cmdl)
         exit(1);
 
-    // IMPORTANT : init_command_line met tous les descriptors à -1.
-    // Sans ça, le test échouerait car add_fd croirait le tableau plein.
+    // IMPORTANT : init_command_line vide le tableau des descripteurs.
     init_command_line(cmdl);
 
     // --- TEST 1 : Ajout nominal ---
     int fd1 = 42;
     assert(add_fd(cmdl, fd1) == 0);
 
-    // Vérifie qu'il est bien à la première position
-    assert(cmdl->opened_descriptors[0] == 42);
-    // Vérifie que la suivante est toujours libre
-    assert(cmdl->opened_descriptors[1] == -1);
+    // Vérifie qu'il est bien dans l'ensemble
+    assert(has_fd(cmdl, 42) && !has_fd(cmdl, 41) && !has_fd(cmdl, 43));
+    assert(cmdl->num_opened == 1);
 
     printf("[PASS] Test 1 : Ajout simple\n");
 
@@ -314,8 +583,9 @@ void test_add_fd()
     int fd2 = 84;
     assert(add_fd(cmdl, fd2) == 0);
 
-    // Doit s'être mis à la suite
-    assert(cmdl->opened_descriptors[1] == 84);
+    // Un descripteur déjà présent n'est compté qu'une fois
+    assert(has_fd(cmdl, 84));
+    assert(add_fd(cmdl, 84) == 0);
     printf("[PASS] Test 2 : Ajout multiple\n");
 
     // --- TEST 3 : Valeurs invalides ---
@@ -323,25 +593,31 @@ void test_add_fd()
     assert(add_fd(NULL, 10) == -1); // Structure NULL
 
     // Vérifie que rien n'a bougé
-    assert(cmdl->opened_descriptors[2] == -1);
+    assert(cmdl->num_opened == 2);
     printf("[PASS] Test 3 : Rejet invalides\n");
 
-    // --- TEST 4 : Saturation (Tableau plein) ---
-    // On remplit tout le reste du tableau
-    int max_descriptors = MAX_CMDS * 3 + 1;
-
+    // --- TEST 4 : Agrandissement (plus de descripteurs que la capacité initiale) ---
     // On commence à l'index 2 car 0 et 1 sont déjà pris
-    for (int i = 2; i < max_descriptors; i++)
+    for (int i = 2; i < 1000; i++)
     {
         assert(add_fd(cmdl, i + 100) == 0);
     }
-
-    // Maintenant le tableau est plein à craquer.
-    // Tenter d'ajouter un fd supplémentaire doit échouer.
-    assert(add_fd(cmdl, 9999) == -1);
-
-    printf("[PASS] Test 4 : Saturation (Full)\n");
-
+    assert(cmdl->num_opened == 1000);
+    assert(has_fd(cmdl, 42) && has_fd(cmdl, 84));
+    assert(has_fd(cmdl, 1099) && !has_fd(cmdl, 1100) && !has_fd(cmdl, 100000));
+
+    printf("[PASS] Test 4 : Agrandissement\n");
+
+    // --- TEST 5 : Retrait ---
+    // remove_fd ne ferme que les descripteurs de l'ensemble (ici fictifs : close échoue sans conséquence)
+    assert(remove_fd(cmdl, 84) == 0);
+    assert(!has_fd(cmdl, 84) && cmdl->num_opened == 999);
+    assert(remove_fd(cmdl, 84) == -1);
+    assert(remove_fd(cmdl, 100000) == -1 && remove_fd(NULL, 42) == -1);
+    assert(cmdl->num_opened == 999);
+    printf("[PASS] Test 5 : Retrait\n");
+
+    arena_reset(&cmdl->arena);
     free(cmdl);
     printf("Tous les tests pour add_fd ont réussi !\n");
 }
@@ -366,14 +642,14 @@ void test_close_fds()
         exit(1);
     }
 
-    // On l'ajoute manuellement au tableau
-    cmdl->opened_descriptors[0] = fd;
+    // On l'ajoute au tableau
+    assert(add_fd(cmdl, fd) == 0);
 
     // Appel de la fonction
     assert(close_fds(cmdl) == 0);
 
-    // Vérification 1 : Le tableau est remis à jour
-    assert(cmdl->opened_descriptors[0] == -1);
+    // Vérification 1 : Le tableau est vidé
+    assert(cmdl->num_opened == 0);
 
     // Vérification 2 : Le fichier est BIEN fermé
     // Si on essaie de le refermer, close doit renvoyer -1 et errno = EBADF (Bad File Descriptor)
@@ -385,14 +661,14 @@ void test_close_fds()
 
     // --- TEST 2 : Gestion d'erreur (FD invalide) ---
     // On met un FD bidon qui n'est pas ouvert (ex: 9999)
-    cmdl->opened_descriptors[1] = 9999;
+    assert(add_fd(cmdl, 9999) == 0);
 
     // close_fds doit essayer de le fermer, échouer, mais continuer.
     // Elle doit retourner -1 à la fin.
     assert(close_fds(cmdl) == -1);
 
-    // Mais l'entrée doit quand même être remise à -1 pour éviter une boucle infinie
-    assert(cmdl->opened_descriptors[1] == -1);
+    // Mais le tableau doit quand même être vidé pour ne pas refermer ce descripteur
+    assert(cmdl->num_opened == 0);
 
     printf("[PASS] Test 2 : Erreur détectée sur FD invalide\n");
 
@@ -409,7 +685,7 @@ void test_init_command_line()
     printf("\nDémarrage des tests unitaires pour init_command_line...\n");
 
     // --- TEST 1 : Robustesse (NULL) ---
-    assert(init_command_line(NULL) == -1);
+    assert(init_command_line(NULL) == -1 && reset_command_line(NULL) == -1);
     printf("[PASS] Test 1 : Gestion NULL\n");
 
     // --- TEST 2 : Nettoyage complet (Mémoire sale) ---
@@ -422,7 +698,7 @@ void test_init_command_line()
 
     // Vérifions que c'est bien sale
     assert(cmdl->num_commands != 0);
-    assert(cmdl->opened_descriptors[0] != -1);
+    assert(cmdl->num_opened != 0);
     assert(cmdl->command_line[0] != '\0');
 
     // 2. Appel de la fonction
@@ -436,41 +712,36 @@ void test_init_command_line()
     // Chaîne vide
     assert(cmdl->command_line[0] == '\0');
 
-    // Tokens NULL
-    assert(cmdl->tokens[0] == NULL);
-    assert(cmdl->tokens[MAX_CMD_LINE / 2] == NULL);
+    // Tableaux vides (alloués dans l'arène au premier ajout)
+    assert(cmdl->tokens == NULL && cmdl->num_tokens == 0);
+    assert(cmdl->commands == NULL && cmdl->flow == NULL);
+    assert(cmdl->opened_descriptors == NULL && cmdl->num_opened == 0);
 
-    // Descripteurs réinitialisés à -1
-    int max_descriptors = MAX_CMDS * 3 + 1;
-    for (int i = 0; i < max_descriptors; i++)
-    {
-        if (cmdl->opened_descriptors[i] != -1)
-        {
-            printf("Echec descripteur index %d : valeur %d\n", i, cmdl->opened_descriptors[i]);
-            exit(1);
-        }
-    }
-
-    // Sous-structures réinitialisées (via init_processus appelé en boucle)
-    // On vérifie le premier et le dernier élément pour être sûr
-    assert(cmdl->commands[0].pid == 0);
-    assert(cmdl->commands[0].stdin_fd == 0);
-
-    assert(cmdl->commands[MAX_CMDS - 1].pid == 0);
-    assert(cmdl->commands[MAX_CMDS - 1].stdout_fd == 1);
-
-    // Sous-structures Control Flow
-    assert(cmdl->flow[0].proc == NULL);
+    // Le premier processus ajouté est initialisé par add_processus
+    processus_t *p = add_processus(cmdl, UNCONDITIONAL);
+    assert(p == &cmdl->commands[0]);
+    assert(p->pid == 0 && p->stdin_fd == 0 && p->stdout_fd == 1);
+    assert(cmdl->flow[0].proc == p);
 
     printf("[PASS] Test 2 : Initialisation et nettoyage complet\n");
 
+    // --- TEST 3 : Remise à zéro indépendante de la ligne précédente ---
+    // Une ligne qui a débordé sur le tas : la remise à zéro libère ses blocs et retrouve le bloc initial
+    for (int i = 0; i < 10000; i++)
+        assert(add_processus(cmdl, UNCONDITIONAL) != NULL);
+    assert(cmdl->arena.chunks != NULL);
+    assert(reset_command_line(cmdl) == 0);
+    assert(cmdl->arena.chunks == NULL && cmdl->arena.ptr == cmdl->command_line);
+    assert(cmdl->num_commands == 0 && cmdl->commands_capacity == 0);
+    printf("[PASS] Test 3 : Remise à zéro après une grande ligne\n");
+
     free(cmdl);
     printf("Tous les tests pour init_command_line ont réussi !\n");
 }
 void reset_cmdl(command_line_t *cmdl)
 {
     close_fds(cmdl);
-    init_command_line(cmdl);
+    reset_command_line(cmdl);
 }
 
 // Helper pour vérifier si un processus a été lancé
@@ -487,6 +758,7 @@ void test_launch_command_line()
     command_line_t *cmdl = malloc(sizeof(command_line_t));
     if (!cmdl)
         exit(1);
+    init_command_line(cmdl);
 
     processus_t *p1, *p2, *p3;
 
@@ -627,6 +899,173 @@ void test_launch_command_line()
     assert(has_run(p3)); // Continue car p2 Success
     printf("[PASS] Test 7 : Chaîne complexe (Fail || Success && Success)\n");
 
+    // --- TEST 8 : Pipeline plus gros que le tampon du tube ---
+    // cmd: head -c 1000000 /dev/zero | wc -c > out && true
+    // Si le producteur était attendu avant le démarrage du consommateur, le test bloquerait.
+    // Le tube entre les étapes est créé par launch_command_line().
+    reset_cmdl(cmdl);
+    int out[2];
+    assert(pipe(out) == 0);
+
+    p1 = add_processus(cmdl, UNCONDITIONAL);
+    p1->argv[0] = "head";
+    p1->argv[1] = "-c";
+    p1->argv[2] = "1000000";
+    p1->argv[3] = "/dev/zero";
+    p1->argv[4] = NULL;
+
+    p2 = add_processus(cmdl, PIPELINE);
+    p2->argv[0] = "wc";
+    p2->argv[1] = "-c";
+    p2->argv[2] = NULL;
+    p2->stdout_fd = out[1];
+
+    p3 = add_processus(cmdl, ON_SUCCESS);
+    p3->argv[0] = "true";
+    p3->argv[1] = NULL;
+
+    assert(launch_command_line(cmdl) == 0);
+    assert(has_run(p1));
+    assert(has_run(p2));
+    assert(p2->status == 0);
+    assert(has_run(p3)); // le && est porté par la dernière étape
+
+    char count[32];
+    memset(count, 0, sizeof(count));
+    read(out[0], count, sizeof(count) - 1);
+    close(out[0]);
+    assert(atoi(count) == 1000000);
+    printf("[PASS] Test 8 : Pipeline concurrent (1 Mo à travers le tube)\n");
+
+    // --- TEST 9 : Le statut d'un pipeline est celui de sa dernière étape ---
+    // cmd: false | true && true
+    reset_cmdl(cmdl);
+
+    p1 = add_processus(cmdl, UNCONDITIONAL);
+    p1->argv[0] = "false";
+    p1->argv[1] = NULL;
+
+    p2 = add_processus(cmdl, PIPELINE);
+    p2->argv[0] = "true";
+    p2->argv[1] = NULL;
+
+    p3 = add_processus(cmdl, ON_SUCCESS);
+    p3->argv[0] = "true";
+    p3->argv[1] = NULL;
+
+    launch_command_line(cmdl);
+    assert(p1->status != 0);
+    assert(p2->status == 0);
+    assert(has_run(p3));
+    printf("[PASS] Test 9 : Statut du pipeline = dernière étape\n");
+
+    // --- TEST 10 : Commande intégrée dans un pipeline, plus grosse que le tampon du tube ---
+    // cmd: printf "%200000s" x | wc -c ; cd / | true
+    reset_cmdl(cmdl);
+    assert(pipe(out) == 0);
+    add_fd(cmdl, out[1]);
+
+    p1 = add_processus(cmdl, UNCONDITIONAL);
+    p1->argv[0] = "printf";
+    p1->argv[1] = "%200000s";
+    p1->argv[2] = "x";
+    p1->argv[3] = NULL;
+
+    p2 = add_processus(cmdl, PIPELINE);
+    p2->argv[0] = "wc";
+    p2->argv[1] = "-c";
+    p2->argv[2] = NULL;
+    p2->stdout_fd = out[1];
+
+    p3 = add_processus(cmdl, UNCONDITIONAL);
+    p3->argv[0] = "cd";
+    p3->argv[1] = "/";
+    p3->argv[2] = NULL;
+    processus_t *p4 = add_processus(cmdl, PIPELINE);
+    p4->argv[0] = "true";
+    p4->argv[1] = NULL;
+
+    char before[PATH_MAX], after[PATH_MAX];
+    assert(getcwd(before, sizeof before) != NULL);
+    assert(launch_command_line(cmdl) == 0); // ne bloque plus le shell
+    assert(p1->pid > 0 && p1->status == 0);  // exécutée dans un fils
+    assert(p3->pid > 0 && p3->status == 0);
+    assert(getcwd(after, sizeof after) != NULL);
+    assert(strcmp(before, after) == 0); // cd confiné au fils, comme dans un sous-shell
+
+    memset(count, 0, sizeof(count));
+    read(out[0], count, sizeof(count) - 1);
+    close(out[0]);
+    assert(atoi(count) == 200000);
+    printf("[PASS] Test 10 : Commandes intégrées d'un pipeline exécutées dans un fils\n");
+
+    // --- TEST 11 : Aucun descripteur du shell transmis à la commande ---
+    // cmd: ls /proc/self/fd | cat > out (le fichier ouvert par la ligne est O_CLOEXEC, comme les tubes)
+    reset_cmdl(cmdl);
+    assert(pipe(out) == 0);
+    fcntl(out[0], F_SETFD, FD_CLOEXEC);
+    fcntl(out[1], F_SETFD, FD_CLOEXEC);
+    int null_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    assert(null_fd > 2 && add_fd(cmdl, null_fd) == 0);
+    add_fd(cmdl, out[1]);
+
+    p1 = add_processus(cmdl, UNCONDITIONAL);
+    p1->argv[0] = "ls";
+    p1->argv[1] = "/proc/self/fd";
+    p1->argv[2] = NULL;
+    p2 = add_processus(cmdl, PIPELINE);
+    p2->argv[0] = "cat";
+    p2->argv[1] = NULL;
+    p2->stdout_fd = out[1];
+
+    assert(launch_command_line(cmdl) == 0);
+    char listing[256];
+    memset(listing, 0, sizeof(listing));
+    read(out[0], listing, sizeof(listing) - 1);
+    close(out[0]);
+    // 0, 1, 2 et le répertoire lu par ls
+    int lines = 0;
+    for (char *c = listing; *c; ++c)
+        lines += (*c == '\n');
+    assert(lines == 4);
+    assert(cmdl->num_opened == 0);
+    printf("[PASS] Test 11 : Descripteurs du shell fermés par l'exec\n");
+
+    // --- TEST 12 : Dernière commande exécutée à la place du shell ---
+    // cmd: true ; sh -c 'exit 5' (dans un fils : le processus est remplacé, 99 s'il ne l'est pas)
+    const uint8_t last_lines[] = {1, 0, 1};
+    const uint8_t inverts[] = {0, 0, 1};
+    const int expected[] = {5, 99, 99};
+    for (int i = 0; i < 3; i++)
+    {
+        // tampons vidés avant fork : le fils ne doit pas réécrire la sortie déjà produite par les tests
+        fflush(stdout);
+        fflush(stderr);
+        pid_t pid = fork();
+        assert(pid >= 0);
+        if (pid == 0)
+        {
+            reset_cmdl(cmdl);
+            p1 = add_processus(cmdl, UNCONDITIONAL);
+            p1->argv[0] = "true";
+            p1->argv[1] = NULL;
+            p2 = add_processus(cmdl, UNCONDITIONAL);
+            p2->argv[0] = "sh";
+            p2->argv[1] = "-c";
+            p2->argv[2] = "exit 5";
+            p2->argv[3] = NULL;
+            p2->invert = inverts[i];
+            cmdl->last_line = last_lines[i];
+            launch_command_line(cmdl);
+            _exit(99);
+        }
+        int wstatus = 0;
+        assert(waitpid(pid, &wstatus, 0) == pid);
+        assert(WIFEXITED(wstatus) && WEXITSTATUS(wstatus) == expected[i]);
+    }
+    printf("[PASS] Test 12 : Dernière commande exécutée à la place du shell (sans fork)\n");
+
+    reset_cmdl(cmdl);
     free(cmdl);
     printf("Tous les tests pour launch_command_line ont réussi !\n");
 }
@@ -635,6 +1074,10 @@ int main()
 {
     test_init_processus();
     test_launch_processus();
+    test_spawn_backend();
+    test_rusage();
+    test_environment();
+    test_max_jobs();
     test_init_control_flow();
     test_add_processus();
     test_next_processus();
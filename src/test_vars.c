@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../include/vars.h"
+
+// make test_vars
+// ./test_vars
+
+// Recherche de "NOM=valeur" dans un tableau envp
+static int envp_contains(char **envp, const char *entry)
+{
+    for (; *envp; ++envp)
+        if (strcmp(*envp, entry) == 0)
+            return 1;
+    return 0;
+}
+
+void test_vars_get_set()
+{
+    printf("Démarrage des tests unitaires pour vars_get et vars_set...\n");
+
+    // l'environnement du processus est importé au premier accès, variables exportées
+    setenv("TEST_VARS_IMPORT", "importée", 1);
+    assert(strcmp(vars_get("TEST_VARS_IMPORT"), "importée") == 0);
+    assert(envp_contains(vars_envp(), "TEST_VARS_IMPORT=importée"));
+    printf("[PASS] Test 1 : Import de environ\n");
+
+    // une nouvelle variable est locale : elle n'apparaît pas dans envp
+    unsigned long gen = vars_generation();
+    assert(vars_set("LOCALE", "un", 0) == 0);
+    assert(strcmp(vars_get("LOCALE"), "un") == 0);
+    assert(vars_generation() == gen);
+    assert(!envp_contains(vars_envp(), "LOCALE=un"));
+    assert(vars_set("LOCALE", "deux", 0) == 0);
+    assert(strcmp(vars_getn("LOCALE_SUITE", 6), "deux") == 0);
+    assert(vars_get("LOCALE_SUITE") == NULL);
+    printf("[PASS] Test 2 : Variables locales\n");
+
+    assert(vars_set("", "x", 0) == -1);
+    assert(vars_set("1A", "x", 0) == -1);
+    assert(vars_set("A-B", "x", 0) == -1);
+    assert(vars_unset("A=B") == -1);
+    assert(vars_export("INCONNUE") == -1);
+    assert(vars_valid_name("_a1", 3) && !vars_valid_name("a b", 3));
+    printf("[PASS] Test 3 : Noms invalides\n");
+
+    printf("Tous les tests pour vars_get et vars_set ont réussi !\n\n");
+}
+
+void test_vars_envp()
+{
+    printf("Démarrage des tests unitaires pour vars_envp...\n");
+
+    // tableau réutilisé tant qu'aucune variable exportée ne change
+    char **envp = vars_envp();
+    unsigned long gen = vars_generation();
+    assert(vars_envp() == envp && vars_generation() == gen);
+    assert(vars_set("LOCALE", "trois", 0) == 0);
+    assert(vars_generation() == gen);
+    printf("[PASS] Test 4 : Instantané réutilisé\n");
+
+    // export d'une variable locale, puis modification d'une variable exportée
+    assert(vars_export("LOCALE") == 0);
+    assert(vars_generation() > gen);
+    assert(envp_contains(vars_envp(), "LOCALE=trois"));
+    gen = vars_generation();
+    assert(vars_set("LOCALE", "quatre", 0) == 0);
+    assert(vars_generation() > gen);
+    envp = vars_envp();
+    assert(envp_contains(envp, "LOCALE=quatre") && !envp_contains(envp, "LOCALE=trois"));
+    printf("[PASS] Test 5 : Reconstruction après modification\n");
+
+    assert(vars_unset("LOCALE") == 0);
+    assert(vars_get("LOCALE") == NULL);
+    assert(!envp_contains(vars_envp(), "LOCALE=quatre"));
+    assert(vars_unset("LOCALE") == 0);
+    printf("[PASS] Test 6 : Suppression\n");
+
+    printf("Tous les tests pour vars_envp ont réussi !\n\n");
+}
+
+void test_vars_table()
+{
+    printf("Démarrage des tests unitaires pour la table des variables...\n");
+
+    // agrandissements successifs puis suppressions au milieu des séquences de sondage
+    char name[32], value[32];
+    for (int i = 0; i < 5000; i++)
+    {
+        snprintf(name, sizeof name, "V%d", i);
+        snprintf(value, sizeof value, "%d", i * 7);
+        assert(vars_set(name, value, i % 3 == 0) == 0);
+    }
+    for (int i = 0; i < 5000; i += 2)
+    {
+        snprintf(name, sizeof name, "V%d", i);
+        assert(vars_unset(name) == 0);
+    }
+    int exported = 0;
+    for (char **e = vars_envp(); *e; ++e)
+        exported += (*e)[0] == 'V';
+    for (int i = 0; i < 5000; i++)
+    {
+        snprintf(name, sizeof name, "V%d", i);
+        const char *v = vars_get(name);
+        if (i % 2 == 0)
+            assert(v == NULL);
+        else
+            assert(v && atoi(v) == i * 7);
+    }
+    // exportées restantes : i impair et multiple de 3
+    assert(exported == 833);
+    printf("[PASS] Test 7 : 5000 variables, suppression de la moitié\n");
+
+    printf("Tous les tests pour la table des variables ont réussi !\n\n");
+}
+
+int main()
+{
+    test_vars_get_set();
+    test_vars_envp();
+    test_vars_table();
+    return 0;
+}
@@ -0,0 +1,310 @@
+/** @file vars.c
+ * @brief Implementation of the shell variable store
+ * @author Sofiane FETTAH
+ * @author Matthieu COMME
+ * @date 2025-26
+ * @details Implémentation de la table des variables du shell.
+ *    La table est à adressage ouvert (sondage linéaire, suppression par décalage arrière) et sa capacité est une puissance de 2.
+ *    Chaque variable est stockée sous la forme "NOM=valeur" : le tableau *envp* ne contient que des pointeurs vers ces chaînes.
+ */
+#define _GNU_SOURCE // environ
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <unistd.h>
+
+#include "vars.h"
+#include "path_cache.h"
+
+extern char **environ;
+
+/// Capacité initiale de la table (puissance de 2)
+#define VARS_INITIAL_CAPACITY 128
+
+/** @brief Variable du shell.
+ * @struct var_t
+ */
+typedef struct
+{
+    char *text;        ///< "NOM=valeur" (NULL : case libre)
+    uint64_t hash;     ///< Hachage du nom
+    size_t name_len;   ///< Longueur du nom
+    uint8_t exported;  ///< Variable transmise aux commandes lancées
+} var_t;
+
+static var_t *table = NULL;      ///< Table des variables
+static size_t capacity = 0;      ///< Nombre de cases de la table
+static size_t count = 0;         ///< Nombre de variables
+static size_t exported_count = 0; ///< Nombre de variables exportées
+
+static unsigned long generation = 1;    ///< Génération des variables exportées
+static unsigned long envp_generation = 0; ///< Génération de *envp*
+static char **envp = NULL;              ///< Dernier tableau construit par *vars_envp()*
+static size_t envp_capacity = 0;        ///< Nombre d'entrées de *envp*
+
+/** @brief Fonction de hachage FNV-1a d'un nom de longueur donnée. */
+static uint64_t hash_name(const char *name, size_t len)
+{
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < len; ++i)
+    {
+        h ^= (unsigned char)name[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/** @brief Recherche de la case de *name* (occupée par *name* ou libre si absent). */
+static var_t *find_slot(var_t *t, size_t cap, const char *name, size_t len, uint64_t h)
+{
+    size_t i = h & (cap - 1);
+    while (t[i].text && (t[i].hash != h || t[i].name_len != len || memcmp(t[i].text, name, len) != 0))
+        i = (i + 1) & (cap - 1);
+    return &t[i];
+}
+
+/** @brief Agrandissement de la table (facteur de charge maximal 1/2). */
+static int grow(void)
+{
+    size_t new_cap = capacity ? capacity * 2 : VARS_INITIAL_CAPACITY;
+    var_t *t = calloc(new_cap, sizeof(*t));
+    if (!t)
+        return -1;
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        if (table[i].text)
+            *find_slot(t, new_cap, table[i].text, table[i].name_len, table[i].hash) = table[i];
+    }
+    free(table);
+    table = t;
+    capacity = new_cap;
+    return 0;
+}
+
+/** @brief Remplacement (ou création) de la variable *name* par le texte "NOM=valeur" déjà alloué *text*. */
+static int store(const char *name, size_t len, char *text, int exported)
+{
+    if ((count + 1) * 2 > capacity && grow() != 0)
+        return -1;
+    uint64_t h = hash_name(name, len);
+    var_t *v = find_slot(table, capacity, name, len, h);
+    if (v->text)
+        free(v->text);
+    else
+    {
+        v->hash = h;
+        v->name_len = len;
+        v->exported = 0;
+        count++;
+    }
+    v->text = text;
+    if (exported && !v->exported)
+    {
+        v->exported = 1;
+        exported_count++;
+    }
+    if (v->exported)
+        generation++;
+    return 0;
+}
+
+/** @brief Import de l'environnement du processus au premier accès (toutes ses variables sont exportées). */
+static void init_vars(void)
+{
+    if (capacity != 0 || grow() != 0)
+        return;
+    for (char **e = environ; e && *e; ++e)
+    {
+        const char *eq = strchr(*e, '=');
+        if (!eq || !vars_valid_name(*e, eq - *e))
+            continue;
+        char *text = strdup(*e);
+        if (!text || store(text, eq - *e, text, 1) != 0)
+            free(text);
+    }
+}
+
+/** @brief Fonction de vérification d'un nom de variable ([A-Za-z_][A-Za-z0-9_]*).
+ * @param name Début du nom.
+ * @param len Longueur du nom.
+ * @return int 1 si le nom est valide, 0 sinon.
+ */
+int vars_valid_name(const char *name, size_t len)
+{
+    if (!name || len == 0 || isdigit((unsigned char)name[0]))
+        return 0;
+    for (size_t i = 0; i < len; ++i)
+    {
+        if (!isalnum((unsigned char)name[i]) && name[i] != '_')
+            return 0;
+    }
+    return 1;
+}
+
+/** @brief Fonction de lecture d'une variable dont le nom n'est pas terminé par '\0'.
+ * @param name Début du nom (par exemple dans la ligne de commande, après '$').
+ * @param len Longueur du nom.
+ * @return const char* Valeur de la variable, NULL si elle n'est pas définie.
+ * @details Une recherche dans la table de hachage, sans copie du nom.
+ */
+const char *vars_getn(const char *name, size_t len)
+{
+    if (!name)
+        return NULL;
+    init_vars();
+    if (capacity == 0)
+        return NULL;
+    var_t *v = find_slot(table, capacity, name, len, hash_name(name, len));
+    return v->text ? v->text + len + 1 : NULL;
+}
+
+/** @brief Fonction de lecture d'une variable.
+ * @param name Nom de la variable.
+ * @return const char* Valeur de la variable (valable jusqu'à sa prochaine modification), NULL si elle n'est pas définie.
+ */
+const char *vars_get(const char *name)
+{
+    return name ? vars_getn(name, strlen(name)) : NULL;
+}
+
+/** @brief Fonction de définition d'une variable.
+ * @param name Nom de la variable.
+ * @param value Valeur (copiée).
+ * @param exported 1 pour exporter la variable, 0 pour conserver son état (une nouvelle variable est locale).
+ * @return int 0 en cas de succès, -1 en cas d'erreur (nom invalide, allocation impossible).
+ * @details Modifier PATH vide le cache des chemins de commandes (voir path_cache.h).
+ */
+int vars_set(const char *name, const char *value, int exported)
+{
+    size_t len = name ? strlen(name) : 0;
+    if (!vars_valid_name(name, len) || !value)
+        return -1;
+    init_vars();
+
+    size_t value_len = strlen(value);
+    char *text = malloc(len + 1 + value_len + 1);
+    if (!text)
+        return -1;
+    memcpy(text, name, len);
+    text[len] = '=';
+    memcpy(text + len + 1, value, value_len + 1);
+    if (store(name, len, text, exported) != 0)
+    {
+        free(text);
+        return -1;
+    }
+
+    // les chemins mémorisés dépendent de $PATH
+    if (strcmp(name, "PATH") == 0)
+        path_cache_clear();
+    return 0;
+}
+
+/** @brief Fonction d'export d'une variable déjà définie ("export NOM").
+ * @param name Nom de la variable.
+ * @return int 0 en cas de succès, -1 si la variable n'est pas définie.
+ */
+int vars_export(const char *name)
+{
+    if (!name)
+        return -1;
+    init_vars();
+    if (capacity == 0)
+        return -1;
+    size_t len = strlen(name);
+    var_t *v = find_slot(table, capacity, name, len, hash_name(name, len));
+    if (!v->text)
+        return -1;
+    if (!v->exported)
+    {
+        v->exported = 1;
+        exported_count++;
+        generation++;
+    }
+    return 0;
+}
+
+/** @brief Fonction de suppression d'une variable.
+ * @param name Nom de la variable.
+ * @return int 0 en cas de succès (variable supprimée ou inexistante), -1 si le nom est invalide.
+ * @details Supprimer PATH vide le cache des chemins de commandes.
+ */
+int vars_unset(const char *name)
+{
+    size_t len = name ? strlen(name) : 0;
+    if (!vars_valid_name(name, len))
+        return -1;
+    init_vars();
+    if (capacity == 0)
+        return 0;
+    var_t *v = find_slot(table, capacity, name, len, hash_name(name, len));
+    if (!v->text)
+        return 0;
+
+    if (v->exported)
+    {
+        exported_count--;
+        generation++;
+    }
+    free(v->text);
+    v->text = NULL;
+    count--;
+
+    // décalage arrière des cases suivantes de la même séquence de sondage : pas de marqueur de suppression
+    size_t hole = v - table;
+    for (size_t i = (hole + 1) & (capacity - 1); table[i].text; i = (i + 1) & (capacity - 1))
+    {
+        size_t home = table[i].hash & (capacity - 1);
+        // la case reste en place si sa position idéale est dans ]hole, i] (circulairement)
+        if (((i - home) & (capacity - 1)) < ((i - hole) & (capacity - 1)))
+            continue;
+        table[hole] = table[i];
+        table[i].text = NULL;
+        hole = i;
+    }
+
+    if (strcmp(name, "PATH") == 0)
+        path_cache_clear();
+    return 0;
+}
+
+/** @brief Fonction de récupération de l'environnement des commandes lancées.
+ * @return char** Tableau contigu "NOM=valeur" des variables exportées, terminé par NULL.
+ * @details Le tableau n'est reconstruit que si une variable exportée a changé depuis l'appel précédent ; il reste valable jusqu'au prochain appel.
+ *    En cas d'erreur d'allocation, *environ* est retourné.
+ */
+char **vars_envp(void)
+{
+    init_vars();
+    if (envp && envp_generation == generation)
+        return envp;
+
+    if (exported_count + 1 > envp_capacity)
+    {
+        size_t new_cap = exported_count + 1 + exported_count / 2;
+        char **e = realloc(envp, new_cap * sizeof(*e));
+        if (!e)
+            return environ;
+        envp = e;
+        envp_capacity = new_cap;
+    }
+    size_t n = 0;
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        if (table[i].text && table[i].exported)
+            envp[n++] = table[i].text;
+    }
+    envp[n] = NULL;
+    envp_generation = generation;
+    return envp;
+}
+
+/** @brief Fonction d'accès au compteur de génération des variables exportées.
+ * @return unsigned long Valeur incrémentée à chaque modification d'une variable exportée.
+ */
+unsigned long vars_generation(void)
+{
+    return generation;
+}
@@ -0,0 +1,613 @@
+/** @file zygote.c
+ * @brief Implementation of the zygote launcher
+ * @author Sofiane FETTAH
+ * @author Matthieu COMME
+ * @date 2025-26
+ * @details Implémentation du zygote.
+ *    Protocole (socket SOCK_SEQPACKET, un message par datagramme) :
+ *    - shell -> zygote : un en-tête *zygote_request_t* suivi du chemin, du répertoire courant, de argv et de l'environnement
+ *      (chaînes terminées par '\0'), avec les trois descripteurs des IOs standards en SCM_RIGHTS ;
+ *    - zygote -> shell : des messages *zygote_msg_t*, ZYGOTE_REPLY en réponse à chaque requête (PID ou errno de l'exec)
+ *      et ZYGOTE_EXIT à chaque changement d'état d'une commande lancée (suivi de SIGCHLD envoyé au shell).
+ *    Le shell est déclaré "subreaper" : si le zygote disparaît, les commandes en cours deviennent ses fils et sont récupérées normalement.
+ */
+#define _GNU_SOURCE // close_range(), MSG_CMSG_CLOEXEC
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+
+#include "zygote.h"
+#include "jobs.h"
+
+/// Types des messages échangés avec le zygote
+enum
+{
+    ZYGOTE_REQUEST = 1, ///< Lancement d'une commande (shell -> zygote -> fils en réserve)
+    ZYGOTE_REPLY,       ///< Résultat d'un lancement (zygote -> shell)
+    ZYGOTE_EXIT         ///< Changement d'état d'une commande lancée (zygote -> shell)
+};
+
+/** @brief En-tête d'une requête de lancement.
+ * @struct zygote_request_t
+ */
+typedef struct
+{
+    int type;     ///< ZYGOTE_REQUEST
+    int argc;     ///< Nombre d'arguments
+    int envc;     ///< Nombre de variables d'environnement
+    size_t len;   ///< Taille des chaînes qui suivent l'en-tête
+} zygote_request_t;
+
+/** @brief Message du zygote vers le shell.
+ * @struct zygote_msg_t
+ */
+typedef struct
+{
+    int type;             ///< ZYGOTE_REPLY ou ZYGOTE_EXIT
+    pid_t pid;            ///< PID de la commande (0 si l'exec a échoué)
+    int err;              ///< errno de l'exec (ZYGOTE_REPLY)
+    int status;           ///< Statut brut au format de wait4() (ZYGOTE_EXIT)
+    struct rusage rusage; ///< Ressources consommées (ZYGOTE_EXIT)
+} zygote_msg_t;
+
+/** @brief Fils en réserve du zygote.
+ * @struct zygote_child_t
+ */
+typedef struct
+{
+    pid_t pid; ///< PID du fils
+    int sock;  ///< Extrémité zygote de la socket du fils
+} zygote_child_t;
+
+static int zygote_sock = -1; ///< Extrémité shell de la socket du zygote (-1 : zygote arrêté)
+
+/// Tampon des requêtes (côté shell : construction, côté zygote et fils : réception)
+static char request_buf[sizeof(zygote_request_t) + ZYGOTE_MAX_REQUEST];
+
+/** @brief Envoi d'un message accompagné de descripteurs (SCM_RIGHTS).
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ */
+static int send_with_fds(int sock, const void *buf, size_t len, const int *fds, int nfds)
+{
+    struct iovec iov = {.iov_base = (void *)buf, .iov_len = len};
+    union
+    {
+        char buf[CMSG_SPACE(3 * sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    struct msghdr msg = {.msg_iov = &iov, .msg_iovlen = 1};
+    if (nfds > 0)
+    {
+        msg.msg_control = control.buf;
+        msg.msg_controllen = CMSG_SPACE(nfds * sizeof(int));
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(nfds * sizeof(int));
+        memcpy(CMSG_DATA(cmsg), fds, nfds * sizeof(int));
+    }
+    ssize_t n;
+    do
+        n = sendmsg(sock, &msg, MSG_NOSIGNAL);
+    while (n < 0 && errno == EINTR);
+    return (n == (ssize_t)len) ? 0 : -1;
+}
+
+/** @brief Réception d'un message accompagné de descripteurs (SCM_RIGHTS, reçus CLOEXEC).
+ * @param nfds Nombre de descripteurs attendus ; *fds* est rempli avec -1 pour ceux qui manquent.
+ * @return ssize_t Taille du message, 0 à la fermeture de la socket, -1 en cas d'erreur.
+ */
+static ssize_t recv_with_fds(int sock, void *buf, size_t len, int *fds, int nfds)
+{
+    struct iovec iov = {.iov_base = buf, .iov_len = len};
+    union
+    {
+        char buf[CMSG_SPACE(3 * sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    struct msghdr msg = {.msg_iov = &iov, .msg_iovlen = 1, .msg_control = control.buf, .msg_controllen = sizeof control.buf};
+    for (int i = 0; i < nfds; ++i)
+        fds[i] = -1;
+
+    ssize_t n;
+    do
+        n = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    while (n < 0 && errno == EINTR);
+    if (n <= 0)
+        return n;
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+    {
+        // le tampon de contrôle (arrondi par CMSG_SPACE) peut contenir plus de descripteurs qu'attendu : les surnuméraires sont
+        // refermés un à un, lus directement dans CMSG_DATA, sans les copier dans un tableau de taille fixe
+        size_t received = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        const unsigned char *data = CMSG_DATA(cmsg);
+        for (size_t i = 0; i < received; ++i)
+        {
+            int fd;
+            memcpy(&fd, data + i * sizeof(int), sizeof(int));
+            if (i < (size_t)nfds)
+                fds[i] = fd;
+            else
+                close(fd);
+        }
+    }
+    if (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC))
+    {
+        for (int i = 0; i < nfds; ++i)
+            if (fds[i] >= 0)
+                close(fds[i]);
+        errno = EMSGSIZE;
+        return -1;
+    }
+    return n;
+}
+
+/** @brief Ecriture complète d'un message (reprise après EINTR).
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ */
+static int send_msg(int sock, const zygote_msg_t *msg)
+{
+    return send_with_fds(sock, msg, sizeof *msg, NULL, 0);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------- */
+/* Fils en réserve                                                                                                   */
+/* ---------------------------------------------------------------------------------------------------------------- */
+
+/** @brief Boucle d'un fils en réserve : attente d'une requête puis exec.
+ * @param sock Socket vers le zygote (CLOEXEC : fermée automatiquement par un exec réussi).
+ * @details Ne retourne jamais. Si l'exec échoue, errno est transmis au zygote avant de terminer avec le code 127.
+ */
+static void child_main(int sock)
+{
+    int fds[3];
+    ssize_t n = recv_with_fds(sock, request_buf, sizeof request_buf, fds, 3);
+    if (n < (ssize_t)sizeof(zygote_request_t))
+        _exit(127); // zygote arrêté
+
+    // la commande ne doit pas être tuée par l'arrêt du zygote (PR_SET_PDEATHSIG survit à l'exec)
+    prctl(PR_SET_PDEATHSIG, 0);
+
+    zygote_request_t *req = (zygote_request_t *)request_buf;
+    char *p = request_buf + sizeof *req;
+    char *end = p + req->len;
+    char *argv[req->argc + 1];
+    char *envp[req->envc + 1];
+
+    const char *path = p;
+    p += strlen(p) + 1;
+    const char *cwd = p;
+    p += strlen(p) + 1;
+    for (int i = 0; i < req->argc && p < end; ++i, p += strlen(p) + 1)
+        argv[i] = p;
+    argv[req->argc] = NULL;
+    for (int i = 0; i < req->envc && p < end; ++i, p += strlen(p) + 1)
+        envp[i] = p;
+    envp[req->envc] = NULL;
+
+    // installation des IOs standards (dup2 retire CLOEXEC sur la copie)
+    for (int i = 0; i < 3; ++i)
+    {
+        if (fds[i] >= 0 && fds[i] != i)
+        {
+            dup2(fds[i], i);
+            close(fds[i]);
+        }
+    }
+    // si le répertoire courant du shell a été supprimé, la commande est lancée depuis celui du zygote
+    int unused_rc = (cwd[0] != '\0') ? chdir(cwd) : 0;
+    (void)unused_rc;
+
+    execve(path, argv, envp);
+
+    int err = errno;
+    ssize_t unused = write(sock, &err, sizeof err);
+    (void)unused;
+    _exit(127);
+}
+
+/** @brief Création d'un fils en réserve.
+ * @param child Fils à initialiser.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ */
+static int spawn_child(zygote_child_t *child)
+{
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv) != 0)
+        return -1;
+
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        close(sv[0]);
+        close(sv[1]);
+        return -1;
+    }
+    if (pid == 0)
+    {
+        // le fils ne garde que sa socket, et disparaît avec le zygote
+        prctl(PR_SET_PDEATHSIG, SIGKILL);
+        if (sv[1] != 3)
+        {
+            dup3(sv[1], 3, O_CLOEXEC);
+            sv[1] = 3;
+        }
+        close_range(4, ~0U, 0);
+
+        // la commande démarre avec les dispositions et le masque par défaut
+        signal(SIGINT, SIG_DFL);
+        signal(SIGQUIT, SIG_DFL);
+        signal(SIGTSTP, SIG_DFL);
+        signal(SIGTTIN, SIG_DFL);
+        signal(SIGTTOU, SIG_DFL);
+        sigset_t empty;
+        sigemptyset(&empty);
+        sigprocmask(SIG_SETMASK, &empty, NULL);
+        child_main(sv[1]);
+    }
+    close(sv[1]);
+    child->pid = pid;
+    child->sock = sv[0];
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------------------------------------------- */
+/* Zygote                                                                                                            */
+/* ---------------------------------------------------------------------------------------------------------------- */
+
+/** @brief Traitement d'une requête du shell par le premier fils en réserve.
+ * @return int 0 si la réponse a été envoyée, -1 si le shell n'est plus joignable.
+ */
+static int serve_request(int sock, zygote_child_t *pool, int *idle, int pool_size)
+{
+    int fds[3];
+    ssize_t n = recv_with_fds(sock, request_buf, sizeof request_buf, fds, 3);
+    if (n <= 0)
+        return -1;
+
+    zygote_msg_t reply = {.type = ZYGOTE_REPLY};
+    if (*idle == 0 && spawn_child(&pool[0]) == 0)
+        *idle = 1;
+    if (*idle == 0)
+        reply.err = EAGAIN;
+    else
+    {
+        zygote_child_t child = pool[--(*idle)];
+        if (send_with_fds(child.sock, request_buf, n, fds, 3) != 0)
+        {
+            reply.err = EAGAIN;
+            kill(child.pid, SIGKILL);
+            waitpid(child.pid, NULL, 0);
+        }
+        else
+        {
+            // fin de fichier : exec réussi (socket CLOEXEC), sinon errno de l'exec
+            int err = 0;
+            ssize_t r;
+            do
+                r = read(child.sock, &err, sizeof err);
+            while (r < 0 && errno == EINTR);
+            if (r == (ssize_t)sizeof err)
+            {
+                waitpid(child.pid, NULL, 0);
+                reply.err = err;
+            }
+            else
+                reply.pid = child.pid;
+        }
+        close(child.sock);
+    }
+    for (int i = 0; i < 3; ++i)
+        if (fds[i] >= 0)
+            close(fds[i]);
+
+    if (send_msg(sock, &reply) != 0)
+        return -1;
+
+    // la réserve est complétée après la réponse, hors du chemin critique du lancement
+    while (*idle < pool_size && spawn_child(&pool[*idle]) == 0)
+        (*idle)++;
+    return 0;
+}
+
+/** @brief Récupération des fils du zygote et transmission de leurs changements d'état au shell.
+ * @return int 0 en cas de succès, -1 si le shell n'est plus joignable.
+ */
+static int reap_children(int sock, zygote_child_t *pool, int *idle)
+{
+    int sent = 0;
+    int status;
+    struct rusage rusage;
+    pid_t pid;
+    while ((pid = wait4(-1, &status, WNOHANG | WUNTRACED | WCONTINUED, &rusage)) > 0)
+    {
+        // fils en réserve disparu : retiré de la réserve
+        int reserved = 0;
+        for (int i = 0; i < *idle; ++i)
+        {
+            if (pool[i].pid == pid)
+            {
+                if (WIFEXITED(status) || WIFSIGNALED(status))
+                {
+                    close(pool[i].sock);
+                    pool[i] = pool[--(*idle)];
+                }
+                reserved = 1;
+                break;
+            }
+        }
+        if (reserved)
+            continue;
+
+        zygote_msg_t msg = {.type = ZYGOTE_EXIT, .pid = pid, .status = status, .rusage = rusage};
+        if (send_msg(sock, &msg) != 0)
+            return -1;
+        sent = 1;
+    }
+    if (sent)
+        kill(getppid(), SIGCHLD);
+    return 0;
+}
+
+/** @brief Boucle principale du zygote.
+ * @param sock Socket vers le shell.
+ * @param pool_size Nombre de fils en réserve.
+ * @details Ne retourne jamais. Le zygote se termine (et ses fils en réserve avec lui) quand le shell ferme la socket.
+ */
+static void zygote_main(int sock, int pool_size)
+{
+    // le zygote ne garde que sa socket
+    if (sock != 3)
+    {
+        dup3(sock, 3, O_CLOEXEC);
+        sock = 3;
+    }
+    close_range(4, ~0U, 0);
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+
+    // les signaux du terminal sont destinés aux commandes, pas au zygote
+    signal(SIGINT, SIG_IGN);
+    signal(SIGQUIT, SIG_IGN);
+    signal(SIGTSTP, SIG_IGN);
+    signal(SIGTTIN, SIG_IGN);
+    signal(SIGTTOU, SIG_IGN);
+
+    sigset_t chld;
+    sigemptyset(&chld);
+    sigaddset(&chld, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &chld, NULL);
+    signal(SIGCHLD, SIG_DFL);
+    int sfd = signalfd(-1, &chld, SFD_CLOEXEC | SFD_NONBLOCK);
+    if (sfd < 0)
+        _exit(1);
+
+    zygote_child_t pool[pool_size];
+    int idle = 0;
+    while (idle < pool_size && spawn_child(&pool[idle]) == 0)
+        idle++;
+
+    struct pollfd pfds[2] = {{.fd = sock, .events = POLLIN}, {.fd = sfd, .events = POLLIN}};
+    while (1)
+    {
+        if (poll(pfds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        if (pfds[1].revents & POLLIN)
+        {
+            struct signalfd_siginfo info;
+            while (read(sfd, &info, sizeof info) == (ssize_t)sizeof info)
+                ;
+            if (reap_children(sock, pool, &idle) != 0)
+                break;
+        }
+        if (pfds[0].revents & (POLLIN | POLLHUP | POLLERR))
+        {
+            if (serve_request(sock, pool, &idle, pool_size) != 0)
+                break;
+        }
+    }
+
+    // les commandes en cours sont reprises par le shell (subreaper), les fils en réserve sont terminés
+    for (int i = 0; i < idle; ++i)
+        kill(pool[i].pid, SIGKILL);
+    _exit(0);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------- */
+/* Côté shell                                                                                                        */
+/* ---------------------------------------------------------------------------------------------------------------- */
+
+/** @brief Récupération des changements d'état transmis par le zygote (appelée par le gestionnaire de SIGCHLD). */
+static void zygote_reaper(void)
+{
+    if (zygote_sock < 0)
+        return;
+    zygote_msg_t msg;
+    ssize_t n;
+    while ((n = recv(zygote_sock, &msg, sizeof msg, MSG_DONTWAIT)) == (ssize_t)sizeof msg)
+    {
+        if (msg.type == ZYGOTE_EXIT)
+            jobs_record(msg.pid, msg.status, &msg.rusage);
+    }
+}
+
+/** @brief Fonction de démarrage du zygote.
+ * @param pool_size Nombre de fils gardés en réserve (au moins 1).
+ * @return int 0 en cas de succès (ou si le zygote est déjà démarré), -1 en cas d'erreur.
+ */
+int zygote_start(int pool_size)
+{
+    if (zygote_sock >= 0)
+        return 0;
+    if (pool_size < 1)
+        pool_size = 1;
+
+    // les commandes orphelines (zygote arrêté) deviennent des fils du shell
+    if (prctl(PR_SET_CHILD_SUBREAPER, 1) != 0)
+        return -1;
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv) != 0)
+        return -1;
+
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        close(sv[0]);
+        close(sv[1]);
+        return -1;
+    }
+    if (pid == 0)
+    {
+        close(sv[0]);
+        zygote_main(sv[1], pool_size);
+    }
+    close(sv[1]);
+
+    // numéros 0 à 9 laissés aux redirections de l'utilisateur ("exec 3>journal")
+    int high = fcntl(sv[0], F_DUPFD_CLOEXEC, 10);
+    if (high >= 0)
+    {
+        close(sv[0]);
+        sv[0] = high;
+    }
+
+    sigset_t old;
+    jobs_block(&old);
+    zygote_sock = sv[0];
+    jobs_unblock(&old);
+    jobs_set_reaper(zygote_reaper);
+    return 0;
+}
+
+/** @brief Fonction d'arrêt du zygote.
+ * @details Les fils en réserve sont terminés ; les commandes en cours continuent de s'exécuter.
+ */
+void zygote_stop(void)
+{
+    if (zygote_sock < 0)
+        return;
+
+    sigset_t old;
+    jobs_block(&old);
+    // le zygote voit la fin de fichier : les derniers changements d'état qu'il a envoyés sont lus jusqu'à sa sortie
+    shutdown(zygote_sock, SHUT_WR);
+    zygote_msg_t msg;
+    ssize_t n;
+    while ((n = recv(zygote_sock, &msg, sizeof msg, 0)) > 0 || (n < 0 && errno == EINTR))
+    {
+        if (n == (ssize_t)sizeof msg && msg.type == ZYGOTE_EXIT)
+            jobs_record(msg.pid, msg.status, &msg.rusage);
+    }
+    close(zygote_sock);
+    zygote_sock = -1;
+    jobs_unblock(&old);
+    jobs_set_reaper(NULL);
+}
+
+/** @brief Fonction de vérification du fonctionnement du zygote.
+ * @return int 1 si le zygote est démarré, 0 sinon.
+ */
+int zygote_running(void)
+{
+    return zygote_sock >= 0;
+}
+
+/** @brief Ajout d'une chaîne (avec son '\0') au tampon de requête.
+ * @return int 0 en cas de succès, -1 si la requête est trop grande.
+ */
+static int append(size_t *len, const char *str)
+{
+    size_t n = strlen(str) + 1;
+    if (*len + n > ZYGOTE_MAX_REQUEST)
+        return -1;
+    memcpy(request_buf + sizeof(zygote_request_t) + *len, str, n);
+    *len += n;
+    return 0;
+}
+
+/** @brief Fonction de lancement d'une commande par le zygote.
+ * @param path Chemin de l'exécutable.
+ * @param argv Arguments (terminés par NULL).
+ * @param envp Environnement de la commande (terminé par NULL, voir *vars_envp()*).
+ * @param fds Descripteurs à installer en entrée, sortie et erreur standard du processus.
+ * @param exec_errno Renseigné avec errno si l'exec a échoué, 0 sinon.
+ * @return pid_t PID du processus, 0 si l'exec a échoué, -1 si le zygote n'a pas pu traiter la requête (le zygote est alors arrêté).
+ * @details Doit être appelée SIGCHLD bloqué (voir *jobs_block()*), comme toute création de processus enregistré dans la table des jobs.
+ *    Le répertoire courant transmis est celui du shell.
+ */
+pid_t zygote_spawn(const char *path, char *const argv[], char *const envp[], const int fds[3], int *exec_errno)
+{
+    if (zygote_sock < 0 || !path || !argv || !envp || !fds)
+        return -1;
+    *exec_errno = 0;
+
+    zygote_request_t *req = (zygote_request_t *)request_buf;
+    size_t len = 0;
+    char *cwd = request_buf + sizeof *req + strlen(path) + 1;
+    if (append(&len, path) != 0)
+        return -1;
+    if (getcwd(cwd, ZYGOTE_MAX_REQUEST - len) == NULL)
+        cwd[0] = '\0';
+    len += strlen(cwd) + 1;
+
+    int argc = 0;
+    for (; argv[argc]; ++argc)
+        if (append(&len, argv[argc]) != 0)
+            return -1;
+    int envc = 0;
+    for (; envp[envc]; ++envc)
+        if (append(&len, envp[envc]) != 0)
+            return -1;
+
+    req->type = ZYGOTE_REQUEST;
+    req->argc = argc;
+    req->envc = envc;
+    req->len = len;
+    if (send_with_fds(zygote_sock, request_buf, sizeof *req + len, fds, 3) != 0)
+    {
+        zygote_stop();
+        return -1;
+    }
+
+    // les changements d'état reçus avant la réponse sont enregistrés au passage
+    zygote_msg_t msg;
+    while (1)
+    {
+        ssize_t n = recv(zygote_sock, &msg, sizeof msg, 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n != (ssize_t)sizeof msg)
+        {
+            zygote_stop();
+            return -1;
+        }
+        if (msg.type == ZYGOTE_EXIT)
+            jobs_record(msg.pid, msg.status, &msg.rusage);
+        else if (msg.type == ZYGOTE_REPLY)
+            break;
+    }
+    if (msg.pid > 0)
+        return msg.pid;
+    if (msg.err == EAGAIN)
+        return -1; // le zygote n'a pas pu créer de fils : le lancement classique prend le relais
+    *exec_errno = msg.err;
+    return 0;
+}